@@ -2,6 +2,7 @@
 
 layout(location = 0) in vec3 position;
 layout(location = 1) in vec4 color;
+layout(location = 2) in mat4 instance_transform;
 
 layout(location = 0) out vec4 vert_color;
 
@@ -10,7 +11,6 @@ layout(push_constant) uniform Constants {
 } constants;
 
 void main() {
-	gl_Position = constants.transform * vec4(position, 1.0);
+	gl_Position = constants.transform * instance_transform * vec4(position, 1.0);
 	vert_color = color;
 }
-
@@ -10,12 +10,15 @@ string(TOLOWER ${vc_platform} vc_lower_platform)
 set(ALIAS_PREFIX vc)
 
 option(VC_COMPILE_SHADERS             "Compile the shaders"                ON)
+option(VC_ENABLE_AVX2                 "Build the SIMD kernels for AVX2"    OFF)
+option(VC_BUILD_TOOLS                 "Build the offline asset tools"      ON)
 
 #======================================== Directories ========================================#
 
 set(vc_assets_dir   ${vc_root}/assets               CACHE PATH "Path to the assets directory")
 set(vc_deps_dir     ${vc_root}/deps                 CACHE PATH "Path to the dependencies directory")
 set(vc_code_dir     ${vc_root}/code                 CACHE PATH "Path to the application directory")
+set(vc_tools_dir    ${vc_root}/tools                CACHE PATH "Path to the tools directory")
 set(vc_platform_dir ${vc_code_dir}/platform/${vc_lower_platform} CACHE PATH "Path to the platform directory")
 
 #====================================== Configurations ======================================#
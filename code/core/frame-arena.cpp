@@ -0,0 +1,80 @@
+#include <memory>
+#include <algorithm>
+
+#include "core/frame-arena.hpp"
+
+namespace vc::core {
+
+linear_arena::linear_arena(const size_t capacity, std::pmr::memory_resource *upstream)
+	: m_upstream{ upstream }
+	, m_capacity{ capacity } {
+	if (m_capacity > 0) {
+		m_buffer = static_cast<std::byte *>(m_upstream->allocate(m_capacity, alignof(std::max_align_t)));
+	}
+}
+
+linear_arena::~linear_arena() {
+	for (const auto &[memory, size, alignment] : m_overflow_blocks) {
+		m_upstream->deallocate(memory, size, alignment);
+	}
+	if (m_buffer != nullptr) {
+		m_upstream->deallocate(m_buffer, m_capacity, alignof(std::max_align_t));
+	}
+}
+
+void linear_arena::reset() {
+	if (!std::empty(m_overflow_blocks)) {
+		// Grown once to what the frame needed, with some slack for alignment
+		const auto required{ std::max(m_capacity * 2, m_used + m_overflow_bytes * 2) };
+		for (const auto &[memory, size, alignment] : m_overflow_blocks) {
+			m_upstream->deallocate(memory, size, alignment);
+		}
+		m_overflow_blocks.clear();
+		if (m_buffer != nullptr) {
+			m_upstream->deallocate(m_buffer, m_capacity, alignof(std::max_align_t));
+		}
+		m_buffer = static_cast<std::byte *>(m_upstream->allocate(required, alignof(std::max_align_t)));
+		m_capacity = required;
+	}
+	m_used = 0;
+	m_overflow_bytes = 0;
+}
+
+void *linear_arena::do_allocate(const size_t bytes, const size_t alignment) {
+	const auto offset{ (m_used + alignment - 1) & ~(alignment - 1) };
+	if (m_buffer != nullptr && offset + bytes <= m_capacity) {
+		m_used = offset + bytes;
+		return m_buffer + offset;
+	}
+
+	// Reserved before the allocation, so a failing push_back can't leak it
+	m_overflow_blocks.reserve(std::size(m_overflow_blocks) + 1);
+	auto *memory{ m_upstream->allocate(bytes, alignment) };
+	m_overflow_blocks.push_back(overflow_block{ .memory = memory, .size = bytes, .alignment = alignment });
+	m_overflow_bytes += bytes;
+	++m_overflows;
+	return memory;
+}
+
+void linear_arena::do_deallocate(void *, size_t, size_t) {
+}
+
+bool linear_arena::do_is_equal(const std::pmr::memory_resource &other) const noexcept {
+	return this == &other;
+}
+
+frame_arenas::frame_arenas(const u32 frames_count, const size_t capacity) {
+	m_arenas.reserve(frames_count);
+	for (u32 i{}; i < frames_count; ++i) {
+		m_arenas.push_back(std::make_unique<linear_arena>(capacity));
+	}
+}
+
+linear_arena &frame_arenas::begin_frame(const size_t frame) {
+	m_current = frame % std::size(m_arenas);
+	auto &arena{ *m_arenas[m_current] };
+	arena.reset();
+	return arena;
+}
+
+} // namespace vc::core
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <memory_resource>
+
+#include "core/types.hpp"
+
+namespace vc::core {
+
+namespace constants {
+
+constexpr size_t frame_arena_capacity{ 64 * 1024 };
+
+} // namespace constants
+
+/// Bump allocator for data that dies with the frame. Deallocation is a no-op, `reset` releases
+/// everything at once. Requests beyond the capacity go to the upstream resource, and the next
+/// `reset` grows the arena to the high-water mark, so a steady workload stops allocating
+/// after its first frames. Not thread safe.
+class linear_arena final : public std::pmr::memory_resource {
+public:
+	explicit linear_arena(size_t capacity = constants::frame_arena_capacity,
+		std::pmr::memory_resource *upstream = std::pmr::new_delete_resource());
+	~linear_arena() override;
+
+	linear_arena(const linear_arena &) = delete;
+	linear_arena &operator=(const linear_arena &) = delete;
+
+	void reset();
+
+	[[nodiscard]] auto capacity() const noexcept { return m_capacity; }
+	/// Bytes handed out since the last reset, overflow included.
+	[[nodiscard]] auto used() const noexcept { return m_used + m_overflow_bytes; }
+	/// Upstream allocations since the construction, zero once the arena is large enough.
+	[[nodiscard]] auto overflows() const noexcept { return m_overflows; }
+
+private:
+	struct overflow_block {
+		void  *memory{ nullptr };
+		size_t size  {};
+		size_t alignment{};
+	};
+
+	std::pmr::memory_resource  *m_upstream;
+	std::byte                  *m_buffer  { nullptr };
+	size_t                      m_capacity{};
+	size_t                      m_used    {};
+	size_t                      m_overflow_bytes{};
+	u64                         m_overflows{};
+	std::vector<overflow_block> m_overflow_blocks;
+
+	auto do_allocate(size_t bytes, size_t alignment) -> void * override;
+	void do_deallocate(void *memory, size_t bytes, size_t alignment) override;
+	[[nodiscard]] auto do_is_equal(const std::pmr::memory_resource &other) const noexcept -> bool override;
+};
+
+/// One arena per frame in flight. `begin_frame` resets the slot's arena, call it once the
+/// slot's previous frame has completed.
+class frame_arenas {
+public:
+	explicit frame_arenas(u32 frames_count, size_t capacity = constants::frame_arena_capacity);
+
+	auto begin_frame(size_t frame) -> linear_arena &;
+	[[nodiscard]] auto current() noexcept -> linear_arena & { return *m_arenas[m_current]; }
+
+private:
+	std::vector<std::unique_ptr<linear_arena>> m_arenas;
+	size_t                                     m_current{};
+};
+
+} // namespace vc::core
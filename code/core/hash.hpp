@@ -0,0 +1,65 @@
+#pragma once
+
+#include <bit>
+#include <span>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+#include "core/types.hpp"
+
+namespace vc::core {
+
+namespace constants {
+
+constexpr u64 fnv_offset_basis{ 0xCBF29CE484222325ull };
+constexpr u64 fnv_prime       { 0x00000100000001B3ull };
+
+} // namespace constants
+
+[[nodiscard]] constexpr auto fnv1a(const std::span<const std::byte> bytes,
+	u64 hash = constants::fnv_offset_basis) noexcept -> u64 {
+	for (const auto byte : bytes) {
+		hash = (hash ^ static_cast<u64>(byte)) * constants::fnv_prime;
+	}
+	return hash;
+}
+
+[[nodiscard]] constexpr auto hash_combine(const u64 seed, const u64 value) noexcept -> u64 {
+	return seed ^ (value + 0x9E3779B97F4A7C15ull + (seed << 6) + (seed >> 2));
+}
+
+template<class T> requires std::is_trivially_copyable_v<T>
+[[nodiscard]] auto hash_bytes(const T &value, const u64 seed = constants::fnv_offset_basis) noexcept -> u64 {
+	return fnv1a(std::as_bytes(std::span<const T, 1>{ &value, 1 }), seed);
+}
+
+/// Word-wise checksum for large payloads: four independent multiply-rotate lanes keep it at memory
+/// bandwidth, unlike byte-wise FNV.
+[[nodiscard]] inline auto checksum64(const std::span<const std::byte> bytes) noexcept -> u64 {
+	constexpr u64 prime_1{ 0x9E3779B185EBCA87ull };
+	constexpr u64 prime_2{ 0xC2B2AE3D27D4EB4Full };
+	constexpr auto round{ [] (const u64 accumulator, const u64 word) {
+		return std::rotl(accumulator + word * prime_2, 31) * prime_1;
+	} };
+	const auto load{ [&bytes] (const size_t offset) {
+		u64 word;
+		std::memcpy(&word, std::data(bytes) + offset, sizeof(word));
+		return word;
+	} };
+
+	std::array<u64, 4> lanes{ prime_1 + prime_2, prime_2, 0, 0 - prime_1 };
+	size_t offset{};
+	for (; offset + sizeof(lanes) <= std::size(bytes); offset += sizeof(lanes)) {
+		for (size_t lane{}; lane < std::size(lanes); ++lane) {
+			lanes[lane] = round(lanes[lane], load(offset + lane * sizeof(u64)));
+		}
+	}
+
+	u64 hash{ std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18) };
+	hash = fnv1a(bytes.subspan(offset), hash ^ static_cast<u64>(std::size(bytes)));
+	return hash;
+}
+
+} // namespace vc::core
@@ -0,0 +1,222 @@
+#include <utility>
+
+#include "core/job-system.hpp"
+
+namespace vc::core {
+
+namespace {
+
+thread_local const job_system *current_system{ nullptr };
+thread_local i32               current_index { -1 };
+
+} // anonymous namespace
+
+#pragma region work_deque
+
+bool job_system::work_deque::push(job *task) noexcept {
+	const auto bottom{ m_bottom.load(std::memory_order_relaxed) };
+	const auto top{ m_top.load(std::memory_order_acquire) };
+	if (bottom - top >= static_cast<i64>(constants::job_deque_capacity)) return false;
+
+	m_buffer[static_cast<size_t>(bottom) & mask].store(task, std::memory_order_release);
+	std::atomic_thread_fence(std::memory_order_release);
+	m_bottom.store(bottom + 1, std::memory_order_relaxed);
+	return true;
+}
+
+job *job_system::work_deque::pop() noexcept {
+	const auto bottom{ m_bottom.load(std::memory_order_relaxed) - 1 };
+	m_bottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	auto top{ m_top.load(std::memory_order_relaxed) };
+
+	if (top > bottom) {
+		m_bottom.store(bottom + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	auto *task{ m_buffer[static_cast<size_t>(bottom) & mask].load(std::memory_order_relaxed) };
+	if (top == bottom) {
+		// The last job: race the thieves for it
+		if (!m_top.compare_exchange_strong(top, top + 1,
+			std::memory_order_seq_cst, std::memory_order_relaxed)) {
+			task = nullptr;
+		}
+		m_bottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+	return task;
+}
+
+job *job_system::work_deque::steal() noexcept {
+	auto top{ m_top.load(std::memory_order_acquire) };
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	const auto bottom{ m_bottom.load(std::memory_order_acquire) };
+	if (top >= bottom) return nullptr;
+
+	auto *task{ m_buffer[static_cast<size_t>(top) & mask].load(std::memory_order_acquire) };
+	if (!m_top.compare_exchange_strong(top, top + 1,
+		std::memory_order_seq_cst, std::memory_order_relaxed)) {
+		return nullptr;
+	}
+	return task;
+}
+
+#pragma endregion work_deque
+
+#pragma region job_system
+
+job_system::job_system(const u32 workers_count) {
+	m_workers.reserve(std::max(1u, workers_count));
+	for (u32 i{}; i < std::max(1u, workers_count); ++i) {
+		m_workers.push_back(std::make_unique<worker>());
+	}
+
+	current_system = this;
+	current_index = 0;
+	for (u32 i{ 1 }; i < std::size(m_workers); ++i) {
+		m_workers[i]->thread = std::thread{ [this, i] { worker_loop(i); } };
+	}
+}
+
+job_system::~job_system() {
+	m_running = false;
+	m_wake_generation.fetch_add(1);
+	m_wake_generation.notify_all();
+
+	for (auto &worker : m_workers) {
+		if (worker->thread.joinable()) worker->thread.join();
+	}
+
+	if (current_system == this) {
+		current_system = nullptr;
+		current_index = -1;
+	}
+}
+
+void job_system::submit(job &task, job_counter &counter) {
+	task.counter = &counter;
+	counter.m_pending.fetch_add(1, std::memory_order_relaxed);
+	enqueue(&task);
+}
+
+void job_system::submit(const std::span<job> tasks, job_counter &counter) {
+	counter.m_pending.fetch_add(static_cast<u32>(std::size(tasks)), std::memory_order_relaxed);
+	for (auto &task : tasks) {
+		task.counter = &counter;
+		enqueue(&task);
+	}
+}
+
+void job_system::wait(job_counter &counter) {
+	const auto self{ current_worker() };
+	for (u32 idle{}; !counter.is_done();) {
+		if (auto *task{ find_job(static_cast<u32>(self)) }; task != nullptr) {
+			execute(task);
+			idle = 0;
+		} else if (++idle > constants::idle_spins_before_sleep) {
+			std::this_thread::yield();
+		}
+	}
+
+	// The last job releases the counter under its mutex, so it's safe to destroy after this.
+	const std::lock_guard lock{ counter.m_mutex };
+	if (counter.m_error) {
+		std::rethrow_exception(std::exchange(counter.m_error, nullptr));
+	}
+}
+
+void job_system::enqueue(job *task) {
+	if (const auto self{ current_worker() }; self < 0 || !m_workers[self]->deque.push(task)) {
+		const std::lock_guard lock{ m_injection_mutex };
+		m_injection.push_back(task);
+	}
+	wake();
+}
+
+void job_system::worker_loop(const u32 index) {
+	current_system = this;
+	current_index = static_cast<i32>(index);
+
+	for (u32 idle{}; m_running;) {
+		const auto generation{ m_wake_generation.load() };
+		if (auto *task{ find_job(index) }; task != nullptr) {
+			execute(task);
+			idle = 0;
+			continue;
+		}
+
+		if (++idle < constants::idle_spins_before_sleep) {
+			std::this_thread::yield();
+			continue;
+		}
+
+		++m_sleeping;
+		m_wake_generation.wait(generation);
+		--m_sleeping;
+		idle = 0;
+	}
+}
+
+void job_system::execute(job *task) {
+	auto *counter{ task->counter };
+	try {
+		task->function(*task);
+	} catch (...) {
+		const std::lock_guard lock{ counter->m_mutex };
+		if (!counter->m_error) counter->m_error = std::current_exception();
+	}
+
+	if (task->owned) delete task;
+	finish(*counter);
+}
+
+void job_system::finish(job_counter &counter) {
+	std::vector<job *> continuations;
+	{
+		const std::lock_guard lock{ counter.m_mutex };
+		if (counter.m_pending.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+		continuations.swap(counter.m_continuations);
+	}
+
+	for (auto *task : continuations) {
+		enqueue(task);
+	}
+}
+
+void job_system::wake() noexcept {
+	m_wake_generation.fetch_add(1);
+	if (m_sleeping.load() > 0) {
+		m_wake_generation.notify_one();
+	}
+}
+
+job *job_system::find_job(const u32 self) {
+	const auto workers_count{ static_cast<u32>(std::size(m_workers)) };
+	if (self < workers_count) {
+		if (auto *task{ m_workers[self]->deque.pop() }; task != nullptr) return task;
+	}
+
+	{
+		const std::lock_guard lock{ m_injection_mutex };
+		if (!std::empty(m_injection)) {
+			auto *task{ m_injection.front() };
+			m_injection.pop_front();
+			return task;
+		}
+	}
+
+	for (u32 offset{ 1 }; offset <= workers_count; ++offset) {
+		const auto victim{ (self + offset) % workers_count };
+		if (victim == self) continue;
+		if (auto *task{ m_workers[victim]->deque.steal() }; task != nullptr) return task;
+	}
+	return nullptr;
+}
+
+i32 job_system::current_worker() const noexcept {
+	return current_system == this ? current_index : -1;
+}
+
+#pragma endregion job_system
+
+} // namespace vc::core
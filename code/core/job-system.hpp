@@ -0,0 +1,201 @@
+#pragma once
+
+#include <span>
+#include <array>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <exception>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+
+#include "core/types.hpp"
+
+namespace vc::core {
+
+struct job;
+class job_system;
+
+namespace constants {
+
+constexpr size_t job_deque_capacity  { 4096 }; ///< Per worker, power of two
+constexpr size_t max_parallel_chunks { 256  }; ///< Jobs a single parallel_for may split into
+constexpr u32    idle_spins_before_sleep{ 64 };
+
+} // namespace constants
+
+/// Counts unfinished jobs. Jobs scheduled with `run_after` start once the counter drops to zero.
+class job_counter {
+public:
+	job_counter() = default;
+	job_counter(const job_counter &) = delete;
+	job_counter &operator=(const job_counter &) = delete;
+
+	[[nodiscard]] bool is_done() const noexcept { return m_pending.load(std::memory_order_acquire) == 0; }
+
+private:
+	friend class job_system;
+
+	std::atomic<u32>   m_pending{};
+	std::mutex         m_mutex;
+	std::vector<job *> m_continuations;
+	std::exception_ptr m_error;
+};
+
+struct job {
+	using entry_point = void(*)(const job &);
+
+	entry_point  function{ nullptr };
+	void        *data    { nullptr };
+	size_t       begin   {};
+	size_t       end     {};
+	job_counter *counter { nullptr };
+	b8           owned   { false }; ///< Allocated by the job system and deleted after execution
+};
+
+/// Work-stealing scheduler. Every worker owns a Chase-Lev deque: it pushes and pops at the
+/// bottom, idle workers steal from the top. The thread that constructed the system is worker #0,
+/// so its `wait` calls execute jobs instead of blocking. Other threads submit through a shared
+/// injection queue. Jobs must not outlive the data they reference; exceptions are forwarded to
+/// the waiter of the job's counter.
+class job_system {
+public:
+	explicit job_system(u32 workers_count = std::max(1u, std::thread::hardware_concurrency()));
+	~job_system();
+
+	job_system(const job_system &) = delete;
+	job_system &operator=(const job_system &) = delete;
+
+	[[nodiscard]] auto workers_count() const noexcept { return static_cast<u32>(std::size(m_workers)); }
+
+	void submit(job &task, job_counter &counter);
+	void submit(std::span<job> tasks, job_counter &counter);
+
+	template<class Function>
+	void run(job_counter &counter, Function &&function);
+
+	/// Schedules the `function` once `dependency` is done; `counter` tracks the new job.
+	template<class Function>
+	void run_after(job_counter &dependency, job_counter &counter, Function &&function);
+
+	/// Calls `function(chunk_begin, chunk_end)` over [begin; end) in chunks of at least `grain`
+	/// items and returns when all of them are done.
+	template<class Function>
+	void parallel_for(size_t begin, size_t end, size_t grain, Function &&function);
+
+	/// Executes pending jobs until the `counter` is done, then rethrows the first job exception.
+	void wait(job_counter &counter);
+
+private:
+	class work_deque {
+	public:
+		[[nodiscard]] bool push(job *task) noexcept;
+		[[nodiscard]] auto pop() noexcept -> job *;
+		[[nodiscard]] auto steal() noexcept -> job *;
+
+	private:
+		static constexpr size_t mask{ constants::job_deque_capacity - 1 };
+		static_assert((constants::job_deque_capacity & mask) == 0, "Capacity must be a power of two");
+
+		alignas(64) std::atomic<i64> m_top   {};
+		alignas(64) std::atomic<i64> m_bottom{};
+		std::array<std::atomic<job *>, constants::job_deque_capacity> m_buffer{};
+	};
+
+	struct worker {
+		work_deque  deque;
+		std::thread thread;
+	};
+
+	std::vector<std::unique_ptr<worker>> m_workers;
+	std::mutex                           m_injection_mutex;
+	std::deque<job *>                    m_injection;
+	std::atomic<u32>                     m_wake_generation{};
+	std::atomic<u32>                     m_sleeping       {};
+	std::atomic<b8>                      m_running        { true };
+
+	void enqueue(job *task);
+	void worker_loop(u32 index);
+	void execute(job *task);
+	void finish(job_counter &counter);
+	void wake() noexcept;
+
+	[[nodiscard]] auto find_job(u32 self) -> job *;
+	[[nodiscard]] auto current_worker() const noexcept -> i32;
+
+	template<class Function>
+	[[nodiscard]] static auto make_owned_job(Function &&function) -> job *;
+};
+
+template<class Function>
+job *job_system::make_owned_job(Function &&function) {
+	using holder = std::decay_t<Function>;
+	return new job{
+		.function = [] (const job &self) {
+			const std::unique_ptr<holder> body{ static_cast<holder *>(self.data) };
+			(*body)();
+		},
+		.data  = new holder(std::forward<Function>(function)),
+		.owned = true
+	};
+}
+
+template<class Function>
+void job_system::run(job_counter &counter, Function &&function) {
+	auto *task{ make_owned_job(std::forward<Function>(function)) };
+	task->counter = &counter;
+	counter.m_pending.fetch_add(1, std::memory_order_relaxed);
+	enqueue(task);
+}
+
+template<class Function>
+void job_system::run_after(job_counter &dependency, job_counter &counter, Function &&function) {
+	auto *task{ make_owned_job(std::forward<Function>(function)) };
+	task->counter = &counter;
+	counter.m_pending.fetch_add(1, std::memory_order_relaxed);
+
+	{
+		const std::lock_guard lock{ dependency.m_mutex };
+		if (!dependency.is_done()) {
+			dependency.m_continuations.push_back(task);
+			return;
+		}
+	}
+	enqueue(task);
+}
+
+template<class Function>
+void job_system::parallel_for(const size_t begin, const size_t end, size_t grain, Function &&function) {
+	if (begin >= end) return;
+
+	const auto count{ end - begin };
+	grain = std::max({ grain, size_t{ 1 }, (count + constants::max_parallel_chunks - 1) / constants::max_parallel_chunks });
+	const auto chunks{ (count + grain - 1) / grain };
+	if (chunks == 1 || std::size(m_workers) == 1) {
+		function(begin, end);
+		return;
+	}
+
+	using body_type = std::remove_reference_t<Function>;
+	std::array<job, constants::max_parallel_chunks> tasks;
+	for (size_t chunk{}; chunk < chunks; ++chunk) {
+		tasks[chunk] = job{
+			.function = [] (const job &self) {
+				(*static_cast<body_type *>(self.data))(self.begin, self.end);
+			},
+			.data  = const_cast<void *>(static_cast<const void *>(std::addressof(function))),
+			.begin = begin + chunk * grain,
+			.end   = std::min(end, begin + (chunk + 1) * grain)
+		};
+	}
+
+	job_counter counter;
+	submit(std::span<job>{ std::data(tasks), chunks }, counter);
+	wait(counter);
+}
+
+} // namespace vc::core
@@ -0,0 +1,184 @@
+#include <charconv>
+
+#include <fmt/core.h>
+
+#include "core/json.hpp"
+
+namespace vc::core {
+
+#pragma region value
+
+json_document::kind json_document::value::type() const noexcept {
+	return is_valid() ? m_document->m_nodes[m_node].type : kind::null;
+}
+
+size_t json_document::value::size() const noexcept {
+	return is_valid() ? m_document->m_nodes[m_node].children : 0;
+}
+
+json_document::value json_document::value::operator[](const std::string_view key) const noexcept {
+	if (type() != kind::object) return value{};
+
+	const auto &nodes{ m_document->m_nodes };
+	for (auto child{ nodes[m_node].first_child }; child != none; child = nodes[child].next_sibling) {
+		if (nodes[child].key == key) return value{ m_document, child };
+	}
+	return value{};
+}
+
+json_document::value json_document::value::operator[](size_t index) const noexcept {
+	if (type() != kind::array) return value{};
+
+	const auto &nodes{ m_document->m_nodes };
+	auto child{ nodes[m_node].first_child };
+	for (; child != none && index != 0; --index) {
+		child = nodes[child].next_sibling;
+	}
+	return child != none ? value{ m_document, child } : value{};
+}
+
+f64 json_document::value::as_number(const f64 fallback) const noexcept {
+	if (type() != kind::number) return fallback;
+
+	const auto text{ m_document->m_nodes[m_node].text };
+	f64 result{ fallback };
+	std::from_chars(std::data(text), std::data(text) + std::size(text), result);
+	return result;
+}
+
+std::string_view json_document::value::as_string(const std::string_view fallback) const noexcept {
+	return type() == kind::string ? m_document->m_nodes[m_node].text : fallback;
+}
+
+b8 json_document::value::as_bool(const b8 fallback) const noexcept {
+	return type() == kind::boolean ? m_document->m_nodes[m_node].text == "true" : fallback;
+}
+
+#pragma endregion value
+
+#pragma region json_document
+
+json_document::json_document(const std::string_view text) : m_text{ text } {
+	m_nodes.reserve(std::size(text) / 8);
+	parse_value({});
+	skip_whitespace();
+	if (m_position != std::size(m_text) && m_text[m_position] != '\0') {
+		throw json_error{ fmt::format("Unexpected trailing data at {}.", m_position) };
+	}
+}
+
+u32 json_document::parse_value(const std::string_view key) {
+	skip_whitespace();
+	if (m_position >= std::size(m_text)) {
+		throw json_error{ "Unexpected end of the document." };
+	}
+
+	const auto index{ static_cast<u32>(std::size(m_nodes)) };
+	m_nodes.push_back(node{ .type = kind::null, .key = key, .text = {} });
+
+	const auto link_children{ [this, index] (const char closing, const bool keyed) {
+		u32 last{ none };
+		skip_whitespace();
+		if (m_position < std::size(m_text) && m_text[m_position] == closing) {
+			++m_position;
+			return;
+		}
+		while (true) {
+			std::string_view child_key;
+			if (keyed) {
+				skip_whitespace();
+				child_key = parse_string();
+				skip_whitespace();
+				expect(':');
+			}
+			const auto child{ parse_value(child_key) };
+			if (last == none) {
+				m_nodes[index].first_child = child;
+			} else {
+				m_nodes[last].next_sibling = child;
+			}
+			last = child;
+			++m_nodes[index].children;
+
+			skip_whitespace();
+			if (m_position < std::size(m_text) && m_text[m_position] == ',') {
+				++m_position;
+				continue;
+			}
+			expect(closing);
+			return;
+		}
+	} };
+
+	switch (m_text[m_position]) {
+		case '{':
+			++m_position;
+			m_nodes[index].type = kind::object;
+			link_children('}', true);
+			break;
+
+		case '[':
+			++m_position;
+			m_nodes[index].type = kind::array;
+			link_children(']', false);
+			break;
+
+		case '"':
+			m_nodes[index].type = kind::string;
+			m_nodes[index].text = parse_string();
+			break;
+
+		default: {
+			const auto begin{ m_position };
+			while (m_position < std::size(m_text)) {
+				const char symbol{ m_text[m_position] };
+				if (symbol == ',' || symbol == '}' || symbol == ']'
+				||  symbol == ' ' || symbol == '\t' || symbol == '\n' || symbol == '\r') break;
+				++m_position;
+			}
+			const auto literal{ m_text.substr(begin, m_position - begin) };
+			if (literal == "true" || literal == "false") {
+				m_nodes[index].type = kind::boolean;
+			} else if (literal == "null") {
+				m_nodes[index].type = kind::null;
+			} else if (!std::empty(literal)) {
+				m_nodes[index].type = kind::number;
+			} else {
+				throw json_error{ fmt::format("Unexpected symbol at {}.", begin) };
+			}
+			m_nodes[index].text = literal;
+		} break;
+	}
+	return index;
+}
+
+std::string_view json_document::parse_string() {
+	expect('"');
+	const auto begin{ m_position };
+	while (m_position < std::size(m_text) && m_text[m_position] != '"') {
+		m_position += (m_text[m_position] == '\\') ? 2 : 1;
+	}
+	if (m_position >= std::size(m_text)) {
+		throw json_error{ "Unterminated string." };
+	}
+	return m_text.substr(begin, m_position++ - begin);
+}
+
+void json_document::skip_whitespace() noexcept {
+	while (m_position < std::size(m_text)) {
+		const char symbol{ m_text[m_position] };
+		if (symbol != ' ' && symbol != '\t' && symbol != '\n' && symbol != '\r') return;
+		++m_position;
+	}
+}
+
+void json_document::expect(const char symbol) {
+	if (m_position >= std::size(m_text) || m_text[m_position] != symbol) {
+		throw json_error{ fmt::format("Expected '{}' at {}.", symbol, m_position) };
+	}
+	++m_position;
+}
+
+#pragma endregion json_document
+
+} // namespace vc::core
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+#include <stdexcept>
+#include <string_view>
+
+#include "core/types.hpp"
+
+namespace vc::core {
+
+/// Read-only JSON document over a caller-owned text. Strings are kept as raw views into the
+/// text (escape sequences are not decoded), which is enough for asset headers like glTF.
+class json_document {
+public:
+	enum class kind : u8 { null, boolean, number, string, array, object };
+
+	class value {
+	public:
+		value() = default;
+
+		[[nodiscard]] bool is_valid() const noexcept { return m_document != nullptr; }
+		[[nodiscard]] auto type() const noexcept -> kind;
+		[[nodiscard]] auto size() const noexcept -> size_t;
+
+		[[nodiscard]] auto operator[](std::string_view key) const noexcept -> value;
+		[[nodiscard]] auto operator[](size_t index) const noexcept -> value;
+
+		[[nodiscard]] auto as_number(f64 fallback = 0.0) const noexcept -> f64;
+		[[nodiscard]] auto as_string(std::string_view fallback = {}) const noexcept -> std::string_view;
+		[[nodiscard]] auto as_bool(b8 fallback = false) const noexcept -> b8;
+
+		template<class Integer>
+		[[nodiscard]] auto as(const Integer fallback = {}) const noexcept -> Integer {
+			return is_valid() && type() == kind::number
+				? static_cast<Integer>(as_number()) : fallback;
+		}
+
+	private:
+		friend class json_document;
+
+		const json_document *m_document{ nullptr };
+		u32                  m_node    {};
+
+		value(const json_document *document, u32 node) noexcept
+			: m_document{ document }, m_node{ node } {}
+	};
+
+	explicit json_document(std::string_view text);
+
+	[[nodiscard]] auto root() const noexcept -> value { return value{ this, 0 }; }
+
+private:
+	static constexpr u32 none{ ~u32{} };
+
+	struct node {
+		kind             type;
+		std::string_view key;
+		std::string_view text;
+		u32              first_child { none };
+		u32              next_sibling{ none };
+		u32              children    {};
+	};
+
+	std::vector<node> m_nodes;
+	std::string_view  m_text;
+	size_t            m_position{};
+
+	auto parse_value(std::string_view key) -> u32;
+	auto parse_string() -> std::string_view;
+	void skip_whitespace() noexcept;
+	void expect(char symbol);
+};
+
+class json_error : public std::runtime_error {
+public:
+	using base_type = std::runtime_error;
+	using base_type::runtime_error;
+};
+
+} // namespace vc::core
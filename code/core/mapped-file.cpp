@@ -0,0 +1,200 @@
+#include <string>
+#include <utility>
+#include <algorithm>
+
+#include <fmt/core.h>
+
+#if defined(VC_WINDOWS)
+#	define WIN32_LEAN_AND_MEAN
+#	define NOMINMAX
+#	include <windows.h>
+#else
+#	include <fcntl.h>
+#	include <unistd.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#endif // defined(VC_WINDOWS)
+
+#include "core/mapped-file.hpp"
+
+namespace vc::core {
+
+#if defined(VC_WINDOWS)
+
+mapped_file::mapped_file(const std::string_view path) {
+	const std::string filename{ path };
+	m_file = CreateFileA(std::data(filename), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (m_file == INVALID_HANDLE_VALUE) {
+		m_file = nullptr;
+		throw mapped_file_error{ fmt::format(R"(Cannot open "{}" file.)", path) };
+	}
+
+	LARGE_INTEGER file_size{};
+	GetFileSizeEx(m_file, &file_size);
+	m_size = static_cast<size_t>(file_size.QuadPart);
+	if (m_size == 0) return;
+
+	m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mapping != nullptr) {
+		m_data = static_cast<const std::byte *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+	}
+	if (m_data == nullptr) {
+		close();
+		throw mapped_file_error{ fmt::format(R"(Cannot map "{}" file.)", path) };
+	}
+}
+
+mapped_file::mapped_file(const std::string_view path, const size_t size) : m_writable{ true } {
+	const std::string filename{ path };
+	m_file = CreateFileA(std::data(filename), GENERIC_READ | GENERIC_WRITE, 0, nullptr,
+		CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (m_file == INVALID_HANDLE_VALUE) {
+		m_file = nullptr;
+		throw mapped_file_error{ fmt::format(R"(Cannot create "{}" file.)", path) };
+	}
+
+	m_size = size;
+	if (m_size == 0) return;
+
+	const auto size_high{ static_cast<DWORD>(static_cast<u64>(size) >> 32) };
+	const auto size_low{ static_cast<DWORD>(static_cast<u64>(size) & 0xFFFFFFFF) };
+	m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READWRITE, size_high, size_low, nullptr);
+	if (m_mapping != nullptr) {
+		m_data = static_cast<const std::byte *>(MapViewOfFile(m_mapping, FILE_MAP_WRITE, 0, 0, 0));
+	}
+	if (m_data == nullptr) {
+		close();
+		throw mapped_file_error{ fmt::format(R"(Cannot map "{}" file for writing.)", path) };
+	}
+}
+
+void mapped_file::release(const size_t, const size_t) const noexcept {
+	// Read-only views of a file are backed by the page cache; the working set trimmer
+	// drops consumed pages on its own.
+}
+
+void mapped_file::close() noexcept {
+	if (m_data != nullptr) UnmapViewOfFile(m_data);
+	if (m_mapping != nullptr) CloseHandle(m_mapping);
+	if (m_file != nullptr) CloseHandle(m_file);
+	m_data = nullptr;
+	m_mapping = nullptr;
+	m_file = nullptr;
+	m_size = 0;
+}
+
+#else
+
+mapped_file::mapped_file(const std::string_view path) {
+	const std::string filename{ path };
+	const int descriptor{ ::open(std::data(filename), O_RDONLY) };
+	if (descriptor < 0) {
+		throw mapped_file_error{ fmt::format(R"(Cannot open "{}" file.)", path) };
+	}
+
+	struct stat status{};
+	if (::fstat(descriptor, &status) != 0) {
+		::close(descriptor);
+		throw mapped_file_error{ fmt::format(R"(Cannot stat "{}" file.)", path) };
+	}
+
+	m_size = static_cast<size_t>(status.st_size);
+	if (m_size != 0) {
+		void *data{ ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, descriptor, 0) };
+		if (data == MAP_FAILED) {
+			::close(descriptor);
+			m_size = 0;
+			throw mapped_file_error{ fmt::format(R"(Cannot map "{}" file.)", path) };
+		}
+		::madvise(data, m_size, MADV_SEQUENTIAL);
+		m_data = static_cast<const std::byte *>(data);
+	}
+	::close(descriptor);
+}
+
+mapped_file::mapped_file(const std::string_view path, const size_t size) : m_writable{ true } {
+	const std::string filename{ path };
+	const int descriptor{ ::open(std::data(filename), O_RDWR | O_CREAT | O_TRUNC, 0644) };
+	if (descriptor < 0) {
+		throw mapped_file_error{ fmt::format(R"(Cannot create "{}" file.)", path) };
+	}
+
+	if (size != 0) {
+		void *data{ MAP_FAILED };
+		if (::ftruncate(descriptor, static_cast<off_t>(size)) == 0) {
+			data = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+		}
+		if (data == MAP_FAILED) {
+			::close(descriptor);
+			throw mapped_file_error{ fmt::format(R"(Cannot map "{}" file for writing.)", path) };
+		}
+		m_data = static_cast<const std::byte *>(data);
+		m_size = size;
+	}
+	::close(descriptor);
+}
+
+void mapped_file::release(const size_t offset, const size_t length) const noexcept {
+	if (m_data == nullptr || m_writable || offset >= m_size) return;
+
+	const auto page_size{ static_cast<size_t>(::sysconf(_SC_PAGESIZE)) };
+	const size_t begin{ (offset + page_size - 1) / page_size * page_size };
+	const size_t end{ std::min(offset + length, m_size) / page_size * page_size };
+	if (begin < end) {
+		::madvise(const_cast<std::byte *>(m_data) + begin, end - begin, MADV_DONTNEED);
+	}
+}
+
+void mapped_file::close() noexcept {
+	if (m_data != nullptr) {
+		::munmap(const_cast<std::byte *>(m_data), m_size);
+	}
+	m_data = nullptr;
+	m_size = 0;
+}
+
+#endif // defined(VC_WINDOWS)
+
+mapped_file::~mapped_file() {
+	close();
+}
+
+mapped_file::mapped_file(mapped_file &&other) noexcept
+	: m_data{ std::exchange(other.m_data, nullptr) }
+	, m_size{ std::exchange(other.m_size, 0) }
+	, m_writable{ std::exchange(other.m_writable, false) }
+#if defined(VC_WINDOWS)
+	, m_file{ std::exchange(other.m_file, nullptr) }
+	, m_mapping{ std::exchange(other.m_mapping, nullptr) }
+#endif // defined(VC_WINDOWS)
+{}
+
+mapped_file &mapped_file::operator=(mapped_file &&other) noexcept {
+	if (this != &other) {
+		close();
+		m_data = std::exchange(other.m_data, nullptr);
+		m_size = std::exchange(other.m_size, 0);
+		m_writable = std::exchange(other.m_writable, false);
+#if defined(VC_WINDOWS)
+		m_file = std::exchange(other.m_file, nullptr);
+		m_mapping = std::exchange(other.m_mapping, nullptr);
+#endif // defined(VC_WINDOWS)
+	}
+	return *this;
+}
+
+std::span<const std::byte> mapped_file::bytes() const noexcept {
+	return std::span<const std::byte>{ m_data, m_size };
+}
+
+std::span<std::byte> mapped_file::writable_bytes() noexcept {
+	if (!m_writable) return {};
+	return std::span<std::byte>{ const_cast<std::byte *>(m_data), m_size };
+}
+
+std::string_view mapped_file::text() const noexcept {
+	return std::string_view{ reinterpret_cast<const char *>(m_data), m_size };
+}
+
+} // namespace vc::core
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <span>
+#include <cstddef>
+#include <stdexcept>
+#include <string_view>
+
+#include "core/types.hpp"
+
+namespace vc::core {
+
+class mapped_file {
+public:
+	/// Maps an existing file for reading.
+	explicit mapped_file(std::string_view path);
+	/// Creates (or truncates) the file to `size` bytes and maps it for writing.
+	mapped_file(std::string_view path, size_t size);
+	~mapped_file();
+
+	mapped_file(const mapped_file &) = delete;
+	mapped_file &operator=(const mapped_file &) = delete;
+	mapped_file(mapped_file &&other) noexcept;
+	mapped_file &operator=(mapped_file &&other) noexcept;
+
+	[[nodiscard]] auto bytes() const noexcept -> std::span<const std::byte>;
+	[[nodiscard]] auto writable_bytes() noexcept -> std::span<std::byte>;
+	[[nodiscard]] auto text() const noexcept -> std::string_view;
+	[[nodiscard]] auto size() const noexcept { return m_size; }
+	[[nodiscard]] auto is_writable() const noexcept { return m_writable; }
+
+	/// Hints the OS that the range was consumed and its pages may be dropped. The mapping stays
+	/// valid: touching the range again just faults the pages back in from the file.
+	void release(size_t offset, size_t length) const noexcept;
+
+private:
+	const std::byte *m_data{ nullptr };
+	size_t           m_size{};
+	b8               m_writable{ false };
+#if defined(VC_WINDOWS)
+	void *m_file   { nullptr };
+	void *m_mapping{ nullptr };
+#endif // defined(VC_WINDOWS)
+
+	void close() noexcept;
+};
+
+class mapped_file_error : public std::runtime_error {
+public:
+	using base_type = std::runtime_error;
+	using base_type::runtime_error;
+};
+
+} // namespace vc::core
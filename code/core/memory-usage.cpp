@@ -0,0 +1,95 @@
+#include <new>
+#include <atomic>
+#include <cstdlib>
+#include <utility>
+
+#if defined(VC_WINDOWS)
+#	define WIN32_LEAN_AND_MEAN
+#	define NOMINMAX
+#	include <windows.h>
+#	include <psapi.h>
+#else
+#	include <sys/resource.h>
+#endif // defined(VC_WINDOWS)
+
+#include "core/memory-usage.hpp"
+
+namespace vc::core {
+
+namespace {
+
+std::atomic<u64> allocations_count{};
+std::atomic<u64> allocated_bytes  {};
+
+} // anonymous namespace
+
+allocation_counters heap_allocations() noexcept {
+	return {
+		.count = allocations_count.load(std::memory_order_relaxed),
+		.bytes = allocated_bytes.load(std::memory_order_relaxed)
+	};
+}
+
+u64 peak_resident_bytes() noexcept {
+#if defined(VC_WINDOWS)
+	PROCESS_MEMORY_COUNTERS counters{};
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+	return counters.PeakWorkingSetSize;
+#else
+	rusage usage{};
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+	return static_cast<u64>(usage.ru_maxrss);
+#else
+	return static_cast<u64>(usage.ru_maxrss) * 1024;
+#endif // defined(__APPLE__)
+#endif // defined(VC_WINDOWS)
+}
+
+void allocation_phases::begin(const std::string_view name) {
+	end();
+	m_current = name;
+	m_start = heap_allocations();
+	m_running = true;
+}
+
+void allocation_phases::end() {
+	if (!m_running) return;
+	m_finished.push_back(allocation_phase{
+		.name        = std::move(m_current),
+		.allocations = heap_allocations() - m_start
+	});
+	m_running = false;
+}
+
+std::vector<allocation_phase> allocation_phases::phases() const {
+	auto result{ m_finished };
+	if (m_running) {
+		result.push_back(allocation_phase{ .name = m_current, .allocations = heap_allocations() - m_start });
+	}
+	return result;
+}
+
+} // namespace vc::core
+
+#pragma region global allocation functions
+
+// The array, nothrow and sized forms forward to these
+void *operator new(const std::size_t size) {
+	vc::core::allocations_count.fetch_add(1, std::memory_order_relaxed);
+	vc::core::allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+	if (auto *memory{ std::malloc(size == 0 ? 1 : size) }; memory != nullptr) {
+		return memory;
+	}
+	throw std::bad_alloc{};
+}
+
+void operator delete(void *memory) noexcept {
+	std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept {
+	std::free(memory);
+}
+
+#pragma endregion
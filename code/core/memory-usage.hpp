@@ -0,0 +1,52 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <string_view>
+
+#include "core/types.hpp"
+
+namespace vc::core {
+
+struct allocation_counters {
+	u64 count{};
+	u64 bytes{};  ///< Requested, freed memory is not subtracted
+
+	[[nodiscard]] auto operator-(const allocation_counters &other) const noexcept -> allocation_counters {
+		return { count - other.count, bytes - other.bytes };
+	}
+};
+
+/// Calls of the global `operator new` since the start of the program, from every thread.
+/// Over-aligned allocations are not counted.
+[[nodiscard]] auto heap_allocations() noexcept -> allocation_counters;
+/// Peak resident set of the process in bytes, 0 when the platform doesn't report it.
+[[nodiscard]] auto peak_resident_bytes() noexcept -> u64;
+
+struct allocation_phase {
+	std::string         name;
+	allocation_counters allocations{};
+};
+
+/// Attributes the heap allocations to consecutive named phases, e.g. loading, the frame loop
+/// and shutdown, to see where memory churn comes from.
+class allocation_phases {
+public:
+	allocation_phases() = default;
+	explicit allocation_phases(const std::string_view first) { begin(first); }
+
+	/// Ends the current phase and starts counting `name`.
+	void begin(std::string_view name);
+	void end();
+
+	/// Finished phases, then the current one up to now.
+	[[nodiscard]] auto phases() const -> std::vector<allocation_phase>;
+
+private:
+	std::vector<allocation_phase> m_finished;
+	std::string                   m_current;
+	allocation_counters           m_start{};
+	b8                            m_running{ false };
+};
+
+} // namespace vc::core
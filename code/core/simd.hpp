@@ -0,0 +1,156 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+
+#include "core/types.hpp"
+
+#if defined(__AVX2__)
+	#define VC_SIMD_AVX2
+	#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define VC_SIMD_SSE
+	#include <emmintrin.h>
+#endif
+
+#if defined(VC_SIMD_AVX2)
+	#define VC_SIMD_SSE
+#endif
+
+namespace vc::core::simd {
+
+/// Kernels are written once against the `lanes` interface and instantiated for the widest
+/// instruction set the translation unit is compiled for (see `VC_ENABLE_AVX2` in CMake).
+/// `scalar_lanes` is the fallback and the reference implementation.
+struct scalar_lanes {
+	static constexpr size_t width{ 1 };
+	static constexpr const char *name{ "scalar" };
+
+	f32 value;
+
+	[[nodiscard]] static auto load(const f32 *source) noexcept { return scalar_lanes{ *source }; }
+	[[nodiscard]] static auto broadcast(const f32 value) noexcept { return scalar_lanes{ value }; }
+	void store(f32 *destination) const noexcept { *destination = value; }
+
+	[[nodiscard]] friend auto operator+(scalar_lanes a, scalar_lanes b) noexcept { return scalar_lanes{ a.value + b.value }; }
+	[[nodiscard]] friend auto operator-(scalar_lanes a, scalar_lanes b) noexcept { return scalar_lanes{ a.value - b.value }; }
+	[[nodiscard]] friend auto operator*(scalar_lanes a, scalar_lanes b) noexcept { return scalar_lanes{ a.value * b.value }; }
+
+	[[nodiscard]] friend auto rsqrt(scalar_lanes a) noexcept { return scalar_lanes{ 1.0f / std::sqrt(a.value) }; }
+	[[nodiscard]] friend auto min(scalar_lanes a, scalar_lanes b) noexcept { return scalar_lanes{ a.value < b.value ? a.value : b.value }; }
+	[[nodiscard]] friend auto max(scalar_lanes a, scalar_lanes b) noexcept { return scalar_lanes{ a.value > b.value ? a.value : b.value }; }
+	/// One bit per lane, set where `a < b`.
+	[[nodiscard]] friend auto less_mask(scalar_lanes a, scalar_lanes b) noexcept -> u32 { return a.value < b.value ? 1u : 0u; }
+
+	/// Writes lane `k` of the four registers as four consecutive floats at `destination + k * stride`.
+	static void store_transposed(scalar_lanes r0, scalar_lanes r1, scalar_lanes r2, scalar_lanes r3,
+		f32 *destination, size_t) noexcept {
+		destination[0] = r0.value;
+		destination[1] = r1.value;
+		destination[2] = r2.value;
+		destination[3] = r3.value;
+	}
+};
+
+#if defined(VC_SIMD_SSE)
+
+struct sse_lanes {
+	static constexpr size_t width{ 4 };
+	static constexpr const char *name{ "sse2" };
+
+	__m128 value;
+
+	[[nodiscard]] static auto load(const f32 *source) noexcept { return sse_lanes{ _mm_loadu_ps(source) }; }
+	[[nodiscard]] static auto broadcast(const f32 value) noexcept { return sse_lanes{ _mm_set1_ps(value) }; }
+	void store(f32 *destination) const noexcept { _mm_storeu_ps(destination, value); }
+
+	[[nodiscard]] friend auto operator+(sse_lanes a, sse_lanes b) noexcept { return sse_lanes{ _mm_add_ps(a.value, b.value) }; }
+	[[nodiscard]] friend auto operator-(sse_lanes a, sse_lanes b) noexcept { return sse_lanes{ _mm_sub_ps(a.value, b.value) }; }
+	[[nodiscard]] friend auto operator*(sse_lanes a, sse_lanes b) noexcept { return sse_lanes{ _mm_mul_ps(a.value, b.value) }; }
+
+	/// The hardware estimate refined with one Newton-Raphson step.
+	[[nodiscard]] friend auto rsqrt(sse_lanes a) noexcept {
+		const auto estimate{ _mm_rsqrt_ps(a.value) };
+		const auto refined{ _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), estimate),
+			_mm_sub_ps(_mm_set1_ps(3.0f), _mm_mul_ps(_mm_mul_ps(a.value, estimate), estimate))) };
+		return sse_lanes{ refined };
+	}
+	[[nodiscard]] friend auto min(sse_lanes a, sse_lanes b) noexcept { return sse_lanes{ _mm_min_ps(a.value, b.value) }; }
+	[[nodiscard]] friend auto max(sse_lanes a, sse_lanes b) noexcept { return sse_lanes{ _mm_max_ps(a.value, b.value) }; }
+	[[nodiscard]] friend auto less_mask(sse_lanes a, sse_lanes b) noexcept -> u32 {
+		return static_cast<u32>(_mm_movemask_ps(_mm_cmplt_ps(a.value, b.value)));
+	}
+
+	static void store_transposed(sse_lanes r0, sse_lanes r1, sse_lanes r2, sse_lanes r3,
+		f32 *destination, const size_t stride) noexcept {
+		_MM_TRANSPOSE4_PS(r0.value, r1.value, r2.value, r3.value);
+		_mm_storeu_ps(destination, r0.value);
+		_mm_storeu_ps(destination + stride, r1.value);
+		_mm_storeu_ps(destination + stride * 2, r2.value);
+		_mm_storeu_ps(destination + stride * 3, r3.value);
+	}
+};
+
+#endif
+
+#if defined(VC_SIMD_AVX2)
+
+struct avx2_lanes {
+	static constexpr size_t width{ 8 };
+	static constexpr const char *name{ "avx2" };
+
+	__m256 value;
+
+	[[nodiscard]] static auto load(const f32 *source) noexcept { return avx2_lanes{ _mm256_loadu_ps(source) }; }
+	[[nodiscard]] static auto broadcast(const f32 value) noexcept { return avx2_lanes{ _mm256_set1_ps(value) }; }
+	void store(f32 *destination) const noexcept { _mm256_storeu_ps(destination, value); }
+
+	[[nodiscard]] friend auto operator+(avx2_lanes a, avx2_lanes b) noexcept { return avx2_lanes{ _mm256_add_ps(a.value, b.value) }; }
+	[[nodiscard]] friend auto operator-(avx2_lanes a, avx2_lanes b) noexcept { return avx2_lanes{ _mm256_sub_ps(a.value, b.value) }; }
+	[[nodiscard]] friend auto operator*(avx2_lanes a, avx2_lanes b) noexcept { return avx2_lanes{ _mm256_mul_ps(a.value, b.value) }; }
+
+	[[nodiscard]] friend auto rsqrt(avx2_lanes a) noexcept {
+		const auto estimate{ _mm256_rsqrt_ps(a.value) };
+		const auto refined{ _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), estimate),
+			_mm256_sub_ps(_mm256_set1_ps(3.0f), _mm256_mul_ps(_mm256_mul_ps(a.value, estimate), estimate))) };
+		return avx2_lanes{ refined };
+	}
+	[[nodiscard]] friend auto min(avx2_lanes a, avx2_lanes b) noexcept { return avx2_lanes{ _mm256_min_ps(a.value, b.value) }; }
+	[[nodiscard]] friend auto max(avx2_lanes a, avx2_lanes b) noexcept { return avx2_lanes{ _mm256_max_ps(a.value, b.value) }; }
+	[[nodiscard]] friend auto less_mask(avx2_lanes a, avx2_lanes b) noexcept -> u32 {
+		return static_cast<u32>(_mm256_movemask_ps(_mm256_cmp_ps(a.value, b.value, _CMP_LT_OQ)));
+	}
+
+	static void store_transposed(const avx2_lanes r0, const avx2_lanes r1, const avx2_lanes r2, const avx2_lanes r3,
+		f32 *destination, const size_t stride) noexcept {
+		// Transposes both 128 bit halves at once: the low one holds lanes 0-3, the high one 4-7
+		const auto t0{ _mm256_unpacklo_ps(r0.value, r1.value) };
+		const auto t1{ _mm256_unpackhi_ps(r0.value, r1.value) };
+		const auto t2{ _mm256_unpacklo_ps(r2.value, r3.value) };
+		const auto t3{ _mm256_unpackhi_ps(r2.value, r3.value) };
+		const auto store{ [destination, stride] (const size_t lane, const __m256 column) {
+			_mm_storeu_ps(destination + stride * lane, _mm256_castps256_ps128(column));
+			_mm_storeu_ps(destination + stride * (lane + 4), _mm256_extractf128_ps(column, 1));
+		} };
+		store(0, _mm256_shuffle_ps(t0, t2, 0x44));
+		store(1, _mm256_shuffle_ps(t0, t2, 0xEE));
+		store(2, _mm256_shuffle_ps(t1, t3, 0x44));
+		store(3, _mm256_shuffle_ps(t1, t3, 0xEE));
+	}
+};
+
+using native_lanes = avx2_lanes;
+#elif defined(VC_SIMD_SSE)
+using native_lanes = sse_lanes;
+#else
+using native_lanes = scalar_lanes;
+#endif
+
+/// Array lengths are padded to a multiple of this, so kernels never need a scalar tail.
+constexpr size_t max_width{ 8 };
+
+[[nodiscard]] constexpr auto padded_size(const size_t count) noexcept -> size_t {
+	return (count + max_width - 1) / max_width * max_width;
+}
+
+} // namespace vc::core::simd
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+#include "core/types.hpp"
+
+namespace vc::core {
+
+/// Lock-free single producer, single consumer handoff of the latest value. The producer fills
+/// `back()` and publishes it; the consumer `acquire`s the most recent published value into
+/// `front()`. Neither side ever blocks and intermediate values may be skipped by the consumer.
+template<class T>
+class triple_buffer {
+public:
+	triple_buffer() = default;
+	triple_buffer(const triple_buffer &) = delete;
+	triple_buffer &operator=(const triple_buffer &) = delete;
+
+	/// Producer side: the slot to fill before `publish`.
+	[[nodiscard]] auto back() noexcept -> T & { return m_slots[m_back]; }
+
+	void publish() noexcept {
+		m_back = m_middle.exchange(static_cast<u8>(m_back | fresh_bit), std::memory_order_acq_rel) & index_mask;
+	}
+
+	/// Consumer side: swaps in the latest published value, returns false if there is none newer.
+	bool acquire() noexcept {
+		if ((m_middle.load(std::memory_order_relaxed) & fresh_bit) == 0) return false;
+		m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & index_mask;
+		return true;
+	}
+
+	[[nodiscard]] auto front() const noexcept -> const T & { return m_slots[m_front]; }
+
+private:
+	static constexpr u8 index_mask{ 0b011 };
+	static constexpr u8 fresh_bit { 0b100 };
+
+	std::array<T, 3>            m_slots {};
+	alignas(64) u8              m_back  { 0 };
+	alignas(64) std::atomic<u8> m_middle{ 1 };
+	alignas(64) u8              m_front { 2 };
+};
+
+} // namespace vc::core
@@ -0,0 +1,162 @@
+#include <array>
+#include <cstdio>
+#include <algorithm>
+
+#include <fmt/core.h>
+
+#include "engine/graphics/batch-renderer.hpp"
+
+namespace vc::engine::graphics {
+
+batch_renderer::batch_renderer(device &dev, const u32 slots_count, const u32 max_draws)
+	: m_device{ dev }
+	, m_slots_count{ slots_count }
+	, m_max_draws{ max_draws }
+	, m_slot_size{ aligned_slot_size(dev, max_draws) }
+	, m_commands{ dev, VkDeviceSize{ slots_count } * m_slot_size,
+		VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT } {
+}
+
+u32 batch_renderer::add_mesh(const u32 vertex_count, const u32 index_count) {
+	if (m_staging.has_value() || m_vertex_buffer.has_value()) {
+		throw batch_renderer_error{ "Cannot add a mesh once the batch is being written." };
+	}
+	if (vertex_count == 0 || index_count == 0) {
+		throw batch_renderer_error{ "Cannot add a mesh without vertices or indices." };
+	}
+
+	m_meshes.push_back(batch_mesh{
+		.vertex_count  = vertex_count,
+		.first_index   = m_indices_count,
+		.index_count   = index_count,
+		.vertex_offset = static_cast<i32>(m_vertices_count)
+	});
+	m_vertices_count += vertex_count;
+	m_indices_count += index_count;
+	return static_cast<u32>(std::size(m_meshes) - 1);
+}
+
+void batch_renderer::write_mesh(const u32 id, const mesh_writer &writer) {
+	using vertex = resources::model::vertex;
+
+	if (m_vertex_buffer.has_value()) {
+		throw batch_renderer_error{ "Cannot write a mesh of an uploaded batch." };
+	}
+	if (!m_staging.has_value()) {
+		m_staging.emplace(m_device, vertices_size() + VkDeviceSize{ m_indices_count } * sizeof(u32),
+			VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	}
+
+	auto &mesh{ m_meshes.at(id) };
+	const auto vertices{ m_staging->as<vertex>(VkDeviceSize{ static_cast<u32>(mesh.vertex_offset) } * sizeof(vertex),
+		mesh.vertex_count) };
+	const auto indices{ m_staging->as<u32>(vertices_size() + VkDeviceSize{ mesh.first_index } * sizeof(u32),
+		mesh.index_count) };
+	writer(vertices, indices);
+
+	// Reads the staging memory back once, the writers only fill it
+	mesh.bounds = resources::model::compute_bounds(vertices);
+	++m_written_count;
+}
+
+void batch_renderer::upload() {
+	if (std::empty(m_meshes)) {
+		throw batch_renderer_error{ "Cannot upload an empty batch." };
+	}
+	if (m_written_count != std::size(m_meshes)) {
+		throw batch_renderer_error{ fmt::format("Only {} of the {} meshes were written before the upload.",
+			m_written_count, std::size(m_meshes)) };
+	}
+
+	const auto vertices_bytes{ vertices_size() };
+	const auto indices_bytes{ VkDeviceSize{ m_indices_count } * sizeof(u32) };
+	m_vertex_buffer.emplace(m_device, vertices_bytes,
+		VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	m_index_buffer.emplace(m_device, indices_bytes,
+		VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+	const auto command_buffer{ m_device.begin_single_time_commands() };
+	const VkBufferCopy vertices_region{ .srcOffset = 0, .dstOffset = 0, .size = vertices_bytes };
+	const VkBufferCopy indices_region{ .srcOffset = vertices_bytes, .dstOffset = 0, .size = indices_bytes };
+	vkCmdCopyBuffer(command_buffer, m_staging->handle(), m_vertex_buffer->handle(), 1, &vertices_region);
+	vkCmdCopyBuffer(command_buffer, m_staging->handle(), m_index_buffer->handle(), 1, &indices_region);
+	m_device.end_single_time_commands(command_buffer);
+
+	std::printf("[engine][graphics][batch_renderer] Uploaded %zu meshes: %u vertices, %u indices\n",
+		std::size(m_meshes), m_vertices_count, m_indices_count);
+
+	m_staging.reset();
+}
+
+std::span<VkDrawIndexedIndirectCommand> batch_renderer::commands(const u32 slot) const noexcept {
+	return m_commands.as<VkDrawIndexedIndirectCommand>(slot_offset(slot), m_max_draws);
+}
+
+VkDeviceSize batch_renderer::slot_offset(const u32 slot) const noexcept {
+	return VkDeviceSize{ slot % m_slots_count } * m_slot_size;
+}
+
+VkDrawIndexedIndirectCommand batch_renderer::make_command(const batch_mesh &mesh,
+	const u32 instance_count, const u32 first_instance) noexcept {
+	return VkDrawIndexedIndirectCommand{
+		.indexCount    = mesh.index_count,
+		.instanceCount = instance_count,
+		.firstIndex    = mesh.first_index,
+		.vertexOffset  = mesh.vertex_offset,
+		.firstInstance = first_instance
+	};
+}
+
+void batch_renderer::bind(VkCommandBuffer command_buffer) const {
+	const std::array buffers{ m_vertex_buffer->handle() };
+	const std::array offsets{ VkDeviceSize{ 0 } };
+
+	vkCmdBindVertexBuffers(command_buffer, 0,
+		static_cast<u32>(std::size(buffers)), std::data(buffers), std::data(offsets));
+	vkCmdBindIndexBuffer(command_buffer, m_index_buffer->handle(), 0, VK_INDEX_TYPE_UINT32);
+}
+
+void batch_renderer::draw(VkCommandBuffer command_buffer, const u32 slot, const u32 draws_count) const {
+	if (draws_count == 0) return;
+
+	const auto &features{ m_device.features() };
+	const auto offset{ slot_offset(slot) };
+	constexpr auto stride{ static_cast<u32>(sizeof(VkDrawIndexedIndirectCommand)) };
+
+	if (!features.drawIndirectFirstInstance) {
+		// Indirect records must have a zero `firstInstance` here, so the CPU issues the draws
+		for (const auto &command : commands(slot).first(draws_count)) {
+			vkCmdDrawIndexed(command_buffer, command.indexCount, command.instanceCount,
+				command.firstIndex, command.vertexOffset, command.firstInstance);
+		}
+		return;
+	}
+
+	if (features.multiDrawIndirect) {
+		const auto max_count{ std::max(1u, m_device.limits().maxDrawIndirectCount) };
+		for (u32 first{}; first < draws_count; first += max_count) {
+			vkCmdDrawIndexedIndirect(command_buffer, m_commands.handle(), offset + VkDeviceSize{ first } * stride,
+				std::min(max_count, draws_count - first), stride);
+		}
+		return;
+	}
+
+	for (u32 draw{}; draw < draws_count; ++draw) {
+		vkCmdDrawIndexedIndirect(command_buffer, m_commands.handle(), offset + VkDeviceSize{ draw } * stride, 1, stride);
+	}
+}
+
+VkDeviceSize batch_renderer::vertices_size() const noexcept {
+	return VkDeviceSize{ m_vertices_count } * sizeof(resources::model::vertex);
+}
+
+VkDeviceSize batch_renderer::aligned_slot_size(const device &dev, const u32 max_draws) noexcept {
+	// Slots are bound as storage buffers by GPU culling, so they start at aligned offsets
+	const auto alignment{ std::max<VkDeviceSize>(1, dev.limits().minStorageBufferOffsetAlignment) };
+	const auto size{ VkDeviceSize{ max_draws } * sizeof(VkDrawIndexedIndirectCommand) };
+	return (size + alignment - 1) / alignment * alignment;
+}
+
+} // namespace vc::engine::graphics
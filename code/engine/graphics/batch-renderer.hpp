@@ -0,0 +1,84 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <optional>
+#include <functional>
+#include <stdexcept>
+
+#include "engine/graphics/buffer.hpp"
+#include "engine/resources/model.hpp"
+
+namespace vc::engine::graphics {
+
+struct batch_mesh {
+	u32               vertex_count {};
+	u32               first_index  {};
+	u32               index_count  {};
+	i32               vertex_offset{};
+	resources::bounds bounds       {};
+};
+
+/// Packs many meshes into one shared vertex and one shared index buffer and draws them with
+/// `VkDrawIndexedIndirectCommand` records: a whole batch is a single indirect draw call when the
+/// device supports `multiDrawIndirect`. Meshes are reserved with `add_mesh`, written in place into
+/// a staging buffer with `write_mesh` and uploaded once; the command records live in a host visible buffer with one slot per frame in flight.
+class batch_renderer {
+public:
+	/// Fills the vertices and the indices of a mesh in the staging buffer.
+	using mesh_writer = std::function<void(std::span<resources::model::vertex>, std::span<u32>)>;
+
+	batch_renderer(device &device, u32 slots_count, u32 max_draws);
+
+	batch_renderer(const batch_renderer &) = delete;
+	batch_renderer &operator=(const batch_renderer &) = delete;
+
+	/// Reserves the ranges of a mesh. Every mesh is added before the first `write_mesh`, so the
+	/// whole batch shares one staging buffer. Meshes are always indexed, every mesh is drawn the same way.
+	auto add_mesh(u32 vertex_count, u32 index_count) -> u32;
+	/// Lets the `writer` fill the reserved ranges in place, then computes the bounds of the mesh.
+	void write_mesh(u32 id, const mesh_writer &writer);
+
+	/// Moves the meshes to device local memory; no mesh can be added afterwards.
+	void upload();
+
+	[[nodiscard]] auto mesh(const u32 id) const -> const batch_mesh & { return m_meshes.at(id); }
+	[[nodiscard]] auto meshes_count() const noexcept { return static_cast<u32>(std::size(m_meshes)); }
+	[[nodiscard]] auto max_draws() const noexcept { return m_max_draws; }
+	[[nodiscard]] auto commands_buffer() const noexcept { return m_commands.handle(); }
+	[[nodiscard]] auto slot_size() const noexcept { return m_slot_size; }
+	[[nodiscard]] auto slot_offset(u32 slot) const noexcept -> VkDeviceSize;
+
+	/// The draw records of the `slot`, filled by the frame that owns it.
+	[[nodiscard]] auto commands(u32 slot) const noexcept -> std::span<VkDrawIndexedIndirectCommand>;
+	[[nodiscard]] static auto make_command(const batch_mesh &mesh, u32 instance_count, u32 first_instance) noexcept
+		-> VkDrawIndexedIndirectCommand;
+
+	void bind(VkCommandBuffer command_buffer) const;
+	void draw(VkCommandBuffer command_buffer, u32 slot, u32 draws_count) const;
+
+private:
+	device                                &m_device;
+	u32                                    m_slots_count;
+	u32                                    m_max_draws;
+	VkDeviceSize                           m_slot_size;
+	std::vector<batch_mesh>                m_meshes;
+	u32                                    m_vertices_count{};
+	u32                                    m_indices_count {};
+	u32                                    m_written_count {};
+	std::optional<buffer>                  m_staging;        ///< Vertices then indices of every mesh, until `upload`
+	std::optional<buffer>                  m_vertex_buffer;
+	std::optional<buffer>                  m_index_buffer;
+	buffer                                 m_commands;
+
+	[[nodiscard]] auto vertices_size() const noexcept -> VkDeviceSize;
+	[[nodiscard]] static auto aligned_slot_size(const device &device, u32 max_draws) noexcept -> VkDeviceSize;
+};
+
+class batch_renderer_error : public std::runtime_error {
+public:
+	using base_type = std::runtime_error;
+	using base_type::runtime_error;
+};
+
+} // namespace vc::engine::graphics
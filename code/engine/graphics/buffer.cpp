@@ -0,0 +1,58 @@
+#include <cstring>
+#include <utility>
+
+#include <fmt/core.h>
+
+#include "engine/graphics/buffer.hpp"
+
+namespace vc::engine::graphics {
+
+buffer::buffer(device &dev, const VkDeviceSize size, const VkBufferUsageFlags usage,
+	const VkMemoryPropertyFlags properties) : m_device{ dev }, m_size{ size } {
+	m_buffer = m_device.make_buffer(size, usage, properties, m_memory);
+
+	if ((properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) == 0) return;
+
+	void *data{ nullptr };
+	if (VK_SUCCESS != vkMapMemory(m_device.handle(), m_memory, 0, size, 0, &data)) {
+		vkDestroyBuffer(m_device.handle(), m_buffer, m_device.allocator());
+		m_device.free_memory(m_memory);
+		throw buffer_error{ fmt::format("Cannot map a buffer {} bytes long.", size) };
+	}
+	m_mapped = static_cast<std::byte *>(data);
+}
+
+buffer buffer::make_device_local(device &dev, const std::span<const std::byte> data, const VkBufferUsageFlags usage) {
+	buffer staging{ dev, data.size_bytes(), VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT };
+	std::memcpy(std::data(staging.bytes()), std::data(data), data.size_bytes());
+
+	buffer target{ dev, data.size_bytes(), usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT };
+	dev.copy_buffer(staging.handle(), target.handle(), data.size_bytes());
+	return target;
+}
+
+buffer::buffer(buffer &&other) noexcept
+	: m_device{ other.m_device }
+	, m_buffer{ std::exchange(other.m_buffer, VK_NULL_HANDLE) }
+	, m_memory{ std::exchange(other.m_memory, VK_NULL_HANDLE) }
+	, m_size  { std::exchange(other.m_size, 0) }
+	, m_mapped{ std::exchange(other.m_mapped, nullptr) } {
+}
+
+buffer::~buffer() {
+	const auto device{ m_device.handle() };
+	if (m_mapped != nullptr) {
+		vkUnmapMemory(device, m_memory);
+	}
+	auto &deletions{ m_device.deletions() };
+	deletions.push(m_buffer);
+	deletions.push(m_memory);
+}
+
+std::span<std::byte> buffer::bytes() const noexcept {
+	if (m_mapped == nullptr) return {};
+	return std::span<std::byte>{ m_mapped, static_cast<size_t>(m_size) };
+}
+
+} // namespace vc::engine::graphics
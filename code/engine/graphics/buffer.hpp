@@ -0,0 +1,55 @@
+#pragma once
+
+#include <span>
+#include <cstddef>
+#include <stdexcept>
+
+#include "engine/graphics/device.hpp"
+
+namespace vc::engine::graphics {
+
+/// Owns a `VkBuffer` with its dedicated memory. Host visible buffers stay mapped for their
+/// whole lifetime, so per-frame data can be written into them without map/unmap calls.
+class buffer {
+public:
+	buffer(device &device, VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
+	~buffer();
+
+	buffer(const buffer &) = delete;
+	buffer &operator=(const buffer &) = delete;
+	buffer(buffer &&other) noexcept;
+	buffer &operator=(buffer &&other) = delete;
+
+	/// Copies `data` into a new device local buffer through a staging one.
+	[[nodiscard]] static auto make_device_local(device &device, std::span<const std::byte> data,
+		VkBufferUsageFlags usage) -> buffer;
+
+	[[nodiscard]] auto handle() const noexcept { return m_buffer; }
+	[[nodiscard]] auto memory() const noexcept { return m_memory; }
+	[[nodiscard]] auto size() const noexcept { return m_size; }
+	[[nodiscard]] auto is_mapped() const noexcept { return m_mapped != nullptr; }
+
+	/// The mapped memory, empty for device local buffers.
+	[[nodiscard]] auto bytes() const noexcept -> std::span<std::byte>;
+
+	template<class T>
+	[[nodiscard]] auto as(const VkDeviceSize offset = 0, const size_t count = 0) const noexcept -> std::span<T> {
+		auto *first{ reinterpret_cast<T *>(std::data(bytes()) + offset) };
+		return std::span<T>{ first, count == 0 ? static_cast<size_t>((m_size - offset) / sizeof(T)) : count };
+	}
+
+private:
+	device        &m_device;
+	VkBuffer       m_buffer{ VK_NULL_HANDLE };
+	VkDeviceMemory m_memory{ VK_NULL_HANDLE };
+	VkDeviceSize   m_size  {};
+	std::byte     *m_mapped{ nullptr };
+};
+
+class buffer_error : public std::runtime_error {
+public:
+	using base_type = std::runtime_error;
+	using base_type::runtime_error;
+};
+
+} // namespace vc::engine::graphics
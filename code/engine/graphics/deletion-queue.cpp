@@ -0,0 +1,83 @@
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include "engine/graphics/device.hpp"
+#include "engine/graphics/deletion-queue.hpp"
+
+namespace vc::engine::graphics {
+
+namespace {
+
+template<class... Functions>
+struct overloaded : Functions... {
+	using Functions::operator()...;
+};
+
+} // anonymous namespace
+
+deletion_queue::~deletion_queue() {
+	flush();
+}
+
+void deletion_queue::push(resource object) {
+	if (std::visit([] (const auto handle) { return handle == VK_NULL_HANDLE; }, object)) return;
+
+	const std::lock_guard lock{ m_mutex };
+	m_entries.push_back(entry{ .frame = m_submitted + 1, .object = std::move(object) });
+}
+
+void deletion_queue::frame_submitted(const u64 frame) noexcept {
+	const std::lock_guard lock{ m_mutex };
+	m_submitted = std::max(m_submitted, frame);
+}
+
+void deletion_queue::collect(const u64 completed) {
+	// Released outside of the lock, destroying an object may queue others
+	std::vector<resource> released;
+	{
+		const std::lock_guard lock{ m_mutex };
+		while (!std::empty(m_entries) && m_entries.front().frame <= completed) {
+			released.push_back(std::move(m_entries.front().object));
+			m_entries.pop_front();
+		}
+	}
+	for (const auto &object : released) {
+		release(object);
+	}
+}
+
+void deletion_queue::flush() {
+	std::deque<entry> entries;
+	{
+		const std::lock_guard lock{ m_mutex };
+		entries.swap(m_entries);
+	}
+	for (const auto &[_, object] : entries) {
+		release(object);
+	}
+}
+
+size_t deletion_queue::pending() const {
+	const std::lock_guard lock{ m_mutex };
+	return std::size(m_entries);
+}
+
+void deletion_queue::release(const resource &object) noexcept {
+	const auto device{ m_device.handle() };
+	const auto *allocator{ m_device.allocator() };
+	std::visit(overloaded{
+		[&] (const VkBuffer buffer)               { vkDestroyBuffer(device, buffer, allocator); },
+		[&] (const VkImage image)                 { vkDestroyImage(device, image, allocator); },
+		[&] (const VkImageView view)              { vkDestroyImageView(device, view, allocator); },
+		[&] (const VkDeviceMemory memory)         { m_device.free_memory(memory); },
+		[&] (const VkPipeline pipeline)           { vkDestroyPipeline(device, pipeline, allocator); },
+		[&] (const VkPipelineLayout layout)       { vkDestroyPipelineLayout(device, layout, allocator); },
+		[&] (const VkSampler sampler)             { vkDestroySampler(device, sampler, allocator); },
+		[&] (const VkFramebuffer framebuffer)     { vkDestroyFramebuffer(device, framebuffer, allocator); },
+		[&] (const VkRenderPass render_pass)      { vkDestroyRenderPass(device, render_pass, allocator); },
+		[&] (const VkDescriptorPool pool)         { vkDestroyDescriptorPool(device, pool, allocator); }
+	}, object);
+}
+
+} // namespace vc::engine::graphics
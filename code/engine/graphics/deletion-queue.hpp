@@ -0,0 +1,55 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <variant>
+
+#include <vulkan/vulkan.h>
+
+#include "core/types.hpp"
+
+namespace vc::engine::graphics {
+
+class device;
+
+/// Destroys objects once the GPU has finished every frame that may still use them. A queued
+/// object is tagged with the frame being recorded, the one after the last submission, and is
+/// released in bulk when that frame completes. The swap chain reports the submissions and the
+/// completions; without frames in flight `flush` releases everything at once.
+class deletion_queue {
+public:
+	using resource = std::variant<VkBuffer, VkImage, VkImageView, VkDeviceMemory, VkPipeline,
+		VkPipelineLayout, VkSampler, VkFramebuffer, VkRenderPass, VkDescriptorPool>;
+
+	explicit deletion_queue(device &device) noexcept : m_device{ device } {}
+	~deletion_queue();
+
+	deletion_queue(const deletion_queue &) = delete;
+	deletion_queue &operator=(const deletion_queue &) = delete;
+
+	/// Null handles are ignored, memory is returned through `device::free_memory`.
+	void push(resource object);
+
+	void frame_submitted(u64 frame) noexcept;
+	/// Releases the objects of the frames up to `completed`.
+	void collect(u64 completed);
+	/// Releases everything, the device must be idle.
+	void flush();
+
+	[[nodiscard]] auto pending() const -> size_t;
+
+private:
+	struct entry {
+		u64      frame{};
+		resource object;
+	};
+
+	device            &m_device;
+	mutable std::mutex m_mutex;
+	std::deque<entry>  m_entries;  ///< Frames never decrease, the oldest ones are in front
+	u64                m_submitted{};
+
+	void release(const resource &object) noexcept;
+};
+
+} // namespace vc::engine::graphics
@@ -0,0 +1,222 @@
+#include <algorithm>
+
+#include <fmt/core.h>
+
+#include "core/hash.hpp"
+#include "engine/graphics/descriptors.hpp"
+
+namespace vc::engine::graphics {
+
+#pragma region descriptor_layout_cache
+
+descriptor_layout_cache::descriptor_layout_cache(device &dev) : m_device{ dev } {
+}
+
+descriptor_layout_cache::~descriptor_layout_cache() {
+	for (const auto &[_, layout] : m_layouts) {
+		vkDestroyDescriptorSetLayout(m_device.handle(), layout, m_device.allocator());
+	}
+}
+
+VkDescriptorSetLayout descriptor_layout_cache::get(const std::span<const VkDescriptorSetLayoutBinding> bindings) {
+	layout_key key{ .bindings = { std::begin(bindings), std::end(bindings) } };
+	std::ranges::sort(key.bindings, {}, &VkDescriptorSetLayoutBinding::binding);
+	if (std::ranges::any_of(key.bindings, [] (const auto &binding) { return binding.pImmutableSamplers != nullptr; })) {
+		throw descriptor_error{ "Immutable samplers aren't supported by the layout cache." };
+	}
+
+	if (const auto found{ m_layouts.find(key) }; found != std::end(m_layouts)) {
+		return found->second;
+	}
+
+	const VkDescriptorSetLayoutCreateInfo layout_info{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO,
+		.bindingCount = static_cast<u32>(std::size(key.bindings)),
+		.pBindings    = std::data(key.bindings)
+	};
+
+	VkDescriptorSetLayout layout;
+	if (VK_SUCCESS != vkCreateDescriptorSetLayout(m_device.handle(), &layout_info, m_device.allocator(), &layout)) {
+		throw descriptor_error{ fmt::format("Failed to create a descriptor set layout of {} bindings.",
+			std::size(key.bindings)) };
+	}
+	m_layouts.emplace(std::move(key), layout);
+	return layout;
+}
+
+bool descriptor_layout_cache::layout_key::operator==(const layout_key &other) const noexcept {
+	return std::ranges::equal(bindings, other.bindings, [] (const auto &a, const auto &b) {
+		return a.binding == b.binding && a.descriptorType == b.descriptorType
+			&& a.descriptorCount == b.descriptorCount && a.stageFlags == b.stageFlags;
+	});
+}
+
+size_t descriptor_layout_cache::layout_key_hash::operator()(const layout_key &key) const noexcept {
+	u64 hash{ std::size(key.bindings) };
+	for (const auto &binding : key.bindings) {
+		// Every field fits in its own bits, so a binding is hashed as one word
+		const auto packed{ static_cast<u64>(binding.binding) | static_cast<u64>(binding.descriptorType) << 8
+			| static_cast<u64>(binding.descriptorCount) << 16 | static_cast<u64>(binding.stageFlags) << 32 };
+		hash = core::hash_combine(hash, packed);
+	}
+	return static_cast<size_t>(hash);
+}
+
+#pragma endregion descriptor_layout_cache
+
+#pragma region descriptor_allocator
+
+descriptor_allocator::descriptor_allocator(device &dev, const u32 initial_sets)
+	: m_device{ dev }, m_sets_per_pool{ initial_sets } {
+}
+
+descriptor_allocator::descriptor_allocator(descriptor_allocator &&other) noexcept
+	: m_device{ other.m_device }
+	, m_sets_per_pool{ other.m_sets_per_pool }
+	, m_current{ std::exchange(other.m_current, VK_NULL_HANDLE) }
+	, m_full_pools{ std::move(other.m_full_pools) }
+	, m_free_pools{ std::move(other.m_free_pools) } {
+}
+
+descriptor_allocator::~descriptor_allocator() {
+	if (m_current != VK_NULL_HANDLE) {
+		vkDestroyDescriptorPool(m_device.handle(), m_current, m_device.allocator());
+	}
+	for (const auto *pools : { &m_full_pools, &m_free_pools }) {
+		for (const auto pool : *pools) {
+			vkDestroyDescriptorPool(m_device.handle(), pool, m_device.allocator());
+		}
+	}
+}
+
+VkDescriptorSet descriptor_allocator::allocate(const VkDescriptorSetLayout layout) {
+	if (m_current == VK_NULL_HANDLE) {
+		m_current = acquire_pool();
+	}
+
+	VkDescriptorSetAllocateInfo allocate_info{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+		.descriptorPool     = m_current,
+		.descriptorSetCount = 1,
+		.pSetLayouts        = &layout
+	};
+
+	VkDescriptorSet set;
+	auto status{ vkAllocateDescriptorSets(m_device.handle(), &allocate_info, &set) };
+	if (status == VK_ERROR_OUT_OF_POOL_MEMORY || status == VK_ERROR_FRAGMENTED_POOL) {
+		// The pool is kept until `reset`, its sets are still in use
+		m_full_pools.push_back(m_current);
+		m_current = acquire_pool();
+		allocate_info.descriptorPool = m_current;
+		status = vkAllocateDescriptorSets(m_device.handle(), &allocate_info, &set);
+	}
+
+	if (VK_SUCCESS != status) {
+		throw descriptor_error{ fmt::format("Failed to allocate a descriptor set ({}).", static_cast<i32>(status)) };
+	}
+	return set;
+}
+
+void descriptor_allocator::reset() {
+	if (m_current != VK_NULL_HANDLE) {
+		m_full_pools.push_back(std::exchange(m_current, VK_NULL_HANDLE));
+	}
+	for (const auto pool : m_full_pools) {
+		vkResetDescriptorPool(m_device.handle(), pool, 0);
+		m_free_pools.push_back(pool);
+	}
+	m_full_pools.clear();
+}
+
+VkDescriptorPool descriptor_allocator::acquire_pool() {
+	if (!std::empty(m_free_pools)) {
+		const auto pool{ m_free_pools.back() };
+		m_free_pools.pop_back();
+		return pool;
+	}
+
+	const auto pool{ make_pool(m_sets_per_pool) };
+	m_sets_per_pool = std::min(m_sets_per_pool * 2, constants::descriptor_pool_max_sets);
+	return pool;
+}
+
+VkDescriptorPool descriptor_allocator::make_pool(const u32 sets) {
+	std::array<VkDescriptorPoolSize, std::size(constants::descriptor_pool_ratios)> sizes;
+	std::ranges::transform(constants::descriptor_pool_ratios, std::begin(sizes), [sets] (const auto &ratio) {
+		return VkDescriptorPoolSize{ .type = ratio.first, .descriptorCount = ratio.second * sets };
+	});
+
+	const VkDescriptorPoolCreateInfo pool_info{
+		.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+		.maxSets       = sets,
+		.poolSizeCount = static_cast<u32>(std::size(sizes)),
+		.pPoolSizes    = std::data(sizes)
+	};
+
+	VkDescriptorPool pool;
+	if (VK_SUCCESS != vkCreateDescriptorPool(m_device.handle(), &pool_info, m_device.allocator(), &pool)) {
+		throw descriptor_error{ fmt::format("Failed to create a descriptor pool of {} sets.", sets) };
+	}
+	return pool;
+}
+
+#pragma endregion descriptor_allocator
+
+#pragma region frame_descriptor_allocator
+
+frame_descriptor_allocator::frame_descriptor_allocator(device &dev, const size_t frames_count) {
+	m_allocators.reserve(frames_count);
+	for (size_t frame{}; frame < frames_count; ++frame) {
+		m_allocators.emplace_back(dev);
+	}
+}
+
+void frame_descriptor_allocator::begin_frame(const size_t frame) {
+	m_current = frame % std::size(m_allocators);
+	m_allocators[m_current].reset();
+}
+
+VkDescriptorSet frame_descriptor_allocator::allocate(const VkDescriptorSetLayout layout) {
+	return m_allocators[m_current].allocate(layout);
+}
+
+#pragma endregion frame_descriptor_allocator
+
+#pragma region descriptor_writer
+
+descriptor_writer &descriptor_writer::buffer(const u32 binding, const VkDescriptorType type, const VkBuffer buffer,
+	const VkDeviceSize offset, const VkDeviceSize range) {
+	const auto &info{ m_buffer_infos.emplace_back(buffer, offset, range) };
+	m_writes.push_back(VkWriteDescriptorSet{
+		.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		.dstBinding      = binding,
+		.descriptorCount = 1,
+		.descriptorType  = type,
+		.pBufferInfo     = &info
+	});
+	return *this;
+}
+
+descriptor_writer &descriptor_writer::image(const u32 binding, const VkDescriptorType type, const VkImageView view,
+	const VkSampler sampler, const VkImageLayout layout) {
+	const auto &info{ m_image_infos.emplace_back(sampler, view, layout) };
+	m_writes.push_back(VkWriteDescriptorSet{
+		.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+		.dstBinding      = binding,
+		.descriptorCount = 1,
+		.descriptorType  = type,
+		.pImageInfo      = &info
+	});
+	return *this;
+}
+
+void descriptor_writer::update(device &dev, const VkDescriptorSet set) {
+	for (auto &write : m_writes) {
+		write.dstSet = set;
+	}
+	vkUpdateDescriptorSets(dev.handle(), static_cast<u32>(std::size(m_writes)), std::data(m_writes), 0, nullptr);
+}
+
+#pragma endregion descriptor_writer
+
+} // namespace vc::engine::graphics
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <span>
+#include <array>
+#include <deque>
+#include <vector>
+#include <utility>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "engine/graphics/device.hpp"
+
+namespace vc::engine::graphics {
+
+namespace constants {
+
+/// Descriptors of every type a pool holds per set it can allocate.
+constexpr std::array<std::pair<VkDescriptorType, u32>, 4> descriptor_pool_ratios{
+	std::pair{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,         4u },
+	std::pair{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,         2u },
+	std::pair{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4u },
+	std::pair{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE,          1u }
+};
+constexpr u32 descriptor_pool_initial_sets{ 64 };
+constexpr u32 descriptor_pool_max_sets    { 4096 };  ///< Pools double in size up to this
+
+} // namespace constants
+
+/// Creates every distinct set layout once: layouts are keyed by their bindings, in any order,
+/// and live as long as the cache.
+class descriptor_layout_cache {
+public:
+	explicit descriptor_layout_cache(device &device);
+	~descriptor_layout_cache();
+
+	descriptor_layout_cache(const descriptor_layout_cache &) = delete;
+	descriptor_layout_cache &operator=(const descriptor_layout_cache &) = delete;
+
+	/// Immutable samplers aren't supported, their `pImmutableSamplers` must be null.
+	[[nodiscard]] auto get(std::span<const VkDescriptorSetLayoutBinding> bindings) -> VkDescriptorSetLayout;
+	[[nodiscard]] auto size() const noexcept { return std::size(m_layouts); }
+
+private:
+	struct layout_key {
+		std::vector<VkDescriptorSetLayoutBinding> bindings;  ///< Sorted by binding
+
+		[[nodiscard]] bool operator==(const layout_key &other) const noexcept;
+	};
+
+	struct layout_key_hash {
+		[[nodiscard]] auto operator()(const layout_key &key) const noexcept -> size_t;
+	};
+
+	device                                                                   &m_device;
+	std::unordered_map<layout_key, VkDescriptorSetLayout, layout_key_hash>   m_layouts;
+};
+
+/// Allocates sets from a list of pools and creates a twice larger pool whenever the current one
+/// runs out, so callers never size pools up front. `reset` returns every set at once.
+class descriptor_allocator {
+public:
+	explicit descriptor_allocator(device &device, u32 initial_sets = constants::descriptor_pool_initial_sets);
+	~descriptor_allocator();
+
+	descriptor_allocator(const descriptor_allocator &) = delete;
+	descriptor_allocator &operator=(const descriptor_allocator &) = delete;
+	descriptor_allocator(descriptor_allocator &&other) noexcept;
+	descriptor_allocator &operator=(descriptor_allocator &&other) = delete;
+
+	[[nodiscard]] auto allocate(VkDescriptorSetLayout layout) -> VkDescriptorSet;
+
+	/// The sets allocated so far must not be used by the GPU anymore.
+	void reset();
+
+private:
+	device                        &m_device;
+	u32                            m_sets_per_pool;
+	VkDescriptorPool               m_current{ VK_NULL_HANDLE };
+	std::vector<VkDescriptorPool>  m_full_pools;
+	std::vector<VkDescriptorPool>  m_free_pools;
+
+	[[nodiscard]] auto acquire_pool() -> VkDescriptorPool;
+	[[nodiscard]] auto make_pool(u32 sets) -> VkDescriptorPool;
+};
+
+/// One `descriptor_allocator` per frame in flight for sets that only live for a frame: the
+/// allocator of a frame is reset wholesale when that frame begins again.
+class frame_descriptor_allocator {
+public:
+	frame_descriptor_allocator(device &device, size_t frames_count);
+
+	/// Call once the GPU is done with the previous use of the `frame`.
+	void begin_frame(size_t frame);
+	[[nodiscard]] auto allocate(VkDescriptorSetLayout layout) -> VkDescriptorSet;
+
+private:
+	std::vector<descriptor_allocator> m_allocators;
+	size_t                            m_current{};
+};
+
+/// Collects descriptor writes for one set and applies them with a single `vkUpdateDescriptorSets`.
+class descriptor_writer {
+public:
+	auto buffer(u32 binding, VkDescriptorType type, VkBuffer buffer,
+		VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE) -> descriptor_writer &;
+	auto image(u32 binding, VkDescriptorType type, VkImageView view, VkSampler sampler,
+		VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL) -> descriptor_writer &;
+
+	void update(device &device, VkDescriptorSet set);
+
+private:
+	// Deques keep the infos in place while the writes point to them
+	std::deque<VkDescriptorBufferInfo> m_buffer_infos;
+	std::deque<VkDescriptorImageInfo>  m_image_infos;
+	std::vector<VkWriteDescriptorSet>  m_writes;
+};
+
+class descriptor_error : public std::runtime_error {
+public:
+	using base_type = std::runtime_error;
+	using base_type::runtime_error;
+};
+
+} // namespace vc::engine::graphics
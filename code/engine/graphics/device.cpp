@@ -1,4 +1,9 @@
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
 #include <ranges>
+#include <charconv>
+#include <string>
 #include <algorithm>
 #include <unordered_set>
 
@@ -9,6 +14,20 @@
 
 namespace vc::engine::graphics {
 
+namespace {
+
+[[nodiscard]] auto has_device_extension(const VkPhysicalDevice device, const std::string_view extension) -> b8 {
+	u32 extensions_count{};
+	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensions_count, nullptr);
+	std::vector<VkExtensionProperties> properties(extensions_count);
+	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensions_count, std::data(properties));
+	return std::ranges::any_of(properties, [extension] (const auto &property) {
+		return extension == property.extensionName;
+	});
+}
+
+} // anonymous namespace
+
 bool swap_chain_support_details::is_adequate() const noexcept {
 	return !(std::empty(formats) || std::empty(present_modes));
 }
@@ -20,16 +39,27 @@ bool queue_family_indices::is_complete() const noexcept {
 // ============================== device ============================== //
 #pragma region device_implementation
 
-device::device(vulkan_instance &instance, core::window &window) : m_instance{ instance } {
+device::device(vulkan_instance &instance, core::window &window, const std::string_view preferred,
+	const b8 dynamic_rendering)
+	: m_instance{ instance }
+	, m_allocator{ instance.allocator() }
+	, m_dynamic_rendering{ dynamic_rendering } {
 	construct_surface(window);
-	select_physical_device();
+	select_physical_device(preferred);
 	construct_logical_device();
 	construct_command_pool();
 }
 
 device::~device() {
-	vkDestroyCommandPool(m_device, m_command_pool, nullptr);
-	vkDestroyDevice(m_device, nullptr);
+	// Every owner is gone, the frames that could still use the queued objects are not
+	wait_for_idle();
+	m_deletions.flush();
+	if (const auto report{ memory_usage() }; report.total_bytes() > 0) {
+		std::printf("[engine][graphics][device] Memory still allocated at destruction:\n");
+		report.print();
+	}
+	vkDestroyCommandPool(m_device, m_command_pool, m_allocator);
+	vkDestroyDevice(m_device, m_allocator);
 	vkDestroySurfaceKHR(m_instance.handle(), m_surface, nullptr);
 }
 
@@ -38,8 +68,18 @@ swap_chain_support_details device::query_swap_chain_support() {
 }
 
 u32 device::find_memory_type(const u32 filter, const VkMemoryPropertyFlags properties) {
-	VkPhysicalDeviceMemoryProperties memory_properties;
-	vkGetPhysicalDeviceMemoryProperties(m_physical_device, &memory_properties);
+	if (const auto type{ try_find_memory_type(filter, properties) }; type.has_value()) {
+		return *type;
+	}
+
+	throw device_error{ fmt::format(
+		"Failed to find suitable memory type with {:X} filter and {:X} properties.",
+		filter, properties
+	) };
+}
+
+std::optional<u32> device::try_find_memory_type(const u32 filter, const VkMemoryPropertyFlags properties) const noexcept {
+	const auto &memory_properties{ m_memory_properties };
 
 	static constexpr auto match{ [](const auto id, const auto filter) {
 		return static_cast<b8>(filter & (1 << id));
@@ -55,10 +95,7 @@ u32 device::find_memory_type(const u32 filter, const VkMemoryPropertyFlags prope
 		}
 	}
 
-	throw device_error{ fmt::format(
-		"Failed to find suitable memory type with {:X} filter and {:X} properties.",
-		filter, properties
-	) };
+	return std::nullopt;
 }
 
 queue_family_indices device::find_queue_families() {
@@ -91,6 +128,13 @@ VkFormat device::find_supported_format(const std::vector<VkFormat> &candidates,
 	throw device_error{ "Failed to find supported format." };
 }
 
+b8 device::supports_format(const VkFormat format, const VkImageTiling tiling, const VkFormatFeatureFlags features) const {
+	VkFormatProperties props;
+	vkGetPhysicalDeviceFormatProperties(m_physical_device, format, &props);
+	const auto supported{ tiling == VK_IMAGE_TILING_LINEAR ? props.linearTilingFeatures : props.optimalTilingFeatures };
+	return (supported & features) == features;
+}
+
 VkBuffer device::make_buffer(
 	const VkDeviceSize size, const VkBufferUsageFlags usage,
 	const VkMemoryPropertyFlags properties, VkDeviceMemory &buffer_memory
@@ -103,7 +147,7 @@ VkBuffer device::make_buffer(
 	};
 
 	VkBuffer buffer{ VK_NULL_HANDLE };
-	if (VK_SUCCESS != vkCreateBuffer(m_device, &buffer_info, nullptr, &buffer)) {
+	if (VK_SUCCESS != vkCreateBuffer(m_device, &buffer_info, m_allocator, &buffer)) {
 		throw device_error{
 			fmt::format("Failed to create a buffer {} bytes long with the {} usage.",
 				size, usage)
@@ -118,16 +162,55 @@ VkBuffer device::make_buffer(
 		.allocationSize  = requirements.size,
 		.memoryTypeIndex = find_memory_type(requirements.memoryTypeBits, properties)
 	};
-	if (VK_SUCCESS != vkAllocateMemory(m_device, &allocate_info, nullptr, &buffer_memory)) {
+	if (VK_SUCCESS != vkAllocateMemory(m_device, &allocate_info, m_allocator, &buffer_memory)) {
 		throw device_error{
 			fmt::format("Failed to allocate {} bytes for the given buffer.", requirements.size)
 		};
 	}
 
 	vkBindBufferMemory(m_device, buffer, buffer_memory, 0);
+	m_memory_tracker.allocated(buffer_memory, requirements.size, categorize_buffer(usage, properties),
+		m_memory_properties.memoryTypes[allocate_info.memoryTypeIndex].heapIndex);
 	return buffer;
 }
 
+void device::free_memory(const VkDeviceMemory memory) noexcept {
+	if (memory == VK_NULL_HANDLE) return;
+	m_memory_tracker.freed(memory);
+	vkFreeMemory(m_device, memory, m_allocator);
+}
+
+memory_report device::memory_usage() const {
+	memory_report report{};
+	report.heaps.resize(m_memory_properties.memoryHeapCount);
+	for (u32 i{}; i < m_memory_properties.memoryHeapCount; ++i) {
+		report.heaps[i].size = m_memory_properties.memoryHeaps[i].size;
+		report.heaps[i].flags = m_memory_properties.memoryHeaps[i].flags;
+	}
+	m_memory_tracker.fill(report);
+
+	const auto get_memory_properties2{ reinterpret_cast<PFN_vkGetPhysicalDeviceMemoryProperties2>(
+		vkGetInstanceProcAddr(m_instance.handle(), "vkGetPhysicalDeviceMemoryProperties2")
+	) };
+	if (!m_memory_budget || get_memory_properties2 == nullptr) return report;
+
+	// Queried every time, the budget changes with the other processes on the GPU
+	VkPhysicalDeviceMemoryBudgetPropertiesEXT budget{
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT
+	};
+	VkPhysicalDeviceMemoryProperties2 properties{
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2,
+		.pNext = &budget
+	};
+	get_memory_properties2(m_physical_device, &properties);
+	for (size_t i{}; i < std::size(report.heaps); ++i) {
+		report.heaps[i].usage = budget.heapUsage[i];
+		report.heaps[i].budget = budget.heapBudget[i];
+	}
+	report.has_budget = true;
+	return report;
+}
+
 
 VkCommandBuffer device::begin_single_time_commands() {
 	const VkCommandBufferAllocateInfo allocate_info{
@@ -193,31 +276,46 @@ void device::wait_for_idle() const noexcept {
 	vkDeviceWaitIdle(m_device);
 }
 
-VkImage device::make_image(const VkImageCreateInfo &info, VkMemoryPropertyFlags properties, VkDeviceMemory &image_memory) {
+VkImage device::make_image(const VkImageCreateInfo &info, VkMemoryPropertyFlags properties, VkDeviceMemory &image_memory,
+	const VkMemoryPropertyFlags preferred) {
 	VkImage image;
-	if (VK_SUCCESS != vkCreateImage(m_device, &info, nullptr, &image)) {
+	if (VK_SUCCESS != vkCreateImage(m_device, &info, m_allocator, &image)) {
 		throw device_error{ "Cannot create image." };
 	}
 
 	VkMemoryRequirements memory_requirements;
 	vkGetImageMemoryRequirements(m_device, image, &memory_requirements);
+	image_memory = allocate_memory(memory_requirements, properties, categorize_image(info.usage), preferred);
+
+	if (VK_SUCCESS != vkBindImageMemory(m_device, image, image_memory, 0)) {
+		throw device_error{ "Failed to bind image memory." };
+	}
+	return image;
+}
 
+VkDeviceMemory device::allocate_memory(const VkMemoryRequirements &requirements, const VkMemoryPropertyFlags properties,
+	const memory_category category, const VkMemoryPropertyFlags preferred) {
+	// The preferred properties are dropped when no type the resource accepts has them
+	const auto preferred_type{ preferred != 0
+		? try_find_memory_type(requirements.memoryTypeBits, properties | preferred)
+		: std::nullopt };
 	const VkMemoryAllocateInfo allocate_info{
 		.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
-		.allocationSize = memory_requirements.size,
-		.memoryTypeIndex = find_memory_type(memory_requirements.memoryTypeBits, properties)
+		.allocationSize = requirements.size,
+		.memoryTypeIndex = preferred_type.has_value()
+			? *preferred_type
+			: find_memory_type(requirements.memoryTypeBits, properties)
 	};
 
-	if (VK_SUCCESS != vkAllocateMemory(m_device, &allocate_info, nullptr, &image_memory)) {
+	VkDeviceMemory memory;
+	if (VK_SUCCESS != vkAllocateMemory(m_device, &allocate_info, m_allocator, &memory)) {
 		throw device_error{
-			fmt::format("Failed to allocate {} bytes for image", memory_requirements.size)
+			fmt::format("Failed to allocate {} bytes of {} memory.", requirements.size, to_string(category))
 		};
 	}
-
-	if (VK_SUCCESS != vkBindImageMemory(m_device, image, image_memory, 0)) {
-		throw device_error{ "Failed to bind image memory." };
-	}
-	return image;
+	m_memory_tracker.allocated(memory, requirements.size, category,
+		m_memory_properties.memoryTypes[allocate_info.memoryTypeIndex].heapIndex);
+	return memory;
 }
 
 #pragma region construct methods
@@ -228,7 +326,7 @@ void device::construct_surface(core::window &window) {
 	}
 }
 
-void device::select_physical_device() {
+void device::select_physical_device(std::string_view preferred) {
 	u32 device_count{};
 	vkEnumeratePhysicalDevices(m_instance.handle(), &device_count, nullptr);
 	if (device_count == 0) {
@@ -237,72 +335,204 @@ void device::select_physical_device() {
 	std::vector<VkPhysicalDevice> devices(device_count);
 	vkEnumeratePhysicalDevices(m_instance.handle(), &device_count, std::data(devices));
 
-	const auto suitable{ [this] (const auto &device) { return is_suitable(device); } };
-	if (auto found{ std::ranges::find_if(devices, suitable) }; found != std::end(devices)) {
-		m_physical_device = *found;
-		vkGetPhysicalDeviceProperties(m_physical_device, &m_physical_device_properties);
-		std::printf("[ending][graphics][device] Selected device: %s\n",
-			m_physical_device_properties.deviceName);
-		return;
+	const auto *variable{ std::getenv(std::data(constants::device_override_env)) };
+	if (std::empty(preferred) && variable != nullptr) {
+		preferred = variable;
 	}
-	throw device_error{ fmt::format("No suitable device from {} was found", device_count) };
-}
 
-void device::construct_logical_device() {
-	static constexpr auto make_queue_info{ [](auto index, auto *priorities) {
-		return VkDeviceQueueCreateInfo{
-			.sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
-			.queueFamilyIndex = index,
-			.queueCount       = 1,
-			.pQueuePriorities = priorities
-		};
+	// An index selects by enumeration order, anything else is a part of the device name
+	std::optional<u32> preferred_index;
+	u32 parsed_index{};
+	const auto *last{ std::data(preferred) + std::size(preferred) };
+	if (const auto [end, error]{ std::from_chars(std::data(preferred), last, parsed_index) }; error == std::errc{} && end == last) {
+		preferred_index = parsed_index;
+	}
+	const auto matches_name{ [preferred] (const std::string_view name) {
+		const auto lower{ [] (const char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); } };
+		return !std::ranges::search(name, preferred, {}, lower, lower).empty();
 	} };
 
-	const auto indices{ find_queue_families() };
-	if (!indices.is_complete()) {
+	std::optional<u32> best;
+	device_score best_score{};
+	for (u32 index{}; index < device_count; ++index) {
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(devices[index], &properties);
+
+		if (!is_suitable(devices[index])) {
+			std::printf("[engine][graphics][device] #%u %s: unsuitable\n", index, properties.deviceName);
+			continue;
+		}
+
+		const auto current{ score(devices[index]) };
+		std::printf("[engine][graphics][device] #%u %s: score %u (type %u, memory %u, capabilities %u, queues %u)\n",
+			index, properties.deviceName, current.total(), current.type, current.memory, current.capabilities, current.queues);
+
+		const auto is_preferred{ preferred_index.has_value() ? *preferred_index == index : matches_name(properties.deviceName) };
+		if (!std::empty(preferred) && !is_preferred) continue;
+		if (!best.has_value() || current.total() > best_score.total()) {
+			best = index;
+			best_score = current;
+		}
+	}
+
+	if (!best.has_value()) {
+		if (!std::empty(preferred)) {
+			throw device_error{ fmt::format(R"(No suitable device from {} matches "{}".)", device_count, preferred) };
+		}
+		throw device_error{ fmt::format("No suitable device from {} was found", device_count) };
+	}
+
+	m_physical_device = devices[*best];
+	vkGetPhysicalDeviceProperties(m_physical_device, &m_physical_device_properties);
+	vkGetPhysicalDeviceMemoryProperties(m_physical_device, &m_memory_properties);
+	m_api_version = std::min(m_instance.api_version(), m_physical_device_properties.apiVersion);
+	std::printf("[engine][graphics][device] Selected device #%u: %s, score %u%s\n", *best,
+		m_physical_device_properties.deviceName, best_score.total(), std::empty(preferred) ? "" : " (preferred)");
+}
+
+void device::construct_logical_device() {
+	m_queue_families = find_queue_families();
+	if (!m_queue_families.is_complete()) {
 		throw device_error{ "Could not find graphics and present queue families." };
 	}
 
+	// Every family gets a single queue, and is listed once even when it has several roles
+	const std::array<std::optional<u32>, 4> families{
+		m_queue_families.graphics_family, m_queue_families.present_family,
+		m_queue_families.compute_family, m_queue_families.transfer_family
+	};
 	f32 priority{ 1.0f };
-	const std::vector<VkDeviceQueueCreateInfo> queue_create_infos{
-		make_queue_info(indices.graphics_family.value_or(0), &priority),
-		make_queue_info(indices.present_family.value_or(0), &priority)
+	std::unordered_set<u32> unique_families;
+	std::vector<VkDeviceQueueCreateInfo> queue_create_infos;
+	for (const auto &family : families) {
+		if (!family.has_value() || !unique_families.insert(*family).second) continue;
+		queue_create_infos.push_back(VkDeviceQueueCreateInfo{
+			.sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO,
+			.queueFamilyIndex = *family,
+			.queueCount       = 1,
+			.pQueuePriorities = &priority
+		});
+	}
+
+	VkPhysicalDeviceFeatures supported{};
+	vkGetPhysicalDeviceFeatures(m_physical_device, &supported);
+
+	// Optional features are enabled whenever the device has them, users check `features()`
+	m_features = VkPhysicalDeviceFeatures{
+		.multiDrawIndirect         = supported.multiDrawIndirect,
+		.drawIndirectFirstInstance = supported.drawIndirectFirstInstance,
+		.samplerAnisotropy         = VK_TRUE,
+		.textureCompressionBC      = supported.textureCompressionBC
 	};
 
-	const VkPhysicalDeviceFeatures features{
-		.samplerAnisotropy = VK_TRUE
+	// Vulkan 1.2 features are queried through the 1.1 entry point, loaded as the loader may be older
+	VkPhysicalDeviceTimelineSemaphoreFeatures timeline{
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES
 	};
+	VkPhysicalDeviceVulkan13Features supported13{
+		.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_13_FEATURES
+	};
+	if (m_api_version >= VK_API_VERSION_1_3) {
+		timeline.pNext = &supported13;
+	}
+	const auto get_features2{ reinterpret_cast<PFN_vkGetPhysicalDeviceFeatures2>(
+		vkGetInstanceProcAddr(m_instance.handle(), "vkGetPhysicalDeviceFeatures2")
+	) };
+	if (m_api_version >= VK_API_VERSION_1_2 && get_features2 != nullptr) {
+		VkPhysicalDeviceFeatures2 features2{
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+			.pNext = &timeline
+		};
+		get_features2(m_physical_device, &features2);
+	}
+	m_timeline_semaphores = timeline.timelineSemaphore == VK_TRUE;
+
+	// Only the two features of the 1.3 path are enabled, not everything the query reported
+	const auto requested_dynamic_rendering{ m_dynamic_rendering };
+	m_dynamic_rendering = requested_dynamic_rendering
+		&& supported13.synchronization2 == VK_TRUE && supported13.dynamicRendering == VK_TRUE;
+	VkPhysicalDeviceVulkan13Features enabled13{
+		.sType            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_13_FEATURES,
+		.synchronization2 = VK_TRUE,
+		.dynamicRendering = VK_TRUE
+	};
+	timeline.pNext = m_dynamic_rendering ? &enabled13 : nullptr;
+	const void *enabled_features{ m_timeline_semaphores ? static_cast<const void *>(&timeline)
+		: m_dynamic_rendering ? static_cast<const void *>(&enabled13) : nullptr };
+
+	// The budget extension needs the 1.1 properties query
+	std::vector<const char *> extensions(std::begin(constants::device_extensions), std::end(constants::device_extensions));
+	m_memory_budget = m_api_version >= VK_API_VERSION_1_1
+		&& has_device_extension(m_physical_device, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+	if (m_memory_budget) {
+		extensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+	}
 
 	const VkDeviceCreateInfo create_info{
 		.sType                   = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
+		.pNext                   = enabled_features,
 		.queueCreateInfoCount    = static_cast<u32>(std::size(queue_create_infos)),
 		.pQueueCreateInfos       = std::data(queue_create_infos),
-		.enabledExtensionCount   = static_cast<u32>(std::size(constants::device_extensions)),
-		.ppEnabledExtensionNames = std::data(constants::device_extensions),
-		.pEnabledFeatures        = &features
+		.enabledExtensionCount   = static_cast<u32>(std::size(extensions)),
+		.ppEnabledExtensionNames = std::data(extensions),
+		.pEnabledFeatures        = &m_features
 	};
-	if (VK_SUCCESS != vkCreateDevice(m_physical_device, &create_info, nullptr, &m_device)) {
+	if (VK_SUCCESS != vkCreateDevice(m_physical_device, &create_info, m_allocator, &m_device)) {
 		throw device_error{ fmt::format(
 			"Failed to create logical device from {} physical device.",
 				m_physical_device_properties.deviceName
 		) };
 	}
 
-	vkGetDeviceQueue(m_device, indices.graphics_family.value_or(0), 0, &m_graphics_queue);
-	vkGetDeviceQueue(m_device, indices.present_family.value_or(0), 0, &m_present_queue);
+	if (m_dynamic_rendering) {
+		const auto load{ [this] (const char *name) { return vkGetDeviceProcAddr(m_device, name); } };
+		m_rendering_commands = dynamic_rendering_commands{
+			.begin_rendering   = reinterpret_cast<PFN_vkCmdBeginRendering>(load("vkCmdBeginRendering")),
+			.end_rendering     = reinterpret_cast<PFN_vkCmdEndRendering>(load("vkCmdEndRendering")),
+			.pipeline_barrier2 = reinterpret_cast<PFN_vkCmdPipelineBarrier2>(load("vkCmdPipelineBarrier2")),
+			.queue_submit2     = reinterpret_cast<PFN_vkQueueSubmit2>(load("vkQueueSubmit2"))
+		};
+		const auto &commands{ m_rendering_commands };
+		m_dynamic_rendering = commands.begin_rendering != nullptr && commands.end_rendering != nullptr
+			&& commands.pipeline_barrier2 != nullptr && commands.queue_submit2 != nullptr;
+	}
+
+	u32 families_count{};
+	vkGetPhysicalDeviceQueueFamilyProperties(m_physical_device, &families_count, nullptr);
+	std::vector<VkQueueFamilyProperties> family_properties(families_count);
+	vkGetPhysicalDeviceQueueFamilyProperties(m_physical_device, &families_count, std::data(family_properties));
+	m_timestamp_valid_bits = family_properties[*m_queue_families.graphics_family].timestampValidBits;
+
+	vkGetDeviceQueue(m_device, *m_queue_families.graphics_family, 0, &m_graphics_queue);
+	vkGetDeviceQueue(m_device, *m_queue_families.present_family, 0, &m_present_queue);
+	if (m_queue_families.compute_family.has_value()) {
+		vkGetDeviceQueue(m_device, *m_queue_families.compute_family, 0, &m_compute_queue);
+	}
+	if (m_queue_families.transfer_family.has_value()) {
+		vkGetDeviceQueue(m_device, *m_queue_families.transfer_family, 0, &m_transfer_queue);
+	}
+
+	constexpr auto describe{ [] (const std::optional<u32> &family) {
+		return family.has_value() ? fmt::format("#{}", *family) : std::string{ "none" };
+	} };
+	std::printf("[engine][graphics][device] Queue families: graphics %s, present %s, compute %s, transfer %s\n",
+		std::data(describe(m_queue_families.graphics_family)), std::data(describe(m_queue_families.present_family)),
+		std::data(describe(m_queue_families.compute_family)), std::data(describe(m_queue_families.transfer_family)));
+	std::printf("[engine][graphics][device] Vulkan %u.%u, timeline semaphores %s, memory budget %s, dynamic rendering %s\n",
+		VK_API_VERSION_MAJOR(m_api_version), VK_API_VERSION_MINOR(m_api_version),
+		m_timeline_semaphores ? "enabled" : "unavailable", m_memory_budget ? "enabled" : "unavailable",
+		m_dynamic_rendering ? "enabled" : requested_dynamic_rendering ? "unavailable" : "off");
 }
 
 void device::construct_command_pool() {
-	const auto family_indices{ find_queue_families() };
-
 	const VkCommandPoolCreateInfo pool_info{
 		.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
 		.flags
 			= VK_COMMAND_POOL_CREATE_TRANSIENT_BIT
 			| VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
-		.queueFamilyIndex = family_indices.graphics_family.value_or(0)
+		.queueFamilyIndex = *m_queue_families.graphics_family
 	};
-	if (VK_SUCCESS != vkCreateCommandPool(m_device, &pool_info, nullptr, &m_command_pool)) {
+	if (VK_SUCCESS != vkCreateCommandPool(m_device, &pool_info, m_allocator, &m_command_pool)) {
 		throw device_error{ "Failed to create command pool." };
 	}
 }
@@ -320,6 +550,55 @@ bool device::is_suitable(VkPhysicalDevice device) {
 	return features.samplerAnisotropy;
 }
 
+device_score device::score(VkPhysicalDevice device) {
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(device, &properties);
+
+	device_score result;
+	switch (properties.deviceType) {
+		case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:   result.type = 40000; break;
+		case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: result.type = 30000; break;
+		case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:    result.type = 20000; break;
+		case VK_PHYSICAL_DEVICE_TYPE_CPU:            result.type = 10000; break;
+		default: break;
+	}
+
+	// 100 points per GiB, integrated devices report the shared system memory here. Memory and
+	// capabilities together stay below the gap between two device types.
+	VkPhysicalDeviceMemoryProperties memory;
+	vkGetPhysicalDeviceMemoryProperties(device, &memory);
+	VkDeviceSize device_local{};
+	for (u32 heap{}; heap < memory.memoryHeapCount; ++heap) {
+		if (memory.memoryHeaps[heap].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+			device_local = std::max(device_local, memory.memoryHeaps[heap].size);
+		}
+	}
+	result.memory = static_cast<u32>(std::min<VkDeviceSize>(device_local * 100 >> 30, 6400));
+
+	VkPhysicalDeviceFeatures features;
+	vkGetPhysicalDeviceFeatures(device, &features);
+	const auto &limits{ properties.limits };
+	result.capabilities = limits.maxImageDimension2D / 256
+		+ limits.maxComputeWorkGroupInvocations / 16
+		+ std::min(limits.maxPerStageDescriptorSampledImages, 65536u) / 64
+		+ (features.multiDrawIndirect ? 200 : 0)
+		+ (features.drawIndirectFirstInstance ? 200 : 0)
+		+ (features.textureCompressionBC ? 200 : 0);
+
+	u32 families_count{};
+	vkGetPhysicalDeviceQueueFamilyProperties(device, &families_count, nullptr);
+	std::vector<VkQueueFamilyProperties> families(families_count);
+	vkGetPhysicalDeviceQueueFamilyProperties(device, &families_count, std::data(families));
+	const auto has_family{ [&families] (const VkQueueFlags required, const VkQueueFlags excluded) {
+		return std::ranges::any_of(families, [required, excluded] (const auto &family) {
+			return family.queueCount > 0 && (family.queueFlags & required) == required && (family.queueFlags & excluded) == 0;
+		});
+	} };
+	result.queues = (has_family(VK_QUEUE_COMPUTE_BIT, VK_QUEUE_GRAPHICS_BIT) ? 300 : 0)
+		+ (has_family(VK_QUEUE_TRANSFER_BIT, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT) ? 300 : 0);
+	return result;
+}
+
 bool device::check_device_extension_support(VkPhysicalDevice device) {
 	u32 extensions_count{};
 	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensions_count, nullptr);
@@ -345,19 +624,37 @@ queue_family_indices device::find_queue_families(VkPhysicalDevice device) {
 		std::data(queue_families));
 
 	queue_family_indices indices;
-	for (u32 family_id{}; family_id < queue_family_count && !indices.is_complete(); ++family_id) {
+	for (u32 family_id{}; family_id < queue_family_count; ++family_id) {
 		const auto &family{ queue_families[family_id] };
 		if (family.queueCount == 0) continue;
 
-		if (family.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+		VkBool32 present_support{ VK_FALSE };
+		vkGetPhysicalDeviceSurfaceSupportKHR(device, family_id, m_surface, &present_support);
+		const auto flags{ family.queueFlags };
+		const b8 graphics{ (flags & VK_QUEUE_GRAPHICS_BIT) != 0 };
+		const b8 present{ present_support == VK_TRUE };
+
+		// A family that both draws and presents wins, the swap chain images then stay exclusive
+		const b8 shared{ indices.graphics_family.has_value() && indices.graphics_family == indices.present_family };
+		if (graphics && present && !shared) {
 			indices.graphics_family = family_id;
-			continue;
+			indices.present_family = family_id;
 		}
-		VkBool32 present_support{ false };
-		vkGetPhysicalDeviceSurfaceSupportKHR(device, family_id, m_surface, &present_support);
-		if (present_support == VK_TRUE) {
+		if (graphics && !indices.graphics_family.has_value()) {
+			indices.graphics_family = family_id;
+		}
+		if (present && !indices.present_family.has_value()) {
 			indices.present_family = family_id;
 		}
+
+		if ((flags & (VK_QUEUE_COMPUTE_BIT | VK_QUEUE_GRAPHICS_BIT)) == VK_QUEUE_COMPUTE_BIT
+			&& !indices.compute_family.has_value()) {
+			indices.compute_family = family_id;
+		}
+		if ((flags & (VK_QUEUE_TRANSFER_BIT | VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) == VK_QUEUE_TRANSFER_BIT
+			&& !indices.transfer_family.has_value()) {
+			indices.transfer_family = family_id;
+		}
 	}
 	return indices;
 }
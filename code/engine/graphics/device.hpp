@@ -4,8 +4,11 @@
 #include <vector>
 #include <exception>
 #include <stdexcept>
+#include <string_view>
 
 #include "core/window.hpp"
+#include "engine/graphics/memory-tracker.hpp"
+#include "engine/graphics/deletion-queue.hpp"
 
 namespace vc::engine::graphics {
 
@@ -17,6 +20,9 @@ constexpr std::array device_extensions{
 	VK_KHR_SWAPCHAIN_EXTENSION_NAME
 };
 
+/// Index or part of the name of the physical device to use, overridden by the launch options.
+constexpr std::string_view device_override_env{ "VC_DEVICE" };
+
 } // namespace constants
 
 struct swap_chain_support_details {
@@ -30,14 +36,43 @@ struct swap_chain_support_details {
 struct queue_family_indices {
 	std::optional<u32> graphics_family;
 	std::optional<u32> present_family;
+	std::optional<u32> compute_family;   ///< Compute without graphics, runs next to the frame
+	std::optional<u32> transfer_family;  ///< Transfer only, usually the copy engine
 
 	[[nodiscard]] bool is_complete() const noexcept;
 };
 
+/// A semaphore a submission waits on before the given stages, e.g. for work of another queue.
+struct semaphore_wait {
+	VkSemaphore          semaphore{ VK_NULL_HANDLE };
+	VkPipelineStageFlags stages   {};
+};
+
+/// Vulkan 1.3 commands, loaded when the device renders without render pass objects.
+struct dynamic_rendering_commands {
+	PFN_vkCmdBeginRendering   begin_rendering  { nullptr };
+	PFN_vkCmdEndRendering     end_rendering    { nullptr };
+	PFN_vkCmdPipelineBarrier2 pipeline_barrier2{ nullptr };
+	PFN_vkQueueSubmit2        queue_submit2    { nullptr };
+};
+
+/// Why a physical device was preferred: the type dominates, the rest orders devices of a type.
+struct device_score {
+	u32 type        {};  ///< Discrete > integrated > virtual > CPU
+	u32 memory      {};  ///< Largest device local heap
+	u32 capabilities{};  ///< Limits and the optional features the renderer uses
+	u32 queues      {};  ///< Dedicated transfer and compute families
+
+	[[nodiscard]] auto total() const noexcept { return type + memory + capabilities + queues; }
+};
 
 class device {
 public:
-	explicit device(vulkan_instance &instance, core::window &window);
+	/// `preferred` selects a device by index or by a case insensitive part of its name, the
+	/// `VC_DEVICE` environment variable is used when it's empty and the best score wins otherwise.
+	/// `dynamic_rendering` opts into the Vulkan 1.3 path when the device supports it.
+	device(vulkan_instance &instance, core::window &window, std::string_view preferred = {},
+		b8 dynamic_rendering = false);
 	~device();
 
 	device(const device &) = delete;
@@ -47,18 +82,47 @@ public:
 
 	[[nodiscard]] decltype(auto) command_pool() noexcept { return m_command_pool; }
 	[[nodiscard]] decltype(auto) handle() noexcept { return m_device; }
+	/// Host allocation callbacks of every object created from the device.
+	[[nodiscard]] auto allocator() const noexcept { return m_allocator; }
 	[[nodiscard]] decltype(auto) surface() noexcept { return m_surface; }
 	[[nodiscard]] decltype(auto) graphics_queue() noexcept { return m_graphics_queue; }
 	[[nodiscard]] decltype(auto) present_queue() noexcept { return m_present_queue; }
+	/// Null without a dedicated family, the work then goes to the graphics queue.
+	[[nodiscard]] decltype(auto) compute_queue() noexcept { return m_compute_queue; }
+	[[nodiscard]] decltype(auto) transfer_queue() noexcept { return m_transfer_queue; }
+	[[nodiscard]] auto queue_families() const noexcept -> const queue_family_indices & { return m_queue_families; }
+	[[nodiscard]] auto features() const noexcept -> const VkPhysicalDeviceFeatures & { return m_features; }
+	[[nodiscard]] auto name() const noexcept -> std::string_view { return m_physical_device_properties.deviceName; }
+	/// Lower of the instance and the device versions.
+	[[nodiscard]] auto api_version() const noexcept { return m_api_version; }
+	[[nodiscard]] auto has_timeline_semaphores() const noexcept { return m_timeline_semaphores; }
+	/// Dynamic rendering and synchronization2 are enabled, `swap_chain` then has no render pass.
+	[[nodiscard]] auto has_dynamic_rendering() const noexcept { return m_dynamic_rendering; }
+	[[nodiscard]] auto rendering_commands() const noexcept -> const dynamic_rendering_commands & { return m_rendering_commands; }
+	/// `VK_EXT_memory_budget` is enabled, `memory_usage` reports the driver's view of each heap.
+	[[nodiscard]] auto has_memory_budget() const noexcept { return m_memory_budget; }
+	/// Valid bits of the graphics queue's timestamps, 0 when it can't write them.
+	[[nodiscard]] auto timestamp_valid_bits() const noexcept { return m_timestamp_valid_bits; }
+	[[nodiscard]] auto limits() const noexcept -> const VkPhysicalDeviceLimits & {
+		return m_physical_device_properties.limits;
+	}
 
 	[[nodiscard]] auto query_swap_chain_support() -> swap_chain_support_details;
 	[[nodiscard]] auto find_memory_type(u32 filter, VkMemoryPropertyFlags properties) -> u32;
 	[[nodiscard]] auto find_queue_families() -> queue_family_indices;
 	[[nodiscard]] auto find_supported_format(const std::vector<VkFormat> &candidates,
 		VkImageTiling tiling, VkFormatFeatureFlags features) -> VkFormat;
+	[[nodiscard]] auto supports_format(VkFormat format, VkImageTiling tiling, VkFormatFeatureFlags features) const -> b8;
 
+	/// The memory is tracked by the usage, return it with `free_memory`.
 	[[nodiscard]] auto make_buffer(VkDeviceSize size, VkBufferUsageFlags usage,
 		VkMemoryPropertyFlags properties, VkDeviceMemory &buffer_memory) -> VkBuffer;
+	void free_memory(VkDeviceMemory memory) noexcept;
+
+	/// Allocations of the engine by category and heap, and the heap budgets when available.
+	[[nodiscard]] auto memory_usage() const -> memory_report;
+	/// Objects the GPU may still use, released once their frame completed.
+	[[nodiscard]] auto deletions() noexcept -> deletion_queue & { return m_deletions; }
 
 	[[nodiscard]] auto begin_single_time_commands() -> VkCommandBuffer;
 	void end_single_time_commands(VkCommandBuffer command_buffer);
@@ -68,28 +132,48 @@ public:
 
 	void wait_for_idle() const noexcept;
 
+	/// The memory has the `preferred` properties too when a type the image accepts has them.
 	[[nodiscard]] auto make_image(const VkImageCreateInfo &info, VkMemoryPropertyFlags properties,
-		VkDeviceMemory &image_memory) -> VkImage;
+		VkDeviceMemory &image_memory, VkMemoryPropertyFlags preferred = 0) -> VkImage;
+	/// Memory for resources bound by the caller, e.g. several aliased images. Return it with `free_memory`.
+	[[nodiscard]] auto allocate_memory(const VkMemoryRequirements &requirements, VkMemoryPropertyFlags properties,
+		memory_category category, VkMemoryPropertyFlags preferred = 0) -> VkDeviceMemory;
 
 private:
 	vulkan_instance           &m_instance;
+	const VkAllocationCallbacks *m_allocator               { nullptr };
 	VkPhysicalDevice           m_physical_device           { VK_NULL_HANDLE };
   	VkPhysicalDeviceProperties m_physical_device_properties{};
+	VkPhysicalDeviceFeatures   m_features                  {};
+	u32                        m_api_version               { VK_API_VERSION_1_0 };
+	b8                         m_timeline_semaphores       { false };
+	b8                         m_memory_budget             { false };
+	b8                         m_dynamic_rendering         { false };  ///< Requested, then whether it's enabled
+	dynamic_rendering_commands m_rendering_commands        {};
+	VkPhysicalDeviceMemoryProperties m_memory_properties   {};
+	memory_tracker             m_memory_tracker;
+	deletion_queue             m_deletions                 { *this };
+	u32                        m_timestamp_valid_bits      {};
 	VkCommandPool              m_command_pool              { VK_NULL_HANDLE };
+	queue_family_indices       m_queue_families            {};
 
 	VkDevice     m_device        { VK_NULL_HANDLE };
 	VkSurfaceKHR m_surface       { VK_NULL_HANDLE };
 	VkQueue      m_graphics_queue{ VK_NULL_HANDLE };
 	VkQueue      m_present_queue { VK_NULL_HANDLE };
+	VkQueue      m_compute_queue { VK_NULL_HANDLE };
+	VkQueue      m_transfer_queue{ VK_NULL_HANDLE };
 
 	void construct_surface(core::window &window);
-	void select_physical_device();
+	void select_physical_device(std::string_view preferred);
 	void construct_logical_device();
 	void construct_command_pool();
 
 	bool is_suitable(VkPhysicalDevice device);
+	auto score(VkPhysicalDevice device) -> device_score;
 	bool check_device_extension_support(VkPhysicalDevice device);
 	auto find_queue_families(VkPhysicalDevice device) -> queue_family_indices;
+	auto try_find_memory_type(u32 filter, VkMemoryPropertyFlags properties) const noexcept -> std::optional<u32>;
 	auto query_swap_chain_support(VkPhysicalDevice device) -> swap_chain_support_details;
 };
 
@@ -0,0 +1,196 @@
+#include <cstdio>
+#include <cstring>
+#include <utility>
+#include <filesystem>
+
+#include <fmt/core.h>
+
+#include "engine/graphics/frame-capture.hpp"
+
+namespace vc::engine::graphics {
+
+namespace {
+
+constexpr size_t bytes_per_pixel{ 4 };
+
+[[nodiscard]] auto is_bgra(const VkFormat format) noexcept -> b8 {
+	return format == VK_FORMAT_B8G8R8A8_UNORM || format == VK_FORMAT_B8G8R8A8_SRGB;
+}
+
+} // anonymous namespace
+
+frame_capture::frame_capture(device &dev, const VkExtent2D extent, const VkFormat format, const u32 slots_count,
+	std::string path, const u32 fps)
+	: m_device{ dev }
+	, m_extent{ extent }
+	, m_swizzle{ is_bgra(format) }
+	, m_pending(slots_count)
+	, m_path{ std::move(path) } {
+	if (!is_supported(format)) {
+		throw frame_capture_error{ fmt::format("Cannot capture images of format {}.", static_cast<i32>(format)) };
+	}
+
+	if (m_path.ends_with(constants::y4m_extension)) {
+		m_video = std::make_unique<resources::y4m_writer>(m_path, glm::u32vec2{ extent.width, extent.height }, fps);
+	} else {
+		std::error_code error;
+		std::filesystem::create_directories(m_path, error);
+		if (error) {
+			throw frame_capture_error{ fmt::format(R"(Cannot create the capture directory "{}": {})", m_path, error.message()) };
+		}
+	}
+
+	const auto size{ VkDeviceSize{ extent.width } * extent.height * bytes_per_pixel };
+	m_buffers.reserve(slots_count);
+	for (u32 slot{}; slot < slots_count; ++slot) {
+		m_buffers.emplace_back(m_device, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	}
+
+	m_encoder = std::thread{ [this] { encode_frames(); } };
+	std::printf("[engine][graphics][frame_capture] Capturing %ux%u frames to %s\n",
+		extent.width, extent.height, m_path.c_str());
+}
+
+frame_capture::~frame_capture() {
+	{
+		const std::lock_guard lock{ m_mutex };
+		m_stopping = true;
+	}
+	m_changed.notify_all();
+	m_encoder.join();
+
+	std::printf("[engine][graphics][frame_capture] %llu frames written, the encoder held back %llu frames\n",
+		static_cast<unsigned long long>(m_written), static_cast<unsigned long long>(m_stalls));
+}
+
+b8 frame_capture::is_supported(const VkFormat format) noexcept {
+	return is_bgra(format) || format == VK_FORMAT_R8G8B8A8_UNORM || format == VK_FORMAT_R8G8B8A8_SRGB;
+}
+
+void frame_capture::record(VkCommandBuffer command_buffer, const VkImage image, const u32 slot, const u64 frame) {
+	const VkBufferImageCopy region{
+		.bufferOffset      = 0,
+		.bufferRowLength   = 0,
+		.bufferImageHeight = 0,
+		.imageSubresource  = VkImageSubresourceLayers{
+			.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+			.mipLevel       = 0,
+			.baseArrayLayer = 0,
+			.layerCount     = 1
+		},
+		.imageOffset = { 0, 0, 0 },
+		.imageExtent = { m_extent.width, m_extent.height, 1 }
+	};
+	const auto &target{ m_buffers[slot] };
+	vkCmdCopyImageToBuffer(command_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, target.handle(), 1, &region);
+
+	const VkBufferMemoryBarrier to_host{
+		.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+		.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
+		.dstAccessMask       = VK_ACCESS_HOST_READ_BIT,
+		.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+		.buffer              = target.handle(),
+		.offset              = 0,
+		.size                = VK_WHOLE_SIZE
+	};
+	vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+		0, 0, nullptr, 1, &to_host, 0, nullptr);
+
+	m_pending[slot] = frame;
+}
+
+void frame_capture::collect(const u32 slot) {
+	if (!m_pending[slot].has_value()) return;
+	const auto index{ *std::exchange(m_pending[slot], std::nullopt) };
+	const auto bytes{ m_buffers[slot].bytes() };
+
+	std::unique_lock lock{ m_mutex };
+	if (std::size(m_queue) >= constants::capture_queue_limit) {
+		++m_stalls;
+		m_changed.wait(lock, [this] { return std::size(m_queue) < constants::capture_queue_limit || m_error; });
+	}
+	if (m_error) return;
+
+	std::vector<std::byte> pixels;
+	if (!std::empty(m_recycled)) {
+		pixels = std::move(m_recycled.back());
+		m_recycled.pop_back();
+	}
+	lock.unlock();
+
+	// The only copy on the render thread, the swizzle and the encoding happen on the encoder
+	pixels.resize(std::size(bytes));
+	std::memcpy(std::data(pixels), std::data(bytes), std::size(bytes));
+
+	lock.lock();
+	m_queue.push_back(captured_frame{
+		.index  = index,
+		.pixels = resources::image{
+			.extent = { m_extent.width, m_extent.height },
+			.pixels = std::move(pixels)
+		}
+	});
+	lock.unlock();
+	m_changed.notify_all();
+}
+
+void frame_capture::flush() {
+	std::unique_lock lock{ m_mutex };
+	m_changed.wait(lock, [this] { return (std::empty(m_queue) && !m_busy) || m_error; });
+	if (m_error) {
+		std::rethrow_exception(m_error);
+	}
+}
+
+void frame_capture::encode_frames() {
+	std::unique_lock lock{ m_mutex };
+	while (true) {
+		m_changed.wait(lock, [this] { return !std::empty(m_queue) || m_stopping; });
+		if (std::empty(m_queue)) return;
+
+		auto frame{ std::move(m_queue.front()) };
+		m_queue.pop_front();
+		m_busy = true;
+		lock.unlock();
+		m_changed.notify_all();
+
+		std::exception_ptr error;
+		try {
+			encode(frame);
+		} catch (...) {
+			error = std::current_exception();
+		}
+
+		lock.lock();
+		m_busy = false;
+		if (error) {
+			// Later frames are dropped, `flush` reports the failure
+			m_error = error;
+			m_queue.clear();
+		} else {
+			++m_written;
+			m_recycled.push_back(std::move(frame.pixels.pixels));
+		}
+		m_changed.notify_all();
+		if (m_error) return;
+	}
+}
+
+void frame_capture::encode(captured_frame &frame) {
+	if (m_swizzle) {
+		auto &pixels{ frame.pixels.pixels };
+		for (size_t i{}; i < std::size(pixels); i += bytes_per_pixel) {
+			std::swap(pixels[i], pixels[i + 2]);
+		}
+	}
+
+	if (m_video != nullptr) {
+		m_video->write(frame.pixels);
+	} else {
+		resources::write_png(fmt::format("{}/frame-{:06}.png", m_path, frame.index), frame.pixels);
+	}
+}
+
+} // namespace vc::engine::graphics
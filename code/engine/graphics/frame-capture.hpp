@@ -0,0 +1,87 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <optional>
+#include <string_view>
+#include <exception>
+#include <stdexcept>
+#include <condition_variable>
+
+#include "engine/graphics/buffer.hpp"
+#include "engine/graphics/device.hpp"
+#include "engine/resources/image-decoder.hpp"
+#include "engine/resources/image-encoder.hpp"
+
+namespace vc::engine::graphics {
+
+namespace constants {
+
+/// Frames copied out but not encoded yet, the render thread waits once the encoder is this far behind
+constexpr size_t capture_queue_limit{ 8 };
+constexpr std::string_view y4m_extension{ ".y4m" };
+
+} // namespace constants
+
+/// Copies rendered images into a ring of host visible buffers, one per frame in flight, and reads
+/// them back once the slot comes around again, so the render thread never waits for the GPU. An
+/// encoder thread writes the frames as a Y4M video when the path ends with `.y4m`, otherwise as
+/// numbered PNG files in the directory at the path.
+class frame_capture {
+public:
+	frame_capture(device &device, VkExtent2D extent, VkFormat format, u32 slots_count, std::string path, u32 fps);
+	~frame_capture();
+
+	frame_capture(const frame_capture &) = delete;
+	frame_capture &operator=(const frame_capture &) = delete;
+
+	[[nodiscard]] static auto is_supported(VkFormat format) noexcept -> b8;
+
+	/// Copies `image` into the slot's buffer, recorded by a render graph pass that reads it as a
+	/// transfer source, in `VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL`.
+	void record(VkCommandBuffer command_buffer, VkImage image, u32 slot, u64 frame);
+	/// Hands the slot's last copy to the encoder. Call once the slot's previous frame has completed.
+	void collect(u32 slot);
+	/// Waits until every queued frame is written, rethrows the first error of the encoder.
+	void flush();
+
+private:
+	struct captured_frame {
+		u64                    index{};
+		resources::image       pixels;
+	};
+
+	device                            &m_device;
+	VkExtent2D                         m_extent;
+	b8                                 m_swizzle{ false };  ///< BGRA images
+	std::vector<buffer>                m_buffers;
+	std::vector<std::optional<u64>>    m_pending;           ///< Frame copied into each slot
+	std::string                        m_path;
+	std::unique_ptr<resources::y4m_writer> m_video;
+
+	std::mutex                         m_mutex;
+	std::condition_variable            m_changed;
+	std::deque<captured_frame>         m_queue;
+	std::vector<std::vector<std::byte>> m_recycled;         ///< Pixel storage of written frames
+	b8                                 m_busy    { false };
+	b8                                 m_stopping{ false };
+	std::exception_ptr                 m_error;
+	u64                                m_written {};
+	u64                                m_stalls  {};        ///< Collections that waited for the encoder
+	std::thread                        m_encoder;
+
+	void encode_frames();
+	void encode(captured_frame &frame);
+};
+
+class frame_capture_error : public std::runtime_error {
+public:
+	using base_type = std::runtime_error;
+	using base_type::runtime_error;
+};
+
+} // namespace vc::engine::graphics
@@ -0,0 +1,209 @@
+#include <limits>
+#include <algorithm>
+
+#include <fmt/core.h>
+
+#include "engine/graphics/frame-timeline.hpp"
+
+namespace vc::engine::graphics {
+
+frame_timeline::frame_timeline(device &dev, const u32 frames_in_flight) : m_device{ dev } {
+	const auto device{ m_device.handle() };
+	if (m_device.has_timeline_semaphores()) {
+		m_wait_semaphores = reinterpret_cast<PFN_vkWaitSemaphores>(vkGetDeviceProcAddr(device, "vkWaitSemaphores"));
+		m_get_counter_value = reinterpret_cast<PFN_vkGetSemaphoreCounterValue>(
+			vkGetDeviceProcAddr(device, "vkGetSemaphoreCounterValue"));
+	}
+
+	if (m_wait_semaphores != nullptr && m_get_counter_value != nullptr) {
+		const VkSemaphoreTypeCreateInfo type_info{
+			.sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO,
+			.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE,
+			.initialValue  = 0
+		};
+		const VkSemaphoreCreateInfo semaphore_info{
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+			.pNext = &type_info
+		};
+		if (VK_SUCCESS != vkCreateSemaphore(device, &semaphore_info, m_device.allocator(), &m_semaphore)) {
+			throw frame_timeline_error{ "Failed to create the frame timeline semaphore." };
+		}
+		return;
+	}
+
+	// Created signalled, so the first waits of every slot return immediately
+	const VkFenceCreateInfo fence_info{
+		.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+		.flags = VK_FENCE_CREATE_SIGNALED_BIT
+	};
+	m_fences.resize(frames_in_flight, VK_NULL_HANDLE);
+	for (auto &fence : m_fences) {
+		if (VK_SUCCESS != vkCreateFence(device, &fence_info, m_device.allocator(), &fence)) {
+			throw frame_timeline_error{ fmt::format("Failed to create {} frame fences.", frames_in_flight) };
+		}
+	}
+}
+
+frame_timeline::~frame_timeline() {
+	const auto device{ m_device.handle() };
+	vkDestroySemaphore(device, m_semaphore, m_device.allocator());
+	for (const auto fence : m_fences) {
+		vkDestroyFence(device, fence, m_device.allocator());
+	}
+}
+
+u64 frame_timeline::completed() {
+	if (is_timeline()) {
+		u64 value{};
+		if (VK_SUCCESS == m_get_counter_value(m_device.handle(), m_semaphore, &value)) {
+			m_completed = std::max(m_completed, value);
+		}
+		return m_completed;
+	}
+
+	// Fences of consecutive frames complete in order, the first unsignalled one ends the scan
+	m_completed = std::max(m_completed, oldest_tracked() - 1);
+	while (m_completed < m_submitted) {
+		const auto fence{ m_fences[(m_completed + 1) % std::size(m_fences)] };
+		if (VK_SUCCESS != vkGetFenceStatus(m_device.handle(), fence)) break;
+		++m_completed;
+	}
+	return m_completed;
+}
+
+b8 frame_timeline::is_complete(const u64 frame) {
+	return frame <= m_completed || frame <= completed();
+}
+
+void frame_timeline::wait(u64 frame) {
+	frame = std::min(frame, m_submitted);
+	if (frame <= m_completed) return;
+
+	const auto device{ m_device.handle() };
+	if (is_timeline()) {
+		const VkSemaphoreWaitInfo wait_info{
+			.sType          = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+			.semaphoreCount = 1,
+			.pSemaphores    = &m_semaphore,
+			.pValues        = &frame
+		};
+		if (VK_SUCCESS != m_wait_semaphores(device, &wait_info, std::numeric_limits<u64>::max())) {
+			throw frame_timeline_error{ fmt::format("Failed to wait for frame {}.", frame) };
+		}
+	} else {
+		const auto fence{ m_fences[frame % std::size(m_fences)] };
+		if (frame >= oldest_tracked()
+			&& VK_SUCCESS != vkWaitForFences(device, 1, &fence, VK_TRUE, std::numeric_limits<u64>::max())) {
+			throw frame_timeline_error{ fmt::format("Failed to wait for frame {}.", frame) };
+		}
+	}
+	m_completed = frame;
+}
+
+u64 frame_timeline::submit(const VkQueue queue, const VkSubmitInfo &info, std::pmr::memory_resource *scratch) {
+	const auto frame{ m_submitted + 1 };
+	if (!is_timeline()) {
+		// The slot's previous frame leaves the ring, so it has to be complete first
+		if (frame > std::size(m_fences)) {
+			wait(frame - std::size(m_fences));
+		}
+		const auto fence{ m_fences[frame % std::size(m_fences)] };
+		vkResetFences(m_device.handle(), 1, &fence);
+		if (m_device.has_dynamic_rendering()) {
+			submit2(queue, info, fence, frame, scratch);
+		} else if (VK_SUCCESS != vkQueueSubmit(queue, 1, &info, fence)) {
+			throw frame_timeline_error{ fmt::format("Failed to submit frame {}.", frame) };
+		}
+		return m_submitted = frame;
+	}
+	if (m_device.has_dynamic_rendering()) {
+		submit2(queue, info, VK_NULL_HANDLE, frame, scratch);
+		return m_submitted = frame;
+	}
+
+	// Binary semaphores ignore their values, the timeline one is signalled last
+	std::pmr::vector<VkSemaphore> signal_semaphores(info.pSignalSemaphores,
+		info.pSignalSemaphores + info.signalSemaphoreCount, scratch);
+	signal_semaphores.push_back(m_semaphore);
+	std::pmr::vector<u64> signal_values(std::size(signal_semaphores), 0, scratch);
+	signal_values.back() = frame;
+	const std::pmr::vector<u64> wait_values(info.waitSemaphoreCount, 0, scratch);
+
+	const VkTimelineSemaphoreSubmitInfo timeline_info{
+		.sType                     = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+		.pNext                     = info.pNext,
+		.waitSemaphoreValueCount   = static_cast<u32>(std::size(wait_values)),
+		.pWaitSemaphoreValues      = std::data(wait_values),
+		.signalSemaphoreValueCount = static_cast<u32>(std::size(signal_values)),
+		.pSignalSemaphoreValues    = std::data(signal_values)
+	};
+	auto timeline_submit{ info };
+	timeline_submit.pNext = &timeline_info;
+	timeline_submit.signalSemaphoreCount = static_cast<u32>(std::size(signal_semaphores));
+	timeline_submit.pSignalSemaphores = std::data(signal_semaphores);
+	if (VK_SUCCESS != vkQueueSubmit(queue, 1, &timeline_submit, VK_NULL_HANDLE)) {
+		throw frame_timeline_error{ fmt::format("Failed to submit frame {}.", frame) };
+	}
+	return m_submitted = frame;
+}
+
+void frame_timeline::submit2(const VkQueue queue, const VkSubmitInfo &info, const VkFence fence, const u64 frame,
+	std::pmr::memory_resource *scratch) {
+	// The 32-bit stage bits keep their values in the 64-bit masks
+	std::pmr::vector<VkSemaphoreSubmitInfo> waits{ scratch };
+	waits.reserve(info.waitSemaphoreCount);
+	for (u32 i{}; i < info.waitSemaphoreCount; ++i) {
+		waits.push_back(VkSemaphoreSubmitInfo{
+			.sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+			.semaphore = info.pWaitSemaphores[i],
+			.stageMask = info.pWaitDstStageMask[i]
+		});
+	}
+	std::pmr::vector<VkCommandBufferSubmitInfo> buffers{ scratch };
+	buffers.reserve(info.commandBufferCount);
+	for (u32 i{}; i < info.commandBufferCount; ++i) {
+		buffers.push_back(VkCommandBufferSubmitInfo{
+			.sType         = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO,
+			.commandBuffer = info.pCommandBuffers[i]
+		});
+	}
+	// The timeline value travels with its semaphore, no extension structure is chained
+	std::pmr::vector<VkSemaphoreSubmitInfo> signals{ scratch };
+	signals.reserve(info.signalSemaphoreCount + 1);
+	for (u32 i{}; i < info.signalSemaphoreCount; ++i) {
+		signals.push_back(VkSemaphoreSubmitInfo{
+			.sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+			.semaphore = info.pSignalSemaphores[i],
+			.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT
+		});
+	}
+	if (is_timeline()) {
+		signals.push_back(VkSemaphoreSubmitInfo{
+			.sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+			.semaphore = m_semaphore,
+			.value     = frame,
+			.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT
+		});
+	}
+
+	const VkSubmitInfo2 submit_info{
+		.sType                    = VK_STRUCTURE_TYPE_SUBMIT_INFO_2,
+		.pNext                    = info.pNext,
+		.waitSemaphoreInfoCount   = static_cast<u32>(std::size(waits)),
+		.pWaitSemaphoreInfos      = std::data(waits),
+		.commandBufferInfoCount   = static_cast<u32>(std::size(buffers)),
+		.pCommandBufferInfos      = std::data(buffers),
+		.signalSemaphoreInfoCount = static_cast<u32>(std::size(signals)),
+		.pSignalSemaphoreInfos    = std::data(signals)
+	};
+	if (VK_SUCCESS != m_device.rendering_commands().queue_submit2(queue, 1, &submit_info, fence)) {
+		throw frame_timeline_error{ fmt::format("Failed to submit frame {}.", frame) };
+	}
+}
+
+u64 frame_timeline::oldest_tracked() const noexcept {
+	const auto capacity{ static_cast<u64>(std::size(m_fences)) };
+	return m_submitted > capacity ? m_submitted - capacity + 1 : 1;
+}
+
+} // namespace vc::engine::graphics
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+#include <memory_resource>
+#include <stdexcept>
+
+#include "engine/graphics/device.hpp"
+
+namespace vc::engine::graphics {
+
+/// One monotonic value per submitted frame, the first frame is 1. With timeline semaphores the
+/// graphics submission signals the value itself; older devices get a ring of fences that answers
+/// the same queries for the last `frames_in_flight` frames, everything older is complete.
+///
+/// Other subsystems can key their resources to `submitted()` and release them once
+/// `is_complete` returns true for that frame.
+class frame_timeline {
+public:
+	frame_timeline(device &device, u32 frames_in_flight);
+	~frame_timeline();
+
+	frame_timeline(const frame_timeline &) = delete;
+	frame_timeline &operator=(const frame_timeline &) = delete;
+
+	[[nodiscard]] auto is_timeline() const noexcept { return m_semaphore != VK_NULL_HANDLE; }
+	/// Value of the last submitted frame, 0 before the first submission.
+	[[nodiscard]] auto submitted() const noexcept { return m_submitted; }
+
+	/// Polls the GPU without blocking.
+	[[nodiscard]] auto completed() -> u64;
+	[[nodiscard]] auto is_complete(u64 frame) -> b8;
+	/// Blocks until `frame` has completed, frames that were never submitted count as complete.
+	void wait(u64 frame);
+
+	/// Submits `info` to `queue` as the next frame and signals its value on completion. The
+	/// `info` must not chain a `VkTimelineSemaphoreSubmitInfo` of its own. The semaphore values
+	/// live in `scratch` for the duration of the call. With dynamic rendering the submission goes
+	/// through `vkQueueSubmit2`.
+	auto submit(VkQueue queue, const VkSubmitInfo &info,
+		std::pmr::memory_resource *scratch = std::pmr::get_default_resource()) -> u64;
+
+private:
+	device               &m_device;
+	VkSemaphore           m_semaphore{ VK_NULL_HANDLE };
+	std::vector<VkFence>  m_fences;  ///< Fallback, frame `n` uses `n % size`
+	u64                   m_submitted{};
+	u64                   m_completed{};
+
+	PFN_vkWaitSemaphores           m_wait_semaphores  { nullptr };
+	PFN_vkGetSemaphoreCounterValue m_get_counter_value{ nullptr };
+
+	void submit2(VkQueue queue, const VkSubmitInfo &info, VkFence fence, u64 frame,
+		std::pmr::memory_resource *scratch);
+	/// First frame whose fence is still in the ring.
+	[[nodiscard]] auto oldest_tracked() const noexcept -> u64;
+};
+
+class frame_timeline_error : public std::runtime_error {
+public:
+	using base_type = std::runtime_error;
+	using base_type::runtime_error;
+};
+
+} // namespace vc::engine::graphics
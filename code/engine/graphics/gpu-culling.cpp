@@ -0,0 +1,323 @@
+#include <array>
+#include <cstdio>
+#include <algorithm>
+
+#include <fmt/core.h>
+#include <glm/vec4.hpp>
+
+#include "engine/graphics/gpu-culling.hpp"
+
+namespace vc::engine::graphics {
+
+namespace {
+
+struct culling_push_constant_data {
+	std::array<glm::vec4, 6> planes;
+	u32                      objects_count;
+};
+
+[[nodiscard]] auto align_up(const VkDeviceSize size, const VkDeviceSize alignment) noexcept -> VkDeviceSize {
+	return (size + alignment - 1) / alignment * alignment;
+}
+
+} // anonymous namespace
+
+gpu_culling::gpu_culling(device &dev, descriptor_layout_cache &layouts, descriptor_allocator &descriptors,
+	pipeline_registry &pipelines, batch_renderer &batch, const std::span<const u32> object_meshes, const u32 slots_count)
+	: m_device{ dev }
+	, m_batch{ batch }
+	, m_objects_count{ static_cast<u32>(std::size(object_meshes)) }
+	, m_slots_count{ slots_count }
+	, m_matrices_size{ align_up(std::max<VkDeviceSize>(1, VkDeviceSize{ m_objects_count } * sizeof(glm::mat4)),
+		std::max<VkDeviceSize>(1, dev.limits().minStorageBufferOffsetAlignment)) }
+	, m_objects{ dev, m_matrices_size * slots_count, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT }
+	, m_instances{ dev, m_matrices_size * slots_count,
+		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT } {
+	if (m_objects_count == 0) {
+		throw gpu_culling_error{ "GPU culling needs at least one object." };
+	}
+	if (m_batch.meshes_count() > m_batch.max_draws()) {
+		throw gpu_culling_error{ fmt::format("Cannot cull {} meshes, the batch is limited to {} draws.",
+			m_batch.meshes_count(), m_batch.max_draws()) };
+	}
+
+	// Every mesh owns a fixed instance range large enough for all of its objects
+	std::vector<u32> mesh_objects(m_batch.meshes_count());
+	for (const auto mesh : object_meshes) {
+		++mesh_objects.at(mesh);
+	}
+
+	std::vector<glm::vec4> mesh_bounds;
+	std::vector<VkDrawIndexedIndirectCommand> reset_commands;
+	mesh_bounds.reserve(m_batch.meshes_count());
+	u32 first_instance{};
+	for (u32 mesh{}; mesh < m_batch.meshes_count(); ++mesh) {
+		const auto &sphere{ m_batch.mesh(mesh).bounds.sphere };
+		mesh_bounds.emplace_back(sphere.center, sphere.radius);
+		reset_commands.push_back(batch_renderer::make_command(m_batch.mesh(mesh), 0, first_instance));
+		first_instance += mesh_objects[mesh];
+	}
+	m_draws_count = static_cast<u32>(std::size(reset_commands));
+
+	m_object_meshes.emplace(buffer::make_device_local(m_device, std::as_bytes(object_meshes),
+		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT));
+	m_mesh_bounds.emplace(buffer::make_device_local(m_device, std::as_bytes(std::span{ mesh_bounds }),
+		VK_BUFFER_USAGE_STORAGE_BUFFER_BIT));
+	m_reset_commands.emplace(buffer::make_device_local(m_device, std::as_bytes(std::span{ reset_commands }),
+		VK_BUFFER_USAGE_TRANSFER_SRC_BIT));
+
+	std::array<VkDescriptorSetLayoutBinding, 5> bindings{};
+	for (u32 binding{}; binding < std::size(bindings); ++binding) {
+		bindings[binding] = VkDescriptorSetLayoutBinding{
+			.binding         = binding,
+			.descriptorType  = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+			.descriptorCount = 1,
+			.stageFlags      = VK_SHADER_STAGE_COMPUTE_BIT
+		};
+	}
+	const std::array set_layouts{ layouts.get(bindings) };
+	construct_descriptors(set_layouts.front(), descriptors);
+
+	const std::array ranges{
+		VkPushConstantRange{
+			.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT,
+			.offset     = 0,
+			.size       = sizeof(culling_push_constant_data)
+		}
+	};
+	m_pipeline_layout.emplace(m_device, set_layouts, ranges);
+	m_pipeline = pipelines.compute(constants::culling_shader, static_cast<VkPipelineLayout>(*m_pipeline_layout));
+
+	if (m_device.compute_queue() != VK_NULL_HANDLE) {
+		construct_compute_queue();
+	}
+
+	std::printf("[engine][graphics][gpu_culling] Culling %u objects of %u meshes on the %s queue\n",
+		m_objects_count, m_batch.meshes_count(), is_async() ? "compute" : "graphics");
+}
+
+gpu_culling::~gpu_culling() {
+	if (!is_async()) return;
+
+	const auto device{ m_device.handle() };
+	vkQueueWaitIdle(m_device.compute_queue());
+	for (const auto semaphore : m_semaphores) {
+		vkDestroySemaphore(device, semaphore, m_device.allocator());
+	}
+	vkDestroyCommandPool(device, m_command_pool, m_device.allocator());
+}
+
+b8 gpu_culling::is_supported(const device &dev) noexcept {
+	return dev.features().drawIndirectFirstInstance == VK_TRUE;
+}
+
+std::span<glm::mat4> gpu_culling::objects(const u32 slot) const noexcept {
+	return m_objects.as<glm::mat4>(VkDeviceSize{ slot % m_slots_count } * m_matrices_size, m_objects_count);
+}
+
+VkDeviceSize gpu_culling::instances_offset(const u32 slot) const noexcept {
+	return VkDeviceSize{ slot % m_slots_count } * m_matrices_size;
+}
+
+void gpu_culling::dispatch(VkCommandBuffer command_buffer, const u32 slot, const scene::frustum &frustum) {
+	record(command_buffer, slot, frustum);
+
+	// The draw records and the instances are consumed by the indirect draws of the same frame
+	const VkMemoryBarrier barrier{
+		.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+		.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT,
+		.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT
+	};
+	vkCmdPipelineBarrier(command_buffer,
+		VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+		0, 1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+semaphore_wait gpu_culling::submit(const u32 slot, const scene::frustum &frustum) {
+	const auto index{ slot % m_slots_count };
+	const auto command_buffer{ m_command_buffers[index] };
+	const VkCommandBufferBeginInfo begin_info{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+	};
+	vkBeginCommandBuffer(command_buffer, &begin_info);
+	record(command_buffer, slot, frustum);
+
+	// Release half of the transfer, the graphics queue never hands them back: the next pass of
+	// the slot overwrites both, so their contents don't have to survive
+	const auto barriers{ ownership_barriers(slot, VK_ACCESS_SHADER_WRITE_BIT, 0) };
+	vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+		0, 0, nullptr, static_cast<u32>(std::size(barriers)), std::data(barriers), 0, nullptr);
+	vkEndCommandBuffer(command_buffer);
+
+	const VkSubmitInfo submit_info{
+		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		.commandBufferCount   = 1,
+		.pCommandBuffers      = &command_buffer,
+		.signalSemaphoreCount = 1,
+		.pSignalSemaphores    = &m_semaphores[index]
+	};
+	if (VK_SUCCESS != vkQueueSubmit(m_device.compute_queue(), 1, &submit_info, VK_NULL_HANDLE)) {
+		throw gpu_culling_error{ fmt::format("Failed to submit the culling of slot {}.", index) };
+	}
+	return semaphore_wait{
+		.semaphore = m_semaphores[index],
+		.stages    = VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT
+	};
+}
+
+void gpu_culling::acquire(VkCommandBuffer command_buffer, const u32 slot) const {
+	const auto barriers{ ownership_barriers(slot, 0,
+		VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT) };
+	vkCmdPipelineBarrier(command_buffer,
+		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+		VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+		0, 0, nullptr, static_cast<u32>(std::size(barriers)), std::data(barriers), 0, nullptr);
+}
+
+void gpu_culling::record(VkCommandBuffer command_buffer, const u32 slot, const scene::frustum &frustum) {
+	// Clears the instance counts of the slot's records before the shader appends to them
+	const VkBufferCopy reset{
+		.srcOffset = 0,
+		.dstOffset = m_batch.slot_offset(slot),
+		.size      = m_reset_commands->size()
+	};
+	vkCmdCopyBuffer(command_buffer, m_reset_commands->handle(), m_batch.commands_buffer(), 1, &reset);
+
+	const VkMemoryBarrier reset_barrier{
+		.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+		.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+		.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT
+	};
+	vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		0, 1, &reset_barrier, 0, nullptr, 0, nullptr);
+
+	const auto layout{ static_cast<VkPipelineLayout>(*m_pipeline_layout) };
+	m_pipeline->bind(command_buffer);
+	vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE, layout,
+		0, 1, &m_descriptor_sets[slot % m_slots_count], 0, nullptr);
+
+	const culling_push_constant_data constant_data{
+		.planes        = frustum.planes,
+		.objects_count = m_objects_count
+	};
+	vkCmdPushConstants(command_buffer, layout, VK_SHADER_STAGE_COMPUTE_BIT,
+		0, sizeof(culling_push_constant_data), &constant_data);
+
+	vkCmdDispatch(command_buffer, (m_objects_count + constants::culling_group_size - 1) / constants::culling_group_size, 1, 1);
+}
+
+std::array<VkBufferMemoryBarrier, 2> gpu_culling::ownership_barriers(const u32 slot, const VkAccessFlags src_access,
+	const VkAccessFlags dst_access) const {
+	const auto &families{ m_device.queue_families() };
+	const auto make_barrier{ [&] (const VkBuffer target, const VkDeviceSize offset, const VkDeviceSize size) {
+		return VkBufferMemoryBarrier{
+			.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+			.srcAccessMask       = src_access,
+			.dstAccessMask       = dst_access,
+			.srcQueueFamilyIndex = *families.compute_family,
+			.dstQueueFamilyIndex = *families.graphics_family,
+			.buffer              = target,
+			.offset              = offset,
+			.size                = size
+		};
+	} };
+	return {
+		make_barrier(m_batch.commands_buffer(), m_batch.slot_offset(slot), m_batch.slot_size()),
+		make_barrier(m_instances.handle(), instances_offset(slot), m_matrices_size)
+	};
+}
+
+void gpu_culling::construct_descriptors(const VkDescriptorSetLayout layout, descriptor_allocator &descriptors) {
+	const auto matrices_range{ VkDeviceSize{ m_objects_count } * sizeof(glm::mat4) };
+
+	m_descriptor_sets.reserve(m_slots_count);
+	for (u32 slot{}; slot < m_slots_count; ++slot) {
+		const auto set{ m_descriptor_sets.emplace_back(descriptors.allocate(layout)) };
+		descriptor_writer{}
+			.buffer(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_objects.handle(), instances_offset(slot), matrices_range)
+			.buffer(1, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_object_meshes->handle())
+			.buffer(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_mesh_bounds->handle())
+			.buffer(3, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_batch.commands_buffer(), m_batch.slot_offset(slot), m_batch.slot_size())
+			.buffer(4, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_instances.handle(), instances_offset(slot), matrices_range)
+			.update(m_device, set);
+	}
+}
+
+void gpu_culling::construct_compute_queue() {
+	const auto device{ m_device.handle() };
+	const auto &families{ m_device.queue_families() };
+	const VkCommandPoolCreateInfo pool_info{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+		.flags            = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT,
+		.queueFamilyIndex = *families.compute_family
+	};
+	if (VK_SUCCESS != vkCreateCommandPool(device, &pool_info, m_device.allocator(), &m_command_pool)) {
+		throw gpu_culling_error{ "Failed to create the compute command pool." };
+	}
+
+	m_command_buffers.resize(m_slots_count);
+	const VkCommandBufferAllocateInfo allocate_info{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+		.commandPool        = m_command_pool,
+		.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+		.commandBufferCount = m_slots_count
+	};
+	if (VK_SUCCESS != vkAllocateCommandBuffers(device, &allocate_info, std::data(m_command_buffers))) {
+		throw gpu_culling_error{ fmt::format("Cannot allocate {} compute command buffers.", m_slots_count) };
+	}
+
+	const VkSemaphoreCreateInfo semaphore_info{ .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+	for (u32 slot{}; slot < m_slots_count; ++slot) {
+		if (VK_SUCCESS != vkCreateSemaphore(device, &semaphore_info, m_device.allocator(), &m_semaphores.emplace_back())) {
+			throw gpu_culling_error{ "Failed to create a culling semaphore." };
+		}
+	}
+
+	// The read-only buffers were uploaded on the graphics queue and move to the compute family
+	// once: the release waits for the graphics queue, so the acquire can be submitted right after
+	const std::array uploads{ m_object_meshes->handle(), m_mesh_bounds->handle(), m_reset_commands->handle() };
+	std::array<VkBufferMemoryBarrier, std::size(uploads)> barriers{};
+	for (size_t i{}; i < std::size(uploads); ++i) {
+		barriers[i] = VkBufferMemoryBarrier{
+			.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER,
+			.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT,
+			.dstAccessMask       = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_TRANSFER_READ_BIT,
+			.srcQueueFamilyIndex = *families.graphics_family,
+			.dstQueueFamilyIndex = *families.compute_family,
+			.buffer              = uploads[i],
+			.offset              = 0,
+			.size                = VK_WHOLE_SIZE
+		};
+	}
+
+	const auto release{ m_device.begin_single_time_commands() };
+	vkCmdPipelineBarrier(release, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+		0, 0, nullptr, static_cast<u32>(std::size(barriers)), std::data(barriers), 0, nullptr);
+	m_device.end_single_time_commands(release);
+
+	const auto acquire{ m_command_buffers.front() };
+	const VkCommandBufferBeginInfo begin_info{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+	};
+	vkBeginCommandBuffer(acquire, &begin_info);
+	vkCmdPipelineBarrier(acquire, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+		VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		0, 0, nullptr, static_cast<u32>(std::size(barriers)), std::data(barriers), 0, nullptr);
+	vkEndCommandBuffer(acquire);
+
+	const VkSubmitInfo submit_info{
+		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+		.commandBufferCount = 1,
+		.pCommandBuffers    = &acquire
+	};
+	if (VK_SUCCESS != vkQueueSubmit(m_device.compute_queue(), 1, &submit_info, VK_NULL_HANDLE)) {
+		throw gpu_culling_error{ "Failed to move the culling buffers to the compute queue." };
+	}
+	vkQueueWaitIdle(m_device.compute_queue());
+}
+
+} // namespace vc::engine::graphics
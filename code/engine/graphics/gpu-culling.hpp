@@ -0,0 +1,100 @@
+#pragma once
+
+#include <span>
+#include <array>
+#include <memory>
+#include <vector>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+
+#include <glm/mat4x4.hpp>
+
+#include "engine/graphics/buffer.hpp"
+#include "engine/graphics/pipeline.hpp"
+#include "engine/graphics/pipeline-registry.hpp"
+#include "engine/graphics/descriptors.hpp"
+#include "engine/graphics/batch-renderer.hpp"
+#include "engine/scene/culling.hpp"
+
+namespace vc::engine::graphics {
+
+namespace constants {
+
+constexpr std::string_view culling_shader       { "assets/shaders/culling/culling" };
+constexpr u32              culling_group_size   { 64 };  ///< `local_size_x` of the shader
+
+} // namespace constants
+
+/// Frustum culling on the GPU: a compute pass tests every object's bounding sphere and appends
+/// the survivors to the instance range of their mesh's draw record in the `batch_renderer`.
+/// Per frame the CPU only streams the world matrices, the records are reset by a copy on the GPU,
+/// so the culling and the compaction cost it nothing however large the scene is.
+///
+/// With a dedicated compute queue the pass is submitted there and overlaps the previous frame's
+/// rendering; the frame waits on its semaphore and acquires the records and the instances.
+class gpu_culling {
+public:
+	/// Objects are drawn with the mesh at the same index of `object_meshes`.
+	gpu_culling(device &device, descriptor_layout_cache &layouts, descriptor_allocator &descriptors,
+		pipeline_registry &pipelines, batch_renderer &batch, std::span<const u32> object_meshes, u32 slots_count);
+
+	~gpu_culling();
+
+	gpu_culling(const gpu_culling &) = delete;
+	gpu_culling &operator=(const gpu_culling &) = delete;
+
+	/// GPU culling writes instances at arbitrary `firstInstance` offsets of indirect records.
+	[[nodiscard]] static auto is_supported(const device &device) noexcept -> b8;
+
+	/// The world matrices the CPU writes for the `slot` before it is dispatched.
+	[[nodiscard]] auto objects(u32 slot) const noexcept -> std::span<glm::mat4>;
+	[[nodiscard]] auto instances() const noexcept { return m_instances.handle(); }
+	[[nodiscard]] auto instances_offset(u32 slot) const noexcept -> VkDeviceSize;
+	[[nodiscard]] auto draws_count() const noexcept { return m_draws_count; }
+	[[nodiscard]] auto is_async() const noexcept { return m_command_pool != VK_NULL_HANDLE; }
+
+	/// Records the culling pass on the graphics queue, it must be outside of a render pass.
+	void dispatch(VkCommandBuffer command_buffer, u32 slot, const scene::frustum &frustum);
+
+	/// Submits the culling pass of the `slot` to the compute queue. The returned wait must be
+	/// passed to the frame's submission, whose command buffer records `acquire` for the slot.
+	/// A slot is only submitted again once the frame that waited on it has completed.
+	[[nodiscard]] auto submit(u32 slot, const scene::frustum &frustum) -> semaphore_wait;
+	void acquire(VkCommandBuffer command_buffer, u32 slot) const;
+
+private:
+	device                                    &m_device;
+	batch_renderer                            &m_batch;
+	u32                                        m_objects_count;
+	u32                                        m_slots_count;
+	VkDeviceSize                               m_matrices_size;  ///< Aligned size of a slot's matrices
+	u32                                        m_draws_count{};
+	buffer                                     m_objects;
+	buffer                                     m_instances;
+	std::optional<buffer>                      m_object_meshes;
+	std::optional<buffer>                      m_mesh_bounds;
+	std::optional<buffer>                      m_reset_commands;  ///< Empty records copied over a slot
+	VkCommandPool                              m_command_pool{ VK_NULL_HANDLE };  ///< Compute family
+	std::vector<VkCommandBuffer>               m_command_buffers;
+	std::vector<VkSemaphore>                   m_semaphores;
+	std::vector<VkDescriptorSet>               m_descriptor_sets;
+	std::optional<pipeline_layout>             m_pipeline_layout;
+	std::shared_ptr<compute_pipeline>          m_pipeline;
+
+	void construct_descriptors(VkDescriptorSetLayout layout, descriptor_allocator &descriptors);
+	void construct_compute_queue();
+
+	void record(VkCommandBuffer command_buffer, u32 slot, const scene::frustum &frustum);
+	/// Barriers of the buffers shared by both queues, from the compute to the graphics family.
+	[[nodiscard]] auto ownership_barriers(u32 slot, VkAccessFlags src_access, VkAccessFlags dst_access) const
+		-> std::array<VkBufferMemoryBarrier, 2>;
+};
+
+class gpu_culling_error : public std::runtime_error {
+public:
+	using base_type = std::runtime_error;
+	using base_type::runtime_error;
+};
+
+} // namespace vc::engine::graphics
@@ -0,0 +1,59 @@
+#include <array>
+#include <cstdio>
+#include <utility>
+
+#include "engine/graphics/gpu-timer.hpp"
+
+namespace vc::engine::graphics {
+
+gpu_timer::gpu_timer(device &dev, const u32 slots_count) : m_device{ dev }, m_pending(slots_count) {
+	const auto bits{ m_device.timestamp_valid_bits() };
+	if (bits == 0) {
+		std::printf("[engine][graphics][gpu_timer] The graphics queue has no timestamps, GPU times are unavailable\n");
+		return;
+	}
+	m_valid_mask = bits >= 64 ? ~u64{} : (u64{ 1 } << bits) - 1;
+	m_period = m_device.limits().timestampPeriod;
+
+	const VkQueryPoolCreateInfo pool_info{
+		.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+		.queryType  = VK_QUERY_TYPE_TIMESTAMP,
+		.queryCount = 2 * slots_count
+	};
+	if (VK_SUCCESS != vkCreateQueryPool(m_device.handle(), &pool_info, m_device.allocator(), &m_query_pool)) {
+		throw gpu_timer_error{ "Failed to create the timestamp query pool." };
+	}
+}
+
+gpu_timer::~gpu_timer() {
+	vkDestroyQueryPool(m_device.handle(), m_query_pool, m_device.allocator());
+}
+
+void gpu_timer::begin(VkCommandBuffer command_buffer, const u32 slot) {
+	if (!is_supported()) return;
+	vkCmdResetQueryPool(command_buffer, m_query_pool, 2 * slot, 2);
+	vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_query_pool, 2 * slot);
+}
+
+void gpu_timer::end(VkCommandBuffer command_buffer, const u32 slot, const u64 frame) {
+	if (!is_supported()) return;
+	vkCmdWriteTimestamp(command_buffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_query_pool, 2 * slot + 1);
+	m_pending[slot] = frame;
+}
+
+std::optional<gpu_time_sample> gpu_timer::read(const u32 slot) {
+	if (!is_supported() || !m_pending[slot].has_value()) return std::nullopt;
+
+	std::array<u64, 2> ticks{};
+	const auto result{ vkGetQueryPoolResults(m_device.handle(), m_query_pool, 2 * slot, 2,
+		sizeof(ticks), std::data(ticks), sizeof(u64), VK_QUERY_RESULT_64_BIT) };
+	if (result != VK_SUCCESS) return std::nullopt;
+
+	const auto elapsed{ ((ticks[1] & m_valid_mask) - (ticks[0] & m_valid_mask)) & m_valid_mask };
+	return gpu_time_sample{
+		.frame        = *std::exchange(m_pending[slot], std::nullopt),
+		.milliseconds = static_cast<f64>(elapsed) * m_period * 1e-6
+	};
+}
+
+} // namespace vc::engine::graphics
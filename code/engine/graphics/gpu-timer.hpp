@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include <optional>
+#include <stdexcept>
+
+#include "engine/graphics/device.hpp"
+
+namespace vc::engine::graphics {
+
+struct gpu_time_sample {
+	u64 frame       {};
+	f64 milliseconds{};
+};
+
+/// Measures the GPU time of whole frames with a pair of timestamps per frame in flight. A slot's
+/// result is read once its frame has completed, before the slot is recorded again.
+class gpu_timer {
+public:
+	gpu_timer(device &device, u32 slots_count);
+	~gpu_timer();
+
+	gpu_timer(const gpu_timer &) = delete;
+	gpu_timer &operator=(const gpu_timer &) = delete;
+
+	/// False when the graphics queue has no valid timestamp bits.
+	[[nodiscard]] auto is_supported() const noexcept { return m_query_pool != VK_NULL_HANDLE; }
+
+	/// Both must be recorded outside of a render pass, `begin` resets the slot's queries.
+	void begin(VkCommandBuffer command_buffer, u32 slot);
+	void end(VkCommandBuffer command_buffer, u32 slot, u64 frame);
+
+	/// The slot's last measurement, empty until it is available or once it was read.
+	[[nodiscard]] auto read(u32 slot) -> std::optional<gpu_time_sample>;
+
+private:
+	device                          &m_device;
+	VkQueryPool                      m_query_pool{ VK_NULL_HANDLE };
+	u64                              m_valid_mask{};
+	f64                              m_period    {};  ///< Nanoseconds per tick
+	std::vector<std::optional<u64>>  m_pending;       ///< Frame measured by each slot
+};
+
+class gpu_timer_error : public std::runtime_error {
+public:
+	using base_type = std::runtime_error;
+	using base_type::runtime_error;
+};
+
+} // namespace vc::engine::graphics
@@ -0,0 +1,256 @@
+#include <bit>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#include "engine/graphics/host-allocator.hpp"
+
+namespace vc::engine::graphics {
+
+namespace {
+
+/// Precedes every allocation, `offset` leads back to the start of its block.
+struct allocation_header {
+	u64 size      {};
+	u32 offset    {};
+	u16 size_class{};
+	u8  scope     {};
+	u8  reserved  {};
+};
+
+constexpr size_t header_size   { sizeof(allocation_header) };
+constexpr size_t base_alignment{ alignof(std::max_align_t) };
+constexpr u16    system_class  { 0xFFFF };  ///< Allocated with malloc
+
+static_assert(header_size == 16 && header_size % base_alignment == 0);
+static_assert(constants::host_pool_chunk_size % constants::host_size_classes.back() == 0);
+
+[[nodiscard]] auto header_of(void *memory) noexcept -> allocation_header * {
+	return reinterpret_cast<allocation_header *>(static_cast<std::byte *>(memory) - header_size);
+}
+
+[[nodiscard]] constexpr auto block_size(const size_t size, const size_t alignment) noexcept -> size_t {
+	return header_size + size + (alignment > base_alignment ? alignment - base_alignment : 0);
+}
+
+[[nodiscard]] auto find_size_class(const size_t size) noexcept -> u16 {
+	const auto found{ std::ranges::lower_bound(constants::host_size_classes, size) };
+	if (found == std::end(constants::host_size_classes)) return system_class;
+	return static_cast<u16>(found - std::begin(constants::host_size_classes));
+}
+
+void raise_peak(std::atomic<u64> &peak, const u64 value) noexcept {
+	for (auto current{ peak.load(std::memory_order_relaxed) };
+		value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed);) {
+	}
+}
+
+} // anonymous namespace
+
+host_allocator::host_allocator() {
+	m_callbacks = VkAllocationCallbacks{
+		.pUserData             = this,
+		.pfnAllocation         = &host_allocator::allocation_callback,
+		.pfnReallocation       = &host_allocator::reallocation_callback,
+		.pfnFree               = &host_allocator::free_callback,
+		.pfnInternalAllocation = &host_allocator::internal_allocation_callback,
+		.pfnInternalFree       = &host_allocator::internal_free_callback
+	};
+}
+
+host_allocator::~host_allocator() {
+	for (auto &pool : m_pools) {
+		for (auto *chunk : pool.chunks) {
+			std::free(chunk);
+		}
+	}
+}
+
+host_scope_statistics host_allocator::statistics(const VkSystemAllocationScope scope) const noexcept {
+	const auto &counters{ m_scopes[std::min<size_t>(scope, std::size(m_scopes) - 1)] };
+	return host_scope_statistics{
+		.allocations    = counters.allocations.load(std::memory_order_relaxed),
+		.reallocations  = counters.reallocations.load(std::memory_order_relaxed),
+		.frees          = counters.frees.load(std::memory_order_relaxed),
+		.pooled         = counters.pooled.load(std::memory_order_relaxed),
+		.bytes          = counters.bytes.load(std::memory_order_relaxed),
+		.peak_bytes     = counters.peak_bytes.load(std::memory_order_relaxed),
+		.internal_bytes = counters.internal_bytes.load(std::memory_order_relaxed)
+	};
+}
+
+void host_allocator::print_statistics() const {
+	constexpr std::array<const char *, constants::host_allocation_scopes> names{
+		"command", "object", "cache", "device", "instance"
+	};
+	size_t chunks_count{};
+	for (const auto &pool : m_pools) {
+		chunks_count += std::size(pool.chunks);
+	}
+	std::printf("[engine][graphics][host_allocator] Driver host memory, %zu KiB of pool chunks\n",
+		chunks_count * constants::host_pool_chunk_size / 1024);
+	for (size_t scope{}; scope < std::size(names); ++scope) {
+		const auto stats{ statistics(static_cast<VkSystemAllocationScope>(scope)) };
+		if (stats.allocations == 0 && stats.internal_bytes == 0) continue;
+		std::printf("[engine][graphics][host_allocator]   %-8s %8llu allocations (%llu pooled), %llu reallocations, "
+			"%llu frees, %.1f KiB live, %.1f KiB peak, %.1f KiB internal\n", names[scope],
+			static_cast<unsigned long long>(stats.allocations), static_cast<unsigned long long>(stats.pooled),
+			static_cast<unsigned long long>(stats.reallocations), static_cast<unsigned long long>(stats.frees),
+			static_cast<f64>(stats.bytes) / 1024.0, static_cast<f64>(stats.peak_bytes) / 1024.0,
+			static_cast<f64>(stats.internal_bytes) / 1024.0);
+	}
+}
+
+void *host_allocator::allocate(const size_t size, const size_t alignment, const VkSystemAllocationScope scope) noexcept {
+	if (size == 0 || !std::has_single_bit(alignment)) return nullptr;
+
+	const auto total{ block_size(size, alignment) };
+	const auto size_class{ find_size_class(total) };
+	auto *block{ size_class == system_class
+		? static_cast<std::byte *>(std::malloc(total))
+		: take_block(size_class) };
+	if (block == nullptr) return nullptr;
+
+	const auto address{ reinterpret_cast<uintptr_t>(block) + header_size };
+	auto *memory{ reinterpret_cast<std::byte *>((address + alignment - 1) & ~(uintptr_t{ alignment } - 1)) };
+	*header_of(memory) = allocation_header{
+		.size       = size,
+		.offset     = static_cast<u32>(memory - block),
+		.size_class = size_class,
+		.scope      = static_cast<u8>(std::min<size_t>(scope, std::size(m_scopes) - 1))
+	};
+
+	auto &stats{ counters(scope) };
+	stats.allocations.fetch_add(1, std::memory_order_relaxed);
+	if (size_class != system_class) {
+		stats.pooled.fetch_add(1, std::memory_order_relaxed);
+	}
+	raise_peak(stats.peak_bytes, stats.bytes.fetch_add(size, std::memory_order_relaxed) + size);
+	return memory;
+}
+
+void *host_allocator::reallocate(void *original, const size_t size, const size_t alignment,
+	const VkSystemAllocationScope scope) noexcept {
+	if (original == nullptr) return allocate(size, alignment, scope);
+	if (size == 0) {
+		free(original);
+		return nullptr;
+	}
+
+	// Blocks of a size class often have room left, the memory then stays where it is
+	auto *header{ header_of(original) };
+	const auto fits_in_place{ header->size_class != system_class
+		&& reinterpret_cast<uintptr_t>(original) % alignment == 0
+		&& header->offset + size <= constants::host_size_classes[header->size_class] };
+	if (fits_in_place) {
+		auto &stats{ m_scopes[header->scope] };
+		stats.reallocations.fetch_add(1, std::memory_order_relaxed);
+		if (size > header->size) {
+			raise_peak(stats.peak_bytes, stats.bytes.fetch_add(size - header->size, std::memory_order_relaxed) + size - header->size);
+		} else {
+			stats.bytes.fetch_sub(header->size - size, std::memory_order_relaxed);
+		}
+		header->size = size;
+		return original;
+	}
+
+	const auto original_size{ header->size };
+	const auto original_scope{ header->scope };
+	auto *memory{ allocate(size, alignment, scope) };
+	if (memory == nullptr) return nullptr;
+	std::memcpy(memory, original, std::min<size_t>(size, original_size));
+	free(original);
+
+	// Counted as a reallocation instead of an allocation and a free
+	auto &stats{ counters(scope) };
+	stats.allocations.fetch_sub(1, std::memory_order_relaxed);
+	stats.reallocations.fetch_add(1, std::memory_order_relaxed);
+	m_scopes[original_scope].frees.fetch_sub(1, std::memory_order_relaxed);
+	return memory;
+}
+
+void host_allocator::free(void *memory) noexcept {
+	if (memory == nullptr) return;
+
+	const auto header{ *header_of(memory) };
+	auto &stats{ m_scopes[header.scope] };
+	stats.frees.fetch_add(1, std::memory_order_relaxed);
+	stats.bytes.fetch_sub(header.size, std::memory_order_relaxed);
+
+	auto *block{ static_cast<std::byte *>(memory) - header.offset };
+	if (header.size_class == system_class) {
+		std::free(block);
+	} else {
+		return_block(header.size_class, block);
+	}
+}
+
+std::byte *host_allocator::take_block(const size_t size_class) noexcept {
+	auto &pool{ m_pools[size_class] };
+	const std::lock_guard lock{ pool.mutex };
+	if (pool.free_list == nullptr) {
+		auto *chunk{ static_cast<std::byte *>(std::malloc(constants::host_pool_chunk_size)) };
+		if (chunk == nullptr) return nullptr;
+		try {
+			pool.chunks.push_back(chunk);
+		} catch (...) {
+			std::free(chunk);
+			return nullptr;
+		}
+
+		// Threads the chunk's blocks into the free list, the first one ends up on top
+		const auto size{ constants::host_size_classes[size_class] };
+		for (auto offset{ constants::host_pool_chunk_size }; offset >= size; offset -= size) {
+			auto *block{ chunk + offset - size };
+			std::memcpy(block, &pool.free_list, sizeof(void *));
+			pool.free_list = block;
+		}
+	}
+
+	auto *block{ static_cast<std::byte *>(pool.free_list) };
+	std::memcpy(&pool.free_list, block, sizeof(void *));
+	return block;
+}
+
+void host_allocator::return_block(const size_t size_class, std::byte *block) noexcept {
+	auto &pool{ m_pools[size_class] };
+	const std::lock_guard lock{ pool.mutex };
+	std::memcpy(block, &pool.free_list, sizeof(void *));
+	pool.free_list = block;
+}
+
+#pragma region callbacks
+
+VKAPI_ATTR void *VKAPI_CALL host_allocator::allocation_callback(void *self, const size_t size, const size_t alignment,
+	const VkSystemAllocationScope scope) {
+	return static_cast<host_allocator *>(self)->allocate(size, alignment, scope);
+}
+
+VKAPI_ATTR void *VKAPI_CALL host_allocator::reallocation_callback(void *self, void *original, const size_t size,
+	const size_t alignment, const VkSystemAllocationScope scope) {
+	return static_cast<host_allocator *>(self)->reallocate(original, size, alignment, scope);
+}
+
+VKAPI_ATTR void VKAPI_CALL host_allocator::free_callback(void *self, void *memory) {
+	static_cast<host_allocator *>(self)->free(memory);
+}
+
+VKAPI_ATTR void VKAPI_CALL host_allocator::internal_allocation_callback(void *self, const size_t size,
+	VkInternalAllocationType, const VkSystemAllocationScope scope) {
+	static_cast<host_allocator *>(self)->counters(scope).internal_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+VKAPI_ATTR void VKAPI_CALL host_allocator::internal_free_callback(void *self, const size_t size,
+	VkInternalAllocationType, const VkSystemAllocationScope scope) {
+	static_cast<host_allocator *>(self)->counters(scope).internal_bytes.fetch_sub(size, std::memory_order_relaxed);
+}
+
+#pragma endregion callbacks
+
+host_allocator::scope_counters &host_allocator::counters(const VkSystemAllocationScope scope) noexcept {
+	return m_scopes[std::min<size_t>(scope, std::size(m_scopes) - 1)];
+}
+
+} // namespace vc::engine::graphics
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+#include <vulkan/vulkan.h>
+
+#include "core/types.hpp"
+
+namespace vc::engine::graphics {
+
+namespace constants {
+
+/// Block sizes of the pools, headers and alignment padding included. Larger requests go to malloc.
+constexpr std::array<size_t, 8> host_size_classes{ 64, 128, 256, 512, 1024, 2048, 4096, 8192 };
+constexpr size_t host_pool_chunk_size{ 256 * 1024 };
+/// Command, object, cache, device and instance, as `VkSystemAllocationScope` numbers them.
+constexpr size_t host_allocation_scopes{ 5 };
+
+} // namespace constants
+
+struct host_scope_statistics {
+	u64 allocations  {};
+	u64 reallocations{};
+	u64 frees        {};
+	u64 pooled       {};  ///< Allocations served by a size class
+	u64 bytes        {};  ///< Currently allocated
+	u64 peak_bytes   {};
+	u64 internal_bytes{}; ///< Allocated by the driver itself, as it notified us
+};
+
+/// Host memory of the driver, handed to every `vkCreate*` through `callbacks()`. Small blocks
+/// come from free lists of fixed size classes carved out of large chunks, which are kept until
+/// the allocator is destroyed: command scope memory is freed right after the call that
+/// requested it and object scope memory churns with the objects, so both are recycled
+/// instead of going back to malloc. Everything is counted per allocation scope.
+///
+/// Objects have to be destroyed with the callbacks they were created with, so the allocator
+/// outlives the instance.
+class host_allocator {
+public:
+	host_allocator();
+	~host_allocator();
+
+	host_allocator(const host_allocator &) = delete;
+	host_allocator &operator=(const host_allocator &) = delete;
+
+	[[nodiscard]] auto callbacks() const noexcept -> const VkAllocationCallbacks * { return &m_callbacks; }
+	[[nodiscard]] auto statistics(VkSystemAllocationScope scope) const noexcept -> host_scope_statistics;
+	void print_statistics() const;
+
+private:
+	struct scope_counters {
+		std::atomic<u64> allocations   {};
+		std::atomic<u64> reallocations {};
+		std::atomic<u64> frees         {};
+		std::atomic<u64> pooled        {};
+		std::atomic<u64> bytes         {};
+		std::atomic<u64> peak_bytes    {};
+		std::atomic<u64> internal_bytes{};
+	};
+
+	struct size_class_pool {
+		std::mutex                mutex;
+		void                     *free_list{ nullptr };  ///< Every free block starts with the next one
+		std::vector<std::byte *>  chunks;
+	};
+
+	VkAllocationCallbacks m_callbacks{};
+	std::array<size_class_pool, std::size(constants::host_size_classes)> m_pools;
+	std::array<scope_counters, constants::host_allocation_scopes>         m_scopes;
+
+	[[nodiscard]] auto allocate(size_t size, size_t alignment, VkSystemAllocationScope scope) noexcept -> void *;
+	[[nodiscard]] auto reallocate(void *original, size_t size, size_t alignment, VkSystemAllocationScope scope) noexcept -> void *;
+	void free(void *memory) noexcept;
+
+	[[nodiscard]] auto take_block(size_t size_class) noexcept -> std::byte *;
+	void return_block(size_t size_class, std::byte *block) noexcept;
+	[[nodiscard]] auto counters(VkSystemAllocationScope scope) noexcept -> scope_counters &;
+
+	static VKAPI_ATTR void *VKAPI_CALL allocation_callback(void *self, size_t size, size_t alignment,
+		VkSystemAllocationScope scope);
+	static VKAPI_ATTR void *VKAPI_CALL reallocation_callback(void *self, void *original, size_t size, size_t alignment,
+		VkSystemAllocationScope scope);
+	static VKAPI_ATTR void VKAPI_CALL free_callback(void *self, void *memory);
+	static VKAPI_ATTR void VKAPI_CALL internal_allocation_callback(void *self, size_t size,
+		VkInternalAllocationType type, VkSystemAllocationScope scope);
+	static VKAPI_ATTR void VKAPI_CALL internal_free_callback(void *self, size_t size,
+		VkInternalAllocationType type, VkSystemAllocationScope scope);
+};
+
+} // namespace vc::engine::graphics
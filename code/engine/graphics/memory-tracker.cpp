@@ -0,0 +1,107 @@
+#include <cstdio>
+#include <numeric>
+#include <algorithm>
+
+#include "engine/graphics/memory-tracker.hpp"
+
+namespace vc::engine::graphics {
+
+namespace {
+
+[[nodiscard]] constexpr auto to_mebibytes(const VkDeviceSize bytes) noexcept -> f64 {
+	return static_cast<f64>(bytes) / (1024.0 * 1024.0);
+}
+
+} // anonymous namespace
+
+std::string_view to_string(const memory_category category) noexcept {
+	switch (category) {
+	case memory_category::vertex:   return "vertex";
+	case memory_category::index:    return "index";
+	case memory_category::uniform:  return "uniform";
+	case memory_category::storage:  return "storage";
+	case memory_category::staging:  return "staging";
+	case memory_category::readback: return "readback";
+	case memory_category::image:    return "image";
+	case memory_category::depth:    return "depth";
+	default:                        return "other";
+	}
+}
+
+memory_category categorize_buffer(const VkBufferUsageFlags usage, const VkMemoryPropertyFlags properties) noexcept {
+	const auto is_host_visible{ (properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0 };
+	if (usage & VK_BUFFER_USAGE_INDEX_BUFFER_BIT) return memory_category::index;
+	if (usage & VK_BUFFER_USAGE_VERTEX_BUFFER_BIT) return memory_category::vertex;
+	if (usage & (VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT)) return memory_category::storage;
+	if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT) return memory_category::uniform;
+	if (is_host_visible && (usage & VK_BUFFER_USAGE_TRANSFER_SRC_BIT)) return memory_category::staging;
+	if (is_host_visible && (usage & VK_BUFFER_USAGE_TRANSFER_DST_BIT)) return memory_category::readback;
+	return memory_category::other;
+}
+
+memory_category categorize_image(const VkImageUsageFlags usage) noexcept {
+	if (usage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT) return memory_category::depth;
+	return memory_category::image;
+}
+
+VkDeviceSize memory_report::total_bytes() const noexcept {
+	return std::accumulate(std::begin(categories), std::end(categories), VkDeviceSize{},
+		[] (const auto sum, const auto &category) { return sum + category.bytes; });
+}
+
+void memory_report::print() const {
+	std::printf("[engine][graphics][memory] %.2f MiB in device memory allocations\n", to_mebibytes(total_bytes()));
+	for (size_t i{}; i < std::size(categories); ++i) {
+		const auto &category{ categories[i] };
+		if (category.peak_bytes == 0) continue;
+		std::printf("[engine][graphics][memory]   %-8s %9.2f MiB in %4u allocations, peak %9.2f MiB\n",
+			std::data(to_string(static_cast<memory_category>(i))), to_mebibytes(category.bytes),
+			category.allocations, to_mebibytes(category.peak_bytes));
+	}
+	for (size_t i{}; i < std::size(heaps); ++i) {
+		const auto &heap{ heaps[i] };
+		const auto *kind{ (heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ? "device local" : "host" };
+		if (has_budget) {
+			std::printf("[engine][graphics][memory]   heap #%zu (%s, %.0f MiB): engine %.2f MiB, process %.2f MiB of a %.2f MiB budget\n",
+				i, kind, to_mebibytes(heap.size), to_mebibytes(heap.allocated), to_mebibytes(heap.usage), to_mebibytes(heap.budget));
+		} else {
+			std::printf("[engine][graphics][memory]   heap #%zu (%s, %.0f MiB): engine %.2f MiB\n",
+				i, kind, to_mebibytes(heap.size), to_mebibytes(heap.allocated));
+		}
+	}
+}
+
+void memory_tracker::allocated(const VkDeviceMemory memory, const VkDeviceSize size, const memory_category category,
+	const u32 heap) {
+	const std::lock_guard lock{ m_mutex };
+	m_allocations.emplace(memory, allocation{ .size = size, .category = category, .heap = heap });
+
+	auto &usage{ m_categories[static_cast<size_t>(category)] };
+	usage.bytes += size;
+	usage.peak_bytes = std::max(usage.peak_bytes, usage.bytes);
+	++usage.allocations;
+	m_heaps[heap] += size;
+}
+
+void memory_tracker::freed(const VkDeviceMemory memory) noexcept {
+	const std::lock_guard lock{ m_mutex };
+	const auto found{ m_allocations.find(memory) };
+	if (found == std::end(m_allocations)) return;
+
+	const auto &[size, category, heap]{ found->second };
+	auto &usage{ m_categories[static_cast<size_t>(category)] };
+	usage.bytes -= size;
+	--usage.allocations;
+	m_heaps[heap] -= size;
+	m_allocations.erase(found);
+}
+
+void memory_tracker::fill(memory_report &report) const {
+	const std::lock_guard lock{ m_mutex };
+	report.categories = m_categories;
+	for (size_t i{}; i < std::size(report.heaps); ++i) {
+		report.heaps[i].allocated = m_heaps[i];
+	}
+}
+
+} // namespace vc::engine::graphics
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <array>
+#include <mutex>
+#include <vector>
+#include <string_view>
+#include <unordered_map>
+
+#include <vulkan/vulkan.h>
+
+#include "core/types.hpp"
+
+namespace vc::engine::graphics {
+
+enum class memory_category : u8 {
+	vertex,
+	index,
+	uniform,
+	storage,   ///< Storage and indirect buffers
+	staging,   ///< Host visible transfer sources
+	readback,  ///< Host visible transfer destinations
+	image,
+	depth,
+	other,
+	count
+};
+
+[[nodiscard]] auto to_string(memory_category category) noexcept -> std::string_view;
+/// Derived from what the memory is created for, the first matching usage wins.
+[[nodiscard]] auto categorize_buffer(VkBufferUsageFlags usage, VkMemoryPropertyFlags properties) noexcept -> memory_category;
+[[nodiscard]] auto categorize_image(VkImageUsageFlags usage) noexcept -> memory_category;
+
+struct category_usage {
+	VkDeviceSize bytes      {};
+	VkDeviceSize peak_bytes {};
+	u32          allocations{};
+};
+
+struct heap_usage {
+	VkDeviceSize      size     {};
+	VkMemoryHeapFlags flags    {};
+	VkDeviceSize      allocated{};  ///< By the engine, through `device`
+	VkDeviceSize      usage    {};  ///< By the whole process as the driver reports it, 0 without a budget
+	VkDeviceSize      budget   {};  ///< What the process can allocate from the heap, 0 without a budget
+};
+
+struct memory_report {
+	std::array<category_usage, static_cast<size_t>(memory_category::count)> categories{};
+	std::vector<heap_usage> heaps;
+	b8                      has_budget{ false };  ///< `VK_EXT_memory_budget` filled `usage` and `budget`
+
+	[[nodiscard]] auto total_bytes() const noexcept -> VkDeviceSize;
+	void print() const;
+};
+
+/// Every `VkDeviceMemory` the device allocates, by category and heap. Thread safe, the
+/// allocations are rare compared to the lookups of a frame.
+class memory_tracker {
+public:
+	void allocated(VkDeviceMemory memory, VkDeviceSize size, memory_category category, u32 heap);
+	void freed(VkDeviceMemory memory) noexcept;
+
+	/// Fills the categories and the engine's part of each heap of `report`.
+	void fill(memory_report &report) const;
+
+private:
+	struct allocation {
+		VkDeviceSize    size    {};
+		memory_category category{};
+		u32             heap    {};
+	};
+
+	mutable std::mutex                                 m_mutex;
+	std::unordered_map<VkDeviceMemory, allocation>     m_allocations;
+	std::array<category_usage, static_cast<size_t>(memory_category::count)> m_categories{};
+	std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS>      m_heaps{};
+};
+
+} // namespace vc::engine::graphics
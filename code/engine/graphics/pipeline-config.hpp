@@ -71,8 +71,11 @@ struct pipeline_config {
 		.maxDepthBounds        = 1.0f
 	};
 	VkPipelineLayout layout     { VK_NULL_HANDLE };
-	VkRenderPass     render_pass{ VK_NULL_HANDLE };
+	VkRenderPass     render_pass{ VK_NULL_HANDLE };  ///< Null for dynamic rendering to the formats below
 	u32              sub_pass   { 0 };
+	b8               instanced  { false }; ///< Adds the per-instance transform vertex binding
+	VkFormat         color_format{ VK_FORMAT_UNDEFINED };
+	VkFormat         depth_format{ VK_FORMAT_UNDEFINED };
 };
 
 
@@ -0,0 +1,145 @@
+#include <span>
+#include <iterator>
+
+#include "core/hash.hpp"
+#include "engine/graphics/pipeline-registry.hpp"
+
+namespace vc::engine::graphics {
+
+std::shared_ptr<const shader_set> pipeline_registry::shaders(const std::string_view shader) {
+	if (const auto found{ m_shaders.find(shader) }; found != std::end(m_shaders)) {
+		return found->second;
+	}
+
+	auto shaders{ std::make_shared<const shader_set>(m_device, shader) };
+	m_shaders.emplace(intern(shader), shaders);
+	return shaders;
+}
+
+std::shared_ptr<pipeline> pipeline_registry::graphics(const std::string_view shader, const pipeline_config &config) {
+	pipeline_key key{
+		.shader      = shader,
+		.layout      = config.layout,
+		.render_pass = config.render_pass,
+		.state       = make_state(config)
+	};
+	if (const auto found{ m_pipelines.find(key) }; found != std::end(m_pipelines)) {
+		return found->second;
+	}
+
+	auto created{ std::make_shared<pipeline>(m_device, *shaders(shader), config) };
+	key.shader = intern(shader);
+	m_pipelines.emplace(key, created);
+	return created;
+}
+
+std::shared_ptr<compute_pipeline> pipeline_registry::compute(const std::string_view shader, const VkPipelineLayout layout) {
+	compute_key key{ .shader = shader, .layout = layout };
+	if (const auto found{ m_compute_pipelines.find(key) }; found != std::end(m_compute_pipelines)) {
+		return found->second;
+	}
+
+	auto created{ std::make_shared<compute_pipeline>(m_device, *shaders(shader), layout) };
+	key.shader = intern(shader);
+	m_compute_pipelines.emplace(key, created);
+	return created;
+}
+
+size_t pipeline_registry::trim() {
+	const auto is_unused{ [] (const auto &entry) { return entry.second.use_count() == 1; } };
+	return std::erase_if(m_pipelines, is_unused) + std::erase_if(m_compute_pipelines, is_unused)
+		+ std::erase_if(m_shaders, is_unused);
+}
+
+std::string_view pipeline_registry::intern(const std::string_view name) {
+	return *m_names.emplace(name).first;
+}
+
+pipeline_registry::pipeline_state pipeline_registry::make_state(const pipeline_config &config) {
+	const auto &assembly{ config.input_assembly_create_info };
+	const auto &rasterization{ config.rasterization_create_info };
+	const auto &multi_sample{ config.multi_sample_create_info };
+	const auto &blend{ config.color_attachment_state };
+	const auto &depth{ config.depth_stencil_create_info };
+
+	if (assembly.pNext != nullptr || rasterization.pNext != nullptr || multi_sample.pNext != nullptr
+		|| multi_sample.pSampleMask != nullptr || depth.pNext != nullptr) {
+		throw pipeline_error{ "Pipeline state extensions and sample masks aren't supported by the registry." };
+	}
+
+	const auto stencil_words{ [] (const VkStencilOpState &front, const VkStencilOpState &back) {
+		return std::array<u32, 14>{
+			front.failOp, front.passOp, front.depthFailOp, front.compareOp,
+			front.compareMask, front.writeMask, front.reference,
+			back.failOp, back.passOp, back.depthFailOp, back.compareOp,
+			back.compareMask, back.writeMask, back.reference
+		};
+	} };
+
+	// Adding zero turns -0.0 into 0.0, equal floats then hash the same
+	return pipeline_state{
+		.viewport_x          = config.viewport.x + 0.0f,
+		.viewport_y          = config.viewport.y + 0.0f,
+		.viewport_width      = config.viewport.width + 0.0f,
+		.viewport_height     = config.viewport.height + 0.0f,
+		.min_depth           = config.viewport.minDepth + 0.0f,
+		.max_depth           = config.viewport.maxDepth + 0.0f,
+		.scissor_x           = config.scissor.offset.x,
+		.scissor_y           = config.scissor.offset.y,
+		.scissor_width       = config.scissor.extent.width,
+		.scissor_height      = config.scissor.extent.height,
+		.topology            = assembly.topology,
+		.primitive_restart   = assembly.primitiveRestartEnable,
+		.depth_clamp         = rasterization.depthClampEnable,
+		.rasterizer_discard  = rasterization.rasterizerDiscardEnable,
+		.polygon_mode        = rasterization.polygonMode,
+		.cull_mode           = rasterization.cullMode,
+		.front_face          = rasterization.frontFace,
+		.depth_bias          = rasterization.depthBiasEnable,
+		.depth_bias_constant = rasterization.depthBiasConstantFactor + 0.0f,
+		.depth_bias_clamp    = rasterization.depthBiasClamp + 0.0f,
+		.depth_bias_slope    = rasterization.depthBiasSlopeFactor + 0.0f,
+		.line_width          = rasterization.lineWidth + 0.0f,
+		.samples             = multi_sample.rasterizationSamples,
+		.sample_shading      = multi_sample.sampleShadingEnable,
+		.min_sample_shading  = multi_sample.minSampleShading + 0.0f,
+		.alpha_to_coverage   = multi_sample.alphaToCoverageEnable,
+		.alpha_to_one        = multi_sample.alphaToOneEnable,
+		.blend               = blend.blendEnable,
+		.src_color_factor    = blend.srcColorBlendFactor,
+		.dst_color_factor    = blend.dstColorBlendFactor,
+		.color_op            = blend.colorBlendOp,
+		.src_alpha_factor    = blend.srcAlphaBlendFactor,
+		.dst_alpha_factor    = blend.dstAlphaBlendFactor,
+		.alpha_op            = blend.alphaBlendOp,
+		.write_mask          = blend.colorWriteMask,
+		.depth_test          = depth.depthTestEnable,
+		.depth_write         = depth.depthWriteEnable,
+		.depth_compare       = depth.depthCompareOp,
+		.depth_bounds_test   = depth.depthBoundsTestEnable,
+		.stencil_test        = depth.stencilTestEnable,
+		.stencil             = stencil_words(depth.front, depth.back),
+		.min_depth_bounds    = depth.minDepthBounds + 0.0f,
+		.max_depth_bounds    = depth.maxDepthBounds + 0.0f,
+		.sub_pass            = config.sub_pass,
+		.instanced           = config.instanced ? 1u : 0u,
+		.color_format        = config.color_format,
+		.depth_format        = config.depth_format
+	};
+}
+
+size_t pipeline_registry::key_hash::operator()(const pipeline_key &key) const noexcept {
+	// The state has no padding, so its bytes are its value
+	auto hash{ core::fnv1a(std::as_bytes(std::span{ key.shader })) };
+	hash = core::hash_combine(hash, core::hash_bytes(key.layout));
+	hash = core::hash_combine(hash, core::hash_bytes(key.render_pass));
+	hash = core::hash_combine(hash, core::hash_bytes(key.state));
+	return static_cast<size_t>(hash);
+}
+
+size_t pipeline_registry::key_hash::operator()(const compute_key &key) const noexcept {
+	const auto hash{ core::fnv1a(std::as_bytes(std::span{ key.shader })) };
+	return static_cast<size_t>(core::hash_combine(hash, core::hash_bytes(key.layout)));
+}
+
+} // namespace vc::engine::graphics
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <string>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "engine/graphics/device.hpp"
+#include "engine/graphics/pipeline.hpp"
+
+namespace vc::engine::graphics {
+
+/// Shares shaders and pipelines between their users: a shader is read and turned into modules
+/// once per name, a pipeline is created once per shader and state. A repeated lookup is a single
+/// probe of a map. The registry references everything it made, `trim` releases the entries
+/// nobody else references anymore.
+class pipeline_registry {
+public:
+	explicit pipeline_registry(device &device) noexcept : m_device{ device } {}
+
+	pipeline_registry(const pipeline_registry &) = delete;
+	pipeline_registry &operator=(const pipeline_registry &) = delete;
+
+	[[nodiscard]] auto shaders(std::string_view shader) -> std::shared_ptr<const shader_set>;
+	/// Extension structures and sample masks aren't supported, their pointers must be null.
+	[[nodiscard]] auto graphics(std::string_view shader, const pipeline_config &config) -> std::shared_ptr<pipeline>;
+	[[nodiscard]] auto compute(std::string_view shader, VkPipelineLayout layout) -> std::shared_ptr<compute_pipeline>;
+
+	/// Releases the shaders and pipelines only the registry references, returns how many.
+	auto trim() -> size_t;
+	[[nodiscard]] auto size() const noexcept {
+		return std::size(m_shaders) + std::size(m_pipelines) + std::size(m_compute_pipelines);
+	}
+
+private:
+	/// The fixed function state of a `pipeline_config`, all 4 bytes wide so there is no padding.
+	struct pipeline_state {
+		f32                   viewport_x;
+		f32                   viewport_y;
+		f32                   viewport_width;
+		f32                   viewport_height;
+		f32                   min_depth;
+		f32                   max_depth;
+		i32                   scissor_x;
+		i32                   scissor_y;
+		u32                   scissor_width;
+		u32                   scissor_height;
+		VkPrimitiveTopology   topology;
+		VkBool32              primitive_restart;
+		VkBool32              depth_clamp;
+		VkBool32              rasterizer_discard;
+		VkPolygonMode         polygon_mode;
+		VkCullModeFlags       cull_mode;
+		VkFrontFace           front_face;
+		VkBool32              depth_bias;
+		f32                   depth_bias_constant;
+		f32                   depth_bias_clamp;
+		f32                   depth_bias_slope;
+		f32                   line_width;
+		VkSampleCountFlagBits samples;
+		VkBool32              sample_shading;
+		f32                   min_sample_shading;
+		VkBool32              alpha_to_coverage;
+		VkBool32              alpha_to_one;
+		VkBool32              blend;
+		VkBlendFactor         src_color_factor;
+		VkBlendFactor         dst_color_factor;
+		VkBlendOp             color_op;
+		VkBlendFactor         src_alpha_factor;
+		VkBlendFactor         dst_alpha_factor;
+		VkBlendOp             alpha_op;
+		VkColorComponentFlags write_mask;
+		VkBool32              depth_test;
+		VkBool32              depth_write;
+		VkCompareOp           depth_compare;
+		VkBool32              depth_bounds_test;
+		VkBool32              stencil_test;
+		std::array<u32, 14>   stencil;  ///< Front and back operations
+		f32                   min_depth_bounds;
+		f32                   max_depth_bounds;
+		u32                   sub_pass;
+		u32                   instanced;
+		VkFormat              color_format;
+		VkFormat              depth_format;
+
+		[[nodiscard]] bool operator==(const pipeline_state &other) const noexcept = default;
+	};
+
+	/// The names point into `m_names` once a key is stored, a lookup uses the caller's view.
+	struct pipeline_key {
+		std::string_view shader;
+		VkPipelineLayout layout;
+		VkRenderPass     render_pass;
+		pipeline_state   state;
+
+		[[nodiscard]] bool operator==(const pipeline_key &other) const noexcept = default;
+	};
+
+	struct compute_key {
+		std::string_view shader;
+		VkPipelineLayout layout;
+
+		[[nodiscard]] bool operator==(const compute_key &other) const noexcept = default;
+	};
+
+	struct key_hash {
+		[[nodiscard]] auto operator()(const pipeline_key &key) const noexcept -> size_t;
+		[[nodiscard]] auto operator()(const compute_key &key) const noexcept -> size_t;
+	};
+
+	device                                                                  &m_device;
+	std::unordered_set<std::string>                                         m_names;
+	std::unordered_map<std::string_view, std::shared_ptr<const shader_set>> m_shaders;
+	std::unordered_map<pipeline_key, std::shared_ptr<pipeline>, key_hash>   m_pipelines;
+	std::unordered_map<compute_key, std::shared_ptr<compute_pipeline>, key_hash> m_compute_pipelines;
+
+	[[nodiscard]] auto intern(std::string_view name) -> std::string_view;
+	[[nodiscard]] static auto make_state(const pipeline_config &config) -> pipeline_state;
+};
+
+} // namespace vc::engine::graphics
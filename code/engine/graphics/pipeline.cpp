@@ -1,28 +1,104 @@
+#include <array>
 #include <cassert>
+#include <cstddef>
 #include <fstream>
+#include <iterator>
 #include <algorithm>
+#include <memory_resource>
 
 #include <fmt/core.h>
 
 #include "engine/resources/model.hpp"
+#include "engine/graphics/device.hpp"
 #include "engine/graphics/pipeline.hpp"
 
 namespace vc::engine::graphics {
 
+#pragma region shader_set
+
+shader_set::shader_set(device &dev, const std::string_view shader)
+	: m_device{ dev }, m_name{ shader } {
+	m_count = load();
+	if (m_count == 0) {
+		throw pipeline_error{ fmt::format(R"(Cannot find any shader file of "{}")", shader) };
+	}
+}
+
+shader_set::~shader_set() {
+	const auto device{ m_device.handle() };
+	for (const auto &[_, shader_module] : m_modules) {
+		if (shader_module != nullptr) {
+			vkDestroyShaderModule(device, shader_module, m_device.allocator());
+		}
+	}
+}
+
+size_t shader_set::load() {
+	const auto name_length{ std::size(m_name) };
+
+	std::string filename(
+		name_length + constants::shader_file_extention_size +
+		std::size(constants::compiled_shader_file_extension) - 1, '\0'
+	);
+	std::copy_n(std::begin(m_name), name_length, std::begin(filename));
+	std::copy_n(std::rbegin(constants::compiled_shader_file_extension),
+		std::size(constants::compiled_shader_file_extension), std::rbegin(filename));
+
+	size_t loaded_counter{};
+	std::vector<char> content(constants::content_buffer_initial_size);
+	for (const auto &[type, extension] : constants::shader_extensions) {
+		std::copy_n(std::begin(extension), std::size(extension),
+			std::next(std::begin(filename), name_length));
+
+		if (load_file_to(content, filename)) {
+			m_modules.insert_or_assign(type, make_module(filename, content));
+			++loaded_counter;
+		}
+	}
+	return loaded_counter;
+}
+
+VkShaderModule shader_set::make_module(const std::string_view filename, const std::vector<char> &code) {
+	const VkShaderModuleCreateInfo create_info{
+		.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
+		.codeSize = static_cast<u32>(std::size(code)),
+		.pCode    = reinterpret_cast<const u32 *>(std::data(code))
+	};
+
+	VkShaderModule shader;
+	if (VK_SUCCESS != vkCreateShaderModule(m_device.handle(), &create_info, m_device.allocator(), &shader)) {
+		throw pipeline_error{ fmt::format(
+			R"(Failed to create shader module from "{}" file.)", filename
+		) };
+	}
+	return shader;
+}
+
+bool shader_set::load_file_to(std::vector<char> &buffer, const std::string_view filename) {
+	if (std::ifstream file{ std::data(filename), std::ios::ate | std::ios::binary }; file.is_open()) {
+		buffer.resize(static_cast<size_t>(file.tellg()));
+		file.seekg(std::ios::beg);
+		file.read(std::data(buffer), std::size(buffer));
+		return std::size(buffer) > 0;
+	}
+	return false;
+}
+
+#pragma endregion shader_set
+
 #pragma region pipeline
 
 pipeline::pipeline(device &dev, const std::string_view shader, const pipeline_config &config)
+	: pipeline{ dev, shader_set{ dev, shader }, config } {
+}
+
+pipeline::pipeline(device &dev, const shader_set &shaders, const pipeline_config &config)
 	: m_device{ dev } {
 
 	assert(config.layout != VK_NULL_HANDLE
 		&& "at pipeline constructor: The config should provide a pipeline `layout`, but it's null");
-	assert(config.render_pass != VK_NULL_HANDLE
-		&& "at pipeline constructor: The config should provide a `render_pass`, but it's null");
-
-	const auto shaders_count{ load_shaders(shader) };
-	if (shaders_count == 0) {
-		throw pipeline_error{ fmt::format(R"(Cannot find any shader file of "{}")", shader) };
-	}
+	assert((config.render_pass != VK_NULL_HANDLE || config.color_format != VK_FORMAT_UNDEFINED)
+		&& "at pipeline constructor: The config should provide a `render_pass` or a `color_format`, but both are null");
 
 	static constexpr auto to_vk{ [](const auto type) {
 		switch (type) {
@@ -38,10 +114,14 @@ pipeline::pipeline(device &dev, const std::string_view shader, const pipeline_co
 		return VkShaderStageFlagBits{};
 	} };
 
-	std::vector<VkPipelineShaderStageCreateInfo> stages;
-	stages.reserve(shaders_count);
+	// The stages and the vertex layout are only read by vkCreateGraphicsPipelines
+	std::array<std::byte, 2048> scratch_buffer;
+	std::pmr::monotonic_buffer_resource scratch{ std::data(scratch_buffer), std::size(scratch_buffer) };
+
+	std::pmr::vector<VkPipelineShaderStageCreateInfo> stages{ &scratch };
+	stages.reserve(shaders.size());
 
-	for (const auto &[type, shader_module] : m_shaders) {
+	for (const auto &[type, shader_module] : shaders.modules()) {
 		if (shader_module == nullptr) continue;
 
 		stages.emplace_back(
@@ -55,8 +135,16 @@ pipeline::pipeline(device &dev, const std::string_view shader, const pipeline_co
 		);
 	}
 
-	const auto vertex_binding_descriptions{ resources::model::vertex::binding_description() };
-	const auto vertex_attribute_descriptions{ resources::model::vertex::attribute_description() };
+	using resources::model;
+
+	std::pmr::vector<VkVertexInputBindingDescription> vertex_binding_descriptions{ &scratch };
+	std::pmr::vector<VkVertexInputAttributeDescription> vertex_attribute_descriptions{ &scratch };
+	std::ranges::copy(model::vertex::binding_description(), std::back_inserter(vertex_binding_descriptions));
+	std::ranges::copy(model::vertex::attribute_description(), std::back_inserter(vertex_attribute_descriptions));
+	if (config.instanced) {
+		vertex_binding_descriptions.push_back(model::instance::binding_description());
+		std::ranges::copy(model::instance::attribute_description(), std::back_inserter(vertex_attribute_descriptions));
+	}
 
 	const VkPipelineVertexInputStateCreateInfo vertex_input_create_info{
 		.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
@@ -81,8 +169,18 @@ pipeline::pipeline(device &dev, const std::string_view shader, const pipeline_co
 		.blendConstants  = { 0.0f, 0.0f, 0.0f, 0.0f }
 	};
 
+	// Without a render pass the attachment formats are given instead
+	const VkPipelineRenderingCreateInfo rendering_info{
+		.sType                   = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+		.colorAttachmentCount    = 1,
+		.pColorAttachmentFormats = &config.color_format,
+		.depthAttachmentFormat   = config.depth_format,
+		.stencilAttachmentFormat = VK_FORMAT_UNDEFINED
+	};
+
 	const VkGraphicsPipelineCreateInfo pipeline_info{
 		.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
+		.pNext               = config.render_pass == VK_NULL_HANDLE ? &rendering_info : nullptr,
 		.stageCount          = static_cast<u32>(std::size(stages)),
 		.pStages             = std::data(stages),
 		.pVertexInputState   = &vertex_input_create_info,
@@ -106,7 +204,7 @@ pipeline::pipeline(device &dev, const std::string_view shader, const pipeline_co
 		VK_NULL_HANDLE,
 		1,
 		&pipeline_info,
-		nullptr,
+		m_device.allocator(),
 		&m_pipeline
 	) };
 
@@ -116,72 +214,55 @@ pipeline::pipeline(device &dev, const std::string_view shader, const pipeline_co
 }
 
 pipeline::~pipeline() {
-	const auto device{ m_device.handle() };
-	for (const auto &[_, shader_module] : m_shaders) {
-		if (shader_module != nullptr) {
-			vkDestroyShaderModule(device, shader_module, nullptr);
-		}
-	}
-
-	vkDestroyPipeline(device, m_pipeline, nullptr);
+	m_device.deletions().push(m_pipeline);
 }
 
 void pipeline::bind(VkCommandBuffer buffer, const VkPipelineBindPoint bind_point) {
 	vkCmdBindPipeline(buffer, bind_point, m_pipeline);
 }
 
-size_t pipeline::load_shaders(const std::string_view shader) {
-	const auto name_length{ std::size(shader) };
+#pragma endregion pipeline
 
-	std::string filename(
-		name_length + constants::shader_file_extention_size +
-		std::size(constants::compiled_shader_file_extension) - 1, '\0'
-	);
-	std::copy_n(std::begin(shader), name_length, std::begin(filename));
-	std::copy_n(std::rbegin(constants::compiled_shader_file_extension),
-		std::size(constants::compiled_shader_file_extension), std::rbegin(filename));
+#pragma region compute_pipeline
 
-	size_t loaded_counter{};
-	std::vector<char> content(constants::content_buffer_initial_size);
-	for (const auto &[type, extension] : constants::shader_extensions) {
-		std::copy_n(std::begin(extension), std::size(extension),
-			std::next(std::begin(filename), name_length));
+compute_pipeline::compute_pipeline(device &dev, const std::string_view shader, const VkPipelineLayout layout)
+	: compute_pipeline{ dev, shader_set{ dev, shader }, layout } {
+}
 
-		if (load_file_to(content, filename)) {
-			m_shaders.insert_or_assign(type, make_shader(filename, content));
-			++loaded_counter;
-		}
+compute_pipeline::compute_pipeline(device &dev, const shader_set &shaders, const VkPipelineLayout layout)
+	: m_device{ dev } {
+	const auto shader_module{ shaders.module(shader_type::compute) };
+	if (shader_module == nullptr) {
+		throw pipeline_error{ fmt::format(R"(Cannot find the compute shader of "{}")", shaders.name()) };
 	}
-	return loaded_counter;
-}
 
-VkShaderModule pipeline::make_shader(const std::string_view filename, const std::vector<char> &code) {
-	const VkShaderModuleCreateInfo create_info{
-		.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
-		.codeSize = static_cast<u32>(std::size(code)),
-		.pCode    = reinterpret_cast<const u32 *>(std::data(code))
+	const VkComputePipelineCreateInfo pipeline_info{
+		.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO,
+		.stage = VkPipelineShaderStageCreateInfo{
+			.sType  = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+			.stage  = VK_SHADER_STAGE_COMPUTE_BIT,
+			.module = shader_module,
+			.pName  = std::data(constants::shader_stage_entry_point)
+		},
+		.layout             = layout,
+		.basePipelineHandle = VK_NULL_HANDLE,
+		.basePipelineIndex  = -1
 	};
 
-	VkShaderModule shader;
-	if (VK_SUCCESS != vkCreateShaderModule(m_device.handle(), &create_info, nullptr, &shader)) {
-		throw pipeline_error{ fmt::format(
-			R"(Failed to create shader module from "%s" file.)", filename
-		) };
+	if (VK_SUCCESS != vkCreateComputePipelines(m_device.handle(), VK_NULL_HANDLE, 1, &pipeline_info, m_device.allocator(), &m_pipeline)) {
+		throw pipeline_error{ "Cannot create compute pipeline." };
 	}
-	return shader;
 }
 
-bool pipeline::load_file_to(std::vector<char> &buffer, const std::string_view filename) {
-	if (std::ifstream file{ std::data(filename), std::ios::ate | std::ios::binary }; file.is_open()) {
-		buffer.resize(static_cast<size_t>(file.tellg()));
-		file.seekg(std::ios::beg);
-		file.read(std::data(buffer), std::size(buffer));
-		return std::size(buffer) > 0;
-	}
-	return false;
+compute_pipeline::~compute_pipeline() {
+	m_device.deletions().push(m_pipeline);
 }
 
-#pragma endregion pipeline
+void compute_pipeline::bind(VkCommandBuffer buffer) {
+	vkCmdBindPipeline(buffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline);
+}
+
+#pragma endregion compute_pipeline
 
 #pragma region pipeline_layout
 
@@ -197,13 +278,13 @@ pipeline_layout::pipeline_layout(device &dev,
 		.pPushConstantRanges    = std::data(constant_ranges)
 	};
 
-	if (VK_SUCCESS != vkCreatePipelineLayout(m_device.handle(), &layout_info, nullptr, &m_layout)) {
+	if (VK_SUCCESS != vkCreatePipelineLayout(m_device.handle(), &layout_info, m_device.allocator(), &m_layout)) {
 		throw pipeline_error{ "Failed to create pipeline layout." };
 	}
 }
 
 pipeline_layout::~pipeline_layout() {
-	vkDestroyPipelineLayout(m_device.handle(), m_layout, nullptr);
+	m_device.deletions().push(m_layout);
 }
 
 #pragma endregion pipeline_layout
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <span>
+#include <string>
 #include <vector>
 #include <exception>
 #include <stdexcept>
@@ -47,19 +48,29 @@ static const std::unordered_map<shader_type, std::string_view> shader_extensions
 
 } // namespace constants
 
-class pipeline {
+/// The compiled stages of a shader, every `<shader>.<stage>.spv` file found. The modules are only
+/// read while pipelines are created, a set can be shared by any number of them.
+class shader_set {
 public:
-	explicit pipeline(device &device, std::string_view shader, const pipeline_config &config);
-	~pipeline();
+	/// Throws when there is no stage of the `shader`.
+	explicit shader_set(device &device, std::string_view shader);
+	~shader_set();
 
-	pipeline(const pipeline &) = delete;
-	pipeline &operator=(const pipeline &) = delete;
+	shader_set(const shader_set &) = delete;
+	shader_set &operator=(const shader_set &) = delete;
 
-	void bind(VkCommandBuffer buffer, VkPipelineBindPoint bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS);
+	[[nodiscard]] auto name() const noexcept -> std::string_view { return m_name; }
+	/// Null when the stage has no file.
+	[[nodiscard]] auto module(const shader_type type) const -> VkShaderModule { return m_modules.at(type); }
+	[[nodiscard]] auto modules() const noexcept -> const std::unordered_map<shader_type, VkShaderModule> & { return m_modules; }
+	[[nodiscard]] auto size() const noexcept { return m_count; }
+
+	static bool load_file_to(std::vector<char> &buffer, std::string_view filename);
 
 private:
-	device &m_device;
-	std::unordered_map<shader_type, VkShaderModule> m_shaders{
+	device     &m_device;
+	std::string m_name;
+	std::unordered_map<shader_type, VkShaderModule> m_modules{
 		{ shader_type::vertex,                   nullptr },
 		{ shader_type::fragment,                 nullptr },
 		{ shader_type::geometry,                 nullptr },
@@ -67,14 +78,45 @@ private:
 		{ shader_type::tessellation_evaluation,  nullptr },
 		{ shader_type::compute,                  nullptr },
 	};
-	VkPipeline m_pipeline{ VK_NULL_HANDLE };
+	size_t      m_count{};
 
-	auto load_shaders(const std::string_view shader) -> size_t;
-	auto make_shader(const std::string_view filename, const std::vector<char> &code)
+	auto load() -> size_t;
+	auto make_module(const std::string_view filename, const std::vector<char> &code)
 		-> VkShaderModule;
+};
 
-	static bool load_file_to(std::vector<char> &buffer, std::string_view filename);
+class pipeline {
+public:
+	/// Loads the shader for this pipeline alone, see `pipeline_registry` to share it.
+	explicit pipeline(device &device, std::string_view shader, const pipeline_config &config);
+	explicit pipeline(device &device, const shader_set &shaders, const pipeline_config &config);
+	~pipeline();
 
+	pipeline(const pipeline &) = delete;
+	pipeline &operator=(const pipeline &) = delete;
+
+	void bind(VkCommandBuffer buffer, VkPipelineBindPoint bind_point = VK_PIPELINE_BIND_POINT_GRAPHICS);
+
+private:
+	device &m_device;
+	VkPipeline m_pipeline{ VK_NULL_HANDLE };
+};
+
+/// A single `.comp` shader, looked up the same way as the stages of a graphics `pipeline`.
+class compute_pipeline {
+public:
+	explicit compute_pipeline(device &device, std::string_view shader, VkPipelineLayout layout);
+	explicit compute_pipeline(device &device, const shader_set &shaders, VkPipelineLayout layout);
+	~compute_pipeline();
+
+	compute_pipeline(const compute_pipeline &) = delete;
+	compute_pipeline &operator=(const compute_pipeline &) = delete;
+
+	void bind(VkCommandBuffer buffer);
+
+private:
+	device    &m_device;
+	VkPipeline m_pipeline{ VK_NULL_HANDLE };
 };
 
 class pipeline_layout {
@@ -0,0 +1,797 @@
+#include <cstdio>
+#include <algorithm>
+
+#include <fmt/core.h>
+
+#include "engine/graphics/render-graph.hpp"
+#include "engine/graphics/device.hpp"
+
+namespace vc::engine::graphics {
+
+namespace {
+
+/// What an access of a usage synchronizes with, the first 32 bits of the synchronization2 flags
+/// are the original ones.
+struct usage_state {
+	VkPipelineStageFlags2 stages      { VK_PIPELINE_STAGE_2_NONE };
+	VkAccessFlags2        read_access { VK_ACCESS_2_NONE };
+	VkAccessFlags2        write_access{ VK_ACCESS_2_NONE };
+	VkImageLayout         layout      { VK_IMAGE_LAYOUT_UNDEFINED };
+	VkImageUsageFlags     usage       {};
+};
+
+[[nodiscard]] auto state_of(const image_usage usage) noexcept -> usage_state {
+	switch (usage) {
+	case image_usage::color_attachment:
+		return { VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT,
+			VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT,
+			VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT };
+	case image_usage::depth_attachment:
+		return { VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT,
+			VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+			VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT };
+	case image_usage::sampled:
+		return { VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT, VK_ACCESS_2_NONE,
+			VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT };
+	case image_usage::storage:
+		return { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_READ_BIT, VK_ACCESS_2_SHADER_WRITE_BIT,
+			VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT };
+	case image_usage::transfer_source:
+		return { VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_ACCESS_2_NONE,
+			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT };
+	case image_usage::transfer_destination:
+		return { VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_NONE, VK_ACCESS_2_TRANSFER_WRITE_BIT,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT };
+	case image_usage::present:
+		// Presentation waits on a semaphore, the transition has nothing to wait for
+		return { VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, 0 };
+	case image_usage::none:
+		break;
+	}
+	return {};
+}
+
+[[nodiscard]] auto aspect_of(const VkFormat format) noexcept -> VkImageAspectFlags {
+	switch (format) {
+	case VK_FORMAT_D16_UNORM:
+	case VK_FORMAT_D32_SFLOAT:
+		return VK_IMAGE_ASPECT_DEPTH_BIT;
+	case VK_FORMAT_D24_UNORM_S8_UINT:
+	case VK_FORMAT_D32_SFLOAT_S8_UINT:
+		return VK_IMAGE_ASPECT_DEPTH_BIT | VK_IMAGE_ASPECT_STENCIL_BIT;
+	default:
+		return VK_IMAGE_ASPECT_COLOR_BIT;
+	}
+}
+
+/// Stages of the acquire semaphore wait, see `swap_chain::submit`.
+constexpr VkPipelineStageFlags2 import_stages{ VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT };
+
+constexpr VkImageUsageFlags attachment_usages{
+	VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT
+};
+
+} // anonymous namespace
+
+#pragma region pass
+
+auto render_graph::pass::color(const handle image, const std::optional<VkClearColorValue> clear) -> pass & {
+	if (std::size(m_colors) + 1 >= constants::max_pass_attachments) {
+		throw render_graph_error{ fmt::format("Pass '{}' has too many color attachments.", m_name) };
+	}
+	m_colors.push_back(attach(image, image_usage::color_attachment,
+		clear.has_value() ? std::optional{ VkClearValue{ .color = *clear } } : std::nullopt));
+	return *this;
+}
+
+auto render_graph::pass::depth(const handle image, const std::optional<VkClearDepthStencilValue> clear) -> pass & {
+	if (m_depth.has_value()) {
+		throw render_graph_error{ fmt::format("Pass '{}' already has a depth attachment.", m_name) };
+	}
+	m_depth = attach(image, image_usage::depth_attachment,
+		clear.has_value() ? std::optional{ VkClearValue{ .depthStencil = *clear } } : std::nullopt);
+	return *this;
+}
+
+auto render_graph::pass::read(const handle image, const image_usage usage) -> pass & {
+	return add_access(image, usage, true, false);
+}
+
+auto render_graph::pass::write(const handle image, const image_usage usage) -> pass & {
+	// Storage writes may read what they do not overwrite
+	return add_access(image, usage, usage == image_usage::storage, true);
+}
+
+auto render_graph::pass::record(record_function function) -> pass & {
+	m_record = std::move(function);
+	return *this;
+}
+
+auto render_graph::pass::side_effect() -> pass & {
+	m_side_effect = true;
+	return *this;
+}
+
+auto render_graph::pass::add_access(const handle image, const image_usage usage, const b8 reads, const b8 writes) -> pass & {
+	const auto existing{ std::ranges::find(m_accesses, image, &access::image) };
+	if (existing == std::end(m_accesses)) {
+		m_accesses.push_back(access{ .image = image, .usage = usage, .reads = reads, .writes = writes });
+		return *this;
+	}
+	// One layout per image and pass
+	if (existing->usage != usage) {
+		throw render_graph_error{ fmt::format("Pass '{}' uses image #{} in two ways.", m_name, image) };
+	}
+	existing->reads  = existing->reads || reads;
+	existing->writes = existing->writes || writes;
+	return *this;
+}
+
+auto render_graph::pass::attach(const handle image, const image_usage usage,
+	const std::optional<VkClearValue> clear) -> attachment {
+	if (m_type != pass_type::graphics) {
+		throw render_graph_error{ fmt::format("Pass '{}' has no attachments, it is not a graphics pass.", m_name) };
+	}
+	add_access(image, usage, !clear.has_value(), true);
+	return attachment{
+		.image = image,
+		.load  = clear.has_value() ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD,
+		.clear = clear.value_or(VkClearValue{})
+	};
+}
+
+#pragma endregion
+
+render_graph::render_graph(device &device, const u32 frames_in_flight)
+	: m_device{ device }, m_frames_in_flight{ frames_in_flight }, m_frames(frames_in_flight) {}
+
+render_graph::~render_graph() {
+	auto &deletions{ m_device.deletions() };
+	for (const auto &current : m_passes) {
+		for (const auto &cached : current.m_framebuffers) {
+			deletions.push(cached.handle);
+		}
+		deletions.push(current.m_render_pass);
+	}
+	for (const auto &frame : m_frames) {
+		for (const auto view : frame.views) {
+			deletions.push(view);
+		}
+		for (const auto image : frame.images) {
+			deletions.push(image);
+		}
+		for (const auto memory : frame.memory) {
+			deletions.push(memory);
+		}
+	}
+}
+
+render_graph::handle render_graph::import_image(const std::string_view name, const VkFormat format,
+	const VkExtent2D extent, const image_usage final_usage) {
+	if (m_compiled) {
+		throw render_graph_error{ fmt::format("Cannot import '{}', the graph is compiled.", name) };
+	}
+	m_resources.push_back(resource{
+		.name        = std::string{ name },
+		.format      = format,
+		.extent      = extent,
+		.aspect      = aspect_of(format),
+		.imported    = true,
+		.final_usage = final_usage
+	});
+	return static_cast<handle>(std::size(m_resources) - 1);
+}
+
+render_graph::handle render_graph::create_image(const std::string_view name, const VkFormat format,
+	const VkExtent2D extent) {
+	if (m_compiled) {
+		throw render_graph_error{ fmt::format("Cannot create '{}', the graph is compiled.", name) };
+	}
+	m_resources.push_back(resource{
+		.name   = std::string{ name },
+		.format = format,
+		.extent = extent,
+		.aspect = aspect_of(format)
+	});
+	return static_cast<handle>(std::size(m_resources) - 1);
+}
+
+render_graph::pass &render_graph::add_pass(const std::string_view name, const pass_type type) {
+	if (m_compiled) {
+		throw render_graph_error{ fmt::format("Cannot add pass '{}', the graph is compiled.", name) };
+	}
+	return m_passes.emplace_back(pass{ name, type });
+}
+
+void render_graph::compile() {
+	if (m_compiled) {
+		throw render_graph_error{ "The render graph is already compiled." };
+	}
+	for (const auto &current : m_passes) {
+		for (const auto &access : current.m_accesses) {
+			if (access.image >= std::size(m_resources)) {
+				throw render_graph_error{ fmt::format("Pass '{}' uses the unknown image #{}.", current.m_name, access.image) };
+			}
+		}
+		if (current.m_type == pass_type::graphics && std::empty(current.m_colors) && !current.m_depth.has_value()) {
+			throw render_graph_error{ fmt::format("Graphics pass '{}' has no attachments.", current.m_name) };
+		}
+	}
+
+	cull_passes();
+	compute_lifetimes();
+	construct_transient_images();
+	compute_barriers();
+	compute_attachment_ops();
+	if (!m_device.has_dynamic_rendering()) {
+		construct_render_passes();
+	}
+	m_compiled = true;
+
+	const auto culled{ std::ranges::count_if(m_passes, &pass::m_culled) };
+	auto barriers{ std::size(m_final_barriers) };
+	for (const auto &current : m_passes) {
+		barriers += std::size(current.m_barriers);
+	}
+	std::printf("[engine][graphics][render_graph] %zu passes (%zu culled), %zu barriers per frame, "
+		"%.2f MiB of transient images in %.2f MiB per frame slot\n",
+		std::size(m_passes), static_cast<size_t>(culled), barriers,
+		static_cast<f64>(m_transient_bytes) / (1024.0 * 1024.0), static_cast<f64>(m_allocated_bytes) / (1024.0 * 1024.0));
+}
+
+void render_graph::bind(const handle image, const VkImage vk_image, const VkImageView view) {
+	auto &resource{ m_resources.at(image) };
+	if (!resource.imported) {
+		throw render_graph_error{ fmt::format("Image '{}' is not imported, the graph owns it.", resource.name) };
+	}
+	resource.image = vk_image;
+	resource.view  = view;
+}
+
+void render_graph::execute(VkCommandBuffer command_buffer, const u32 frame_slot) {
+	if (!m_compiled) {
+		throw render_graph_error{ "The render graph must be compiled before it is executed." };
+	}
+	for (auto &current : m_passes) {
+		if (current.m_culled) continue;
+
+		record_barriers(command_buffer, current.m_barriers, frame_slot);
+		if (current.m_type == pass_type::graphics) {
+			begin_pass(command_buffer, current, frame_slot);
+		}
+		if (current.m_record) {
+			current.m_record(command_buffer);
+		}
+		if (current.m_type == pass_type::graphics) {
+			end_pass(command_buffer);
+		}
+	}
+	record_barriers(command_buffer, m_final_barriers, frame_slot);
+}
+
+const render_graph::pass &render_graph::find_pass(const std::string_view name) const {
+	const auto found{ std::ranges::find(m_passes, name, &pass::m_name) };
+	if (found == std::end(m_passes)) {
+		throw render_graph_error{ fmt::format("There is no pass '{}'.", name) };
+	}
+	return *found;
+}
+
+#pragma region compile methods
+
+void render_graph::cull_passes() {
+	// Walks back from the imported images and the side effects. A pass that overwrites an image
+	// without reading it ends the demand for the earlier writers.
+	std::vector<b8> needed(std::size(m_resources));
+	for (size_t i{}; i < std::size(m_resources); ++i) {
+		needed[i] = m_resources[i].imported;
+	}
+
+	for (auto current{ std::rbegin(m_passes) }; current != std::rend(m_passes); ++current) {
+		current->m_culled = !current->m_side_effect && std::ranges::none_of(current->m_accesses,
+			[&needed] (const pass::access &access) { return access.writes && needed[access.image]; });
+		if (current->m_culled) continue;
+
+		for (const auto &access : current->m_accesses) {
+			if (access.writes && !access.reads) {
+				needed[access.image] = false;
+			}
+		}
+		for (const auto &access : current->m_accesses) {
+			if (access.reads) {
+				needed[access.image] = true;
+			}
+		}
+	}
+}
+
+void render_graph::compute_lifetimes() {
+	for (u32 i{}; i < std::size(m_passes); ++i) {
+		if (m_passes[i].m_culled) continue;
+
+		for (const auto &access : m_passes[i].m_accesses) {
+			auto &resource{ m_resources[access.image] };
+			resource.first_pass = resource.first_pass.value_or(i);
+			resource.last_pass  = i;
+			resource.usage     |= state_of(access.usage).usage;
+		}
+	}
+}
+
+void render_graph::construct_transient_images() {
+	struct block {
+		handle          occupant{};         ///< Latest image in the block
+		u32             memory_types{};
+		b8              lazy{ false };      ///< Only attachments, the memory may stay unbacked
+		memory_category category{ memory_category::image };
+		std::vector<VkDeviceSize> sizes;    ///< Per frame slot
+	};
+	std::vector<block> blocks;
+	std::vector<u32>   image_blocks(std::size(m_resources));
+
+	// By first use, an image takes the first block whose occupant is done with it
+	std::vector<handle> order;
+	for (handle i{}; i < std::size(m_resources); ++i) {
+		if (!m_resources[i].imported && m_resources[i].first_pass.has_value()) {
+			order.push_back(i);
+		}
+	}
+	std::ranges::stable_sort(order, {}, [this] (const handle i) { return *m_resources[i].first_pass; });
+
+	for (auto &frame : m_frames) {
+		frame.images.resize(std::size(m_resources), VK_NULL_HANDLE);
+		frame.views.resize(std::size(m_resources), VK_NULL_HANDLE);
+	}
+
+	const auto device{ m_device.handle() };
+	for (const auto i : order) {
+		auto &resource{ m_resources[i] };
+		const auto lazy{ (resource.usage & ~attachment_usages) == 0 };
+		if (lazy) {
+			resource.usage |= VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+		}
+
+		u32 memory_types{ ~0u };
+		std::vector<VkDeviceSize> sizes(m_frames_in_flight);
+		for (u32 slot{}; slot < m_frames_in_flight; ++slot) {
+			const VkImageCreateInfo create_info{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+				.imageType   = VK_IMAGE_TYPE_2D,
+				.format      = resource.format,
+				.extent      = VkExtent3D{
+					.width  = resource.extent.width,
+					.height = resource.extent.height,
+					.depth  = 1
+				},
+				.mipLevels   = 1,
+				.arrayLayers = 1,
+				.samples     = VK_SAMPLE_COUNT_1_BIT,
+				.tiling      = VK_IMAGE_TILING_OPTIMAL,
+				.usage       = resource.usage,
+				.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+			};
+			if (VK_SUCCESS != vkCreateImage(device, &create_info, m_device.allocator(), &m_frames[slot].images[i])) {
+				throw render_graph_error{ fmt::format("Failed to create the transient image '{}'.", resource.name) };
+			}
+			VkMemoryRequirements requirements;
+			vkGetImageMemoryRequirements(device, m_frames[slot].images[i], &requirements);
+			memory_types &= requirements.memoryTypeBits;
+			sizes[slot] = requirements.size;
+		}
+		m_transient_bytes += sizes[0];
+
+		const auto reusable{ std::ranges::find_if(blocks, [&] (const block &candidate) {
+			return candidate.lazy == lazy && (candidate.memory_types & memory_types) != 0
+				&& m_resources[candidate.occupant].last_pass < *resource.first_pass;
+		}) };
+		if (reusable == std::end(blocks)) {
+			image_blocks[i] = static_cast<u32>(std::size(blocks));
+			blocks.push_back(block{
+				.occupant     = i,
+				.memory_types = memory_types,
+				.lazy         = lazy,
+				.category     = (resource.aspect & VK_IMAGE_ASPECT_DEPTH_BIT) != 0 ? memory_category::depth : memory_category::image,
+				.sizes        = std::move(sizes)
+			});
+			continue;
+		}
+		resource.previous = reusable->occupant;
+		reusable->occupant      = i;
+		reusable->memory_types &= memory_types;
+		for (u32 slot{}; slot < m_frames_in_flight; ++slot) {
+			reusable->sizes[slot] = std::max(reusable->sizes[slot], sizes[slot]);
+		}
+		image_blocks[i] = static_cast<u32>(reusable - std::begin(blocks));
+	}
+
+	// Every block starts at offset 0, which meets the alignment of any image
+	for (u32 slot{}; slot < m_frames_in_flight; ++slot) {
+		auto &frame{ m_frames[slot] };
+		for (const auto &current : blocks) {
+			frame.memory.push_back(m_device.allocate_memory(
+				VkMemoryRequirements{ .size = current.sizes[slot], .alignment = 1, .memoryTypeBits = current.memory_types },
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, current.category,
+				current.lazy ? VK_MEMORY_PROPERTY_LAZILY_ALLOCATED_BIT : 0
+			));
+		}
+		for (const auto i : order) {
+			const auto &resource{ m_resources[i] };
+			vkBindImageMemory(device, frame.images[i], frame.memory[image_blocks[i]], 0);
+
+			const VkImageViewCreateInfo view_info{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+				.image            = frame.images[i],
+				.viewType         = VK_IMAGE_VIEW_TYPE_2D,
+				.format           = resource.format,
+				.subresourceRange = VkImageSubresourceRange{
+					.aspectMask     = resource.aspect,
+					.baseMipLevel   = 0, .levelCount = 1,
+					.baseArrayLayer = 0, .layerCount = 1,
+				}
+			};
+			if (VK_SUCCESS != vkCreateImageView(device, &view_info, m_device.allocator(), &frame.views[i])) {
+				throw render_graph_error{ fmt::format("Failed to create the view of '{}'.", resource.name) };
+			}
+		}
+	}
+	for (const auto &current : blocks) {
+		m_allocated_bytes += current.sizes[0];
+	}
+}
+
+void render_graph::compute_barriers() {
+	struct tracked {
+		VkPipelineStageFlags2 write_stages{};  ///< Of the last write or layout transition
+		VkAccessFlags2        write_access{};
+		VkPipelineStageFlags2 read_stages {};  ///< Reads since, already after the write
+		VkImageLayout         layout      { VK_IMAGE_LAYOUT_UNDEFINED };
+		b8                    touched     { false };
+	};
+	std::vector<tracked> states(std::size(m_resources));
+
+	for (auto &current : m_passes) {
+		current.m_barriers.clear();
+		if (current.m_culled) continue;
+
+		for (const auto &access : current.m_accesses) {
+			const auto usage{ state_of(access.usage) };
+			const auto &resource{ m_resources[access.image] };
+			auto &state{ states[access.image] };
+			pass::barrier barrier{
+				.image      = access.image,
+				.dst_stages = usage.stages,
+				.dst_access = (access.reads ? usage.read_access : 0) | (access.writes ? usage.write_access : 0),
+				.old_layout = state.layout,
+				.new_layout = usage.layout
+			};
+			if (!state.touched) {
+				// The contents are discarded, only the acquire or the previous occupant of the memory are waited for
+				if (resource.imported) {
+					barrier.src_stages = import_stages;
+				} else if (resource.previous.has_value()) {
+					const auto &previous{ states[*resource.previous] };
+					barrier.src_stages = previous.write_stages | previous.read_stages;
+					barrier.src_access = previous.write_access;
+				}
+			} else if (!access.writes && state.layout == usage.layout) {
+				// Reads after reads need nothing, each new stage waits for the write once
+				if ((usage.stages & ~state.read_stages) == 0) {
+					continue;
+				}
+				barrier.src_stages = state.write_stages;
+				barrier.src_access = state.write_access;
+			} else {
+				// Writes and transitions wait for every earlier access
+				barrier.src_stages = state.write_stages | state.read_stages;
+				barrier.src_access = state.write_access;
+			}
+			current.m_barriers.push_back(barrier);
+
+			state.touched = true;
+			state.layout  = usage.layout;
+			if (access.writes || barrier.old_layout != barrier.new_layout) {
+				state.write_stages = usage.stages;
+				state.write_access = access.writes ? usage.write_access : VK_ACCESS_2_NONE;
+				state.read_stages  = access.writes ? VK_PIPELINE_STAGE_2_NONE : usage.stages;
+			} else {
+				state.read_stages |= usage.stages;
+			}
+		}
+		if (std::size(current.m_barriers) > constants::max_pass_barriers) {
+			throw render_graph_error{ fmt::format("Pass '{}' needs more than {} barriers.",
+				current.m_name, constants::max_pass_barriers) };
+		}
+	}
+
+	m_final_barriers.clear();
+	for (handle i{}; i < std::size(m_resources); ++i) {
+		const auto &resource{ m_resources[i] };
+		const auto &state{ states[i] };
+		if (!resource.imported || resource.final_usage == image_usage::none || !state.touched) continue;
+
+		const auto usage{ state_of(resource.final_usage) };
+		m_final_barriers.push_back(pass::barrier{
+			.image      = i,
+			.src_stages = state.write_stages | state.read_stages,
+			.src_access = state.write_access,
+			.dst_stages = usage.stages,
+			.dst_access = usage.read_access,
+			.old_layout = state.layout,
+			.new_layout = usage.layout
+		});
+	}
+	if (std::size(m_final_barriers) > constants::max_pass_barriers) {
+		throw render_graph_error{ fmt::format("More than {} images are imported.", constants::max_pass_barriers) };
+	}
+}
+
+void render_graph::compute_attachment_ops() {
+	// Nothing to load before the first write of the frame, nothing to store without a later reader
+	std::vector<b8> written(std::size(m_resources));
+	for (auto &current : m_passes) {
+		if (current.m_culled) continue;
+
+		for (auto &attachment : current.m_colors) {
+			if (attachment.load == VK_ATTACHMENT_LOAD_OP_LOAD && !written[attachment.image]) {
+				attachment.load = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			}
+		}
+		if (current.m_depth.has_value() && current.m_depth->load == VK_ATTACHMENT_LOAD_OP_LOAD && !written[current.m_depth->image]) {
+			current.m_depth->load = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		}
+		for (const auto &access : current.m_accesses) {
+			written[access.image] = written[access.image] || access.writes;
+		}
+	}
+
+	std::vector<b8> read_later(std::size(m_resources));
+	for (size_t i{}; i < std::size(m_resources); ++i) {
+		read_later[i] = m_resources[i].imported;
+	}
+	for (auto current{ std::rbegin(m_passes) }; current != std::rend(m_passes); ++current) {
+		if (current->m_culled) continue;
+
+		for (auto &attachment : current->m_colors) {
+			attachment.store = read_later[attachment.image] ? VK_ATTACHMENT_STORE_OP_STORE : VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		}
+		if (current->m_depth.has_value()) {
+			current->m_depth->store = read_later[current->m_depth->image]
+				? VK_ATTACHMENT_STORE_OP_STORE
+				: VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		}
+		for (const auto &access : current->m_accesses) {
+			if (access.writes && !access.reads) {
+				read_later[access.image] = false;
+			}
+		}
+		for (const auto &access : current->m_accesses) {
+			if (access.reads) {
+				read_later[access.image] = true;
+			}
+		}
+	}
+}
+
+void render_graph::construct_render_passes() {
+	// The graph records the transitions, attachments stay in their layout during the pass
+	for (auto &current : m_passes) {
+		if (current.m_culled || current.m_type != pass_type::graphics) continue;
+
+		std::array<VkAttachmentDescription, constants::max_pass_attachments> attachments{};
+		std::array<VkAttachmentReference, constants::max_pass_attachments> color_refs{};
+		u32 count{};
+		const auto describe = [&] (const pass::attachment &attachment, const VkImageLayout layout) {
+			attachments[count] = VkAttachmentDescription{
+				.format         = m_resources[attachment.image].format,
+				.samples        = VK_SAMPLE_COUNT_1_BIT,
+				.loadOp         = attachment.load,
+				.storeOp        = attachment.store,
+				.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+				.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+				.initialLayout  = layout,
+				.finalLayout    = layout
+			};
+			return VkAttachmentReference{ .attachment = count++, .layout = layout };
+		};
+		for (u32 i{}; i < std::size(current.m_colors); ++i) {
+			color_refs[i] = describe(current.m_colors[i], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+		}
+		const auto depth_ref{ current.m_depth.has_value()
+			? describe(*current.m_depth, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
+			: VkAttachmentReference{} };
+
+		const VkSubpassDescription sub_pass{
+			.pipelineBindPoint       = VK_PIPELINE_BIND_POINT_GRAPHICS,
+			.colorAttachmentCount    = static_cast<u32>(std::size(current.m_colors)),
+			.pColorAttachments       = std::data(color_refs),
+			.pDepthStencilAttachment = current.m_depth.has_value() ? &depth_ref : nullptr
+		};
+		const VkRenderPassCreateInfo render_pass_info{
+			.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+			.attachmentCount = count,
+			.pAttachments    = std::data(attachments),
+			.subpassCount    = 1,
+			.pSubpasses      = &sub_pass
+		};
+		if (VK_SUCCESS != vkCreateRenderPass(m_device.handle(), &render_pass_info, m_device.allocator(), &current.m_render_pass)) {
+			throw render_graph_error{ fmt::format("Failed to create the render pass of '{}'.", current.m_name) };
+		}
+	}
+}
+
+#pragma endregion
+
+#pragma region record methods
+
+void render_graph::record_barriers(VkCommandBuffer command_buffer, const std::vector<pass::barrier> &barriers,
+	const u32 frame_slot) const {
+	if (std::empty(barriers)) return;
+
+	const auto range = [this] (const handle image) {
+		return VkImageSubresourceRange{
+			.aspectMask     = m_resources[image].aspect,
+			.baseMipLevel   = 0, .levelCount = 1,
+			.baseArrayLayer = 0, .layerCount = 1
+		};
+	};
+	if (m_device.has_dynamic_rendering()) {
+		std::array<VkImageMemoryBarrier2, constants::max_pass_barriers> image_barriers;
+		for (size_t i{}; i < std::size(barriers); ++i) {
+			const auto &barrier{ barriers[i] };
+			image_barriers[i] = VkImageMemoryBarrier2{
+				.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+				.srcStageMask        = barrier.src_stages,
+				.srcAccessMask       = barrier.src_access,
+				.dstStageMask        = barrier.dst_stages,
+				.dstAccessMask       = barrier.dst_access,
+				.oldLayout           = barrier.old_layout,
+				.newLayout           = barrier.new_layout,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.image               = image(barrier.image, frame_slot),
+				.subresourceRange    = range(barrier.image)
+			};
+		}
+		const VkDependencyInfo dependency{
+			.sType                   = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+			.imageMemoryBarrierCount = static_cast<u32>(std::size(barriers)),
+			.pImageMemoryBarriers    = std::data(image_barriers)
+		};
+		m_device.rendering_commands().pipeline_barrier2(command_buffer, &dependency);
+		return;
+	}
+
+	// The original flags are the low bits, without stages the barrier spans the whole pipe
+	std::array<VkImageMemoryBarrier, constants::max_pass_barriers> image_barriers;
+	VkPipelineStageFlags src_stages{};
+	VkPipelineStageFlags dst_stages{};
+	for (size_t i{}; i < std::size(barriers); ++i) {
+		const auto &barrier{ barriers[i] };
+		src_stages |= static_cast<VkPipelineStageFlags>(barrier.src_stages);
+		dst_stages |= static_cast<VkPipelineStageFlags>(barrier.dst_stages);
+		image_barriers[i] = VkImageMemoryBarrier{
+			.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+			.srcAccessMask       = static_cast<VkAccessFlags>(barrier.src_access),
+			.dstAccessMask       = static_cast<VkAccessFlags>(barrier.dst_access),
+			.oldLayout           = barrier.old_layout,
+			.newLayout           = barrier.new_layout,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.image               = image(barrier.image, frame_slot),
+			.subresourceRange    = range(barrier.image)
+		};
+	}
+	vkCmdPipelineBarrier(command_buffer,
+		src_stages != 0 ? src_stages : VkPipelineStageFlags{ VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT },
+		dst_stages != 0 ? dst_stages : VkPipelineStageFlags{ VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT },
+		0, 0, nullptr, 0, nullptr, static_cast<u32>(std::size(barriers)), std::data(image_barriers));
+}
+
+void render_graph::begin_pass(VkCommandBuffer command_buffer, pass &current, const u32 frame_slot) {
+	const auto first{ std::empty(current.m_colors) ? current.m_depth->image : current.m_colors.front().image };
+	const VkRect2D render_area{ .offset = { 0, 0 }, .extent = m_resources[first].extent };
+
+	if (!m_device.has_dynamic_rendering()) {
+		std::array<VkClearValue, constants::max_pass_attachments> clear_values{};
+		u32 count{};
+		for (const auto &attachment : current.m_colors) {
+			clear_values[count++] = attachment.clear;
+		}
+		if (current.m_depth.has_value()) {
+			clear_values[count++] = current.m_depth->clear;
+		}
+		const VkRenderPassBeginInfo render_pass_info{
+			.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+			.renderPass      = current.m_render_pass,
+			.framebuffer     = framebuffer(current, frame_slot),
+			.renderArea      = render_area,
+			.clearValueCount = count,
+			.pClearValues    = std::data(clear_values)
+		};
+		vkCmdBeginRenderPass(command_buffer, &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
+		return;
+	}
+
+	const auto describe = [&] (const pass::attachment &attachment, const VkImageLayout layout) {
+		return VkRenderingAttachmentInfo{
+			.sType       = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+			.imageView   = view(attachment.image, frame_slot),
+			.imageLayout = layout,
+			.loadOp      = attachment.load,
+			.storeOp     = attachment.store,
+			.clearValue  = attachment.clear
+		};
+	};
+	std::array<VkRenderingAttachmentInfo, constants::max_pass_attachments> colors;
+	for (size_t i{}; i < std::size(current.m_colors); ++i) {
+		colors[i] = describe(current.m_colors[i], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+	}
+	const auto depth{ current.m_depth.has_value()
+		? describe(*current.m_depth, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL)
+		: VkRenderingAttachmentInfo{} };
+	const VkRenderingInfo rendering_info{
+		.sType                = VK_STRUCTURE_TYPE_RENDERING_INFO,
+		.renderArea           = render_area,
+		.layerCount           = 1,
+		.colorAttachmentCount = static_cast<u32>(std::size(current.m_colors)),
+		.pColorAttachments    = std::data(colors),
+		.pDepthAttachment     = current.m_depth.has_value() ? &depth : nullptr
+	};
+	m_device.rendering_commands().begin_rendering(command_buffer, &rendering_info);
+}
+
+void render_graph::end_pass(VkCommandBuffer command_buffer) const {
+	if (m_device.has_dynamic_rendering()) {
+		m_device.rendering_commands().end_rendering(command_buffer);
+	} else {
+		vkCmdEndRenderPass(command_buffer);
+	}
+}
+
+#pragma endregion
+
+VkImage render_graph::image(const handle image, const u32 frame_slot) const {
+	const auto &resource{ m_resources[image] };
+	return resource.imported ? resource.image : m_frames[frame_slot].images[image];
+}
+
+VkImageView render_graph::view(const handle image, const u32 frame_slot) const {
+	const auto &resource{ m_resources[image] };
+	return resource.imported ? resource.view : m_frames[frame_slot].views[image];
+}
+
+VkFramebuffer render_graph::framebuffer(pass &current, const u32 frame_slot) {
+	// Few combinations in practice, the imported views take turns
+	std::array<VkImageView, constants::max_pass_attachments> views{};
+	u32 count{};
+	for (const auto &attachment : current.m_colors) {
+		views[count++] = view(attachment.image, frame_slot);
+	}
+	if (current.m_depth.has_value()) {
+		views[count++] = view(current.m_depth->image, frame_slot);
+	}
+	for (const auto &cached : current.m_framebuffers) {
+		if (cached.views == views) {
+			return cached.handle;
+		}
+	}
+
+	const auto &extent{ m_resources[current.m_colors.empty() ? current.m_depth->image : current.m_colors.front().image].extent };
+	const VkFramebufferCreateInfo create_info{
+		.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+		.renderPass      = current.m_render_pass,
+		.attachmentCount = count,
+		.pAttachments    = std::data(views),
+		.width           = extent.width,
+		.height          = extent.height,
+		.layers          = 1
+	};
+	VkFramebuffer created;
+	if (VK_SUCCESS != vkCreateFramebuffer(m_device.handle(), &create_info, m_device.allocator(), &created)) {
+		throw render_graph_error{ fmt::format("Failed to create a framebuffer of '{}'.", current.m_name) };
+	}
+	current.m_framebuffers.push_back(pass::framebuffer{ .views = views, .handle = created });
+	return created;
+}
+
+} // namespace vc::engine::graphics
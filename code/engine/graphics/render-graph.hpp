@@ -0,0 +1,195 @@
+#pragma once
+
+#include <array>
+#include <deque>
+#include <string>
+#include <vector>
+#include <optional>
+#include <functional>
+#include <string_view>
+#include <stdexcept>
+
+#include <vulkan/vulkan.h>
+
+#include "core/types.hpp"
+
+namespace vc::engine::graphics {
+
+class device;
+
+namespace constants {
+
+constexpr u32 max_pass_attachments{ 4 };   ///< Color attachments and the depth one of a pass
+constexpr u32 max_pass_barriers   { 8 };   ///< Image barriers recorded before a pass
+
+} // namespace constants
+
+/// How a pass accesses an image, it implies the stages, the accesses and the layout.
+enum class image_usage : u8 {
+	none,
+	color_attachment,
+	depth_attachment,
+	sampled,               ///< Read by fragment shaders
+	storage,               ///< Read and written by compute shaders
+	transfer_source,
+	transfer_destination,
+	present,
+};
+
+enum class pass_type : u8 {
+	graphics,  ///< Records inside the rendering of its attachments
+	compute,
+	transfer,
+};
+
+/// Passes declare the images they read and write, `compile` then culls the passes no output
+/// depends on, computes the barriers between the remaining ones and aliases the memory of
+/// transient images whose lifetimes do not overlap. Passes run in declaration order. Buffers stay
+/// outside the graph, their owners synchronize them.
+class render_graph {
+public:
+	using handle = u32;
+	using record_function = std::function<void(VkCommandBuffer)>;
+
+	class pass {
+	public:
+		/// Loaded when there is no clear value, the previous writer is then kept.
+		auto color(handle image, std::optional<VkClearColorValue> clear = std::nullopt) -> pass &;
+		auto depth(handle image, std::optional<VkClearDepthStencilValue> clear = std::nullopt) -> pass &;
+		auto read(handle image, image_usage usage) -> pass &;
+		auto write(handle image, image_usage usage) -> pass &;
+		auto record(record_function function) -> pass &;
+		/// Never culled, e.g. a readback the host waits for.
+		auto side_effect() -> pass &;
+
+		[[nodiscard]] auto name() const noexcept -> std::string_view { return m_name; }
+		/// Null with dynamic rendering or before `compile`.
+		[[nodiscard]] auto render_pass() const noexcept { return m_render_pass; }
+		[[nodiscard]] auto is_culled() const noexcept { return m_culled; }
+
+	private:
+		friend class render_graph;
+
+		struct access {
+			handle      image{};
+			image_usage usage{ image_usage::none };
+			b8          reads{ false };
+			b8          writes{ false };
+		};
+		struct attachment {
+			handle              image{};
+			VkAttachmentLoadOp  load { VK_ATTACHMENT_LOAD_OP_LOAD };
+			VkAttachmentStoreOp store{ VK_ATTACHMENT_STORE_OP_STORE };
+			VkClearValue        clear{};
+		};
+		struct barrier {
+			handle                image{};
+			VkPipelineStageFlags2 src_stages{};
+			VkAccessFlags2        src_access{};
+			VkPipelineStageFlags2 dst_stages{};
+			VkAccessFlags2        dst_access{};
+			VkImageLayout         old_layout{ VK_IMAGE_LAYOUT_UNDEFINED };
+			VkImageLayout         new_layout{ VK_IMAGE_LAYOUT_UNDEFINED };
+		};
+		struct framebuffer {
+			std::array<VkImageView, constants::max_pass_attachments> views{};
+			VkFramebuffer handle{ VK_NULL_HANDLE };
+		};
+
+		std::string                     m_name;
+		pass_type                       m_type;
+		std::vector<access>             m_accesses;
+		std::vector<attachment>         m_colors;
+		std::optional<attachment>       m_depth;
+		record_function                 m_record;
+		b8                              m_side_effect{ false };
+		b8                              m_culled     { false };
+		std::vector<barrier>            m_barriers;     ///< Before the pass, from `compile`
+		VkRenderPass                    m_render_pass{ VK_NULL_HANDLE };
+		std::vector<framebuffer>        m_framebuffers; ///< Keyed by the views, imported ones change per frame
+
+		pass(std::string_view name, pass_type type) : m_name{ name }, m_type{ type } {}
+
+		auto add_access(handle image, image_usage usage, b8 reads, b8 writes) -> pass &;
+		auto attach(handle image, image_usage usage, std::optional<VkClearValue> clear) -> attachment;
+	};
+
+	/// `frames_in_flight` copies of every transient image, one per frame slot.
+	render_graph(device &device, u32 frames_in_flight);
+	~render_graph();
+
+	render_graph(const render_graph &) = delete;
+	render_graph &operator=(const render_graph &) = delete;
+
+	/// An image owned elsewhere, bound every frame. Its contents are discarded when the frame
+	/// starts, it is left for `final_usage`. The first barrier waits on the color output stage,
+	/// like the submission does for an acquired swap chain image.
+	[[nodiscard]] auto import_image(std::string_view name, VkFormat format, VkExtent2D extent,
+		image_usage final_usage) -> handle;
+	/// An image that only lives during the frame, its memory is shared with others.
+	[[nodiscard]] auto create_image(std::string_view name, VkFormat format, VkExtent2D extent) -> handle;
+	/// The returned reference stays valid for the lifetime of the graph.
+	auto add_pass(std::string_view name, pass_type type) -> pass &;
+
+	/// Once, after every pass has been added.
+	void compile();
+
+	void bind(handle image, VkImage vk_image, VkImageView view);
+	void execute(VkCommandBuffer command_buffer, u32 frame_slot);
+
+	[[nodiscard]] auto find_pass(std::string_view name) const -> const pass &;
+
+private:
+	struct resource {
+		std::string        name;
+		VkFormat           format     { VK_FORMAT_UNDEFINED };
+		VkExtent2D         extent     {};
+		VkImageAspectFlags aspect     {};
+		VkImageUsageFlags  usage      {};
+		b8                 imported   { false };
+		image_usage        final_usage{ image_usage::none };
+		VkImage            image      { VK_NULL_HANDLE };  ///< Bound, imported images only
+		VkImageView        view       { VK_NULL_HANDLE };
+		std::optional<u32> first_pass;
+		u32                last_pass  {};
+		std::optional<handle> previous;  ///< Transient image whose memory this one takes over
+	};
+	struct frame_resources {
+		std::vector<VkImage>        images;  ///< By handle, null for imported images
+		std::vector<VkImageView>    views;
+		std::vector<VkDeviceMemory> memory;  ///< By block
+	};
+
+	device                        &m_device;
+	u32                            m_frames_in_flight;
+	std::vector<resource>          m_resources;
+	std::deque<pass>               m_passes;
+	std::vector<pass::barrier>     m_final_barriers;  ///< Leaves the imported images for their final usage
+	std::vector<frame_resources>   m_frames;
+	VkDeviceSize                   m_transient_bytes{};  ///< Requested by the transient images of a slot
+	VkDeviceSize                   m_allocated_bytes{};  ///< Allocated for them once aliased
+	b8                             m_compiled{ false };
+
+	void cull_passes();
+	void compute_lifetimes();
+	void compute_barriers();
+	void compute_attachment_ops();
+	void construct_transient_images();
+	void construct_render_passes();
+
+	void record_barriers(VkCommandBuffer command_buffer, const std::vector<pass::barrier> &barriers, u32 frame_slot) const;
+	void begin_pass(VkCommandBuffer command_buffer, pass &current, u32 frame_slot);
+	void end_pass(VkCommandBuffer command_buffer) const;
+
+	[[nodiscard]] auto image(handle image, u32 frame_slot) const -> VkImage;
+	[[nodiscard]] auto view(handle image, u32 frame_slot) const -> VkImageView;
+	[[nodiscard]] auto framebuffer(pass &current, u32 frame_slot) -> VkFramebuffer;
+};
+
+class render_graph_error : public std::runtime_error {
+public:
+	using base_type = std::runtime_error;
+	using base_type::runtime_error;
+};
+
+} // namespace vc::engine::graphics
@@ -0,0 +1,80 @@
+#include <fmt/core.h>
+
+#include "core/hash.hpp"
+#include "engine/graphics/sampler-cache.hpp"
+
+namespace vc::engine::graphics {
+
+sampler_cache::sampler_cache(device &dev) : m_device{ dev } {
+}
+
+sampler_cache::~sampler_cache() {
+	for (const auto &[_, sampler] : m_samplers) {
+		vkDestroySampler(m_device.handle(), sampler, m_device.allocator());
+	}
+}
+
+VkSampler sampler_cache::get(const VkSamplerCreateInfo &info) {
+	if (info.pNext != nullptr) {
+		throw sampler_error{ "Sampler create-info extensions aren't supported by the cache." };
+	}
+
+	// Adding zero turns -0.0 into 0.0, equal floats then hash the same
+	const sampler_key key{
+		.flags                    = info.flags,
+		.mag_filter               = info.magFilter,
+		.min_filter               = info.minFilter,
+		.mipmap_mode              = info.mipmapMode,
+		.address_mode_u           = info.addressModeU,
+		.address_mode_v           = info.addressModeV,
+		.address_mode_w           = info.addressModeW,
+		.mip_lod_bias             = info.mipLodBias + 0.0f,
+		.anisotropy_enable        = info.anisotropyEnable,
+		.max_anisotropy           = info.maxAnisotropy + 0.0f,
+		.compare_enable           = info.compareEnable,
+		.compare_op               = info.compareOp,
+		.min_lod                  = info.minLod + 0.0f,
+		.max_lod                  = info.maxLod + 0.0f,
+		.border_color             = info.borderColor,
+		.unnormalized_coordinates = info.unnormalizedCoordinates
+	};
+	if (const auto found{ m_samplers.find(key) }; found != std::end(m_samplers)) {
+		return found->second;
+	}
+
+	VkSampler sampler;
+	if (VK_SUCCESS != vkCreateSampler(m_device.handle(), &info, m_device.allocator(), &sampler)) {
+		throw sampler_error{ fmt::format("Failed to create a sampler, {} are cached.", std::size(m_samplers)) };
+	}
+	m_samplers.emplace(key, sampler);
+	return sampler;
+}
+
+VkSamplerCreateInfo sampler_cache::linear(const u32 mip_levels, const VkSamplerAddressMode address_mode) const noexcept {
+	const auto anisotropy{ m_device.features().samplerAnisotropy };
+	return VkSamplerCreateInfo{
+		.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO,
+		.magFilter        = VK_FILTER_LINEAR,
+		.minFilter        = VK_FILTER_LINEAR,
+		.mipmapMode       = VK_SAMPLER_MIPMAP_MODE_LINEAR,
+		.addressModeU     = address_mode,
+		.addressModeV     = address_mode,
+		.addressModeW     = address_mode,
+		.mipLodBias       = 0.0f,
+		.anisotropyEnable = anisotropy,
+		.maxAnisotropy    = anisotropy == VK_TRUE ? m_device.limits().maxSamplerAnisotropy : 1.0f,
+		.compareEnable    = VK_FALSE,
+		.compareOp        = VK_COMPARE_OP_ALWAYS,
+		.minLod           = 0.0f,
+		.maxLod           = static_cast<f32>(mip_levels),
+		.borderColor      = VK_BORDER_COLOR_INT_OPAQUE_BLACK,
+		.unnormalizedCoordinates = VK_FALSE
+	};
+}
+
+size_t sampler_cache::sampler_key_hash::operator()(const sampler_key &key) const noexcept {
+	// The key has no padding, so its bytes are its value
+	return static_cast<size_t>(core::hash_bytes(key));
+}
+
+} // namespace vc::engine::graphics
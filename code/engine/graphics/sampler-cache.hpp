@@ -0,0 +1,65 @@
+#pragma once
+
+#include <stdexcept>
+#include <unordered_map>
+
+#include "engine/graphics/device.hpp"
+
+namespace vc::engine::graphics {
+
+/// Creates every distinct sampler once: samplers are keyed by their create-info and live as long
+/// as the cache, so textures share them instead of owning one each.
+class sampler_cache {
+public:
+	explicit sampler_cache(device &device);
+	~sampler_cache();
+
+	sampler_cache(const sampler_cache &) = delete;
+	sampler_cache &operator=(const sampler_cache &) = delete;
+
+	/// Extension structures aren't supported, `pNext` must be null.
+	[[nodiscard]] auto get(const VkSamplerCreateInfo &info) -> VkSampler;
+	[[nodiscard]] auto size() const noexcept { return std::size(m_samplers); }
+
+	/// Trilinear filtering over `mip_levels`, anisotropic when the device enables it.
+	[[nodiscard]] auto linear(u32 mip_levels, VkSamplerAddressMode address_mode = VK_SAMPLER_ADDRESS_MODE_REPEAT) const noexcept
+		-> VkSamplerCreateInfo;
+
+private:
+	/// Every field of the create-info but `sType` and `pNext`, all 4 bytes wide so there is no padding.
+	struct sampler_key {
+		VkSamplerCreateFlags flags;
+		VkFilter             mag_filter;
+		VkFilter             min_filter;
+		VkSamplerMipmapMode  mipmap_mode;
+		VkSamplerAddressMode address_mode_u;
+		VkSamplerAddressMode address_mode_v;
+		VkSamplerAddressMode address_mode_w;
+		f32                  mip_lod_bias;
+		VkBool32             anisotropy_enable;
+		f32                  max_anisotropy;
+		VkBool32             compare_enable;
+		VkCompareOp          compare_op;
+		f32                  min_lod;
+		f32                  max_lod;
+		VkBorderColor        border_color;
+		VkBool32             unnormalized_coordinates;
+
+		[[nodiscard]] bool operator==(const sampler_key &other) const noexcept = default;
+	};
+
+	struct sampler_key_hash {
+		[[nodiscard]] auto operator()(const sampler_key &key) const noexcept -> size_t;
+	};
+
+	device                                                       &m_device;
+	std::unordered_map<sampler_key, VkSampler, sampler_key_hash> m_samplers;
+};
+
+class sampler_error : public std::runtime_error {
+public:
+	using base_type = std::runtime_error;
+	using base_type::runtime_error;
+};
+
+} // namespace vc::engine::graphics
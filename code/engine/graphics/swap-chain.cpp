@@ -7,12 +7,9 @@
 namespace vc::engine::graphics {
 
 swap_chain::swap_chain(device &_device, const VkExtent2D extent)
-	: m_device{ _device }, m_window_extent{ extent } {
+	: m_device{ _device }, m_window_extent{ extent }, m_timeline{ _device, constants::max_frames_in_flight } {
 	construct_swap_chain();
 	construct_image_views();
-	construct_render_pass();
-	construct_depth_resources();
-	construct_framebuffers();
 	construct_sync_objects();
 }
 
@@ -20,29 +17,16 @@ swap_chain::~swap_chain() {
 	auto device{ m_device.handle() };
 
 	for (auto &&image_view : m_image_views) {
-		vkDestroyImageView(device, image_view, nullptr);
+		vkDestroyImageView(device, image_view, m_device.allocator());
 	}
 
 	if (m_swap_chain != nullptr) {
-		vkDestroySwapchainKHR(device, std::exchange(m_swap_chain, nullptr), nullptr);
+		vkDestroySwapchainKHR(device, std::exchange(m_swap_chain, nullptr), m_device.allocator());
 	}
 
-	for (size_t i{}; i < std::size(m_depth_images); ++i) {
-		vkDestroyImageView(device, m_depth_image_views[i], nullptr);
-		vkDestroyImage(device, m_depth_images[i], nullptr);
-		vkFreeMemory(device, m_depth_image_memories[i], nullptr);
-	}
-
-	for (auto &&framebuffer : m_framebuffers) {
-		vkDestroyFramebuffer(device, framebuffer, nullptr);
-	}
-
-	vkDestroyRenderPass(device, m_render_pass, nullptr);
-
 	for (size_t i{}; i < std::size(m_render_finished_semaphores); ++i) {
-		vkDestroySemaphore(device, m_render_finished_semaphores[i], nullptr);
-		vkDestroySemaphore(device, m_available_images_semaphores[i], nullptr);
-		vkDestroyFence(device, m_in_flight_fences[i], nullptr);
+		vkDestroySemaphore(device, m_render_finished_semaphores[i], m_device.allocator());
+		vkDestroySemaphore(device, m_available_images_semaphores[i], m_device.allocator());
 	}
 }
 
@@ -59,8 +43,12 @@ VkFormat swap_chain::find_depth_format() const {
 }
 
 std::optional<u32> swap_chain::acquire_next_image() {
-	vkWaitForFences(m_device.handle(), 1, &m_in_flight_fences[m_current_frame],
-		VK_TRUE, constants::fence_wait_timeout);
+	// The frame that last used these semaphores
+	if (const auto frame{ m_timeline.submitted() + 1 }; frame > constants::max_frames_in_flight) {
+		m_timeline.wait(frame - constants::max_frames_in_flight);
+	}
+	m_frame_arenas.begin_frame(m_current_frame);
+	m_device.deletions().collect(m_timeline.completed());
 
 	u32 image_index;
 	const auto result{ vkAcquireNextImageKHR(
@@ -74,23 +62,25 @@ std::optional<u32> swap_chain::acquire_next_image() {
 	return VK_SUCCESS == result ? std::make_optional(image_index) : std::nullopt;
 }
 
-VkResult swap_chain::submit(u32 image_index, const VkCommandBuffer *buffers, u32 buffers_count) {
-	if (auto current_image_fence{ m_images_in_flight[image_index] }; current_image_fence != VK_NULL_HANDLE) {
-		vkWaitForFences(m_device.handle(), 1, &current_image_fence, VK_TRUE, constants::fence_wait_timeout);
-	}
-	const auto *current_fence_ptr{ std::next(std::data(m_in_flight_fences), m_current_frame) };
-	m_images_in_flight[image_index] = *current_fence_ptr;
+VkResult swap_chain::submit(u32 image_index, const VkCommandBuffer *buffers, u32 buffers_count,
+	const std::span<const semaphore_wait> waits) {
+	m_timeline.wait(m_images_in_flight[image_index]);
+	m_images_in_flight[image_index] = m_timeline.submitted() + 1;
 
-	const std::array<VkPipelineStageFlags, 1> wait_stages{
-		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
-	};
+	auto *scratch{ frame_resource() };
+	std::pmr::vector<VkSemaphore> wait_semaphores({ m_available_images_semaphores[m_current_frame] }, scratch);
+	std::pmr::vector<VkPipelineStageFlags> wait_stages({ VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT }, scratch);
+	for (const auto &[semaphore, stages] : waits) {
+		wait_semaphores.push_back(semaphore);
+		wait_stages.push_back(stages);
+	}
 	const auto *signal_semaphores_ptr{
 		std::next(std::data(m_render_finished_semaphores), m_current_frame)
 	};
 	const VkSubmitInfo submit_info{
 		.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-		.waitSemaphoreCount   = 1,
-		.pWaitSemaphores      = std::next(std::data(m_available_images_semaphores), m_current_frame),
+		.waitSemaphoreCount   = static_cast<u32>(std::size(wait_semaphores)),
+		.pWaitSemaphores      = std::data(wait_semaphores),
 		.pWaitDstStageMask    = std::data(wait_stages),
 		.commandBufferCount   = buffers_count,
 		.pCommandBuffers      = buffers,
@@ -98,10 +88,8 @@ VkResult swap_chain::submit(u32 image_index, const VkCommandBuffer *buffers, u32
 		.pSignalSemaphores    = signal_semaphores_ptr,
 	};
 
-	vkResetFences(m_device.handle(), 1, current_fence_ptr);
-	if (VK_SUCCESS != vkQueueSubmit(m_device.graphics_queue(), 1, &submit_info, *current_fence_ptr)) {
-		throw swap_chain_error{ "Failed to submit draw command buffer" };
-	}
+	m_timeline.submit(m_device.graphics_queue(), submit_info, scratch);
+	m_device.deletions().frame_submitted(m_timeline.submitted());
 
 	const VkPresentInfoKHR present_info{
 		.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
@@ -129,16 +117,20 @@ void swap_chain::construct_swap_chain() {
 		return count;
 	}(support.capabilities) };
 
-	auto [graphics_family, present_family]{ m_device.find_queue_families() };
-	// TODO: Check optional families. It actually matters
+	const auto &families{ m_device.queue_families() };
+	// Images are shared only when a separate family presents them
 	constexpr u32 queue_family_indices_count{ 2 };
 	const std::array<u32, queue_family_indices_count> queue_family_indices{
-		graphics_family.value_or(0),
-		present_family.value_or(0)
+		families.graphics_family.value_or(0),
+		families.present_family.value_or(0)
 	};
-	const bool is_concurrent{ graphics_family == present_family };
+	const bool is_concurrent{ families.graphics_family != families.present_family };
 	const auto sharing_mode{ is_concurrent ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE };
 
+	// Frame captures copy out of the images, drivers almost always allow it
+	const auto capture_usage{ support.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT };
+	m_supports_capture = capture_usage != 0;
+
 	const auto surface_format{ select_surface_format(support.formats) };
 	const VkSwapchainCreateInfoKHR create_info{
 		.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
@@ -148,7 +140,7 @@ void swap_chain::construct_swap_chain() {
 		.imageColorSpace       = surface_format.colorSpace,
 		.imageExtent           = select_extent(support.capabilities),
 		.imageArrayLayers      = 1,
-		.imageUsage            = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+		.imageUsage            = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | capture_usage,
 		.imageSharingMode      = sharing_mode,
 		.queueFamilyIndexCount = (is_concurrent ? queue_family_indices_count      : 0u     ),
 		.pQueueFamilyIndices   = (is_concurrent ? std::data(queue_family_indices) : nullptr),
@@ -158,7 +150,7 @@ void swap_chain::construct_swap_chain() {
 		.clipped               = VK_TRUE,
 		.oldSwapchain          = VK_NULL_HANDLE
 	};
-	if (VK_SUCCESS != vkCreateSwapchainKHR(m_device.handle(), &create_info, nullptr, &m_swap_chain)) {
+	if (VK_SUCCESS != vkCreateSwapchainKHR(m_device.handle(), &create_info, m_device.allocator(), &m_swap_chain)) {
 		throw swap_chain_error{ "Failed to create swap chain." };
 	}
 
@@ -188,163 +180,24 @@ void swap_chain::construct_image_views() {
 				.layerCount     = 1
 			}
 		};
-		if (vkCreateImageView(device, &create_info, nullptr, &m_image_views[i]) != VK_SUCCESS) {
+		if (vkCreateImageView(device, &create_info, m_device.allocator(), &m_image_views[i]) != VK_SUCCESS) {
 			throw swap_chain_error{ "Failed to create texture image view." };
 		}
 	}
 }
 
-void swap_chain::construct_render_pass() {
-	enum { COLOR_ATTACHMENT, DEPTH_ATTACHMENT, ATTACHMENTS_COUNT };
-
-	const std::array<const VkAttachmentDescription, ATTACHMENTS_COUNT> attachments{
-		VkAttachmentDescription{
-			.format         = m_image_format,
-			.samples        = VK_SAMPLE_COUNT_1_BIT,
-			.loadOp         = VK_ATTACHMENT_LOAD_OP_CLEAR,
-			.storeOp        = VK_ATTACHMENT_STORE_OP_STORE,
-			.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
-			.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
-			.initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED,
-			.finalLayout    = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
-		},
-		VkAttachmentDescription{
-			.format         = find_depth_format(),
-			.samples        = VK_SAMPLE_COUNT_1_BIT,
-			.loadOp         = VK_ATTACHMENT_LOAD_OP_CLEAR,
-			.storeOp        = VK_ATTACHMENT_STORE_OP_DONT_CARE,
-			.stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
-			.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
-			.initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED,
-			.finalLayout    = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
-		}
-	};
-
-	const VkAttachmentReference color_attachment_ref{
-		.attachment = COLOR_ATTACHMENT,
-		.layout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
-	};
-	const VkAttachmentReference depth_attachment_ref{
-		.attachment = DEPTH_ATTACHMENT,
-		.layout     = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL
-	};
-
-	const VkSubpassDescription sub_pass{
-		.pipelineBindPoint       = VK_PIPELINE_BIND_POINT_GRAPHICS,
-		.colorAttachmentCount    = 1,
-		.pColorAttachments       = &color_attachment_ref,
-		.pDepthStencilAttachment = &depth_attachment_ref
-	};
-	const VkSubpassDependency dependency{
-		.srcSubpass = VK_SUBPASS_EXTERNAL,
-		.srcStageMask
-			= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
-			| VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
-		.dstStageMask
-			= VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
-			| VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
-		.dstAccessMask
-			= VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
-			| VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT
-	};
-
-	const VkRenderPassCreateInfo render_pass_info{
-		.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
-		.attachmentCount = static_cast<u32>(std::size(attachments)),
-		.pAttachments    = std::data(attachments),
-		.subpassCount    = 1,
-		.pSubpasses      = &sub_pass,
-		.dependencyCount = 1,
-		.pDependencies   = &dependency
-	};
-	if (VK_SUCCESS != vkCreateRenderPass(m_device.handle(), &render_pass_info, nullptr, &m_render_pass)) {
-		throw swap_chain_error{ "Failed to create render pass." };
-	}
-}
-
-void swap_chain::construct_depth_resources() {
-	m_depth_images.resize(std::size(m_images));
-	m_depth_image_memories.resize(std::size(m_images));
-	m_depth_image_views.resize(std::size(m_images));
-
-	const auto device{ m_device.handle() };
-	const auto depth_format{ find_depth_format() };
-	for (size_t i{}; i < std::size(m_depth_images); ++i) {
-		m_depth_images[i] = m_device.make_image(
-			VkImageCreateInfo{
-				.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
-				.imageType   = VK_IMAGE_TYPE_2D,
-				.format      = depth_format,
-				.extent      = VkExtent3D{
-					.width  = m_extent.width,
-					.height = m_extent.height,
-					.depth  = 1
-				},
-				.mipLevels   = 1,
-				.arrayLayers = 1,
-				.samples     = VK_SAMPLE_COUNT_1_BIT,
-				.tiling      = VK_IMAGE_TILING_OPTIMAL,
-				.usage       = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
-				.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
-			},
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
-			m_depth_image_memories[i]
-		);
-		const VkImageViewCreateInfo view_info{
-			.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-			.image            = m_depth_images[i],
-			.viewType         = VK_IMAGE_VIEW_TYPE_2D,
-			.format           = depth_format,
-			.subresourceRange = VkImageSubresourceRange{
-				.aspectMask = VK_IMAGE_ASPECT_DEPTH_BIT,
-				.baseMipLevel   = 0, .levelCount = 1,
-				.baseArrayLayer = 0, .layerCount = 1,
-			}
-		};
-		if (VK_SUCCESS != vkCreateImageView(device, &view_info, nullptr, &m_depth_image_views[i])) {
-			throw swap_chain_error{ "Failed to create texture image view." };
-		}
-	}
-}
-
-void swap_chain::construct_framebuffers() {
-	m_framebuffers.resize(std::size(m_images));
-	const auto device{ m_device.handle() };
-	for (size_t i{}; i < std::size(m_framebuffers); ++i) {
-		const std::array attachments{ m_image_views[i], m_depth_image_views[i] };
-		const VkFramebufferCreateInfo create_info{
-			.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
-			.renderPass      = m_render_pass,
-			.attachmentCount = static_cast<u32>(std::size(attachments)),
-			.pAttachments    = std::data(attachments),
-			.width           = m_extent.width,
-			.height          = m_extent.height,
-			.layers          = 1
-		};
-		if (VK_SUCCESS != vkCreateFramebuffer(device, &create_info, nullptr, &m_framebuffers[i])) {
-			throw swap_chain_error{ "Failed to create a framebuffer." };
-		}
-	}
-}
-
 void swap_chain::construct_sync_objects() {
-	m_images_in_flight.resize(std::size(m_images), VK_NULL_HANDLE);
+	m_images_in_flight.resize(std::size(m_images), 0);
 
 	const VkSemaphoreCreateInfo semaphore_info{
 		.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO
 	};
 
-	const VkFenceCreateInfo fence_info{
-		.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
-		.flags = VK_FENCE_CREATE_SIGNALED_BIT
-	};
-
 	const auto device{ m_device.handle() };
 	for (size_t i{}; i < std::size(m_available_images_semaphores); ++i) {
 		const auto result{
-			vkCreateSemaphore(device, &semaphore_info, nullptr, &m_available_images_semaphores[i]) &
-			vkCreateSemaphore(device, &semaphore_info, nullptr, &m_render_finished_semaphores[i])  &
-			vkCreateFence(device, &fence_info, nullptr, &m_in_flight_fences[i])
+			vkCreateSemaphore(device, &semaphore_info, m_device.allocator(), &m_available_images_semaphores[i]) &
+			vkCreateSemaphore(device, &semaphore_info, m_device.allocator(), &m_render_finished_semaphores[i])
 		};
 		if (result != VK_SUCCESS) {
 			throw swap_chain_error{ "Failed to create syncronization objects for a frame." };
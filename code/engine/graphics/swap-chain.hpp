@@ -1,23 +1,25 @@
 #pragma once
 
+#include <span>
 #include <array>
 #include <limits>
 #include <vector>
 #include <optional>
+#include <memory_resource>
 #include <stdexcept>
 
 #include <vulkan/vulkan.h>
 
 #include "core/types.hpp"
+#include "core/frame-arena.hpp"
+#include "engine/graphics/device.hpp"
+#include "engine/graphics/frame-timeline.hpp"
 
 namespace vc::engine::graphics {
 
-class device;
-
 namespace constants {
 
 constexpr i32 max_frames_in_flight{ 2 };
-constexpr u64 fence_wait_timeout  { std::numeric_limits<u64>::max() };
 constexpr u64 acquire_next_timeout{ std::numeric_limits<u64>::max() };
 
 // Use VK_FORMAT_B8G8R8A8_SRGB for gamma correction
@@ -37,19 +39,29 @@ public:
 	swap_chain(const swap_chain &) = delete;
 	swap_chain &operator=(const swap_chain &) = delete;
 
-	[[nodiscard]] auto framebuffer(const size_t index) const { return m_framebuffers.at(index); }
-	[[nodiscard]] auto render_pass() const noexcept { return m_render_pass; }
+	[[nodiscard]] auto image(const size_t index) const { return m_images.at(index); }
 	[[nodiscard]] auto image_view(const size_t index) const { return m_image_views.at(index); }
 	[[nodiscard]] auto image_count() const noexcept { return std::size(m_images); }
 	[[nodiscard]] auto image_format() const noexcept { return m_image_format; }
 	[[nodiscard]] auto extent() const noexcept { return m_extent; }
+	/// The images can be a transfer source, see `frame_capture`.
+	[[nodiscard]] auto supports_capture() const noexcept { return m_supports_capture; }
+	/// Frame in flight of the last acquired image, its previous submission has completed
+	[[nodiscard]] auto current_frame() const noexcept { return m_current_frame; }
+	/// Submitted frames, other subsystems key their resources to `timeline().submitted()`.
+	[[nodiscard]] auto timeline() noexcept -> frame_timeline & { return m_timeline; }
+	[[nodiscard]] auto is_frame_complete(const u64 frame) { return m_timeline.is_complete(frame); }
+	/// Transient memory of the acquired frame, released when its slot is acquired again. Only
+	/// for the thread that acquires and submits.
+	[[nodiscard]] auto frame_resource() noexcept -> std::pmr::memory_resource * { return &m_frame_arenas.current(); }
 
 	[[nodiscard]] auto aspect_ratio() const noexcept -> f32;
 	[[nodiscard]] auto find_depth_format() const -> VkFormat;
 
 	[[nodiscard]] auto acquire_next_image() -> std::optional<u32>;
+	/// The submission also waits on `waits`, each of them signalled once for this frame.
 	[[nodiscard]] auto submit(u32 image_index, const VkCommandBuffer *buffers,
-		u32 buffers_count = 1) -> VkResult;
+		u32 buffers_count = 1, std::span<const semaphore_wait> waits = {}) -> VkResult;
 
 private:
 	device                      &m_device;
@@ -59,28 +71,21 @@ private:
 	VkFormat                     m_image_format;
 	VkExtent2D                   m_extent;
 	VkExtent2D                   m_window_extent;
+	b8                           m_supports_capture{ false };
 
-	std::vector<VkFramebuffer>   m_framebuffers;
-	VkRenderPass                 m_render_pass;
-
-	std::vector<VkImage>         m_depth_images;
-	std::vector<VkDeviceMemory>  m_depth_image_memories;
-	std::vector<VkImageView>     m_depth_image_views;
 	std::vector<VkImage>         m_images;
 	std::vector<VkImageView>     m_image_views;
 
 	max_frame_array<VkSemaphore> m_available_images_semaphores;
 	max_frame_array<VkSemaphore> m_render_finished_semaphores;
-	max_frame_array<VkFence>     m_in_flight_fences;
-	std::vector<VkFence>         m_images_in_flight;
+	frame_timeline               m_timeline;
+	std::vector<u64>             m_images_in_flight;  ///< Last frame that rendered to each image
+	core::frame_arenas           m_frame_arenas{ constants::max_frames_in_flight };
 
 	size_t m_current_frame{};
 
 	void construct_swap_chain();
 	void construct_image_views();
-	void construct_render_pass();
-	void construct_depth_resources();
-	void construct_framebuffers();
 	void construct_sync_objects();
 
 	auto select_surface_format(const std::vector<VkSurfaceFormatKHR> &available) -> VkSurfaceFormatKHR;
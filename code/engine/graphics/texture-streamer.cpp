@@ -0,0 +1,483 @@
+#include <array>
+#include <cstdio>
+#include <limits>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+#include <exception>
+
+#include <fmt/core.h>
+
+#include "engine/graphics/texture-streamer.hpp"
+
+namespace vc::engine::graphics {
+
+namespace {
+
+constexpr VkDeviceSize staging_alignment{ 16 };
+
+struct layout_transition {
+	VkImageLayout        old_layout;
+	VkImageLayout        new_layout;
+	VkAccessFlags        src_access;
+	VkAccessFlags        dst_access;
+	VkPipelineStageFlags src_stage;
+	VkPipelineStageFlags dst_stage;
+};
+
+void transition_levels(VkCommandBuffer command_buffer, const VkImage image, const u32 first_level, const u32 levels,
+	const layout_transition &transition, const u32 src_family = VK_QUEUE_FAMILY_IGNORED,
+	const u32 dst_family = VK_QUEUE_FAMILY_IGNORED) {
+	const VkImageMemoryBarrier barrier{
+		.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+		.srcAccessMask       = transition.src_access,
+		.dstAccessMask       = transition.dst_access,
+		.oldLayout           = transition.old_layout,
+		.newLayout           = transition.new_layout,
+		.srcQueueFamilyIndex = src_family,
+		.dstQueueFamilyIndex = dst_family,
+		.image               = image,
+		.subresourceRange    = VkImageSubresourceRange{
+			.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+			.baseMipLevel   = first_level, .levelCount = levels,
+			.baseArrayLayer = 0,           .layerCount = 1,
+		}
+	};
+	vkCmdPipelineBarrier(command_buffer, transition.src_stage, transition.dst_stage,
+		0, 0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+constexpr layout_transition to_transfer_destination{
+	VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+	0, VK_ACCESS_TRANSFER_WRITE_BIT,
+	VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT
+};
+constexpr layout_transition to_blit_source{
+	VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+	VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+	VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT
+};
+constexpr layout_transition blit_source_to_sampled{
+	VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+	VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT,
+	VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
+};
+// The release half only makes the copies available, the acquire half makes them visible again
+constexpr layout_transition release_destination{
+	VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+	VK_ACCESS_TRANSFER_WRITE_BIT, 0,
+	VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT
+};
+constexpr layout_transition acquire_destination{
+	VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+	0, VK_ACCESS_TRANSFER_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT,
+	VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT
+};
+constexpr layout_transition destination_to_sampled{
+	VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+	VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+	VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT
+};
+
+[[nodiscard]] auto can_blit(const device &dev, const VkFormat format) -> b8 {
+	// Blitting needs linear filtering of the format, without it textures keep a single level
+	return dev.supports_format(format, VK_IMAGE_TILING_OPTIMAL,
+		VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT);
+}
+
+[[nodiscard]] auto align_up(const VkDeviceSize size, const VkDeviceSize alignment) noexcept -> VkDeviceSize {
+	return (size + alignment - 1) / alignment * alignment;
+}
+
+} // anonymous namespace
+
+texture_streamer::texture_streamer(device &dev, core::job_system &jobs)
+	: m_device{ dev }, m_jobs{ jobs }, m_samplers{ dev } {
+	const auto &families{ m_device.queue_families() };
+	VkCommandPoolCreateInfo pool_info{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+		.flags            = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+		.queueFamilyIndex = *families.graphics_family
+	};
+	if (VK_SUCCESS != vkCreateCommandPool(m_device.handle(), &pool_info, m_device.allocator(), &m_command_pool)) {
+		throw texture_streamer_error{ "Failed to create the upload command pool." };
+	}
+	if (families.transfer_family.has_value()) {
+		pool_info.queueFamilyIndex = *families.transfer_family;
+		if (VK_SUCCESS != vkCreateCommandPool(m_device.handle(), &pool_info, m_device.allocator(), &m_transfer_pool)) {
+			vkDestroyCommandPool(m_device.handle(), m_command_pool, m_device.allocator());
+			throw texture_streamer_error{ "Failed to create the transfer command pool." };
+		}
+	}
+
+	// Block formats can only be used with the feature enabled, whatever the format properties say
+	constexpr std::array block_formats{ resources::block_format::bc1, resources::block_format::bc3, resources::block_format::bc7 };
+	for (const auto format : block_formats) {
+		for (const auto srgb : { false, true }) {
+			const auto vk_format{ static_cast<VkFormat>(resources::ktx2_vk_format(format, srgb)) };
+			const auto sampled{ m_device.supports_format(vk_format, VK_IMAGE_TILING_OPTIMAL,
+				VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) };
+			if (sampled && m_device.features().textureCompressionBC == VK_TRUE) {
+				m_block_formats.push_back(vk_format);
+			}
+		}
+	}
+	std::printf("[engine][graphics][texture_streamer] %zu of 6 block formats are sampled natively, copies on the %s queue\n",
+		std::size(m_block_formats), m_transfer_pool != VK_NULL_HANDLE ? "transfer" : "graphics");
+}
+
+texture_streamer::~texture_streamer() {
+	// Decode jobs reference the entries, the uploads reference the staging buffers
+	for (auto &entry : m_entries) {
+		if (entry.state != entry_state::decoding) continue;
+		try {
+			m_jobs.wait(entry.counter);
+		} catch (const std::exception &) {
+		}
+	}
+
+	const auto device{ m_device.handle() };
+	for (auto &batch : m_in_flight) {
+		vkWaitForFences(device, 1, &batch.fence, VK_TRUE, std::numeric_limits<u64>::max());
+		vkDestroyFence(device, batch.fence, m_device.allocator());
+		vkDestroySemaphore(device, batch.copied, m_device.allocator());
+	}
+	m_in_flight.clear();
+	vkDestroyCommandPool(device, m_transfer_pool, m_device.allocator());
+	vkDestroyCommandPool(device, m_command_pool, m_device.allocator());
+}
+
+texture_streamer::handle texture_streamer::request(const std::string_view path) {
+	const auto found{ std::ranges::find(m_entries, path, &entry::path) };
+	if (found != std::end(m_entries)) {
+		return static_cast<handle>(std::distance(std::begin(m_entries), found));
+	}
+
+	auto &target{ m_entries.emplace_back() };
+	target.path = path;
+	m_jobs.run(target.counter, [this, &target] {
+		load(target);
+	});
+	return static_cast<handle>(std::size(m_entries) - 1);
+}
+
+void texture_streamer::update() {
+	retire_batches();
+	collect_decoded();
+	submit_batch();
+}
+
+const texture *texture_streamer::get(const handle texture) const noexcept {
+	if (texture >= std::size(m_entries)) return nullptr;
+	const auto &target{ m_entries[texture] };
+	return target.state == entry_state::resident ? &*target.texture : nullptr;
+}
+
+VkSampler texture_streamer::sampler(const handle texture) const noexcept {
+	if (texture >= std::size(m_entries)) return VK_NULL_HANDLE;
+	const auto &target{ m_entries[texture] };
+	return target.state == entry_state::resident ? target.sampler : VK_NULL_HANDLE;
+}
+
+size_t texture_streamer::pending() const noexcept {
+	return static_cast<size_t>(std::ranges::count_if(m_entries, [] (const auto &target) {
+		return target.state != entry_state::resident && target.state != entry_state::failed;
+	}));
+}
+
+void texture_streamer::load(entry &target) const {
+	if (!target.path.ends_with(resources::constants::ktx2_extension)) {
+		target.image = resources::decode_image(target.path);
+		return;
+	}
+
+	auto blocks{ resources::read_ktx2(target.path) };
+	const auto format{ static_cast<VkFormat>(resources::ktx2_vk_format(blocks.format, blocks.srgb)) };
+	if (std::ranges::find(m_block_formats, format) != std::end(m_block_formats)) {
+		target.format = format;
+		target.blocks = std::move(blocks);
+		return;
+	}
+
+	// Without native support only the base level is decoded, its mips are blitted again
+	const auto &base{ blocks.levels.front() };
+	target.format = blocks.srgb ? constants::texture_format : VK_FORMAT_R8G8B8A8_UNORM;
+	target.image = resources::decode_blocks(std::span{ blocks.data }.subspan(base.offset, base.size),
+		base.extent, blocks.format);
+}
+
+std::span<const std::byte> texture_streamer::upload_bytes(const entry &target) noexcept {
+	return target.blocks.has_value() ? std::span{ target.blocks->data } : std::span{ target.image.pixels };
+}
+
+void texture_streamer::retire_batches() {
+	const auto device{ m_device.handle() };
+	// Batches end on the graphics queue, so they complete in submission order
+	while (!std::empty(m_in_flight) && VK_SUCCESS == vkGetFenceStatus(device, m_in_flight.front().fence)) {
+		auto &batch{ m_in_flight.front() };
+
+		for (const auto texture : batch.textures) {
+			auto &target{ m_entries[texture] };
+			target.state = entry_state::resident;
+			std::printf("[engine][graphics][texture_streamer] %s is resident: %ux%u, %u mips\n",
+				std::data(target.path), target.texture->extent().x, target.texture->extent().y,
+				target.texture->mip_levels());
+		}
+		release_batch(batch);
+		m_in_flight.pop_front();
+	}
+}
+
+void texture_streamer::collect_decoded() {
+	for (auto &target : m_entries) {
+		if (target.state != entry_state::decoding || !target.counter.is_done()) continue;
+
+		try {
+			// The job is done, so this only rethrows its error
+			m_jobs.wait(target.counter);
+			target.state = entry_state::decoded;
+		} catch (const std::exception &error) {
+			std::printf("[engine][graphics][texture_streamer] Failed to load %s: %s\n",
+				std::data(target.path), error.what());
+			target.state = entry_state::failed;
+		}
+	}
+}
+
+void texture_streamer::submit_batch() {
+	upload_batch batch;
+	VkDeviceSize staging_size{};
+	for (handle texture{}; texture < std::size(m_entries); ++texture) {
+		const auto &target{ m_entries[texture] };
+		if (target.state != entry_state::decoded) continue;
+
+		// A texture larger than the budget still goes alone in its own batch
+		const auto size{ align_up(std::size(upload_bytes(target)), staging_alignment) };
+		if (!std::empty(batch.textures) && staging_size + size > constants::texture_upload_budget) break;
+		batch.textures.push_back(texture);
+		staging_size += size;
+	}
+	if (std::empty(batch.textures)) return;
+
+	// A failure leaves nothing behind: the batch's objects are released and its textures failed,
+	// otherwise they would stay uploading forever
+	b8 copies_submitted{ false };
+	try {
+		batch.staging.emplace(m_device, staging_size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+
+		// Without a transfer queue both halves are the same command buffer
+		const auto dedicated{ m_transfer_pool != VK_NULL_HANDLE };
+		batch.command_buffer = begin_commands(m_command_pool);
+		if (dedicated) {
+			batch.transfer_command_buffer = begin_commands(m_transfer_pool);
+		}
+		const auto copy_commands{ dedicated ? batch.transfer_command_buffer : batch.command_buffer };
+
+		VkDeviceSize offset{};
+		for (const auto texture : batch.textures) {
+			auto &target{ m_entries[texture] };
+			VkImageUsageFlags usage{ VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT };
+			if (target.blocks.has_value()) {
+				target.texture.emplace(m_device, target.blocks->extent, target.format,
+					static_cast<u32>(std::size(target.blocks->levels)), usage);
+			} else {
+				const auto extent{ target.image.extent };
+				const auto mip_levels{ can_blit(m_device, target.format) ? texture::full_mip_levels(extent) : 1u };
+				if (mip_levels > 1) usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+				target.texture.emplace(m_device, extent, target.format, mip_levels, usage);
+			}
+			target.sampler = m_samplers.get(m_samplers.linear(target.texture->mip_levels()));
+
+			const auto bytes{ upload_bytes(target) };
+			std::memcpy(std::data(batch.staging->bytes()) + offset, std::data(bytes), std::size(bytes));
+			record_copy(copy_commands, batch.staging->handle(), offset, target);
+			if (dedicated) {
+				record_ownership(batch.transfer_command_buffer, batch.command_buffer, *target.texture);
+			}
+			record_finish(batch.command_buffer, target);
+
+			offset += align_up(std::size(bytes), staging_alignment);
+			target.image = {};
+			target.blocks.reset();
+			target.state = entry_state::uploading;
+		}
+		vkEndCommandBuffer(batch.command_buffer);
+
+		const VkFenceCreateInfo fence_info{ .sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO };
+		if (VK_SUCCESS != vkCreateFence(m_device.handle(), &fence_info, m_device.allocator(), &batch.fence)) {
+			throw texture_streamer_error{ "Failed to create an upload fence." };
+		}
+
+		const VkPipelineStageFlags wait_stage{ VK_PIPELINE_STAGE_TRANSFER_BIT };
+		if (dedicated) {
+			vkEndCommandBuffer(batch.transfer_command_buffer);
+
+			const VkSemaphoreCreateInfo semaphore_info{ .sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO };
+			if (VK_SUCCESS != vkCreateSemaphore(m_device.handle(), &semaphore_info, m_device.allocator(), &batch.copied)) {
+				throw texture_streamer_error{ "Failed to create an upload semaphore." };
+			}
+			const VkSubmitInfo transfer_info{
+				.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+				.commandBufferCount   = 1,
+				.pCommandBuffers      = &batch.transfer_command_buffer,
+				.signalSemaphoreCount = 1,
+				.pSignalSemaphores    = &batch.copied
+			};
+			if (VK_SUCCESS != vkQueueSubmit(m_device.transfer_queue(), 1, &transfer_info, VK_NULL_HANDLE)) {
+				throw texture_streamer_error{ fmt::format("Failed to submit the copies of {} textures.", std::size(batch.textures)) };
+			}
+			copies_submitted = true;
+		}
+
+		const VkSubmitInfo submit_info{
+			.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+			.waitSemaphoreCount = dedicated ? 1u : 0u,
+			.pWaitSemaphores    = dedicated ? &batch.copied : nullptr,
+			.pWaitDstStageMask  = dedicated ? &wait_stage : nullptr,
+			.commandBufferCount = 1,
+			.pCommandBuffers    = &batch.command_buffer
+		};
+		if (VK_SUCCESS != vkQueueSubmit(m_device.graphics_queue(), 1, &submit_info, batch.fence)) {
+			throw texture_streamer_error{ fmt::format("Failed to submit the upload of {} textures.", std::size(batch.textures)) };
+		}
+	} catch (const std::exception &error) {
+		if (copies_submitted) {
+			vkQueueWaitIdle(m_device.transfer_queue());
+		}
+		release_batch(batch);
+		for (const auto texture : batch.textures) {
+			auto &target{ m_entries[texture] };
+			std::printf("[engine][graphics][texture_streamer] Failed to upload %s: %s\n",
+				std::data(target.path), error.what());
+			target.texture.reset();
+			target.sampler = VK_NULL_HANDLE;
+			target.image = {};
+			target.blocks.reset();
+			target.state = entry_state::failed;
+		}
+		throw;
+	}
+	m_in_flight.push_back(std::move(batch));
+}
+
+void texture_streamer::release_batch(upload_batch &batch) noexcept {
+	const auto device{ m_device.handle() };
+	if (batch.transfer_command_buffer != VK_NULL_HANDLE) {
+		vkFreeCommandBuffers(device, m_transfer_pool, 1, &batch.transfer_command_buffer);
+		batch.transfer_command_buffer = VK_NULL_HANDLE;
+	}
+	if (batch.command_buffer != VK_NULL_HANDLE) {
+		vkFreeCommandBuffers(device, m_command_pool, 1, &batch.command_buffer);
+		batch.command_buffer = VK_NULL_HANDLE;
+	}
+	vkDestroySemaphore(device, std::exchange(batch.copied, VK_NULL_HANDLE), m_device.allocator());
+	vkDestroyFence(device, std::exchange(batch.fence, VK_NULL_HANDLE), m_device.allocator());
+	// The staging buffer goes through the deletion queue when the batch is destroyed
+}
+
+VkCommandBuffer texture_streamer::begin_commands(const VkCommandPool pool) {
+	const VkCommandBufferAllocateInfo allocate_info{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+		.commandPool        = pool,
+		.level              = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+		.commandBufferCount = 1
+	};
+	VkCommandBuffer command_buffer{ VK_NULL_HANDLE };
+	if (VK_SUCCESS != vkAllocateCommandBuffers(m_device.handle(), &allocate_info, &command_buffer)) {
+		throw texture_streamer_error{ "Failed to allocate an upload command buffer." };
+	}
+
+	const VkCommandBufferBeginInfo begin_info{
+		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+		.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+	};
+	vkBeginCommandBuffer(command_buffer, &begin_info);
+	return command_buffer;
+}
+
+void texture_streamer::record_copy(VkCommandBuffer command_buffer, const VkBuffer staging, const VkDeviceSize offset,
+	const entry &target) {
+	const auto &destination{ *target.texture };
+	const auto image{ destination.image() };
+	transition_levels(command_buffer, image, 0, destination.mip_levels(), to_transfer_destination);
+
+	const auto make_region{ [offset] (const VkDeviceSize level_offset, const u32 level, const glm::u32vec2 extent) {
+		return VkBufferImageCopy{
+			.bufferOffset     = offset + level_offset,
+			.imageSubresource = VkImageSubresourceLayers{
+				.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT,
+				.mipLevel       = level,
+				.baseArrayLayer = 0,
+				.layerCount     = 1
+			},
+			.imageExtent = VkExtent3D{ .width = extent.x, .height = extent.y, .depth = 1 }
+		};
+	} };
+
+	// Block-compressed levels are copied as they are, including the mips baked by the encoder
+	std::vector<VkBufferImageCopy> regions;
+	if (target.blocks.has_value()) {
+		for (u32 level{}; level < std::size(target.blocks->levels); ++level) {
+			const auto &source{ target.blocks->levels[level] };
+			regions.push_back(make_region(source.offset, level, source.extent));
+		}
+	} else {
+		regions.push_back(make_region(0, 0, destination.extent()));
+	}
+	vkCmdCopyBufferToImage(command_buffer, staging, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		static_cast<u32>(std::size(regions)), std::data(regions));
+}
+
+void texture_streamer::record_ownership(VkCommandBuffer release, VkCommandBuffer acquire, const texture &target) {
+	// Both halves name the same families and layouts, the graphics submission waits for the copies
+	const auto &families{ m_device.queue_families() };
+	const auto source{ *families.transfer_family };
+	const auto destination{ *families.graphics_family };
+	transition_levels(release, target.image(), 0, target.mip_levels(), release_destination, source, destination);
+	transition_levels(acquire, target.image(), 0, target.mip_levels(), acquire_destination, source, destination);
+}
+
+void texture_streamer::record_finish(VkCommandBuffer command_buffer, entry &target) {
+	auto &destination{ *target.texture };
+	if (target.blocks.has_value()) {
+		transition_levels(command_buffer, destination.image(), 0, destination.mip_levels(), destination_to_sampled);
+		return;
+	}
+	record_mips(command_buffer, destination);
+}
+
+void texture_streamer::record_mips(VkCommandBuffer command_buffer, texture &target) {
+	const auto image{ target.image() };
+	auto width{ static_cast<i32>(target.extent().x) };
+	auto height{ static_cast<i32>(target.extent().y) };
+
+	// Every level is blitted from the previous one, which becomes sampled once it was read
+	for (u32 level{ 1 }; level < target.mip_levels(); ++level) {
+		const auto next_width{ std::max(width / 2, 1) };
+		const auto next_height{ std::max(height / 2, 1) };
+		transition_levels(command_buffer, image, level - 1, 1, to_blit_source);
+
+		const VkImageBlit blit{
+			.srcSubresource = VkImageSubresourceLayers{
+				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .mipLevel = level - 1, .baseArrayLayer = 0, .layerCount = 1
+			},
+			.srcOffsets = { VkOffset3D{ 0, 0, 0 }, VkOffset3D{ width, height, 1 } },
+			.dstSubresource = VkImageSubresourceLayers{
+				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .mipLevel = level, .baseArrayLayer = 0, .layerCount = 1
+			},
+			.dstOffsets = { VkOffset3D{ 0, 0, 0 }, VkOffset3D{ next_width, next_height, 1 } }
+		};
+		vkCmdBlitImage(command_buffer,
+			image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			1, &blit, VK_FILTER_LINEAR);
+
+		transition_levels(command_buffer, image, level - 1, 1, blit_source_to_sampled);
+		width = next_width;
+		height = next_height;
+	}
+	transition_levels(command_buffer, image, target.mip_levels() - 1, 1, destination_to_sampled);
+}
+
+} // namespace vc::engine::graphics
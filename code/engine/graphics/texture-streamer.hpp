@@ -0,0 +1,123 @@
+#pragma once
+
+#include <span>
+#include <deque>
+#include <string>
+#include <vector>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+
+#include "core/job-system.hpp"
+#include "engine/graphics/buffer.hpp"
+#include "engine/graphics/device.hpp"
+#include "engine/graphics/sampler-cache.hpp"
+#include "engine/graphics/texture.hpp"
+#include "engine/resources/ktx2.hpp"
+#include "engine/resources/image-decoder.hpp"
+
+namespace vc::engine::graphics {
+
+namespace constants {
+
+constexpr VkFormat     texture_format       { VK_FORMAT_R8G8B8A8_SRGB };
+constexpr VkDeviceSize texture_upload_budget{ 32ull << 20 };  ///< Staging bytes submitted per `update`
+
+} // namespace constants
+
+/// Loads textures without stalling the frame: images are decoded on the job system, then every
+/// `update` packs the decoded ones into one staging buffer and submits a single command buffer
+/// that copies them and blits their mip chains. Submissions are tracked by fences polled on the
+/// next updates, nothing waits for the queue.
+///
+/// With a dedicated transfer queue the copies run there and the images are released to the
+/// graphics family, which acquires them after a semaphore and blits the mips.
+///
+/// KTX2 files keep their blocks and precomputed mips when the device samples their format,
+/// otherwise their base level is decoded to RGBA on the worker.
+///
+/// Every texture gets a trilinear sampler for its mip chain from a shared `sampler_cache`.
+class texture_streamer {
+public:
+	using handle = u32;
+
+	texture_streamer(device &device, core::job_system &jobs);
+	~texture_streamer();
+
+	texture_streamer(const texture_streamer &) = delete;
+	texture_streamer &operator=(const texture_streamer &) = delete;
+
+	/// Starts decoding the image at `path`, the same path is loaded only once.
+	[[nodiscard]] auto request(std::string_view path) -> handle;
+
+	/// Retires finished uploads and submits the next batch. Call once per frame from the thread
+	/// that submits to the graphics queue.
+	void update();
+
+	/// Null until the texture is resident, or when it failed to load.
+	[[nodiscard]] auto get(handle texture) const noexcept -> const graphics::texture *;
+	/// Null until the texture is resident.
+	[[nodiscard]] auto sampler(handle texture) const noexcept -> VkSampler;
+	[[nodiscard]] auto samplers() const noexcept -> const sampler_cache & { return m_samplers; }
+	[[nodiscard]] auto pending() const noexcept -> size_t;
+
+private:
+	enum class entry_state : u8 {
+		decoding,
+		decoded,
+		uploading,
+		resident,
+		failed,
+	};
+
+	struct entry {
+		std::string                      path;
+		entry_state                      state { entry_state::decoding };
+		VkFormat                         format{ constants::texture_format };
+		core::job_counter                counter;
+		resources::image                 image;
+		std::optional<resources::compressed_image> blocks;
+		std::optional<graphics::texture> texture;
+		VkSampler                        sampler{ VK_NULL_HANDLE };  ///< Owned by the sampler cache
+	};
+
+	struct upload_batch {
+		VkCommandBuffer       transfer_command_buffer{ VK_NULL_HANDLE };  ///< Copies on the transfer queue
+		VkCommandBuffer       command_buffer{ VK_NULL_HANDLE };
+		VkSemaphore           copied        { VK_NULL_HANDLE };
+		VkFence               fence         { VK_NULL_HANDLE };
+		std::optional<buffer> staging;
+		std::vector<handle>   textures;
+	};
+
+	device            &m_device;
+	core::job_system  &m_jobs;
+	sampler_cache      m_samplers;
+	VkCommandPool      m_command_pool{ VK_NULL_HANDLE };
+	VkCommandPool      m_transfer_pool{ VK_NULL_HANDLE };  ///< Null without a dedicated transfer family
+	std::vector<VkFormat> m_block_formats;  ///< Sampled by the device, read by the decode jobs
+	std::deque<entry>  m_entries;  ///< Decode jobs write into them, so they never move
+	std::deque<upload_batch>  m_in_flight;
+
+	void load(entry &target) const;
+	[[nodiscard]] static auto upload_bytes(const entry &target) noexcept -> std::span<const std::byte>;
+	void retire_batches();
+	void collect_decoded();
+	void submit_batch();
+	/// Frees the command buffers and the synchronization objects of the `batch`.
+	void release_batch(upload_batch &batch) noexcept;
+
+	[[nodiscard]] auto begin_commands(VkCommandPool pool) -> VkCommandBuffer;
+	void record_copy(VkCommandBuffer command_buffer, VkBuffer staging, VkDeviceSize offset, const entry &target);
+	void record_ownership(VkCommandBuffer release, VkCommandBuffer acquire, const graphics::texture &target);
+	void record_finish(VkCommandBuffer command_buffer, entry &target);
+	void record_mips(VkCommandBuffer command_buffer, graphics::texture &target);
+};
+
+class texture_streamer_error : public std::runtime_error {
+public:
+	using base_type = std::runtime_error;
+	using base_type::runtime_error;
+};
+
+} // namespace vc::engine::graphics
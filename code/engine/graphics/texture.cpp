@@ -0,0 +1,70 @@
+#include <bit>
+#include <utility>
+#include <algorithm>
+
+#include <fmt/core.h>
+
+#include "engine/graphics/texture.hpp"
+
+namespace vc::engine::graphics {
+
+texture::texture(device &dev, const glm::u32vec2 extent, const VkFormat format, const u32 mip_levels,
+	const VkImageUsageFlags usage)
+	: m_device{ dev }, m_extent{ extent }, m_format{ format }, m_mip_levels{ mip_levels } {
+	m_image = m_device.make_image(
+		VkImageCreateInfo{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+			.imageType   = VK_IMAGE_TYPE_2D,
+			.format      = format,
+			.extent      = VkExtent3D{ .width = extent.x, .height = extent.y, .depth = 1 },
+			.mipLevels   = mip_levels,
+			.arrayLayers = 1,
+			.samples     = VK_SAMPLE_COUNT_1_BIT,
+			.tiling      = VK_IMAGE_TILING_OPTIMAL,
+			.usage       = usage,
+			.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+		},
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+		m_memory
+	);
+
+	const VkImageViewCreateInfo view_info{
+		.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+		.image            = m_image,
+		.viewType         = VK_IMAGE_VIEW_TYPE_2D,
+		.format           = format,
+		.subresourceRange = VkImageSubresourceRange{
+			.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+			.baseMipLevel   = 0, .levelCount = mip_levels,
+			.baseArrayLayer = 0, .layerCount = 1,
+		}
+	};
+	if (VK_SUCCESS != vkCreateImageView(m_device.handle(), &view_info, m_device.allocator(), &m_view)) {
+		vkDestroyImage(m_device.handle(), m_image, m_device.allocator());
+		m_device.free_memory(m_memory);
+		throw texture_error{ fmt::format("Failed to create the view of a {}x{} texture.", extent.x, extent.y) };
+	}
+}
+
+texture::texture(texture &&other) noexcept
+	: m_device    { other.m_device }
+	, m_image     { std::exchange(other.m_image, VK_NULL_HANDLE) }
+	, m_memory    { std::exchange(other.m_memory, VK_NULL_HANDLE) }
+	, m_view      { std::exchange(other.m_view, VK_NULL_HANDLE) }
+	, m_extent    { other.m_extent }
+	, m_format    { other.m_format }
+	, m_mip_levels{ other.m_mip_levels } {
+}
+
+texture::~texture() {
+	auto &deletions{ m_device.deletions() };
+	deletions.push(m_view);
+	deletions.push(m_image);
+	deletions.push(m_memory);
+}
+
+u32 texture::full_mip_levels(const glm::u32vec2 extent) noexcept {
+	return static_cast<u32>(std::bit_width(std::max({ extent.x, extent.y, 1u })));
+}
+
+} // namespace vc::engine::graphics
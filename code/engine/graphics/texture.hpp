@@ -0,0 +1,47 @@
+#pragma once
+
+#include <stdexcept>
+
+#include <glm/vec2.hpp>
+
+#include "engine/graphics/device.hpp"
+
+namespace vc::engine::graphics {
+
+/// Owns a sampled 2D image with its dedicated memory and a view of the whole mip chain.
+class texture {
+public:
+	texture(device &device, glm::u32vec2 extent, VkFormat format, u32 mip_levels, VkImageUsageFlags usage);
+	~texture();
+
+	texture(const texture &) = delete;
+	texture &operator=(const texture &) = delete;
+	texture(texture &&other) noexcept;
+	texture &operator=(texture &&other) = delete;
+
+	/// Levels of a full chain down to 1x1.
+	[[nodiscard]] static auto full_mip_levels(glm::u32vec2 extent) noexcept -> u32;
+
+	[[nodiscard]] auto image() const noexcept { return m_image; }
+	[[nodiscard]] auto view() const noexcept { return m_view; }
+	[[nodiscard]] auto extent() const noexcept { return m_extent; }
+	[[nodiscard]] auto format() const noexcept { return m_format; }
+	[[nodiscard]] auto mip_levels() const noexcept { return m_mip_levels; }
+
+private:
+	device        &m_device;
+	VkImage        m_image     { VK_NULL_HANDLE };
+	VkDeviceMemory m_memory    { VK_NULL_HANDLE };
+	VkImageView    m_view      { VK_NULL_HANDLE };
+	glm::u32vec2   m_extent    { 0, 0 };
+	VkFormat       m_format    { VK_FORMAT_UNDEFINED };
+	u32            m_mip_levels{ 1 };
+};
+
+class texture_error : public std::runtime_error {
+public:
+	using base_type = std::runtime_error;
+	using base_type::runtime_error;
+};
+
+} // namespace vc::engine::graphics
@@ -1,4 +1,7 @@
+#include <array>
 #include <string>
+#include <cstddef>
+#include <memory_resource>
 #include <algorithm>
 #include <unordered_set>
 
@@ -81,10 +84,11 @@ vulkan_instance::vulkan_instance() {
 
 vulkan_instance::~vulkan_instance() {
 #if defined(VC_DEBUG)
-	destroy_debug_utils_messenger(m_instance, m_debug_messenger, nullptr);
+	destroy_debug_utils_messenger(m_instance, m_debug_messenger, allocator());
 #endif // defined(VC_DEBUG)
 
-	vkDestroyInstance(m_instance, nullptr);
+	vkDestroyInstance(m_instance, allocator());
+	m_host_allocator.print_statistics();
 }
 
 #if defined(VC_DEBUG)
@@ -107,7 +111,7 @@ VkDebugUtilsMessengerCreateInfoEXT vulkan_instance::make_debug_messenger_create_
 
 void vulkan_instance::construct_debug_messenger() {
 	const auto create_info{ make_debug_messenger_create_info() };
-	m_debug_messenger = create_debug_utils_messenger(m_instance, &create_info, nullptr);
+	m_debug_messenger = create_debug_utils_messenger(m_instance, &create_info, allocator());
 	if (m_debug_messenger == nullptr) {
 		throw vulkan_instance_error{ "Failed to construct the debug messenger." };
 	}
@@ -145,16 +149,27 @@ void vulkan_instance::construct_instance() {
 	const auto debug_create_info{ make_debug_messenger_create_info() };
 #endif // defined(VC_DEBUG)
 
+	// A 1.0 loader lacks the function, and rejects any higher version
+	const auto enumerate_version{ reinterpret_cast<PFN_vkEnumerateInstanceVersion>(
+		vkGetInstanceProcAddr(VK_NULL_HANDLE, "vkEnumerateInstanceVersion")
+	) };
+	if (u32 version{}; enumerate_version != nullptr && VK_SUCCESS == enumerate_version(&version)) {
+		m_api_version = std::min(version, constants::max_api_version);
+	}
+
 	const VkApplicationInfo application_info{
 		.sType              = VK_STRUCTURE_TYPE_APPLICATION_INFO,
 		.pApplicationName   = std::data(core::info::application::name),
 		.applicationVersion = core::info::application::version::bits,
 		.pEngineName        = "vulkan-course-engine",
 		.engineVersion      = VK_MAKE_VERSION(1, 0, 0),
-		.apiVersion         = VK_API_VERSION_1_0
+		.apiVersion         = m_api_version
 	};
 
-	const auto extensions{ required_extensions() };
+	// A handful of names, kept on the stack
+	std::array<std::byte, 512> scratch_buffer;
+	std::pmr::monotonic_buffer_resource scratch{ std::data(scratch_buffer), std::size(scratch_buffer) };
+	const auto extensions{ required_extensions(&scratch) };
 	const VkInstanceCreateInfo create_info{
 		.sType                   = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO,
 #if defined(VC_DEBUG)
@@ -169,24 +184,24 @@ void vulkan_instance::construct_instance() {
 		.ppEnabledExtensionNames = std::data(extensions)
 	};
 
-	if (VK_SUCCESS != vkCreateInstance(&create_info, nullptr, &m_instance)) {
+	if (VK_SUCCESS != vkCreateInstance(&create_info, allocator(), &m_instance)) {
 		throw vulkan_instance_error{ "Failed to create the vulkan instance." };
 	}
 
 	has_glfw_required_instance_extensions();
 }
 
-std::vector<const char *> vulkan_instance::required_extensions() const {
+std::pmr::vector<const char *> vulkan_instance::required_extensions(std::pmr::memory_resource *resource) const {
 	u32 glfw_extensions_count{};
 	const char **glfw_extensions{ glfwGetRequiredInstanceExtensions(&glfw_extensions_count) };
 
 #if defined(VC_DEBUG)
-	std::vector<const char *> extensions(glfw_extensions_count + 1);
+	std::pmr::vector<const char *> extensions(glfw_extensions_count + 1, resource);
 	std::copy_n(glfw_extensions, glfw_extensions_count, std::data(extensions));
 	extensions.back() = VK_EXT_DEBUG_UTILS_EXTENSION_NAME;
 	return extensions;
 #else
-	return std::vector<const char *>(glfw_extensions, glfw_extensions + glfw_extensions_count);
+	return std::pmr::vector<const char *>(glfw_extensions, glfw_extensions + glfw_extensions_count, resource);
 #endif // defined(VC_DEBUG)
 }
 
@@ -2,10 +2,14 @@
 
 #include <array>
 #include <vector>
+#include <memory_resource>
 #include <stdexcept>
 
 #include <vulkan/vulkan.h>
 
+#include "core/types.hpp"
+#include "engine/graphics/host-allocator.hpp"
+
 namespace vc::engine::graphics {
 
 namespace constants {
@@ -14,6 +18,9 @@ constexpr std::array validation_layers{
 	"VK_LAYER_KHRONOS_validation"
 };
 
+/// Highest version the engine uses, older loaders and devices stay on their own version.
+constexpr u32 max_api_version{ VK_API_VERSION_1_3 };
+
 } // namespace constants
 
 class vulkan_instance {
@@ -25,9 +32,15 @@ public:
 	vulkan_instance &operator=(const vulkan_instance&) = delete;
 
 	[[nodiscard]] auto handle() const noexcept { return m_instance; };
+	[[nodiscard]] auto api_version() const noexcept { return m_api_version; }
+	/// Passed to every object of the instance and its devices.
+	[[nodiscard]] auto allocator() const noexcept { return m_host_allocator.callbacks(); }
+	[[nodiscard]] auto host_allocator() const noexcept -> const graphics::host_allocator & { return m_host_allocator; }
 
 private:
-	VkInstance m_instance{ VK_NULL_HANDLE };
+	graphics::host_allocator m_host_allocator;  ///< Destroyed last
+	VkInstance m_instance   { VK_NULL_HANDLE };
+	u32        m_api_version{ VK_API_VERSION_1_0 };
 
 #if defined(VC_DEBUG)
 	VkDebugUtilsMessengerEXT m_debug_messenger{ VK_NULL_HANDLE };
@@ -39,7 +52,8 @@ private:
 
 	void construct_instance();
 
-	auto required_extensions() const -> std::vector<const char *>;
+	auto required_extensions(std::pmr::memory_resource *resource = std::pmr::get_default_resource()) const
+		-> std::pmr::vector<const char *>;
 	void has_glfw_required_instance_extensions() const;
 };
 
@@ -0,0 +1,640 @@
+#include <cmath>
+#include <array>
+#include <limits>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+
+#include <fmt/core.h>
+
+#include "engine/resources/block-compression.hpp"
+
+namespace vc::engine::resources {
+
+namespace {
+
+using texel       = std::array<u8, 4>;
+using texel_block = std::array<texel, 16>;
+
+constexpr std::array<u32, 4>  bc7_weights_2{ 0, 21, 43, 64 };
+constexpr std::array<u32, 8>  bc7_weights_3{ 0, 9, 18, 27, 37, 46, 55, 64 };
+constexpr std::array<u32, 16> bc7_weights_4{ 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+#pragma region texels
+
+[[nodiscard]] auto blocks_count(const glm::u32vec2 extent) noexcept -> glm::u32vec2 {
+	return { (extent.x + 3) / 4, (extent.y + 3) / 4 };
+}
+
+/// Texels outside of the image repeat the last row and column.
+[[nodiscard]] auto fetch_block(const image &source, const u32 block_x, const u32 block_y) noexcept -> texel_block {
+	texel_block block;
+	for (u32 y{}; y < 4; ++y) {
+		const auto row{ std::min(block_y * 4 + y, source.extent.y - 1) };
+		for (u32 x{}; x < 4; ++x) {
+			const auto column{ std::min(block_x * 4 + x, source.extent.x - 1) };
+			std::memcpy(&block[y * 4 + x], std::data(source.pixels) + (size_t{ row } * source.extent.x + column) * 4, 4);
+		}
+	}
+	return block;
+}
+
+void store_block(image &target, const u32 block_x, const u32 block_y, const texel_block &block) noexcept {
+	for (u32 y{}; y < 4 && block_y * 4 + y < target.extent.y; ++y) {
+		for (u32 x{}; x < 4 && block_x * 4 + x < target.extent.x; ++x) {
+			const auto pixel{ size_t{ block_y * 4 + y } * target.extent.x + block_x * 4 + x };
+			std::memcpy(std::data(target.pixels) + pixel * 4, &block[y * 4 + x], 4);
+		}
+	}
+}
+
+[[nodiscard]] auto distance(const texel &lhs, const texel &rhs, const u32 channels) noexcept -> u32 {
+	u32 result{};
+	for (u32 channel{}; channel < channels; ++channel) {
+		const auto difference{ static_cast<i32>(lhs[channel]) - static_cast<i32>(rhs[channel]) };
+		result += static_cast<u32>(difference * difference);
+	}
+	return result;
+}
+
+template<size_t Size>
+[[nodiscard]] auto nearest(const std::array<texel, Size> &palette, const texel &color, const u32 channels) noexcept -> u32 {
+	u32 best{};
+	auto best_distance{ std::numeric_limits<u32>::max() };
+	for (u32 index{}; index < Size; ++index) {
+		if (const auto current{ distance(palette[index], color, channels) }; current < best_distance) {
+			best = index;
+			best_distance = current;
+		}
+	}
+	return best;
+}
+
+/// Bounding box of the block shrunk by 1/16th of its range. Its diagonal follows the colors: a
+/// channel that decreases while the widest one increases gets its endpoints swapped.
+void fit_endpoints(const texel_block &block, const u32 channels, texel &low, texel &high) noexcept {
+	std::array<i32, 4> mean{};
+	low = texel{ 255, 255, 255, 255 };
+	high = texel{ 0, 0, 0, 0 };
+	for (const auto &color : block) {
+		for (u32 channel{}; channel < channels; ++channel) {
+			mean[channel] += color[channel];
+			low[channel] = std::min(low[channel], color[channel]);
+			high[channel] = std::max(high[channel], color[channel]);
+		}
+	}
+
+	u32 widest{};
+	for (u32 channel{}; channel < channels; ++channel) {
+		mean[channel] /= static_cast<i32>(std::size(block));
+		if (high[channel] - low[channel] > high[widest] - low[widest]) widest = channel;
+	}
+
+	for (u32 channel{}; channel < channels; ++channel) {
+		i32 covariance{};
+		for (const auto &color : block) {
+			covariance += (color[widest] - mean[widest]) * (color[channel] - mean[channel]);
+		}
+
+		const auto inset{ (high[channel] - low[channel]) / 16 };
+		low[channel] = static_cast<u8>(low[channel] + inset);
+		high[channel] = static_cast<u8>(high[channel] - inset);
+		if (covariance < 0) std::swap(low[channel], high[channel]);
+	}
+}
+
+[[nodiscard]] auto srgb_to_linear(const u8 value) noexcept -> f32 {
+	static const auto table{ [] {
+		std::array<f32, 256> result;
+		for (size_t i{}; i < std::size(result); ++i) {
+			const auto color{ static_cast<f32>(i) / 255.0f };
+			result[i] = color <= 0.04045f ? color / 12.92f : std::pow((color + 0.055f) / 1.055f, 2.4f);
+		}
+		return result;
+	}() };
+	return table[value];
+}
+
+[[nodiscard]] auto linear_to_srgb(const f32 value) noexcept -> u8 {
+	const auto color{ value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f };
+	return static_cast<u8>(std::clamp(color * 255.0f + 0.5f, 0.0f, 255.0f));
+}
+
+/// Averages every 2x2 quad, odd edges reuse their last row or column.
+[[nodiscard]] auto downsample(const image &source, const b8 srgb) -> image {
+	const glm::u32vec2 extent{ std::max(source.extent.x / 2, 1u), std::max(source.extent.y / 2, 1u) };
+	image result{ .extent = extent, .pixels = std::vector<std::byte>(size_t{ extent.x } * extent.y * 4) };
+
+	const auto sample{ [&source] (const u32 x, const u32 y, const u32 channel) {
+		const auto pixel{ size_t{ std::min(y, source.extent.y - 1) } * source.extent.x + std::min(x, source.extent.x - 1) };
+		return static_cast<u8>(source.pixels[pixel * 4 + channel]);
+	} };
+
+	for (u32 y{}; y < extent.y; ++y) {
+		for (u32 x{}; x < extent.x; ++x) {
+			auto *destination{ std::data(result.pixels) + (size_t{ y } * extent.x + x) * 4 };
+			for (u32 channel{}; channel < 4; ++channel) {
+				const std::array quad{
+					sample(x * 2, y * 2, channel),     sample(x * 2 + 1, y * 2, channel),
+					sample(x * 2, y * 2 + 1, channel), sample(x * 2 + 1, y * 2 + 1, channel)
+				};
+				if (srgb && channel < 3) {
+					f32 sum{};
+					for (const auto value : quad) sum += srgb_to_linear(value);
+					destination[channel] = static_cast<std::byte>(linear_to_srgb(sum / 4.0f));
+				} else {
+					destination[channel] = static_cast<std::byte>((quad[0] + quad[1] + quad[2] + quad[3] + 2) / 4);
+				}
+			}
+		}
+	}
+	return result;
+}
+
+#pragma endregion texels
+
+#pragma region bc1 and bc3
+
+[[nodiscard]] auto to_565(const texel &color) noexcept -> u16 {
+	return static_cast<u16>((color[0] * 31 + 127) / 255 << 11 | (color[1] * 63 + 127) / 255 << 5 | (color[2] * 31 + 127) / 255);
+}
+
+[[nodiscard]] auto from_565(const u16 value) noexcept -> texel {
+	const auto red{ value >> 11 & 0x1F }, green{ value >> 5 & 0x3F }, blue{ value & 0x1F };
+	return texel{
+		static_cast<u8>(red << 3 | red >> 2),
+		static_cast<u8>(green << 2 | green >> 4),
+		static_cast<u8>(blue << 3 | blue >> 2),
+		255
+	};
+}
+
+/// Four colors when `c0 > c1` or in BC3, otherwise three and transparent black.
+[[nodiscard]] auto color_palette(const u16 c0, const u16 c1, const b8 four_colors) noexcept -> std::array<texel, 4> {
+	std::array palette{ from_565(c0), from_565(c1), texel{}, texel{} };
+	for (u32 channel{}; channel < 3; ++channel) {
+		const auto first{ palette[0][channel] }, second{ palette[1][channel] };
+		if (four_colors) {
+			palette[2][channel] = static_cast<u8>((2 * first + second + 1) / 3);
+			palette[3][channel] = static_cast<u8>((first + 2 * second + 1) / 3);
+		} else {
+			palette[2][channel] = static_cast<u8>((first + second + 1) / 2);
+		}
+	}
+	palette[2][3] = 255;
+	palette[3][3] = four_colors ? 255 : 0;
+	return palette;
+}
+
+[[nodiscard]] auto alpha_palette(const u8 a0, const u8 a1) noexcept -> std::array<texel, 8> {
+	std::array<texel, 8> palette{};
+	palette[0][0] = a0;
+	palette[1][0] = a1;
+	if (a0 > a1) {
+		for (u32 i{ 1 }; i < 7; ++i) {
+			palette[i + 1][0] = static_cast<u8>(((7 - i) * a0 + i * a1 + 3) / 7);
+		}
+	} else {
+		for (u32 i{ 1 }; i < 5; ++i) {
+			palette[i + 1][0] = static_cast<u8>(((5 - i) * a0 + i * a1 + 2) / 5);
+		}
+		palette[6][0] = 0;
+		palette[7][0] = 255;
+	}
+	return palette;
+}
+
+void encode_color(const texel_block &block, std::byte *destination) noexcept {
+	texel low, high;
+	fit_endpoints(block, 3, low, high);
+
+	auto c0{ to_565(high) }, c1{ to_565(low) };
+	if (c0 < c1) std::swap(c0, c1);
+
+	// Equal endpoints would select the three color mode, every texel then uses the first one
+	u32 indices{};
+	if (c0 != c1) {
+		const auto palette{ color_palette(c0, c1, true) };
+		for (u32 i{}; i < std::size(block); ++i) {
+			indices |= nearest(palette, block[i], 3) << (i * 2);
+		}
+	}
+
+	std::memcpy(destination, &c0, sizeof(c0));
+	std::memcpy(destination + 2, &c1, sizeof(c1));
+	std::memcpy(destination + 4, &indices, sizeof(indices));
+}
+
+void encode_alpha(const texel_block &block, std::byte *destination) noexcept {
+	u8 low{ 255 }, high{ 0 };
+	for (const auto &color : block) {
+		low = std::min(low, color[3]);
+		high = std::max(high, color[3]);
+	}
+
+	u64 indices{};
+	if (high != low) {
+		const auto palette{ alpha_palette(high, low) };
+		for (u32 i{}; i < std::size(block); ++i) {
+			indices |= u64{ nearest(palette, texel{ block[i][3] }, 1) } << (i * 3);
+		}
+	}
+
+	destination[0] = static_cast<std::byte>(high);
+	destination[1] = static_cast<std::byte>(low);
+	std::memcpy(destination + 2, &indices, 6);
+}
+
+void decode_color(const std::byte *source, const b8 always_four_colors, texel_block &block) noexcept {
+	u16 c0, c1;
+	u32 indices;
+	std::memcpy(&c0, source, sizeof(c0));
+	std::memcpy(&c1, source + 2, sizeof(c1));
+	std::memcpy(&indices, source + 4, sizeof(indices));
+
+	const auto palette{ color_palette(c0, c1, always_four_colors || c0 > c1) };
+	for (u32 i{}; i < std::size(block); ++i) {
+		block[i] = palette[indices >> (i * 2) & 0x3];
+	}
+}
+
+void decode_alpha(const std::byte *source, texel_block &block) noexcept {
+	u64 indices{};
+	std::memcpy(&indices, source + 2, 6);
+
+	const auto palette{ alpha_palette(static_cast<u8>(source[0]), static_cast<u8>(source[1])) };
+	for (u32 i{}; i < std::size(block); ++i) {
+		block[i][3] = palette[indices >> (i * 3) & 0x7][0];
+	}
+}
+
+#pragma endregion bc1 and bc3
+
+#pragma region bc7
+
+struct bc7_mode {
+	u32 subsets;
+	u32 partition_bits;
+	u32 rotation_bits;
+	u32 index_selection_bits;
+	u32 color_bits;
+	u32 alpha_bits;            ///< Zero when the alpha is opaque
+	b8  endpoint_pbits;        ///< A p-bit per endpoint
+	b8  shared_pbits;          ///< A p-bit per subset
+	u32 primary_bits;
+	u32 secondary_bits;
+};
+
+constexpr std::array<bc7_mode, 8> bc7_modes{ {
+	{ 3, 4, 0, 0, 4, 0, true,  false, 3, 0 },
+	{ 2, 6, 0, 0, 6, 0, false, true,  3, 0 },
+	{ 3, 6, 0, 0, 5, 0, false, false, 2, 0 },
+	{ 2, 6, 0, 0, 7, 0, true,  false, 2, 0 },
+	{ 1, 0, 2, 1, 5, 6, false, false, 2, 3 },
+	{ 1, 0, 2, 0, 7, 8, false, false, 2, 2 },
+	{ 1, 0, 0, 0, 7, 7, true,  false, 4, 0 },
+	{ 2, 6, 0, 0, 5, 5, true,  false, 2, 0 },
+} };
+
+/// Subset of every texel, one bit per texel.
+constexpr std::array<u16, 64> bc7_partitions_2{
+	0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+	0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+	0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+	0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+	0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A,
+	0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+	0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C,
+	0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22,
+};
+
+/// Subset of every texel, two bits per texel.
+constexpr std::array<u32, 64> bc7_partitions_3{
+	0xAA685050, 0x6A5A5040, 0x5A5A4200, 0x5450A0A8, 0xA5A50000, 0xA0A05050, 0x5555A0A0, 0x5A5A5050,
+	0xAA550000, 0xAA555500, 0xAAAA5500, 0x90909090, 0x94949494, 0xA4A4A4A4, 0xA9A59450, 0x2A0A4250,
+	0xA5945040, 0x0A425054, 0xA5A5A500, 0x55A0A0A0, 0xA8A85454, 0x6A6A4040, 0xA4A45000, 0x1A1A0500,
+	0x0050A4A4, 0xAAA59090, 0x14696914, 0x69691400, 0xA08585A0, 0xAA821414, 0x50A4A450, 0x6A5A0200,
+	0xA9A58000, 0x5090A0A8, 0xA8A09050, 0x24242424, 0x00AA5500, 0x24924924, 0x24499224, 0x50A50A50,
+	0x500AA550, 0xAAAA4444, 0x66660000, 0xA5A0A5A0, 0x50A050A0, 0x69286928, 0x44AAAA44, 0x66666600,
+	0xAA444444, 0x54A854A8, 0x95809580, 0x96969600, 0xA85454A8, 0x80959580, 0xAA141414, 0x96960000,
+	0xAAAA1414, 0xA05050A0, 0xA0A5A5A0, 0x96000000, 0x40804080, 0xA9A8A9A8, 0xAAAAAA44, 0x2A4A5254,
+};
+
+/// Texels whose index drops its top bit, besides the first one.
+constexpr std::array<u8, 64> bc7_anchors_2{
+	15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+	15,  2,  8,  2,  2,  8,  8, 15,  2,  8,  2,  2,  8,  8,  2,  2,
+	15, 15,  6,  8,  2,  8, 15, 15,  2,  8,  2,  2,  2, 15, 15,  6,
+	 6,  2,  6,  8, 15, 15,  2,  2, 15, 15, 15, 15, 15,  2,  2, 15,
+};
+
+constexpr std::array<std::array<u8, 2>, 64> bc7_anchors_3{ {
+	{  3, 15 }, {  3,  8 }, { 15,  8 }, { 15,  3 }, {  8, 15 }, {  3, 15 }, { 15,  3 }, { 15,  8 },
+	{  8, 15 }, {  8, 15 }, {  6, 15 }, {  6, 15 }, {  6, 15 }, {  5, 15 }, {  3, 15 }, {  3,  8 },
+	{  3, 15 }, {  3,  8 }, {  8, 15 }, { 15,  3 }, {  3, 15 }, {  3,  8 }, {  6, 15 }, { 10,  8 },
+	{  5,  3 }, {  8, 15 }, {  8,  6 }, {  6, 10 }, {  8, 15 }, {  5, 15 }, { 15, 10 }, { 15,  8 },
+	{  8, 15 }, { 15,  3 }, {  3, 15 }, {  5, 10 }, {  6, 10 }, { 10,  8 }, {  8,  9 }, { 15, 10 },
+	{ 15,  6 }, {  3, 15 }, { 15,  8 }, {  5, 15 }, { 15,  3 }, { 15,  6 }, { 15,  6 }, { 15,  8 },
+	{  3, 15 }, { 15,  3 }, {  5, 15 }, {  5, 15 }, {  5, 15 }, {  8, 15 }, {  5, 15 }, { 10, 15 },
+	{  5, 15 }, { 10, 15 }, {  8, 15 }, { 13, 15 }, { 15,  3 }, { 12, 15 }, {  3, 15 }, {  3,  8 },
+} };
+
+class bit_writer {
+public:
+	void put(const u32 value, const u32 bits) noexcept {
+		for (u32 bit{}; bit < bits; ++bit, ++m_position) {
+			m_words[m_position / 64] |= u64{ value >> bit & 1 } << (m_position % 64);
+		}
+	}
+
+	void store(std::byte *destination) const noexcept { std::memcpy(destination, std::data(m_words), sizeof(m_words)); }
+
+private:
+	std::array<u64, 2> m_words{};
+	u32                m_position{};
+};
+
+class bit_reader {
+public:
+	explicit bit_reader(const std::byte *source) noexcept { std::memcpy(std::data(m_words), source, sizeof(m_words)); }
+
+	[[nodiscard]] auto get(const u32 bits) noexcept -> u32 {
+		u32 value{};
+		for (u32 bit{}; bit < bits && m_position < 128; ++bit, ++m_position) {
+			value |= static_cast<u32>(m_words[m_position / 64] >> (m_position % 64) & 1) << bit;
+		}
+		return value;
+	}
+
+private:
+	std::array<u64, 2> m_words{};
+	u32                m_position{};
+};
+
+[[nodiscard]] auto interpolate(const u32 e0, const u32 e1, const u32 weight) noexcept -> u8 {
+	return static_cast<u8>(((64 - weight) * e0 + weight * e1 + 32) >> 6);
+}
+
+/// Splits an endpoint into 7 bit channels and the shared p-bit that reconstructs it best.
+[[nodiscard]] auto quantize_mode6(const texel &endpoint, texel &quantized) noexcept -> u32 {
+	u32 best_pbit{};
+	auto best_error{ std::numeric_limits<u32>::max() };
+	for (u32 pbit{}; pbit < 2; ++pbit) {
+		texel candidate;
+		u32 error{};
+		for (u32 channel{}; channel < 4; ++channel) {
+			const auto value{ std::clamp((static_cast<i32>(endpoint[channel]) - static_cast<i32>(pbit) + 1) >> 1, 0, 127) };
+			candidate[channel] = static_cast<u8>(value);
+			const auto difference{ (value << 1 | static_cast<i32>(pbit)) - static_cast<i32>(endpoint[channel]) };
+			error += static_cast<u32>(difference * difference);
+		}
+		if (error < best_error) {
+			best_error = error;
+			best_pbit = pbit;
+			quantized = candidate;
+		}
+	}
+	return best_pbit;
+}
+
+/// Mode 6 only: one subset, RGBA endpoints with 7 bits and a p-bit per channel and 4 bit indices.
+void encode_bc7(const texel_block &block, std::byte *destination) noexcept {
+	texel low, high;
+	fit_endpoints(block, 4, low, high);
+
+	std::array<texel, 2> quantized;
+	std::array pbits{ quantize_mode6(low, quantized[0]), quantize_mode6(high, quantized[1]) };
+
+	std::array<i32, 4> origin, axis;
+	i32 length{};
+	for (u32 channel{}; channel < 4; ++channel) {
+		origin[channel] = quantized[0][channel] << 1 | static_cast<i32>(pbits[0]);
+		axis[channel] = (quantized[1][channel] << 1 | static_cast<i32>(pbits[1])) - origin[channel];
+		length += axis[channel] * axis[channel];
+	}
+
+	std::array<u32, 16> indices{};
+	if (length > 0) {
+		for (u32 i{}; i < std::size(block); ++i) {
+			i32 projection{};
+			for (u32 channel{}; channel < 4; ++channel) {
+				projection += (block[i][channel] - origin[channel]) * axis[channel];
+			}
+			const auto weight{ std::clamp(projection * 64 / length, 0, 64) };
+			indices[i] = static_cast<u32>(std::distance(std::begin(bc7_weights_4), std::ranges::min_element(bc7_weights_4,
+				{}, [weight] (const u32 candidate) { return std::abs(static_cast<i32>(candidate) - weight); })));
+		}
+	}
+
+	// The anchor index drops its top bit, flipping the endpoints makes it zero
+	if (indices[0] >= 8) {
+		std::swap(quantized[0], quantized[1]);
+		std::swap(pbits[0], pbits[1]);
+		for (auto &index : indices) index = 15 - index;
+	}
+
+	bit_writer writer;
+	writer.put(1u << 6, 7);
+	for (u32 channel{}; channel < 4; ++channel) {
+		writer.put(quantized[0][channel], 7);
+		writer.put(quantized[1][channel], 7);
+	}
+	writer.put(pbits[0], 1);
+	writer.put(pbits[1], 1);
+	for (u32 i{}; i < std::size(indices); ++i) {
+		writer.put(indices[i], i == 0 ? 3 : 4);
+	}
+	writer.store(destination);
+}
+
+[[nodiscard]] auto bc7_weights(const u32 bits) noexcept -> std::span<const u32> {
+	switch (bits) {
+		case 2:  return bc7_weights_2;
+		case 3:  return bc7_weights_3;
+		default: return bc7_weights_4;
+	}
+}
+
+[[nodiscard]] auto bc7_subset(const bc7_mode &mode, const u32 partition, const u32 texel) noexcept -> u32 {
+	switch (mode.subsets) {
+		case 2:  return bc7_partitions_2[partition] >> texel & 1;
+		case 3:  return bc7_partitions_3[partition] >> (texel * 2) & 3;
+		default: return 0;
+	}
+}
+
+[[nodiscard]] auto bc7_is_anchor(const bc7_mode &mode, const u32 partition, const u32 texel) noexcept -> b8 {
+	switch (mode.subsets) {
+		case 2:  return texel == 0 || texel == bc7_anchors_2[partition];
+		case 3:  return texel == 0 || texel == bc7_anchors_3[partition][0] || texel == bc7_anchors_3[partition][1];
+		default: return texel == 0;
+	}
+}
+
+void decode_bc7(const std::byte *source, texel_block &block) noexcept {
+	bit_reader reader{ source };
+
+	u32 mode_index{};
+	while (mode_index < 8 && reader.get(1) == 0) ++mode_index;
+	if (mode_index == 8) {
+		// Reserved mode, decoders output transparent black
+		block.fill(texel{});
+		return;
+	}
+	const auto &mode{ bc7_modes[mode_index] };
+
+	const auto partition{ reader.get(mode.partition_bits) };
+	const auto rotation{ reader.get(mode.rotation_bits) };
+	const auto index_selection{ reader.get(mode.index_selection_bits) };
+
+	// Each channel lists the endpoints of every subset in turn
+	const auto endpoints_count{ mode.subsets * 2 };
+	std::array<std::array<u32, 4>, 6> endpoints{};
+	for (u32 channel{}; channel < 4; ++channel) {
+		const auto bits{ channel < 3 ? mode.color_bits : mode.alpha_bits };
+		for (u32 endpoint{}; endpoint < endpoints_count; ++endpoint) {
+			endpoints[endpoint][channel] = reader.get(bits);
+		}
+	}
+
+	auto precision{ std::array{ mode.color_bits, mode.alpha_bits } };
+	if (mode.endpoint_pbits || mode.shared_pbits) {
+		std::array<u32, 6> pbits{};
+		for (u32 endpoint{}; endpoint < endpoints_count; ++endpoint) {
+			pbits[endpoint] = mode.shared_pbits && endpoint % 2 == 1 ? pbits[endpoint - 1] : reader.get(1);
+		}
+		for (u32 endpoint{}; endpoint < endpoints_count; ++endpoint) {
+			for (u32 channel{}; channel < (mode.alpha_bits != 0 ? 4u : 3u); ++channel) {
+				endpoints[endpoint][channel] = endpoints[endpoint][channel] << 1 | pbits[endpoint];
+			}
+		}
+		++precision[0];
+		if (mode.alpha_bits != 0) ++precision[1];
+	}
+	for (u32 endpoint{}; endpoint < endpoints_count; ++endpoint) {
+		for (u32 channel{}; channel < 4; ++channel) {
+			auto &value{ endpoints[endpoint][channel] };
+			const auto bits{ precision[channel < 3 ? 0 : 1] };
+			if (bits == 0) {
+				value = 255;
+			} else if (bits < 8) {
+				value = value << (8 - bits) | value >> (2 * bits - 8);
+			}
+		}
+	}
+
+	std::array<u32, 16> primary{}, secondary{};
+	for (u32 i{}; i < std::size(primary); ++i) {
+		primary[i] = reader.get(bc7_is_anchor(mode, partition, i) ? mode.primary_bits - 1 : mode.primary_bits);
+	}
+	if (mode.secondary_bits != 0) {
+		for (u32 i{}; i < std::size(secondary); ++i) {
+			secondary[i] = reader.get(i == 0 ? mode.secondary_bits - 1 : mode.secondary_bits);
+		}
+	}
+
+	const auto primary_bits{ mode.primary_bits };
+	const auto secondary_bits{ mode.secondary_bits };
+	const auto &color_indices{ index_selection != 0 ? secondary : primary };
+	const auto &alpha_indices{ secondary_bits == 0 ? primary : index_selection != 0 ? primary : secondary };
+	const auto color_weights{ bc7_weights(index_selection != 0 ? secondary_bits : primary_bits) };
+	const auto alpha_weights{ bc7_weights(secondary_bits == 0 ? primary_bits : index_selection != 0 ? primary_bits : secondary_bits) };
+
+	for (u32 i{}; i < std::size(block); ++i) {
+		const auto subset{ bc7_subset(mode, partition, i) };
+		const auto &low{ endpoints[subset * 2] };
+		const auto &high{ endpoints[subset * 2 + 1] };
+
+		auto &color{ block[i] };
+		for (u32 channel{}; channel < 3; ++channel) {
+			color[channel] = interpolate(low[channel], high[channel], color_weights[color_indices[i]]);
+		}
+		color[3] = interpolate(low[3], high[3], alpha_weights[alpha_indices[i]]);
+		if (rotation != 0) std::swap(color[3], color[rotation - 1]);
+	}
+}
+
+#pragma endregion bc7
+
+} // anonymous namespace
+
+compressed_image compress_image(const image &source, const block_format format, const b8 srgb, const b8 mips) {
+	compressed_image result{ .format = format, .srgb = srgb, .extent = source.extent };
+
+	const image *level{ &source };
+	image downsampled;
+	while (true) {
+		auto blocks{ encode_blocks(*level, format) };
+		result.levels.push_back(compressed_level{
+			.offset = std::size(result.data),
+			.size   = std::size(blocks),
+			.extent = level->extent
+		});
+		result.data.insert(std::end(result.data), std::begin(blocks), std::end(blocks));
+
+		if (!mips || (level->extent.x == 1 && level->extent.y == 1)) break;
+		downsampled = downsample(*level, srgb);
+		level = &downsampled;
+	}
+	return result;
+}
+
+std::vector<std::byte> encode_blocks(const image &source, const block_format format) {
+	const auto blocks{ blocks_count(source.extent) };
+	std::vector<std::byte> result(level_size(format, source.extent));
+
+	auto *destination{ std::data(result) };
+	for (u32 block_y{}; block_y < blocks.y; ++block_y) {
+		for (u32 block_x{}; block_x < blocks.x; ++block_x, destination += block_size(format)) {
+			const auto block{ fetch_block(source, block_x, block_y) };
+			switch (format) {
+				case block_format::bc1:
+					encode_color(block, destination);
+					break;
+				case block_format::bc3:
+					encode_alpha(block, destination);
+					encode_color(block, destination + 8);
+					break;
+				case block_format::bc7:
+					encode_bc7(block, destination);
+					break;
+			}
+		}
+	}
+	return result;
+}
+
+image decode_blocks(const std::span<const std::byte> blocks, const glm::u32vec2 extent, const block_format format) {
+	if (std::size(blocks) < level_size(format, extent)) {
+		throw block_compression_error{ fmt::format("{} bytes of blocks can't hold a {}x{} level.",
+			std::size(blocks), extent.x, extent.y) };
+	}
+
+	image result{ .extent = extent, .pixels = std::vector<std::byte>(size_t{ extent.x } * extent.y * 4) };
+	const auto count{ blocks_count(extent) };
+
+	const auto *source{ std::data(blocks) };
+	texel_block block{};
+	for (u32 block_y{}; block_y < count.y; ++block_y) {
+		for (u32 block_x{}; block_x < count.x; ++block_x, source += block_size(format)) {
+			switch (format) {
+				case block_format::bc1:
+					// BC1 is stored as opaque RGB, the three color mode decodes to black
+					decode_color(source, false, block);
+					for (auto &color : block) color[3] = 255;
+					break;
+				case block_format::bc3:
+					decode_color(source + 8, true, block);
+					decode_alpha(source, block);
+					break;
+				case block_format::bc7:
+					decode_bc7(source, block);
+					break;
+			}
+			store_block(result, block_x, block_y, block);
+		}
+	}
+	return result;
+}
+
+} // namespace vc::engine::resources
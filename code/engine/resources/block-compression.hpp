@@ -0,0 +1,62 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <cstddef>
+#include <stdexcept>
+
+#include <glm/vec2.hpp>
+
+#include "core/types.hpp"
+#include "engine/resources/image-decoder.hpp"
+
+namespace vc::engine::resources {
+
+/// 4x4 texel block formats: BC1 stores opaque RGB in 8 bytes, BC3 adds an 8 byte alpha block and
+/// BC7 stores RGBA in 16 bytes at a much higher quality.
+enum class block_format : u8 {
+	bc1,
+	bc3,
+	bc7,
+};
+
+struct compressed_level {
+	size_t       offset{};  ///< Into `compressed_image::data`
+	size_t       size  {};
+	glm::u32vec2 extent{ 0, 0 };
+};
+
+/// A mip chain of blocks, level 0 first and packed in the same order in `data`.
+struct compressed_image {
+	block_format                  format{ block_format::bc7 };
+	b8                            srgb  { true };
+	glm::u32vec2                  extent{ 0, 0 };
+	std::vector<compressed_level> levels;
+	std::vector<std::byte>        data;
+};
+
+[[nodiscard]] constexpr auto block_size(const block_format format) noexcept -> size_t {
+	return format == block_format::bc1 ? 8 : 16;
+}
+
+/// Bytes of a level, partial blocks at the right and bottom edges count as whole ones.
+[[nodiscard]] constexpr auto level_size(const block_format format, const glm::u32vec2 extent) noexcept -> size_t {
+	return size_t{ (extent.x + 3) / 4 } * ((extent.y + 3) / 4) * block_size(format);
+}
+
+/// Encodes `source` and, when `mips` is set, its whole chain of box-filtered levels. sRGB images
+/// are filtered in linear space.
+[[nodiscard]] auto compress_image(const image &source, block_format format, b8 srgb, b8 mips) -> compressed_image;
+
+[[nodiscard]] auto encode_blocks(const image &source, block_format format) -> std::vector<std::byte>;
+
+/// CPU fallback for devices that can't sample the format, every BC7 mode is decoded.
+[[nodiscard]] auto decode_blocks(std::span<const std::byte> blocks, glm::u32vec2 extent, block_format format) -> image;
+
+class block_compression_error : public std::runtime_error {
+public:
+	using base_type = std::runtime_error;
+	using base_type::runtime_error;
+};
+
+} // namespace vc::engine::resources
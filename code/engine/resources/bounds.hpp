@@ -0,0 +1,24 @@
+#pragma once
+
+#include <glm/vec3.hpp>
+
+#include "core/types.hpp"
+
+namespace vc::engine::resources {
+
+struct bounding_box {
+	glm::vec3 min{ 0.0f };
+	glm::vec3 max{ 0.0f };
+};
+
+struct bounding_sphere {
+	glm::vec3 center{ 0.0f };
+	f32       radius{ 0.0f };
+};
+
+struct bounds {
+	bounding_box    box;
+	bounding_sphere sphere;
+};
+
+} // namespace vc::engine::resources
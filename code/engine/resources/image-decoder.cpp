@@ -0,0 +1,253 @@
+#include <cctype>
+#include <cstring>
+#include <algorithm>
+
+#include <fmt/core.h>
+
+#include "core/mapped-file.hpp"
+#include "engine/resources/image-decoder.hpp"
+
+namespace vc::engine::resources {
+
+namespace {
+
+constexpr size_t tga_header_size { 18 };
+constexpr u8     tga_truecolor   { 2 };
+constexpr u8     tga_grayscale   { 3 };
+constexpr u8     tga_rle_flag    { 8 };
+constexpr u8     tga_top_left    { 0x20 };
+constexpr size_t bmp_header_size { 54 };
+constexpr u32    bmp_rgb         { 0 };
+constexpr u32    bmp_bitfields   { 3 };
+constexpr u32    max_extent      { 16384 };
+
+template<class T>
+[[nodiscard]] auto read(const std::span<const std::byte> bytes, const size_t offset) -> T {
+	if (offset + sizeof(T) > std::size(bytes)) {
+		throw image_decoder_error{ "Unexpected end of the image." };
+	}
+	T value;
+	std::memcpy(&value, std::data(bytes) + offset, sizeof(T));
+	return value;
+}
+
+[[nodiscard]] auto make_image(const u32 width, const u32 height) -> image {
+	if (width == 0 || height == 0 || width > max_extent || height > max_extent) {
+		throw image_decoder_error{ fmt::format("Unsupported image size {}x{}.", width, height) };
+	}
+	return image{ .extent = { width, height }, .pixels = std::vector<std::byte>(size_t{ width } * height * 4) };
+}
+
+/// Writes a pixel stored as `channels` bytes in BGR(A) or gray order.
+void store_pixel(std::byte *destination, const std::byte *source, const u32 channels) noexcept {
+	if (channels < 3) {
+		destination[0] = destination[1] = destination[2] = source[0];
+		destination[3] = std::byte{ 0xFF };
+		return;
+	}
+	destination[0] = source[2];
+	destination[1] = source[1];
+	destination[2] = source[0];
+	destination[3] = channels == 4 ? source[3] : std::byte{ 0xFF };
+}
+
+[[nodiscard]] auto decode_tga(const std::span<const std::byte> bytes) -> image {
+	const auto id_length{ read<u8>(bytes, 0) };
+	const auto colormap_type{ read<u8>(bytes, 1) };
+	const auto type{ read<u8>(bytes, 2) };
+	const auto width{ read<u16>(bytes, 12) };
+	const auto height{ read<u16>(bytes, 14) };
+	const auto bits{ read<u8>(bytes, 16) };
+	const auto descriptor{ read<u8>(bytes, 17) };
+
+	const auto base_type{ static_cast<u8>(type & ~tga_rle_flag) };
+	const auto channels{ static_cast<u32>(bits / 8) };
+	const auto supported{ colormap_type == 0 && (
+		(base_type == tga_truecolor && (bits == 24 || bits == 32)) || (base_type == tga_grayscale && bits == 8)
+	) };
+	if (!supported) {
+		throw image_decoder_error{ fmt::format("Unsupported TGA image of type {} with {} bits per pixel.", type, bits) };
+	}
+
+	auto result{ make_image(width, height) };
+	const auto pixels_count{ size_t{ width } * height };
+	auto offset{ tga_header_size + id_length };
+
+	// Pixels are decoded in file order and flipped afterwards when rows are stored bottom up
+	const auto pixel_source{ [&bytes, channels] (const size_t at) {
+		if (at + channels > std::size(bytes)) {
+			throw image_decoder_error{ "Unexpected end of the TGA image." };
+		}
+		return std::data(bytes) + at;
+	} };
+
+	auto *destination{ std::data(result.pixels) };
+	if ((type & tga_rle_flag) == 0) {
+		for (size_t pixel{}; pixel < pixels_count; ++pixel, offset += channels) {
+			store_pixel(destination + pixel * 4, pixel_source(offset), channels);
+		}
+	} else {
+		for (size_t pixel{}; pixel < pixels_count;) {
+			const auto packet{ read<u8>(bytes, offset++) };
+			const auto count{ std::min<size_t>((packet & 0x7F) + 1, pixels_count - pixel) };
+			if ((packet & 0x80) != 0) {
+				const auto *source{ pixel_source(offset) };
+				offset += channels;
+				for (size_t i{}; i < count; ++i) store_pixel(destination + (pixel + i) * 4, source, channels);
+			} else {
+				for (size_t i{}; i < count; ++i, offset += channels) {
+					store_pixel(destination + (pixel + i) * 4, pixel_source(offset), channels);
+				}
+			}
+			pixel += count;
+		}
+	}
+
+	if ((descriptor & tga_top_left) == 0) {
+		const auto row{ size_t{ width } * 4 };
+		for (size_t top{}, bottom{ height - 1u }; top < bottom; ++top, --bottom) {
+			std::swap_ranges(destination + top * row, destination + (top + 1) * row, destination + bottom * row);
+		}
+	}
+	return result;
+}
+
+[[nodiscard]] auto decode_bmp(const std::span<const std::byte> bytes) -> image {
+	if (std::size(bytes) < bmp_header_size) {
+		throw image_decoder_error{ "The BMP header is truncated." };
+	}
+
+	const auto data_offset{ read<u32>(bytes, 10) };
+	const auto width{ read<i32>(bytes, 18) };
+	const auto height{ read<i32>(bytes, 22) };
+	const auto bits{ read<u16>(bytes, 28) };
+	const auto compression{ read<u32>(bytes, 30) };
+
+	const auto supported{ (bits == 24 && compression == bmp_rgb)
+		|| (bits == 32 && (compression == bmp_rgb || compression == bmp_bitfields)) };
+	if (!supported || width <= 0 || height == 0) {
+		throw image_decoder_error{ fmt::format("Unsupported BMP image with {} bits per pixel and compression {}.",
+			bits, compression) };
+	}
+
+	const auto top_down{ height < 0 };
+	const auto rows{ static_cast<u32>(top_down ? -height : height) };
+	auto result{ make_image(static_cast<u32>(width), rows) };
+
+	const auto channels{ static_cast<u32>(bits / 8) };
+	const auto stride{ (size_t{ static_cast<u32>(width) } * channels + 3) & ~size_t{ 3 } };
+	if (data_offset + stride * rows > std::size(bytes)) {
+		throw image_decoder_error{ "The BMP pixel data is truncated." };
+	}
+
+	for (u32 row{}; row < rows; ++row) {
+		const auto *source{ std::data(bytes) + data_offset + stride * (top_down ? row : rows - 1 - row) };
+		auto *destination{ std::data(result.pixels) + size_t{ row } * result.extent.x * 4 };
+		for (u32 column{}; column < result.extent.x; ++column) {
+			store_pixel(destination + column * 4, source + column * channels, channels);
+			// BI_RGB keeps the fourth byte unused, it isn't alpha
+			if (compression == bmp_rgb) destination[column * 4 + 3] = std::byte{ 0xFF };
+		}
+	}
+	return result;
+}
+
+[[nodiscard]] auto decode_pnm(const std::span<const std::byte> bytes) -> image {
+	if (std::size(bytes) < 2) {
+		throw image_decoder_error{ "The PNM header is truncated." };
+	}
+	const auto text{ std::string_view{ reinterpret_cast<const char *>(std::data(bytes)), std::size(bytes) } };
+	const auto channels{ text[1] == '6' ? 3u : 1u };
+
+	size_t offset{ 2 };
+	const auto next_number{ [&text, &offset] {
+		while (offset < std::size(text)) {
+			if (text[offset] == '#') {
+				offset = text.find('\n', offset);
+				if (offset == std::string_view::npos) break;
+			} else if (!std::isspace(static_cast<unsigned char>(text[offset]))) {
+				break;
+			}
+			++offset;
+		}
+
+		u32 value{};
+		const auto first{ offset };
+		for (; offset < std::size(text) && std::isdigit(static_cast<unsigned char>(text[offset])); ++offset) {
+			value = value * 10 + static_cast<u32>(text[offset] - '0');
+		}
+		if (offset == first) {
+			throw image_decoder_error{ "The PNM header is malformed." };
+		}
+		return value;
+	} };
+
+	const auto width{ next_number() };
+	const auto height{ next_number() };
+	const auto max_value{ next_number() };
+	++offset; // A single whitespace separates the header from the samples
+
+	if (max_value == 0 || max_value > 255) {
+		throw image_decoder_error{ fmt::format("Unsupported PNM sample range {}.", max_value) };
+	}
+
+	auto result{ make_image(width, height) };
+	const auto pixels_count{ size_t{ width } * height };
+	if (offset + pixels_count * channels > std::size(bytes)) {
+		throw image_decoder_error{ "The PNM pixel data is truncated." };
+	}
+
+	const auto scale{ [max_value] (const std::byte sample) {
+		return static_cast<std::byte>(static_cast<u32>(sample) * 255 / max_value);
+	} };
+	for (size_t pixel{}; pixel < pixels_count; ++pixel) {
+		const auto *source{ std::data(bytes) + offset + pixel * channels };
+		auto *destination{ std::data(result.pixels) + pixel * 4 };
+		destination[0] = scale(source[0]);
+		destination[1] = scale(source[channels == 3 ? 1 : 0]);
+		destination[2] = scale(source[channels == 3 ? 2 : 0]);
+		destination[3] = std::byte{ 0xFF };
+	}
+	return result;
+}
+
+} // anonymous namespace
+
+image decode_image(const std::string_view path) {
+	const core::mapped_file file{ path };
+	const auto format{ detect_image_format(path, file.bytes()) };
+	if (format == image_format::unknown) {
+		throw image_decoder_error{ fmt::format(R"(Unknown image format of "{}".)", path) };
+	}
+	return decode_image(file.bytes(), format);
+}
+
+image decode_image(const std::span<const std::byte> bytes, const image_format format) {
+	switch (format) {
+		case image_format::tga: return decode_tga(bytes);
+		case image_format::bmp: return decode_bmp(bytes);
+		case image_format::pnm: return decode_pnm(bytes);
+		default: break;
+	}
+	throw image_decoder_error{ "Unknown image format." };
+}
+
+image_format detect_image_format(const std::string_view path, const std::span<const std::byte> bytes) {
+	if (std::size(bytes) >= 2) {
+		const auto first{ static_cast<char>(bytes[0]) };
+		const auto second{ static_cast<char>(bytes[1]) };
+		if (first == 'B' && second == 'M') return image_format::bmp;
+		if (first == 'P' && (second == '5' || second == '6')) return image_format::pnm;
+	}
+
+	const auto ends_with{ [path] (const std::string_view extension) {
+		if (std::size(path) < std::size(extension)) return false;
+		return std::ranges::equal(path.substr(std::size(path) - std::size(extension)), extension,
+			[] (const char lhs, const char rhs) { return (lhs | 0x20) == rhs; });
+	} };
+	if (ends_with(".tga") && std::size(bytes) >= tga_header_size) return image_format::tga;
+
+	return image_format::unknown;
+}
+
+} // namespace vc::engine::resources
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <cstddef>
+#include <stdexcept>
+#include <string_view>
+
+#include <glm/vec2.hpp>
+
+#include "core/types.hpp"
+
+namespace vc::engine::resources {
+
+enum class image_format : u8 {
+	unknown,
+	tga,
+	bmp,
+	pnm,
+};
+
+/// Tightly packed RGBA8 pixels, rows from top to bottom.
+struct image {
+	glm::u32vec2           extent{ 0, 0 };
+	std::vector<std::byte> pixels;
+};
+
+/// Decodes truecolor and grayscale TGA (raw or RLE), 24/32 bit BMP and binary PGM/PPM files.
+/// It only reads the memory-mapped file and allocates the result, so it runs on worker threads.
+[[nodiscard]] auto decode_image(std::string_view path) -> image;
+[[nodiscard]] auto decode_image(std::span<const std::byte> bytes, image_format format) -> image;
+
+/// Looks at the magic numbers first, TGA has none and is recognized by its extension.
+[[nodiscard]] auto detect_image_format(std::string_view path, std::span<const std::byte> bytes) -> image_format;
+
+class image_decoder_error : public std::runtime_error {
+public:
+	using base_type = std::runtime_error;
+	using base_type::runtime_error;
+};
+
+} // namespace vc::engine::resources
@@ -0,0 +1,189 @@
+#include <span>
+#include <array>
+#include <string>
+#include <cstring>
+#include <algorithm>
+
+#include <fmt/core.h>
+
+#include "core/mapped-file.hpp"
+#include "engine/resources/image-encoder.hpp"
+
+namespace vc::engine::resources {
+
+namespace {
+
+constexpr std::array<u8, 8> png_signature{ 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+constexpr size_t png_chunk_overhead{ 12 };  ///< Length, type and CRC
+constexpr size_t png_header_size   { 13 };
+constexpr u8     png_color_rgb     { 2 };
+constexpr size_t max_stored_block  { 65535 };
+constexpr size_t stored_block_header{ 5 };
+
+[[nodiscard]] constexpr auto make_crc_table() noexcept -> std::array<u32, 256> {
+	std::array<u32, 256> table{};
+	for (u32 entry{}; entry < std::size(table); ++entry) {
+		auto value{ entry };
+		for (u32 bit{}; bit < 8; ++bit) {
+			value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+		}
+		table[entry] = value;
+	}
+	return table;
+}
+
+constexpr auto crc_table{ make_crc_table() };
+
+[[nodiscard]] auto crc32(const std::span<const std::byte> bytes) noexcept -> u32 {
+	u32 crc{ 0xFFFFFFFFu };
+	for (const auto byte : bytes) {
+		crc = crc_table[(crc ^ static_cast<u8>(byte)) & 0xFF] ^ (crc >> 8);
+	}
+	return crc ^ 0xFFFFFFFFu;
+}
+
+[[nodiscard]] auto adler32(const std::span<const std::byte> bytes) noexcept -> u32 {
+	constexpr u32 modulus{ 65521 };
+	constexpr size_t max_run{ 5552 };  ///< Largest run whose sums can't overflow before the modulo
+	u32 a{ 1 }, b{ 0 };
+	for (size_t offset{}; offset < std::size(bytes); offset += max_run) {
+		for (const auto byte : bytes.subspan(offset, std::min(max_run, std::size(bytes) - offset))) {
+			a += static_cast<u8>(byte);
+			b += a;
+		}
+		a %= modulus;
+		b %= modulus;
+	}
+	return b << 16 | a;
+}
+
+/// Big endian writes in file order, PNG stores every integer that way.
+class png_writer {
+public:
+	explicit png_writer(const std::span<std::byte> bytes) noexcept : m_bytes{ bytes } {}
+
+	void put_u8(const u8 value) noexcept { m_bytes[m_offset++] = std::byte{ value }; }
+	void put_u16_le(const u16 value) noexcept {
+		put_u8(static_cast<u8>(value));
+		put_u8(static_cast<u8>(value >> 8));
+	}
+	void put_u32(const u32 value) noexcept {
+		for (u32 shift{ 24 };; shift -= 8) {
+			put_u8(static_cast<u8>(value >> shift));
+			if (shift == 0) break;
+		}
+	}
+	void put_bytes(const std::span<const std::byte> data) noexcept {
+		std::memcpy(std::data(m_bytes) + m_offset, std::data(data), std::size(data));
+		m_offset += std::size(data);
+	}
+
+	/// Starts a chunk, `end_chunk` appends the CRC of its type and data.
+	void begin_chunk(const std::string_view type, const size_t length) noexcept {
+		put_u32(static_cast<u32>(length));
+		m_chunk = m_offset;
+		put_bytes(std::as_bytes(std::span{ type }));
+	}
+	void end_chunk() noexcept {
+		put_u32(crc32(m_bytes.subspan(m_chunk, m_offset - m_chunk)));
+	}
+
+private:
+	std::span<std::byte> m_bytes;
+	size_t               m_offset{};
+	size_t               m_chunk {};
+};
+
+} // anonymous namespace
+
+void write_png(const std::string_view path, const image &source) {
+	const auto [width, height]{ source.extent };
+	if (width == 0 || height == 0 || std::size(source.pixels) < size_t{ width } * height * 4) {
+		throw image_encoder_error{ fmt::format(R"(Cannot write a {}x{} image to "{}".)", width, height, path) };
+	}
+
+	// Every row starts with the "none" filter
+	const auto row_size{ 1 + size_t{ width } * 3 };
+	std::vector<std::byte> rows(row_size * height);
+	for (u32 y{}; y < height; ++y) {
+		auto *row{ std::data(rows) + y * row_size };
+		const auto *pixel{ std::data(source.pixels) + size_t{ y } * width * 4 };
+		for (u32 x{}; x < width; ++x, pixel += 4) {
+			std::memcpy(row + 1 + size_t{ x } * 3, pixel, 3);
+		}
+	}
+
+	const auto blocks_count{ std::max<size_t>(1, (std::size(rows) + max_stored_block - 1) / max_stored_block) };
+	const auto zlib_size{ 2 + blocks_count * stored_block_header + std::size(rows) + 4 };
+	const auto file_size{ std::size(png_signature) + png_chunk_overhead + png_header_size
+		+ png_chunk_overhead + zlib_size + png_chunk_overhead };
+
+	core::mapped_file file{ path, file_size };
+	png_writer writer{ file.writable_bytes() };
+	writer.put_bytes(std::as_bytes(std::span{ png_signature }));
+
+	writer.begin_chunk("IHDR", png_header_size);
+	writer.put_u32(width);
+	writer.put_u32(height);
+	writer.put_u8(8);                // Bits per channel
+	writer.put_u8(png_color_rgb);
+	writer.put_u8(0);                // Deflate
+	writer.put_u8(0);                // Adaptive filtering
+	writer.put_u8(0);                // Not interlaced
+	writer.end_chunk();
+
+	writer.begin_chunk("IDAT", zlib_size);
+	writer.put_u8(0x78);             // Deflate with a 32 KiB window
+	writer.put_u8(0x01);             // Fastest, the header check makes it a multiple of 31
+	const std::span<const std::byte> data{ rows };
+	for (size_t block{}; block < blocks_count; ++block) {
+		const auto offset{ block * max_stored_block };
+		const auto length{ static_cast<u16>(std::min(max_stored_block, std::size(data) - offset)) };
+		writer.put_u8(block + 1 == blocks_count ? 1 : 0);
+		writer.put_u16_le(length);
+		writer.put_u16_le(static_cast<u16>(~length));
+		writer.put_bytes(data.subspan(offset, length));
+	}
+	writer.put_u32(adler32(data));
+	writer.end_chunk();
+
+	writer.begin_chunk("IEND", 0);
+	writer.end_chunk();
+}
+
+y4m_writer::y4m_writer(const std::string_view path, const glm::u32vec2 extent, const u32 fps)
+	: m_file{ std::string{ path }, std::ios::binary | std::ios::trunc }
+	, m_extent{ extent }
+	, m_planes(size_t{ extent.x } * extent.y * 3) {
+	if (!m_file.is_open()) {
+		throw image_encoder_error{ fmt::format(R"(Cannot create "{}".)", path) };
+	}
+	m_file << fmt::format("YUV4MPEG2 W{} H{} F{}:1 Ip A1:1 C444\n", extent.x, extent.y, fps);
+}
+
+void y4m_writer::write(const image &frame) {
+	if (frame.extent.x != m_extent.x || frame.extent.y != m_extent.y) {
+		throw image_encoder_error{ fmt::format("A {}x{} frame doesn't fit the {}x{} stream.",
+			frame.extent.x, frame.extent.y, m_extent.x, m_extent.y) };
+	}
+
+	const auto pixels_count{ size_t{ m_extent.x } * m_extent.y };
+	auto *y_plane{ std::data(m_planes) };
+	auto *u_plane{ y_plane + pixels_count };
+	auto *v_plane{ u_plane + pixels_count };
+	const auto *pixel{ reinterpret_cast<const u8 *>(std::data(frame.pixels)) };
+	for (size_t i{}; i < pixels_count; ++i, pixel += 4) {
+		const i32 r{ pixel[0] }, g{ pixel[1] }, b{ pixel[2] };
+		y_plane[i] = static_cast<u8>((( 66 * r + 129 * g +  25 * b + 128) >> 8) + 16);
+		u_plane[i] = static_cast<u8>(((-38 * r -  74 * g + 112 * b + 128) >> 8) + 128);
+		v_plane[i] = static_cast<u8>(((112 * r -  94 * g -  18 * b + 128) >> 8) + 128);
+	}
+
+	m_file << "FRAME\n";
+	m_file.write(reinterpret_cast<const char *>(std::data(m_planes)), static_cast<std::streamsize>(std::size(m_planes)));
+	if (!m_file) {
+		throw image_encoder_error{ "Failed to write a Y4M frame." };
+	}
+}
+
+} // namespace vc::engine::resources
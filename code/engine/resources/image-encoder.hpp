@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vector>
+#include <fstream>
+#include <stdexcept>
+#include <string_view>
+
+#include <glm/vec2.hpp>
+
+#include "core/types.hpp"
+#include "engine/resources/image-decoder.hpp"
+
+namespace vc::engine::resources {
+
+/// Writes the RGB channels of `source` as a PNG file. The deflate stream only has stored blocks:
+/// the files are larger, but no compression library is needed and it keeps up with a capture
+/// of every frame.
+void write_png(std::string_view path, const image &source);
+
+/// A YUV4MPEG2 stream of 4:4:4 frames in BT.601 limited range, as read by ffmpeg and most
+/// players. Frames must all have the extent given at construction.
+class y4m_writer {
+public:
+	y4m_writer(std::string_view path, glm::u32vec2 extent, u32 fps);
+
+	y4m_writer(const y4m_writer &) = delete;
+	y4m_writer &operator=(const y4m_writer &) = delete;
+
+	void write(const image &frame);
+
+private:
+	std::ofstream    m_file;
+	glm::u32vec2     m_extent;
+	std::vector<u8>  m_planes;  ///< Y, U then V of the current frame
+};
+
+class image_encoder_error : public std::runtime_error {
+public:
+	using base_type = std::runtime_error;
+	using base_type::runtime_error;
+};
+
+} // namespace vc::engine::resources
@@ -0,0 +1,225 @@
+#include <array>
+#include <bit>
+#include <cstring>
+#include <numeric>
+#include <algorithm>
+
+#include <fmt/core.h>
+
+#include "core/mapped-file.hpp"
+#include "engine/resources/ktx2.hpp"
+
+namespace vc::engine::resources {
+
+namespace {
+
+constexpr std::array<u8, 12> identifier{ 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+constexpr size_t header_size     { 80 };
+constexpr size_t level_entry_size{ 24 };
+
+constexpr u32 dfd_model_bc1a      { 128 };
+constexpr u32 dfd_model_bc3       { 130 };
+constexpr u32 dfd_model_bc7       { 134 };
+constexpr u32 dfd_channel_color   { 0 };
+constexpr u32 dfd_channel_bc3_alpha{ 15 };
+constexpr u32 dfd_primaries_bt709 { 1 };
+constexpr u32 dfd_transfer_linear { 1 };
+constexpr u32 dfd_transfer_srgb   { 2 };
+
+constexpr std::string_view writer_key  { "KTXwriter" };
+constexpr std::string_view writer_value{ "vulkan-course texture encoder" };
+
+template<class T>
+[[nodiscard]] auto read(const std::span<const std::byte> bytes, const size_t offset) -> T {
+	if (offset + sizeof(T) > std::size(bytes)) {
+		throw ktx2_error{ "Unexpected end of the KTX2 file." };
+	}
+	T value;
+	std::memcpy(&value, std::data(bytes) + offset, sizeof(T));
+	return value;
+}
+
+/// Little endian writes at fixed offsets of a preallocated file.
+class byte_writer {
+public:
+	explicit byte_writer(const std::span<std::byte> bytes) noexcept : m_bytes{ bytes } {}
+
+	template<class T>
+	void put(const T value, const size_t offset) noexcept { std::memcpy(std::data(m_bytes) + offset, &value, sizeof(T)); }
+	void put_bytes(const std::span<const std::byte> data, const size_t offset) noexcept {
+		std::memcpy(std::data(m_bytes) + offset, std::data(data), std::size(data));
+	}
+
+private:
+	std::span<std::byte> m_bytes;
+};
+
+[[nodiscard]] auto align_up(const size_t size, const size_t alignment) noexcept -> size_t {
+	return (size + alignment - 1) / alignment * alignment;
+}
+
+/// Basic descriptor block: one sample per 64 bit plane of the block.
+[[nodiscard]] auto make_dfd(const block_format format, const b8 srgb) -> std::vector<u32> {
+	struct sample { u32 offset, length, channel; };
+	std::vector<sample> samples;
+	u32 model{};
+	switch (format) {
+		case block_format::bc1:
+			model = dfd_model_bc1a;
+			samples = { { 0, 64, dfd_channel_color } };
+			break;
+		case block_format::bc3:
+			model = dfd_model_bc3;
+			samples = { { 0, 64, dfd_channel_bc3_alpha }, { 64, 64, dfd_channel_color } };
+			break;
+		case block_format::bc7:
+			model = dfd_model_bc7;
+			samples = { { 0, 128, dfd_channel_color } };
+			break;
+	}
+
+	const auto block_length{ static_cast<u32>(24 + 16 * std::size(samples)) };
+	std::vector<u32> words{
+		4 + block_length,
+		0,                                     // Khronos vendor, basic descriptor type
+		2 | block_length << 16,                // Version 2
+		model | dfd_primaries_bt709 << 8 | (srgb ? dfd_transfer_srgb : dfd_transfer_linear) << 16,
+		3 | 3 << 8,                            // 4x4x1x1 texels, stored minus one
+		static_cast<u32>(block_size(format)),  // Bytes of plane 0
+		0
+	};
+	for (const auto &[offset, length, channel] : samples) {
+		words.insert(std::end(words), { offset | (length - 1) << 16 | channel << 24, 0u, 0u, 0xFFFFFFFFu });
+	}
+	return words;
+}
+
+} // anonymous namespace
+
+compressed_image read_ktx2(const std::string_view path) {
+	const core::mapped_file file{ path };
+	try {
+		return read_ktx2(file.bytes());
+	} catch (const ktx2_error &error) {
+		throw ktx2_error{ fmt::format(R"(Failed to read "{}": {})", path, error.what()) };
+	}
+}
+
+compressed_image read_ktx2(const std::span<const std::byte> bytes) {
+	if (std::size(bytes) < header_size
+		|| std::memcmp(std::data(bytes), std::data(identifier), std::size(identifier)) != 0) {
+		throw ktx2_error{ "Not a KTX2 file." };
+	}
+
+	const auto vk_format{ read<u32>(bytes, 12) };
+	const auto width{ read<u32>(bytes, 20) };
+	const auto height{ read<u32>(bytes, 24) };
+	const auto depth{ read<u32>(bytes, 28) };
+	const auto layers{ read<u32>(bytes, 32) };
+	const auto faces{ read<u32>(bytes, 36) };
+	const auto levels_count{ std::max(read<u32>(bytes, 40), 1u) };
+	const auto supercompression{ read<u32>(bytes, 44) };
+
+	if (depth > 1 || layers > 1 || faces != 1 || width == 0 || height == 0) {
+		throw ktx2_error{ "Only single 2D textures are supported." };
+	}
+	if (supercompression != 0) {
+		throw ktx2_error{ fmt::format("Supercompression scheme {} isn't supported.", supercompression) };
+	}
+	// A full chain ends at 1x1, more levels would shift the extents past their width
+	if (const auto max_levels{ static_cast<u32>(std::bit_width(std::max(width, height))) }; levels_count > max_levels) {
+		throw ktx2_error{ fmt::format("{} levels exceed the {} of a {}x{} texture.", levels_count, max_levels, width, height) };
+	}
+
+	compressed_image result{ .extent = { width, height } };
+	const auto found{ std::ranges::find_if(constants::ktx2_vk_formats, [vk_format] (const auto &formats) {
+		return std::ranges::find(formats, vk_format) != std::end(formats);
+	}) };
+	if (found == std::end(constants::ktx2_vk_formats)) {
+		throw ktx2_error{ fmt::format("VkFormat {} isn't a supported block format.", vk_format) };
+	}
+	result.format = static_cast<block_format>(std::distance(std::begin(constants::ktx2_vk_formats), found));
+	result.srgb = (*found)[1] == vk_format;
+
+	for (u32 level{}; level < levels_count; ++level) {
+		const auto entry{ header_size + level * level_entry_size };
+		const auto offset{ read<u64>(bytes, entry) };
+		const auto length{ read<u64>(bytes, entry + 8) };
+
+		const glm::u32vec2 extent{ std::max(width >> level, 1u), std::max(height >> level, 1u) };
+		const auto size{ level_size(result.format, extent) };
+		if (length < size || offset > std::size(bytes) || std::size(bytes) - offset < size) {
+			throw ktx2_error{ fmt::format("Level {} lies outside of the file.", level) };
+		}
+
+		result.levels.push_back(compressed_level{ .offset = std::size(result.data), .size = size, .extent = extent });
+		const auto level_bytes{ bytes.subspan(static_cast<size_t>(offset), size) };
+		result.data.insert(std::end(result.data), std::begin(level_bytes), std::end(level_bytes));
+	}
+	return result;
+}
+
+void write_ktx2(const std::string_view path, const compressed_image &texture) {
+	if (std::empty(texture.levels)) {
+		throw ktx2_error{ fmt::format(R"(Cannot write "{}" without levels.)", path) };
+	}
+
+	const auto levels_count{ static_cast<u32>(std::size(texture.levels)) };
+	const auto dfd{ make_dfd(texture.format, texture.srgb) };
+	const auto dfd_offset{ header_size + levels_count * level_entry_size };
+	const auto dfd_length{ std::size(dfd) * sizeof(u32) };
+
+	// A single key/value pair: its length, the key and the value, both null-terminated
+	const auto kvd_offset{ dfd_offset + dfd_length };
+	const auto kvd_entry_length{ std::size(writer_key) + std::size(writer_value) + 2 };
+	const auto kvd_length{ align_up(sizeof(u32) + kvd_entry_length, 4) };
+
+	// Levels are aligned to the least common multiple of the block size and 4, smallest first
+	const auto alignment{ std::lcm(block_size(texture.format), size_t{ 4 }) };
+	std::vector<size_t> level_offsets(levels_count);
+	auto file_size{ kvd_offset + kvd_length };
+	for (auto level{ levels_count }; level-- > 0;) {
+		level_offsets[level] = align_up(file_size, alignment);
+		file_size = level_offsets[level] + texture.levels[level].size;
+	}
+
+	core::mapped_file file{ path, file_size };
+	std::ranges::fill(file.writable_bytes(), std::byte{ 0 });
+	byte_writer writer{ file.writable_bytes() };
+
+	writer.put_bytes(std::as_bytes(std::span{ identifier }), 0);
+	const std::array<u32, 9> header{
+		ktx2_vk_format(texture.format, texture.srgb),
+		1,                 // Type size of block-compressed formats
+		texture.extent.x,
+		texture.extent.y,
+		0, 0, 1,           // Depth, layers and faces of a single 2D texture
+		levels_count,
+		0                  // No supercompression
+	};
+	writer.put_bytes(std::as_bytes(std::span{ header }), 12);
+	writer.put(static_cast<u32>(dfd_offset), 48);
+	writer.put(static_cast<u32>(dfd_length), 52);
+	writer.put(static_cast<u32>(kvd_offset), 56);
+	writer.put(static_cast<u32>(kvd_length), 60);
+
+	for (u32 level{}; level < levels_count; ++level) {
+		const auto &source{ texture.levels[level] };
+		const auto entry{ header_size + level * level_entry_size };
+		writer.put(static_cast<u64>(level_offsets[level]), entry);
+		writer.put(static_cast<u64>(source.size), entry + 8);
+		writer.put(static_cast<u64>(source.size), entry + 16);
+		writer.put_bytes(std::span{ texture.data }.subspan(source.offset, source.size), level_offsets[level]);
+	}
+
+	writer.put_bytes(std::as_bytes(std::span{ dfd }), dfd_offset);
+	writer.put(static_cast<u32>(kvd_entry_length), kvd_offset);
+	writer.put_bytes(std::as_bytes(std::span{ writer_key }), kvd_offset + sizeof(u32));
+	writer.put_bytes(std::as_bytes(std::span{ writer_value }), kvd_offset + sizeof(u32) + std::size(writer_key) + 1);
+}
+
+u32 ktx2_vk_format(const block_format format, const b8 srgb) noexcept {
+	return constants::ktx2_vk_formats[static_cast<size_t>(format)][srgb ? 1 : 0];
+}
+
+} // namespace vc::engine::resources
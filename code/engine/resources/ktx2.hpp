@@ -0,0 +1,43 @@
+#pragma once
+
+#include <span>
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <string_view>
+
+#include "core/types.hpp"
+#include "engine/resources/block-compression.hpp"
+
+namespace vc::engine::resources {
+
+namespace constants {
+
+constexpr std::string_view ktx2_extension{ ".ktx2" };
+
+/// `VkFormat` values of the block formats as stored in the container, UNORM then sRGB.
+constexpr std::array<std::array<u32, 2>, 3> ktx2_vk_formats{
+	std::array<u32, 2>{ 131, 132 },  // VK_FORMAT_BC1_RGB_UNORM_BLOCK, VK_FORMAT_BC1_RGB_SRGB_BLOCK
+	std::array<u32, 2>{ 137, 138 },  // VK_FORMAT_BC3_UNORM_BLOCK, VK_FORMAT_BC3_SRGB_BLOCK
+	std::array<u32, 2>{ 145, 146 },  // VK_FORMAT_BC7_UNORM_BLOCK, VK_FORMAT_BC7_SRGB_BLOCK
+};
+
+} // namespace constants
+
+/// Reads a 2D KTX2 texture of BC1, BC3 or BC7 blocks without supercompression.
+[[nodiscard]] auto read_ktx2(std::string_view path) -> compressed_image;
+[[nodiscard]] auto read_ktx2(std::span<const std::byte> bytes) -> compressed_image;
+
+/// Writes the levels smallest first, as the specification recommends for streaming, with a basic
+/// data format descriptor.
+void write_ktx2(std::string_view path, const compressed_image &texture);
+
+[[nodiscard]] auto ktx2_vk_format(block_format format, b8 srgb) noexcept -> u32;
+
+class ktx2_error : public std::runtime_error {
+public:
+	using base_type = std::runtime_error;
+	using base_type::runtime_error;
+};
+
+} // namespace vc::engine::resources
@@ -0,0 +1,164 @@
+#include <cstdio>
+#include <string>
+#include <cstring>
+#include <filesystem>
+
+#include <fmt/core.h>
+
+#include "core/hash.hpp"
+#include "engine/resources/mesh-cache.hpp"
+
+namespace vc::engine::resources {
+
+namespace {
+
+[[nodiscard]] constexpr auto align_up(const u64 value, const u64 alignment) noexcept -> u64 {
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+} // anonymous namespace
+
+mesh_cache::mesh_cache(const std::string_view path, const u64 source_key, const b8 verify)
+	: m_file{ path } {
+	const auto bytes{ m_file.bytes() };
+	if (std::size(bytes) < sizeof(mesh_cache_header)) {
+		throw mesh_cache_error{ fmt::format(R"("{}" is too small to be a mesh cache.)", path) };
+	}
+
+	m_header = reinterpret_cast<const mesh_cache_header *>(std::data(bytes));
+	const auto &header{ *m_header };
+	if (header.magic != constants::mesh_cache_magic || header.version != constants::mesh_cache_version
+	||  header.header_size != sizeof(mesh_cache_header)) {
+		throw mesh_cache_error{ fmt::format(R"("{}" has an unsupported header.)", path) };
+	}
+	if (header.source_key != source_key) {
+		throw mesh_cache_error{ fmt::format(R"("{}" was built from another source.)", path) };
+	}
+
+	const auto expected{ make_header(source_key, header.vertex_count, header.index_count) };
+	const auto same_layout{ header.vertex_stride == expected.vertex_stride
+		&& header.attributes_count == expected.attributes_count
+		&& std::memcmp(std::data(header.attributes), std::data(expected.attributes),
+			sizeof(mesh_cache_attribute) * expected.attributes_count) == 0 };
+	if (!same_layout) {
+		throw mesh_cache_error{ fmt::format(R"("{}" has an outdated vertex layout.)", path) };
+	}
+
+	if (header.vertices_offset != expected.vertices_offset || header.indices_offset != expected.indices_offset
+	||  header.payload_size != expected.payload_size
+	||  header.vertices_offset + header.payload_size > std::size(bytes)) {
+		throw mesh_cache_error{ fmt::format(R"("{}" is truncated.)", path) };
+	}
+
+	if (verify && core::checksum64(bytes.subspan(header.vertices_offset, header.payload_size)) != header.checksum) {
+		throw mesh_cache_error{ fmt::format(R"("{}" checksum mismatch.)", path) };
+	}
+}
+
+std::span<const model::vertex> mesh_cache::vertices() const noexcept {
+	return std::span<const model::vertex>{
+		reinterpret_cast<const model::vertex *>(std::data(m_file.bytes()) + m_header->vertices_offset),
+		static_cast<size_t>(m_header->vertex_count)
+	};
+}
+
+std::span<const u32> mesh_cache::indices() const noexcept {
+	return std::span<const u32>{
+		reinterpret_cast<const u32 *>(std::data(m_file.bytes()) + m_header->indices_offset),
+		static_cast<size_t>(m_header->index_count)
+	};
+}
+
+std::optional<mesh_cache> mesh_cache::try_open(const std::string_view path, const u64 source_key) {
+	if (std::error_code error; !std::filesystem::exists(path, error)) {
+		return std::nullopt;
+	}
+
+	try {
+		return std::make_optional<mesh_cache>(path, source_key);
+	} catch (const std::exception &error) {
+		std::printf("[engine][resources][mesh_cache] Ignoring cache: %s\n", error.what());
+	}
+	return std::nullopt;
+}
+
+mesh_cache mesh_cache::build(const std::string_view path, const u64 source_key,
+	const size_t vertex_count, const size_t index_count, const payload_writer &writer) {
+	namespace fs = std::filesystem;
+
+	auto header{ make_header(source_key, vertex_count, index_count) };
+	const fs::path target{ path };
+	auto temporary{ target };
+	temporary += ".tmp";
+
+	std::error_code error;
+	if (target.has_parent_path()) {
+		fs::create_directories(target.parent_path(), error);
+	}
+
+	try {
+		core::mapped_file file{ temporary.string(), header.vertices_offset + header.payload_size };
+		const auto bytes{ file.writable_bytes() };
+
+		writer(
+			std::span<model::vertex>{
+				reinterpret_cast<model::vertex *>(std::data(bytes) + header.vertices_offset), vertex_count
+			},
+			std::span<u32>{
+				reinterpret_cast<u32 *>(std::data(bytes) + header.indices_offset), index_count
+			}
+		);
+
+		header.checksum = core::checksum64(bytes.subspan(header.vertices_offset, header.payload_size));
+		std::memcpy(std::data(bytes), &header, sizeof(header));
+	} catch (...) {
+		// The file is unmapped by now, a half written one must not outlive the failure
+		fs::remove(temporary, error);
+		throw;
+	}
+
+	if (fs::rename(temporary, target, error); error) {
+		fs::remove(temporary, error);
+		throw mesh_cache_error{ fmt::format(R"(Cannot store the mesh cache as "{}".)", path) };
+	}
+	return mesh_cache{ path, source_key, false };
+}
+
+mesh_cache_header mesh_cache::make_header(const u64 source_key,
+	const size_t vertex_count, const size_t index_count) {
+	static_assert(constants::vertex_elements <= constants::mesh_cache_max_attributes,
+		"The vertex has more attributes than the mesh cache can describe");
+	const auto attributes{ model::vertex::attribute_description() };
+
+	mesh_cache_header header{
+		.magic            = constants::mesh_cache_magic,
+		.version          = constants::mesh_cache_version,
+		.header_size      = sizeof(mesh_cache_header),
+		.vertex_stride    = sizeof(model::vertex),
+		.attributes_count = static_cast<u32>(std::size(attributes)),
+		.reserved         = 0,
+		.attributes       = {},
+		.source_key       = source_key,
+		.vertex_count     = vertex_count,
+		.index_count      = index_count,
+		.vertices_offset  = align_up(sizeof(mesh_cache_header), constants::mesh_cache_alignment),
+		.indices_offset   = 0,
+		.payload_size     = 0,
+		.checksum         = 0
+	};
+	for (size_t i{}; i < std::size(attributes); ++i) {
+		header.attributes[i] = mesh_cache_attribute{
+			.location = attributes[i].location,
+			.format   = static_cast<u32>(attributes[i].format),
+			.offset   = attributes[i].offset,
+			.reserved = 0
+		};
+	}
+
+	header.indices_offset = align_up(header.vertices_offset + vertex_count * sizeof(model::vertex),
+		constants::mesh_cache_alignment);
+	header.payload_size = header.indices_offset + index_count * sizeof(u32) - header.vertices_offset;
+	return header;
+}
+
+} // namespace vc::engine::resources
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <span>
+#include <array>
+#include <optional>
+#include <stdexcept>
+#include <functional>
+#include <string_view>
+
+#include "core/mapped-file.hpp"
+#include "engine/resources/model.hpp"
+
+namespace vc::engine::resources {
+
+namespace constants {
+
+constexpr u32              mesh_cache_magic         { 0x434D4356 }; // "VCMC"
+constexpr u32              mesh_cache_version       { 2 };  ///< Non indexed meshes store a trivial index list since 2
+constexpr size_t           mesh_cache_max_attributes{ 8 };
+constexpr size_t           mesh_cache_alignment     { 16 };
+constexpr std::string_view mesh_cache_extension     { ".vcmesh" };
+
+} // namespace constants
+
+struct mesh_cache_attribute {
+	u32 location;
+	u32 format;
+	u32 offset;
+	u32 reserved;
+};
+
+/// On-disk layout: header, vertex payload, index payload. Payloads start at 16 byte aligned
+/// offsets, so the mapped file can be handed to the GPU upload as is.
+struct mesh_cache_header {
+	u32 magic;
+	u32 version;
+	u32 header_size;
+	u32 vertex_stride;
+	u32 attributes_count;
+	u32 reserved;
+	std::array<mesh_cache_attribute, constants::mesh_cache_max_attributes> attributes;
+	u64 source_key;
+	u64 vertex_count;
+	u64 index_count;
+	u64 vertices_offset;
+	u64 indices_offset;
+	u64 payload_size;
+	u64 checksum;
+};
+
+/// Memory-mapped mesh blob written after the first load or generation of a mesh. The blob is
+/// only valid for the same `source_key` (a hash of whatever the mesh was produced from) and the
+/// current `model::vertex` layout.
+class mesh_cache {
+public:
+	using payload_writer = std::function<void(std::span<model::vertex>, std::span<u32>)>;
+
+	explicit mesh_cache(std::string_view path, u64 source_key, b8 verify = true);
+
+	[[nodiscard]] auto vertices() const noexcept -> std::span<const model::vertex>;
+	[[nodiscard]] auto indices() const noexcept -> std::span<const u32>;
+
+	/// Returns nothing if the cache is missing, stale or corrupted.
+	[[nodiscard]] static auto try_open(std::string_view path, u64 source_key) -> std::optional<mesh_cache>;
+
+	/// Lets the `writer` fill the payload of a new cache file in place, then opens it. The temporary
+	/// file is removed when anything throws, the `writer`'s exceptions are passed on.
+	[[nodiscard]] static auto build(std::string_view path, u64 source_key,
+		size_t vertex_count, size_t index_count, const payload_writer &writer) -> mesh_cache;
+
+private:
+	core::mapped_file        m_file;
+	const mesh_cache_header *m_header{ nullptr };
+
+	[[nodiscard]] static auto make_header(u64 source_key, size_t vertex_count, size_t index_count)
+		-> mesh_cache_header;
+};
+
+class mesh_cache_error : public std::runtime_error {
+public:
+	using base_type = std::runtime_error;
+	using base_type::runtime_error;
+};
+
+} // namespace vc::engine::resources
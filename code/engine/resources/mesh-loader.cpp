@@ -0,0 +1,585 @@
+#include <array>
+#include <atomic>
+#include <limits>
+#include <cstdio>
+#include <cstring>
+#include <charconv>
+#include <algorithm>
+
+#include <fmt/core.h>
+#include <glm/common.hpp>
+
+#include "engine/resources/mesh-loader.hpp"
+
+namespace vc::engine::resources {
+
+namespace {
+
+constexpr size_t obj_min_chunk_size  { 1 << 20 };
+constexpr size_t obj_chunks_per_worker{ 4 };
+constexpr size_t glb_batch_vertices  { 3 << 16 };
+
+constexpr u32 glb_magic     { 0x46546C67 }; // "glTF"
+constexpr u32 glb_version   { 2 };
+constexpr u32 glb_chunk_json{ 0x4E4F534A }; // "JSON"
+constexpr u32 glb_chunk_bin { 0x004E4942 }; // "BIN\0"
+constexpr u32 gltf_triangles{ 4 };
+
+enum gltf_component_type : u32 {
+	gltf_byte           = 5120,
+	gltf_unsigned_byte  = 5121,
+	gltf_short          = 5122,
+	gltf_unsigned_short = 5123,
+	gltf_unsigned_int   = 5125,
+	gltf_float          = 5126,
+};
+
+/// Runs `function(task)` for every task in [0; tasks_count) on the job system workers.
+template<class Function>
+void run_parallel(core::job_system &jobs, const size_t tasks_count, Function &&function) {
+	jobs.parallel_for(0, tasks_count, 1, [&function] (const size_t begin, const size_t end) {
+		for (auto task{ begin }; task < end; ++task) {
+			function(task);
+		}
+	});
+}
+
+[[nodiscard]] auto read_u32(const std::span<const std::byte> bytes, const size_t offset) -> u32 {
+	u32 value{};
+	std::memcpy(&value, std::data(bytes) + offset, sizeof(value));
+	return value;
+}
+
+[[nodiscard]] constexpr bool is_blank(const char symbol) noexcept {
+	return symbol == ' ' || symbol == '\t' || symbol == '\r';
+}
+
+[[nodiscard]] auto skip_blanks(const char *it, const char *end) noexcept -> const char * {
+	while (it != end && is_blank(*it)) ++it;
+	return it;
+}
+
+[[nodiscard]] auto line_end(const char *it, const char *end) noexcept -> const char * {
+	const auto found{ static_cast<const char *>(std::memchr(it, '\n', static_cast<size_t>(end - it))) };
+	return found != nullptr ? found : end;
+}
+
+[[nodiscard]] auto next_line(const char *last, const char *end) noexcept -> const char * {
+	return last == end ? end : last + 1;
+}
+
+[[nodiscard]] bool is_token_end(const char *it, const char *end) noexcept {
+	return it == end || is_blank(*it) || *it == '\n' || *it == '#';
+}
+
+[[nodiscard]] bool parse_float(const char *&it, const char *end, f32 &value) noexcept {
+	it = skip_blanks(it, end);
+	if (it != end && *it == '+') ++it;
+	const auto [last, error]{ std::from_chars(it, end, value) };
+	if (error != std::errc{}) return false;
+	it = last;
+	return true;
+}
+
+/// Reads the position index of a face token ("i", "i/t", "i//n" or "i/t/n") and skips the rest.
+[[nodiscard]] bool parse_face_index(const char *&it, const char *end, i64 &value) noexcept {
+	it = skip_blanks(it, end);
+	if (is_token_end(it, end)) return false;
+
+	const auto [last, error]{ std::from_chars(it, end, value) };
+	if (error != std::errc{}) return false;
+	it = last;
+	while (!is_token_end(it, end)) ++it;
+	return true;
+}
+
+enum class obj_line : u8 { other, position, face };
+
+[[nodiscard]] auto classify(const char *&it, const char *end) noexcept -> obj_line {
+	it = skip_blanks(it, end);
+	if (end - it < 2 || !is_blank(it[1])) return obj_line::other;
+
+	switch (it[0]) {
+		case 'v': it += 2; return obj_line::position;
+		case 'f': it += 2; return obj_line::face;
+		default: break;
+	}
+	return obj_line::other;
+}
+
+[[nodiscard]] auto count_face_tokens(const char *it, const char *end) noexcept -> size_t {
+	size_t tokens{};
+	while (true) {
+		it = skip_blanks(it, end);
+		if (is_token_end(it, end)) return tokens;
+		++tokens;
+		while (!is_token_end(it, end)) ++it;
+	}
+}
+
+[[nodiscard]] constexpr auto component_size(const u32 component_type) noexcept -> size_t {
+	switch (component_type) {
+		case gltf_byte:
+		case gltf_unsigned_byte:  return 1;
+		case gltf_short:
+		case gltf_unsigned_short: return 2;
+		case gltf_unsigned_int:
+		case gltf_float:          return 4;
+		default: break;
+	}
+	return 0;
+}
+
+[[nodiscard]] constexpr auto components_count(const std::string_view type) noexcept -> u32 {
+	if (type == "SCALAR") return 1;
+	if (type == "VEC2")   return 2;
+	if (type == "VEC3")   return 3;
+	if (type == "VEC4")   return 4;
+	return 0;
+}
+
+} // anonymous namespace
+
+mesh_loader::mesh_loader(core::job_system &jobs, const std::string_view path,
+	const mesh_load_options &options)
+	: m_jobs{ jobs }, m_file{ path }, m_options{ options }, m_format{ detect_format(path) } {
+
+	if (const auto bytes{ m_file.bytes() };
+		std::size(bytes) >= sizeof(u32) && read_u32(bytes, 0) == glb_magic) {
+		m_format = mesh_format::glb;
+	}
+
+	switch (m_format) {
+		case mesh_format::obj: scan_obj(); break;
+		case mesh_format::glb: scan_glb(); break;
+		default:
+			throw mesh_loader_error{ fmt::format(R"(Unknown mesh format of "{}".)", path) };
+	}
+
+	if (m_vertex_count == 0) {
+		throw mesh_loader_error{ fmt::format(R"("{}" produces no triangles.)", path) };
+	}
+	if (m_vertex_count > std::numeric_limits<u32>::max()) {
+		throw mesh_loader_error{ fmt::format(
+			R"("{}" produces {} vertices, which exceeds the model limit.)", path, m_vertex_count
+		) };
+	}
+}
+
+void mesh_loader::load_to(const std::span<model::vertex> destination) {
+	if (std::size(destination) != m_vertex_count) {
+		throw mesh_loader_error{ fmt::format(
+			"Destination holds {} vertices, but the mesh has {}.",
+			std::size(destination), m_vertex_count
+		) };
+	}
+
+	switch (m_format) {
+		case mesh_format::obj: load_obj(destination); break;
+		case mesh_format::glb: load_glb(destination); break;
+		default: break;
+	}
+}
+
+mesh_format mesh_loader::detect_format(const std::string_view path) {
+	const auto ends_with{ [path] (const std::string_view extension) {
+		if (std::size(path) < std::size(extension)) return false;
+		return std::ranges::equal(path.substr(std::size(path) - std::size(extension)), extension,
+			[] (const char lhs, const char rhs) { return (lhs | 0x20) == rhs; });
+	} };
+
+	if (ends_with(".obj")) return mesh_format::obj;
+	if (ends_with(".glb")) return mesh_format::glb;
+	return mesh_format::unknown;
+}
+
+#pragma region obj
+
+void mesh_loader::scan_obj() {
+	const auto text{ m_file.text() };
+	const auto *begin{ std::data(text) };
+	const auto *end{ begin + std::size(text) };
+
+	const size_t chunks_count{ std::clamp<size_t>(
+		std::size(text) / obj_min_chunk_size, 1, m_jobs.workers_count() * obj_chunks_per_worker
+	) };
+	const size_t chunk_size{ std::size(text) / chunks_count };
+
+	m_obj_chunks.clear();
+	m_obj_chunks.reserve(chunks_count);
+	for (size_t offset{}; offset < std::size(text);) {
+		const auto *chunk_end{ begin + std::min(std::size(text), offset + chunk_size) };
+		if (chunk_end != end) chunk_end = next_line(line_end(chunk_end, end), end);
+
+		const auto next_offset{ static_cast<size_t>(chunk_end - begin) };
+		m_obj_chunks.push_back(obj_chunk{ .begin = offset, .end = next_offset });
+		offset = next_offset;
+	}
+
+	run_parallel(m_jobs, std::size(m_obj_chunks), [this, begin] (const size_t index) {
+		auto &chunk{ m_obj_chunks[index] };
+		const auto *end{ begin + chunk.end };
+		for (const auto *it{ begin + chunk.begin }; it < end;) {
+			const auto *last{ line_end(it, end) };
+			switch (classify(it, last)) {
+				case obj_line::position:
+					++chunk.positions_count;
+					break;
+				case obj_line::face:
+					if (const auto tokens{ count_face_tokens(it, last) }; tokens >= 3) {
+						chunk.vertices_count += (tokens - 2) * 3;
+					}
+					break;
+				default: break;
+			}
+			it = next_line(last, end);
+		}
+	});
+
+	size_t positions{};
+	for (auto &chunk : m_obj_chunks) {
+		chunk.first_position = positions;
+		chunk.first_vertex = m_vertex_count;
+		positions += chunk.positions_count;
+		m_vertex_count += chunk.vertices_count;
+	}
+}
+
+void mesh_loader::load_obj(const std::span<model::vertex> destination) {
+	const auto *begin{ std::data(m_file.text()) };
+	const auto positions_count{ std::empty(m_obj_chunks) ? size_t{}
+		: m_obj_chunks.back().first_position + m_obj_chunks.back().positions_count };
+
+	// The only per-position storage: faces index positions from any earlier chunk.
+	std::vector<model::vertex> positions(positions_count);
+	std::vector<std::array<glm::vec3, 2>> chunk_bounds(std::size(m_obj_chunks), {
+		glm::vec3{ std::numeric_limits<f32>::max() }, glm::vec3{ std::numeric_limits<f32>::lowest() }
+	});
+	std::atomic<b8> failed{ false };
+
+	run_parallel(m_jobs, std::size(m_obj_chunks), [&] (const size_t index) {
+		const auto &chunk{ m_obj_chunks[index] };
+		auto &[bounds_min, bounds_max]{ chunk_bounds[index] };
+		auto *output{ std::data(positions) + chunk.first_position };
+		const auto *end{ begin + chunk.end };
+
+		for (const auto *it{ begin + chunk.begin }; it < end;) {
+			const auto *last{ line_end(it, end) };
+			if (classify(it, last) == obj_line::position) {
+				auto &vertex{ *output++ };
+				if (!parse_float(it, last, vertex.position.x)
+				||  !parse_float(it, last, vertex.position.y)
+				||  !parse_float(it, last, vertex.position.z)) {
+					failed = true;
+					return;
+				}
+				vertex.color = m_options.default_color;
+				if (glm::vec3 color; parse_float(it, last, color.r)
+					&& parse_float(it, last, color.g) && parse_float(it, last, color.b)) {
+					vertex.color = glm::vec4{ color, 1.0f };
+				}
+				bounds_min = glm::min(bounds_min, vertex.position);
+				bounds_max = glm::max(bounds_max, vertex.position);
+			}
+			it = next_line(last, end);
+		}
+	});
+	if (failed) {
+		throw mesh_loader_error{ "Malformed OBJ vertex position." };
+	}
+
+	m_bounds_min = glm::vec3{ std::numeric_limits<f32>::max() };
+	m_bounds_max = glm::vec3{ std::numeric_limits<f32>::lowest() };
+	for (const auto &[bounds_min, bounds_max] : chunk_bounds) {
+		m_bounds_min = glm::min(m_bounds_min, bounds_min);
+		m_bounds_max = glm::max(m_bounds_max, bounds_max);
+	}
+
+	run_parallel(m_jobs, std::size(m_obj_chunks), [&] (const size_t index) {
+		const auto &chunk{ m_obj_chunks[index] };
+		auto *output{ std::data(destination) + chunk.first_vertex };
+		auto defined_positions{ chunk.first_position };
+		const auto *end{ begin + chunk.end };
+
+		const auto resolve{ [&] (const i64 raw, model::vertex &vertex) {
+			const auto absolute{ raw > 0 ? raw - 1 : static_cast<i64>(defined_positions) + raw };
+			if (raw == 0 || absolute < 0 || static_cast<size_t>(absolute) >= defined_positions) {
+				failed = true;
+				return false;
+			}
+			vertex = positions[static_cast<size_t>(absolute)];
+			vertex.position = fit(vertex.position);
+			return true;
+		} };
+
+		for (const auto *it{ begin + chunk.begin }; it < end && !failed;) {
+			const auto *last{ line_end(it, end) };
+			switch (classify(it, last)) {
+				case obj_line::position:
+					++defined_positions;
+					break;
+
+				case obj_line::face: {
+					const auto tokens{ count_face_tokens(it, last) };
+					if (tokens < 3) break;
+
+					i64 first{};
+					i64 previous{};
+					i64 current{};
+					if (!parse_face_index(it, last, first) || !parse_face_index(it, last, previous)) {
+						failed = true;
+						break;
+					}
+					size_t parsed{ 2 };
+					while (parse_face_index(it, last, current)) {
+						if (!resolve(first, output[0]) || !resolve(previous, output[1])
+						||  !resolve(current, output[2])) break;
+						output += 3;
+						previous = current;
+						++parsed;
+					}
+					// The output was sized from the token count, a malformed token would leave vertices unwritten
+					if (parsed != tokens) failed = true;
+				} break;
+
+				default: break;
+			}
+			it = next_line(last, end);
+		}
+
+		m_file.release(chunk.begin, chunk.end - chunk.begin);
+	});
+	if (failed) {
+		throw mesh_loader_error{ "Malformed OBJ face or out of range vertex index." };
+	}
+}
+
+#pragma endregion obj
+
+#pragma region glb
+
+void mesh_loader::scan_glb() {
+	constexpr size_t header_size{ sizeof(u32) * 3 };
+	constexpr size_t chunk_header_size{ sizeof(u32) * 2 };
+
+	const auto bytes{ m_file.bytes() };
+	if (std::size(bytes) < header_size + chunk_header_size
+	||  read_u32(bytes, 0) != glb_magic || read_u32(bytes, sizeof(u32)) != glb_version) {
+		throw mesh_loader_error{ "Not a glTF 2.0 binary file." };
+	}
+
+	std::string_view json;
+	std::span<const std::byte> binary;
+	for (size_t offset{ header_size }; offset + chunk_header_size <= std::size(bytes);) {
+		const auto length{ static_cast<size_t>(read_u32(bytes, offset)) };
+		const auto type{ read_u32(bytes, offset + sizeof(u32)) };
+		offset += chunk_header_size;
+		if (offset + length > std::size(bytes)) {
+			throw mesh_loader_error{ "Truncated glTF chunk." };
+		}
+
+		const auto content{ bytes.subspan(offset, length) };
+		if (type == glb_chunk_json && std::empty(json)) {
+			json = std::string_view{ reinterpret_cast<const char *>(std::data(content)), length };
+		} else if (type == glb_chunk_bin && std::empty(binary)) {
+			binary = content;
+		}
+		offset += (length + 3) & ~size_t{ 3 };
+	}
+	if (std::empty(json)) {
+		throw mesh_loader_error{ "The glTF binary has no JSON chunk." };
+	}
+
+	m_gltf.emplace(json);
+	const auto root{ m_gltf->root() };
+
+	m_bounds_min = glm::vec3{ std::numeric_limits<f32>::max() };
+	m_bounds_max = glm::vec3{ std::numeric_limits<f32>::lowest() };
+
+	const auto meshes{ root["meshes"] };
+	for (size_t mesh_id{}; mesh_id < meshes.size(); ++mesh_id) {
+		const auto primitives{ meshes[mesh_id]["primitives"] };
+		for (size_t primitive_id{}; primitive_id < primitives.size(); ++primitive_id) {
+			const auto primitive{ primitives[primitive_id] };
+			const auto attributes{ primitive["attributes"] };
+			if (primitive["mode"].as<u32>(gltf_triangles) != gltf_triangles
+			||  !attributes["POSITION"].is_valid()) {
+				std::printf("[engine][resources][mesh_loader] Skipping primitive #%zu of mesh #%zu: "
+					"only indexed or plain triangle lists are supported\n", primitive_id, mesh_id);
+				continue;
+			}
+
+			const auto position_id{ attributes["POSITION"].as<u32>() };
+			glb_primitive entry{
+				.positions    = resolve_accessor(binary, position_id),
+				.first_vertex = m_vertex_count
+			};
+			if (entry.positions.component_type != gltf_float || entry.positions.components != 3) {
+				throw mesh_loader_error{ "glTF POSITION accessor must be a float VEC3." };
+			}
+			if (const auto color{ attributes["COLOR_0"] }; color.is_valid()) {
+				entry.colors = resolve_accessor(binary, color.as<u32>());
+				const auto type{ entry.colors->component_type };
+				const auto normalized_integer{ entry.colors->normalized
+					&& (type == gltf_unsigned_byte || type == gltf_unsigned_short) };
+				if ((entry.colors->components != 3 && entry.colors->components != 4)
+				||  (type != gltf_float && !normalized_integer)) {
+					throw mesh_loader_error{
+						"glTF COLOR_0 accessor must be a VEC3 or VEC4 of floats or normalized unsigned bytes or shorts."
+					};
+				}
+			}
+			if (const auto indices{ primitive["indices"] }; indices.is_valid()) {
+				entry.indices = resolve_accessor(binary, indices.as<u32>());
+			}
+			entry.vertices_count = entry.indices ? entry.indices->count : entry.positions.count;
+			entry.vertices_count -= entry.vertices_count % 3;
+
+			const auto accessor{ root["accessors"][position_id] };
+			for (u32 axis{}; axis < 3; ++axis) {
+				m_bounds_min[axis] = std::min(m_bounds_min[axis],
+					static_cast<f32>(accessor["min"][axis].as_number(-1.0)));
+				m_bounds_max[axis] = std::max(m_bounds_max[axis],
+					static_cast<f32>(accessor["max"][axis].as_number(1.0)));
+			}
+
+			m_vertex_count += entry.vertices_count;
+			m_glb_primitives.push_back(entry);
+		}
+	}
+}
+
+void mesh_loader::load_glb(const std::span<model::vertex> destination) {
+	struct batch {
+		const glb_primitive *primitive;
+		size_t               begin;
+		size_t               end;
+	};
+
+	std::vector<batch> batches;
+	for (const auto &primitive : m_glb_primitives) {
+		for (size_t begin{}; begin < primitive.vertices_count; begin += glb_batch_vertices) {
+			batches.push_back(batch{
+				.primitive = &primitive,
+				.begin     = begin,
+				.end       = std::min(primitive.vertices_count, begin + glb_batch_vertices)
+			});
+		}
+	}
+
+	std::atomic<b8> failed{ false };
+	run_parallel(m_jobs, std::size(batches), [&] (const size_t index) {
+		const auto &[primitive, begin, end]{ batches[index] };
+		const auto &positions{ primitive->positions };
+		auto *output{ std::data(destination) + primitive->first_vertex };
+
+		for (size_t i{ begin }; i < end; ++i) {
+			auto &vertex{ output[i] };
+			const auto element{ primitive->indices ? primitive->indices->read_index(i) : i };
+			if (element >= positions.count) {
+				failed = true;
+				return;
+			}
+
+			vertex.position = fit(glm::vec3{
+				positions.read(element, 0), positions.read(element, 1), positions.read(element, 2)
+			});
+			vertex.color = m_options.default_color;
+			if (const auto &colors{ primitive->colors }; colors && element < colors->count) {
+				vertex.color = glm::vec4{
+					colors->read(element, 0), colors->read(element, 1), colors->read(element, 2),
+					colors->components == 4 ? colors->read(element, 3) : 1.0f
+				};
+			}
+		}
+	});
+	if (failed) {
+		throw mesh_loader_error{ "glTF vertex index out of range of its position accessor." };
+	}
+}
+
+auto mesh_loader::resolve_accessor(const std::span<const std::byte> binary, const u32 index) const
+	-> accessor_view {
+	const auto root{ m_gltf->root() };
+	const auto accessor{ root["accessors"][index] };
+	const auto view{ root["bufferViews"][accessor["bufferView"].as<u32>(~u32{})] };
+	if (!accessor.is_valid() || !view.is_valid() || view["buffer"].as<u32>() != 0) {
+		throw mesh_loader_error{ fmt::format(
+			"glTF accessor #{} must reference a buffer view of the embedded binary chunk.", index
+		) };
+	}
+
+	accessor_view result{
+		.count          = accessor["count"].as<size_t>(),
+		.component_type = accessor["componentType"].as<u32>(),
+		.components     = components_count(accessor["type"].as_string()),
+		.normalized     = accessor["normalized"].as_bool()
+	};
+	const auto element_size{ component_size(result.component_type) * result.components };
+	result.stride = view["byteStride"].as<size_t>(element_size);
+
+	const auto view_offset{ view["byteOffset"].as<size_t>() };
+	const auto view_length{ view["byteLength"].as<size_t>() };
+	const auto offset{ accessor["byteOffset"].as<size_t>() };
+	const auto required{ result.count == 0 ? 0 : offset + result.stride * (result.count - 1) + element_size };
+	if (result.stride < element_size) {
+		throw mesh_loader_error{ fmt::format("glTF accessor #{} has a stride shorter than its elements.", index) };
+	}
+	if (element_size == 0 || required > view_length || view_offset + view_length > std::size(binary)) {
+		throw mesh_loader_error{ fmt::format("glTF accessor #{} is out of the binary chunk.", index) };
+	}
+
+	result.data = std::data(binary) + view_offset + offset;
+	return result;
+}
+
+glm::vec3 mesh_loader::fit(const glm::vec3 position) const noexcept {
+	if (!m_options.normalize) return position;
+
+	const auto center{ (m_bounds_min + m_bounds_max) * 0.5f };
+	const auto half_size{ (m_bounds_max - m_bounds_min) * 0.5f };
+	const auto largest{ std::max({ half_size.x, half_size.y, half_size.z }) };
+	return largest > 0.0f ? (position - center) * (m_options.extent / largest) : position - center;
+}
+
+f32 mesh_loader::accessor_view::read(const size_t element, const u32 component) const noexcept {
+	const auto *source{ data + element * stride + component * component_size(component_type) };
+	const auto load{ [source] <class T> (T value) {
+		std::memcpy(&value, source, sizeof(T));
+		return value;
+	} };
+
+	switch (component_type) {
+		case gltf_float:          return load(f32{});
+		case gltf_unsigned_byte:  return normalized ? load(u8{})  / 255.0f   : load(u8{});
+		case gltf_unsigned_short: return normalized ? load(u16{}) / 65535.0f : load(u16{});
+		case gltf_byte:           return normalized ? std::max(load(i8{})  / 127.0f,   -1.0f) : load(i8{});
+		case gltf_short:          return normalized ? std::max(load(i16{}) / 32767.0f, -1.0f) : load(i16{});
+		case gltf_unsigned_int:   return static_cast<f32>(load(u32{}));
+		default: break;
+	}
+	return 0.0f;
+}
+
+u32 mesh_loader::accessor_view::read_index(const size_t element) const noexcept {
+	const auto *source{ data + element * stride };
+	switch (component_type) {
+		case gltf_unsigned_byte: return static_cast<u32>(*source);
+		case gltf_unsigned_short: {
+			u16 value;
+			std::memcpy(&value, source, sizeof(value));
+			return value;
+		}
+		case gltf_unsigned_int: {
+			u32 value;
+			std::memcpy(&value, source, sizeof(value));
+			return value;
+		}
+		default: break;
+	}
+	return ~u32{};
+}
+
+#pragma endregion glb
+
+} // namespace vc::engine::resources
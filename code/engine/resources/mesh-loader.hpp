@@ -0,0 +1,106 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+#include "core/json.hpp"
+#include "core/job-system.hpp"
+#include "core/mapped-file.hpp"
+#include "engine/resources/model.hpp"
+
+namespace vc::engine::resources {
+
+enum class mesh_format : u8 {
+	unknown,
+	obj,
+	glb,
+};
+
+struct mesh_load_options {
+	glm::vec4 default_color{ 1.0f, 1.0f, 1.0f, 1.0f };
+	b8        normalize    { true }; ///< Fit the mesh into the [-extent; extent] cube
+	f32       extent       { 0.9f };
+};
+
+/// Loads OBJ and binary glTF meshes from a memory-mapped file. The constructor only scans the
+/// file to find out how many vertices it produces; `load_to` parses it in parallel chunks on the
+/// job system and writes triangle list vertices straight into the destination span.
+class mesh_loader {
+public:
+	mesh_loader(core::job_system &jobs, std::string_view path, const mesh_load_options &options = {});
+
+	mesh_loader(const mesh_loader &) = delete;
+	mesh_loader &operator=(const mesh_loader &) = delete;
+
+	[[nodiscard]] auto format() const noexcept { return m_format; }
+	[[nodiscard]] auto vertex_count() const noexcept { return m_vertex_count; }
+
+	void load_to(std::span<model::vertex> destination);
+
+	[[nodiscard]] static auto detect_format(std::string_view path) -> mesh_format;
+
+private:
+	struct obj_chunk {
+		size_t begin;
+		size_t end;
+		size_t first_position;
+		size_t positions_count;
+		size_t first_vertex;
+		size_t vertices_count;
+	};
+
+	struct accessor_view {
+		const std::byte *data          { nullptr };
+		size_t           count         {};
+		size_t           stride        {};
+		u32              component_type{};
+		u32              components    {};
+		b8               normalized    { false };
+
+		[[nodiscard]] auto read(size_t element, u32 component) const noexcept -> f32;
+		[[nodiscard]] auto read_index(size_t element) const noexcept -> u32;
+	};
+
+	struct glb_primitive {
+		accessor_view                positions;
+		std::optional<accessor_view> colors;
+		std::optional<accessor_view> indices;
+		size_t                       first_vertex;
+		size_t                       vertices_count;
+	};
+
+	core::job_system                  &m_jobs;
+	core::mapped_file                  m_file;
+	mesh_load_options                  m_options;
+	mesh_format                        m_format      { mesh_format::unknown };
+	size_t                             m_vertex_count{};
+	glm::vec3                          m_bounds_min  { 0.0f };
+	glm::vec3                          m_bounds_max  { 0.0f };
+
+	std::vector<obj_chunk>             m_obj_chunks;
+	std::optional<core::json_document> m_gltf;
+	std::vector<glb_primitive>         m_glb_primitives;
+
+	void scan_obj();
+	void scan_glb();
+	void load_obj(std::span<model::vertex> destination);
+	void load_glb(std::span<model::vertex> destination);
+
+	[[nodiscard]] auto resolve_accessor(std::span<const std::byte> binary, u32 index) const
+		-> accessor_view;
+	[[nodiscard]] auto fit(glm::vec3 position) const noexcept -> glm::vec3;
+};
+
+class mesh_loader_error : public std::runtime_error {
+public:
+	using base_type = std::runtime_error;
+	using base_type::runtime_error;
+};
+
+} // namespace vc::engine::resources
@@ -1,54 +1,31 @@
-#include <cassert>
-#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#include <glm/geometric.hpp>
+#include <glm/common.hpp>
 
 #include "engine/resources/model.hpp"
 
 namespace vc::engine::resources {
 
-model::model(graphics::device &device, const std::span<const vertex> vertices) : m_device{ device } {
-	construct_vertex_buffers(vertices);
-}
-
-model::~model() {
-	const auto device{ m_device.handle() };
-	vkDestroyBuffer(device, m_vertex_buffer, nullptr);
-	vkFreeMemory(device, m_vertex_buffer_memory, nullptr);
-}
-
-
-void model::bind(VkCommandBuffer command_buffer) {
-	const std::array buffers{ m_vertex_buffer };
-	const std::array offsets{ VkDeviceSize{ 0 } };
-
-	vkCmdBindVertexBuffers(command_buffer, 0,
-		static_cast<u32>(std::size(buffers)),
-		std::data(buffers), std::data(offsets)
-	);
-}
-
-void model::draw(VkCommandBuffer command_buffer) {
-	vkCmdDraw(command_buffer, m_vertex_count, 1, 0, 0);
-}
-
-void model::construct_vertex_buffers(const std::span<const vertex> vertices) {
-	constexpr auto vertex_size{ static_cast<u32>(sizeof(decltype(vertices)::value_type)) };
-
-	m_vertex_count = static_cast<u32>(std::size(vertices));
-	assert(m_vertex_count >= 3 && "Vertex count should be at least 3");
+bounds model::compute_bounds(const std::span<const vertex> vertices) noexcept {
+	if (std::empty(vertices)) return resources::bounds{};
 
-	const VkDeviceSize buffer_size{ vertex_size * m_vertex_count };
+	bounding_box box{ vertices.front().position, vertices.front().position };
+	for (const auto &vertex : vertices) {
+		box.min = glm::min(box.min, vertex.position);
+		box.max = glm::max(box.max, vertex.position);
+	}
 
-	m_vertex_buffer = m_device.make_buffer(
-		buffer_size,
-		VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-		m_vertex_buffer_memory
-	);
+	bounding_sphere sphere{ .center = (box.min + box.max) * 0.5f };
+	f32 radius_squared{};
+	for (const auto &vertex : vertices) {
+		const auto offset{ vertex.position - sphere.center };
+		radius_squared = std::max(radius_squared, glm::dot(offset, offset));
+	}
+	sphere.radius = std::sqrt(radius_squared);
 
-	void *data{ nullptr };
-	vkMapMemory(m_device.handle(), m_vertex_buffer_memory, 0, buffer_size, 0, &data);
-	std::memcpy(data, std::data(vertices), static_cast<size_t>(buffer_size));
-	vkUnmapMemory(m_device.handle(), m_vertex_buffer_memory);
+	return resources::bounds{ .box = box, .sphere = sphere };
 }
 
 #pragma region vertex
@@ -86,5 +63,31 @@ auto model::vertex::attribute_description()
 
 #pragma endregion vertex
 
+#pragma region instance
+
+auto model::instance::binding_description() -> VkVertexInputBindingDescription {
+	return VkVertexInputBindingDescription{
+		.binding   = constants::instance_binding,
+		.stride    = sizeof(instance),
+		.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE
+	};
+}
+
+auto model::instance::attribute_description()
+	-> std::array<VkVertexInputAttributeDescription, constants::instance_elements> {
+	std::array<VkVertexInputAttributeDescription, constants::instance_elements> attributes;
+	for (u32 column{}; column < std::size(attributes); ++column) {
+		attributes[column] = VkVertexInputAttributeDescription{
+			.location = static_cast<u32>(constants::vertex_elements) + column,
+			.binding  = constants::instance_binding,
+			.format   = VK_FORMAT_R32G32B32A32_SFLOAT,
+			.offset   = static_cast<u32>(sizeof(glm::vec4)) * column
+		};
+	}
+	return attributes;
+}
+
+#pragma endregion instance
+
 } // namespace vc::engine::resources
 
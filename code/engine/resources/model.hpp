@@ -1,41 +1,37 @@
 #pragma once
 
 #include <span>
+#include <array>
+#include <functional>
 #include <glm/vec3.hpp>
 #include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
 
-#include "engine/graphics/device.hpp"
+#include <vulkan/vulkan.h>
+
+#include "core/types.hpp"
+#include "engine/resources/bounds.hpp"
 
 namespace vc::engine::resources {
 
 namespace constants {
 
-constexpr size_t bindings_count { 1 };
-constexpr size_t vertex_elements{ 2 };
+constexpr size_t bindings_count   { 1 };
+constexpr size_t vertex_elements  { 2 };
+constexpr u32    instance_binding { 1 };
+constexpr size_t instance_elements{ 4 }; ///< A mat4 takes one attribute location per column
 
 } // namespace constants
 
 
+/// Vertex layouts of the pipelines; the meshes themselves live in the batch renderer.
 class model {
 public:
 	struct vertex;
+	struct instance;
+	using vertex_writer = std::function<void(std::span<vertex>)>;
 
-	model(graphics::device &device, const std::span<const vertex> vertices);
-	~model();
-
-	model(const model &) = delete;
-	model &operator=(const model &) = delete;
-
-	void bind(VkCommandBuffer command_buffer);
-	void draw(VkCommandBuffer command_buffer);
-
-private:
-	graphics::device &m_device;
-	VkBuffer          m_vertex_buffer;
-	VkDeviceMemory    m_vertex_buffer_memory;
-	u32               m_vertex_count;
-
-	void construct_vertex_buffers(const std::span<const vertex> vertices);
+	[[nodiscard]] static auto compute_bounds(std::span<const vertex> vertices) noexcept -> resources::bounds;
 };
 
 struct model::vertex {
@@ -50,4 +46,14 @@ struct model::vertex {
 		-> std::array<VkVertexInputAttributeDescription, constants::vertex_elements>;
 };
 
+/// Per-instance vertex data, read from the `instance_binding` vertex buffer.
+struct model::instance {
+	glm::mat4 transform;
+
+	[[nodiscard]] static auto binding_description() -> VkVertexInputBindingDescription;
+
+	[[nodiscard]] static auto attribute_description()
+		-> std::array<VkVertexInputAttributeDescription, constants::instance_elements>;
+};
+
 } // namespace vc::engine::resources
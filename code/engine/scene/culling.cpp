@@ -0,0 +1,235 @@
+#include <bit>
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+
+#include "core/simd.hpp"
+#include "engine/scene/culling.hpp"
+
+namespace vc::engine::scene {
+
+namespace {
+
+using lanes = core::simd::native_lanes;
+
+constexpr u32 all_planes{ 0b111111 };
+
+static_assert(constants::bvh_leaf_size % lanes::width == 0, "A leaf must fill whole registers");
+
+[[nodiscard]] auto center(const sphere_arrays &spheres, const u32 object) noexcept -> glm::vec3 {
+	return glm::vec3{ spheres.x[object], spheres.y[object], spheres.z[object] };
+}
+
+} // anonymous namespace
+
+frustum frustum::from(const glm::mat4 &m) noexcept {
+	const auto row{ [&m] (const glm::length_t index) {
+		return glm::vec4{ m[0][index], m[1][index], m[2][index], m[3][index] };
+	} };
+
+	frustum result{ .planes = {
+		row(3) + row(0), // left
+		row(3) - row(0), // right
+		row(3) + row(1), // bottom
+		row(3) - row(1), // top
+		row(2),          // near
+		row(3) - row(2)  // far
+	} };
+	for (auto &plane : result.planes) {
+		plane /= glm::length(glm::vec3{ plane });
+	}
+	return result;
+}
+
+#pragma region bvh
+
+void bvh::build(const sphere_arrays &spheres) {
+	m_objects_count = static_cast<u32>(std::size(spheres.x));
+	m_nodes.clear();
+	m_slots.clear();
+	for (auto *array : { &m_slot_x, &m_slot_y, &m_slot_z, &m_slot_radius }) {
+		array->clear();
+	}
+	// An empty scene has no root, `refit` and `cull` then do nothing
+	if (m_objects_count == 0) return;
+
+	std::vector<u32> objects(m_objects_count);
+	std::iota(std::begin(objects), std::end(objects), 0u);
+
+	m_nodes.emplace_back();
+	build_node(0, objects, spheres);
+
+	for (auto *array : { &m_slot_x, &m_slot_y, &m_slot_z, &m_slot_radius }) {
+		array->assign(std::size(m_slots), 0.0f);
+	}
+	refit(spheres);
+}
+
+void bvh::refit(const sphere_arrays &spheres) {
+	if (m_objects_count == 0) return;
+
+	// Children always follow their parent, so a reverse pass sees them first.
+	for (auto index{ std::size(m_nodes) }; index-- > 0;) {
+		auto &current{ m_nodes[index] };
+		if (!current.leaf) {
+			const auto &left{ m_nodes[current.child] };
+			const auto &right{ m_nodes[current.child + 1] };
+			current.min = glm::min(left.min, right.min);
+			current.max = glm::max(left.max, right.max);
+			continue;
+		}
+
+		current.min = glm::vec3{ std::numeric_limits<f32>::max() };
+		current.max = glm::vec3{ std::numeric_limits<f32>::lowest() };
+		for (auto slot{ current.slot_begin }; slot < current.slot_begin + current.count; ++slot) {
+			const auto object{ m_slots[slot] };
+			const auto position{ center(spheres, object) };
+			const auto radius{ spheres.radius[object] };
+
+			m_slot_x[slot]      = position.x;
+			m_slot_y[slot]      = position.y;
+			m_slot_z[slot]      = position.z;
+			m_slot_radius[slot] = radius;
+			current.min = glm::min(current.min, position - radius);
+			current.max = glm::max(current.max, position + radius);
+		}
+	}
+}
+
+culling_stats bvh::cull(const frustum &frustum, std::vector<u32> &visible) const {
+	visible.clear();
+	culling_stats stats{};
+	if (std::empty(m_nodes) || m_objects_count == 0) return stats;
+
+	struct entry {
+		u32 node;
+		u32 planes_mask; ///< Planes the node isn't already known to be fully inside of
+	};
+	std::array<entry, constants::bvh_max_depth> stack;
+	size_t stack_size{};
+	stack[stack_size++] = entry{ 0, all_planes };
+
+	while (stack_size > 0) {
+		const auto [index, parent_mask]{ stack[--stack_size] };
+		const auto &current{ m_nodes[index] };
+		++stats.nodes_visited;
+
+		const auto center{ (current.min + current.max) * 0.5f };
+		const auto extent{ (current.max - current.min) * 0.5f };
+
+		auto planes_mask{ parent_mask };
+		auto outside{ false };
+		for (u32 plane{}; plane < std::size(frustum.planes) && !outside; ++plane) {
+			if ((planes_mask & (1u << plane)) == 0) continue;
+
+			const auto &equation{ frustum.planes[plane] };
+			const auto normal{ glm::vec3{ equation } };
+			const auto distance{ glm::dot(normal, center) + equation.w };
+			const auto reach{ glm::dot(glm::abs(normal), extent) };
+
+			outside = distance + reach < 0.0f;
+			if (distance - reach >= 0.0f) planes_mask &= ~(1u << plane);
+		}
+
+		if (outside) continue;
+		if (planes_mask == 0) {
+			accept_subtree(current, visible);
+		} else if (current.leaf) {
+			test_leaf(current, frustum, planes_mask, visible);
+		} else {
+			stack[stack_size++] = entry{ current.child + 1, planes_mask };
+			stack[stack_size++] = entry{ current.child, planes_mask };
+		}
+	}
+
+	stats.visible = static_cast<u32>(std::size(visible));
+	stats.culled = m_objects_count - stats.visible;
+	return stats;
+}
+
+void bvh::build_node(const u32 index, const std::span<u32> objects, const sphere_arrays &spheres) {
+	const auto count{ static_cast<u32>(std::size(objects)) };
+
+	if (count <= constants::bvh_leaf_size) {
+		const auto slot{ static_cast<u32>(std::size(m_slots)) };
+		m_slots.resize(slot + constants::bvh_leaf_size, constants::no_object);
+		std::ranges::copy(objects, std::next(std::begin(m_slots), slot));
+
+		auto &leaf{ m_nodes[index] };
+		leaf.count      = count;
+		leaf.slot_begin = slot;
+		leaf.slot_end   = slot + static_cast<u32>(constants::bvh_leaf_size);
+		return;
+	}
+
+	glm::vec3 low{ std::numeric_limits<f32>::max() };
+	glm::vec3 high{ std::numeric_limits<f32>::lowest() };
+	for (const auto object : objects) {
+		low = glm::min(low, center(spheres, object));
+		high = glm::max(high, center(spheres, object));
+	}
+	const auto size{ high - low };
+	const auto axis{ size.x >= size.y && size.x >= size.z ? 0 : (size.y >= size.z ? 1 : 2) };
+
+	const auto middle{ std::next(std::begin(objects), count / 2) };
+	std::nth_element(std::begin(objects), middle, std::end(objects),
+		[&spheres, axis] (const u32 a, const u32 b) {
+			return center(spheres, a)[axis] < center(spheres, b)[axis];
+		});
+
+	const auto child{ static_cast<u32>(std::size(m_nodes)) };
+	m_nodes.resize(child + 2);
+	m_nodes[index].child = child;
+	m_nodes[index].count = 0;
+	m_nodes[index].leaf  = false;
+
+	build_node(child, objects.first(count / 2), spheres);
+	build_node(child + 1, objects.subspan(count / 2), spheres);
+
+	// Leaves are laid out depth first, so every subtree owns a contiguous range of slots
+	m_nodes[index].slot_begin = m_nodes[child].slot_begin;
+	m_nodes[index].slot_end   = m_nodes[child + 1].slot_end;
+}
+
+void bvh::test_leaf(const node &leaf, const frustum &frustum, const u32 planes_mask,
+	std::vector<u32> &visible) const {
+	const auto zero{ lanes::broadcast(0.0f) };
+	const auto valid{ (1u << leaf.count) - 1 };
+
+	for (size_t offset{}; offset < constants::bvh_leaf_size; offset += lanes::width) {
+		const auto slot{ leaf.slot_begin + offset };
+		const auto x{ lanes::load(std::data(m_slot_x) + slot) };
+		const auto y{ lanes::load(std::data(m_slot_y) + slot) };
+		const auto z{ lanes::load(std::data(m_slot_z) + slot) };
+		const auto radius{ lanes::load(std::data(m_slot_radius) + slot) };
+
+		u32 outside{};
+		for (u32 plane{}; plane < std::size(frustum.planes); ++plane) {
+			if ((planes_mask & (1u << plane)) == 0) continue;
+
+			const auto &equation{ frustum.planes[plane] };
+			const auto distance{ lanes::broadcast(equation.x) * x + lanes::broadcast(equation.y) * y
+				+ lanes::broadcast(equation.z) * z + lanes::broadcast(equation.w) };
+			outside |= less_mask(distance + radius, zero);
+		}
+
+		for (auto inside{ ~outside & (valid >> offset) & ((1u << lanes::width) - 1) }; inside != 0; inside &= inside - 1) {
+			visible.push_back(m_slots[slot + static_cast<size_t>(std::countr_zero(inside))]);
+		}
+	}
+}
+
+void bvh::accept_subtree(const node &subtree, std::vector<u32> &visible) const {
+	for (auto slot{ subtree.slot_begin }; slot < subtree.slot_end; ++slot) {
+		if (m_slots[slot] != constants::no_object) {
+			visible.push_back(m_slots[slot]);
+		}
+	}
+}
+
+#pragma endregion bvh
+
+} // namespace vc::engine::scene
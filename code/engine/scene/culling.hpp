@@ -0,0 +1,77 @@
+#pragma once
+
+#include <span>
+#include <array>
+#include <limits>
+#include <vector>
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+#include <glm/mat4x4.hpp>
+
+#include "core/types.hpp"
+#include "engine/scene/scene.hpp"
+
+namespace vc::engine::scene {
+
+namespace constants {
+
+constexpr size_t bvh_leaf_size { 8 };  ///< Objects tested at once with the SIMD plane tests
+constexpr size_t bvh_max_depth { 64 };
+constexpr u32    no_object     { std::numeric_limits<u32>::max() };
+
+} // namespace constants
+
+/// Planes point inwards: a point `p` is inside if `dot(plane.xyz, p) + plane.w >= 0` for all six.
+struct frustum {
+	std::array<glm::vec4, 6> planes;
+
+	/// Extracts the planes of a [0; 1] depth range projection.
+	[[nodiscard]] static auto from(const glm::mat4 &view_projection) noexcept -> frustum;
+};
+
+struct culling_stats {
+	u32 visible      {};
+	u32 culled       {};
+	u32 nodes_visited{};
+};
+
+/// Bounding volume hierarchy over the scene's world bounding spheres. The topology is built once
+/// with median splits; afterwards `refit` only recomputes the boxes, which is cheap and stays
+/// tight as long as objects move around their initial neighbourhood.
+class bvh {
+public:
+	void build(const sphere_arrays &spheres);
+	void refit(const sphere_arrays &spheres);
+
+	/// Replaces `visible` with the indices of the objects intersecting the `frustum`.
+	auto cull(const frustum &frustum, std::vector<u32> &visible) const -> culling_stats;
+
+	[[nodiscard]] auto objects_count() const noexcept { return m_objects_count; }
+
+private:
+	struct node {
+		glm::vec3 min       { 0.0f };
+		u32       child     {};  ///< Left child, the right one follows it
+		glm::vec3 max       { 0.0f };
+		u32       count     {};  ///< Objects in a leaf, zero for inner nodes and empty leaves
+		u32       slot_begin{};  ///< Leaf slots of the whole subtree
+		u32       slot_end  {};
+		b8        leaf      { true };
+	};
+
+	std::vector<node> m_nodes;
+	/// Object of every leaf slot, each leaf owns `bvh_leaf_size` slots
+	std::vector<u32>  m_slots;
+	std::vector<f32>  m_slot_x;
+	std::vector<f32>  m_slot_y;
+	std::vector<f32>  m_slot_z;
+	std::vector<f32>  m_slot_radius;
+	u32               m_objects_count{};
+
+	void build_node(u32 index, std::span<u32> objects, const sphere_arrays &spheres);
+	void test_leaf(const node &leaf, const frustum &frustum, u32 planes_mask, std::vector<u32> &visible) const;
+	void accept_subtree(const node &subtree, std::vector<u32> &visible) const;
+};
+
+} // namespace vc::engine::scene
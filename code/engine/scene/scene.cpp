@@ -0,0 +1,286 @@
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+
+#include <glm/geometric.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include "core/simd.hpp"
+#include "engine/scene/scene.hpp"
+
+namespace vc::engine::scene {
+
+namespace {
+
+using lanes = core::simd::native_lanes;
+
+constexpr size_t matrix_elements{ 16 };
+
+template<class Lanes>
+void spin(const size_t count, const f32 delta,
+	const f32 *spin_x, const f32 *spin_y, const f32 *spin_z,
+	f32 *rotation_x, f32 *rotation_y, f32 *rotation_z, f32 *rotation_w) noexcept {
+	// First order rotation quaternion (axis * angle / 2, 1) followed by a renormalization:
+	// no trigonometry per object, and the angle error is negligible at per-frame steps.
+	const auto half_delta{ Lanes::broadcast(0.5f * delta) };
+
+	for (size_t i{}; i < count; i += Lanes::width) {
+		const auto ax{ Lanes::load(spin_x + i) * half_delta };
+		const auto ay{ Lanes::load(spin_y + i) * half_delta };
+		const auto az{ Lanes::load(spin_z + i) * half_delta };
+
+		const auto bx{ Lanes::load(rotation_x + i) };
+		const auto by{ Lanes::load(rotation_y + i) };
+		const auto bz{ Lanes::load(rotation_z + i) };
+		const auto bw{ Lanes::load(rotation_w + i) };
+
+		const auto x{ bx + ax * bw + ay * bz - az * by };
+		const auto y{ by - ax * bz + ay * bw + az * bx };
+		const auto z{ bz + ax * by - ay * bx + az * bw };
+		const auto w{ bw - ax * bx - ay * by - az * bz };
+
+		const auto inverse_length{ rsqrt(x * x + y * y + z * z + w * w) };
+		(x * inverse_length).store(rotation_x + i);
+		(y * inverse_length).store(rotation_y + i);
+		(z * inverse_length).store(rotation_z + i);
+		(w * inverse_length).store(rotation_w + i);
+	}
+}
+
+template<class Lanes>
+void compose(const size_t count,
+	const f32 *position_x, const f32 *position_y, const f32 *position_z,
+	const f32 *rotation_x, const f32 *rotation_y, const f32 *rotation_z, const f32 *rotation_w,
+	const f32 *scale_x, const f32 *scale_y, const f32 *scale_z,
+	glm::mat4 *world) noexcept {
+	const auto one{ Lanes::broadcast(1.0f) };
+	const auto two{ Lanes::broadcast(2.0f) };
+	const auto zero{ Lanes::broadcast(0.0f) };
+
+	// Every register holds one matrix element of `width` objects, so each column is transposed
+	// on the way out to get column-major matrices.
+	for (size_t i{}; i < count; i += Lanes::width) {
+		const auto x{ Lanes::load(rotation_x + i) };
+		const auto y{ Lanes::load(rotation_y + i) };
+		const auto z{ Lanes::load(rotation_z + i) };
+		const auto w{ Lanes::load(rotation_w + i) };
+		const auto sx{ Lanes::load(scale_x + i) };
+		const auto sy{ Lanes::load(scale_y + i) };
+		const auto sz{ Lanes::load(scale_z + i) };
+
+		const auto xx{ x * x }, yy{ y * y }, zz{ z * z };
+		const auto xy{ x * y }, xz{ x * z }, yz{ y * z };
+		const auto wx{ w * x }, wy{ w * y }, wz{ w * z };
+
+		auto *destination{ glm::value_ptr(world[i]) };
+		Lanes::store_transposed(
+			sx * (one - two * (yy + zz)), sx * two * (xy + wz), sx * two * (xz - wy), zero,
+			destination, matrix_elements);
+		Lanes::store_transposed(
+			sy * two * (xy - wz), sy * (one - two * (xx + zz)), sy * two * (yz + wx), zero,
+			destination + 4, matrix_elements);
+		Lanes::store_transposed(
+			sz * two * (xz + wy), sz * two * (yz - wx), sz * (one - two * (xx + yy)), zero,
+			destination + 8, matrix_elements);
+		Lanes::store_transposed(
+			Lanes::load(position_x + i), Lanes::load(position_y + i), Lanes::load(position_z + i), one,
+			destination + 12, matrix_elements);
+	}
+}
+
+/// `child = parent * child`
+void apply_parent(const glm::mat4 &parent, glm::mat4 &child) noexcept {
+#if defined(VC_SIMD_SSE)
+	const auto *p{ glm::value_ptr(parent) };
+	auto *c{ glm::value_ptr(child) };
+	const auto p0{ _mm_loadu_ps(p) };
+	const auto p1{ _mm_loadu_ps(p + 4) };
+	const auto p2{ _mm_loadu_ps(p + 8) };
+	const auto p3{ _mm_loadu_ps(p + 12) };
+
+	// Every source element is read before its column is overwritten
+	for (size_t column{}; column < 4; ++column) {
+		auto *target{ c + column * 4 };
+		const auto result{ _mm_add_ps(
+			_mm_add_ps(_mm_mul_ps(p0, _mm_set1_ps(target[0])), _mm_mul_ps(p1, _mm_set1_ps(target[1]))),
+			_mm_add_ps(_mm_mul_ps(p2, _mm_set1_ps(target[2])), _mm_mul_ps(p3, _mm_set1_ps(target[3])))
+		) };
+		_mm_storeu_ps(target, result);
+	}
+#else
+	child = parent * child;
+#endif
+}
+
+} // anonymous namespace
+
+scene::scene(const size_t capacity) {
+	const auto padded{ core::simd::padded_size(capacity) };
+	for (auto *array : { &m_position_x, &m_position_y, &m_position_z,
+		&m_rotation_x, &m_rotation_y, &m_rotation_z, &m_rotation_w,
+		&m_scale_x, &m_scale_y, &m_scale_z, &m_spin_x, &m_spin_y, &m_spin_z,
+		&m_bounds_x, &m_bounds_y, &m_bounds_z, &m_bounds_radius,
+		&m_sphere_x, &m_sphere_y, &m_sphere_z, &m_sphere_radius }) {
+		array->reserve(padded);
+	}
+	m_parents.reserve(padded);
+	m_world.reserve(padded);
+}
+
+u32 scene::add(const transform &local, const resources::bounding_sphere &bounds,
+	const glm::vec3 spin, const u32 parent) {
+	const auto index{ static_cast<u32>(m_size) };
+	assert((parent == constants::no_parent || parent < index) && "A parent must be added before its children");
+
+	if (m_size == std::size(m_parents)) {
+		resize_arrays(core::simd::padded_size(m_size + 1));
+	}
+	++m_size;
+
+	m_position_x[index] = local.position.x;
+	m_position_y[index] = local.position.y;
+	m_position_z[index] = local.position.z;
+	m_rotation_x[index] = local.rotation.x;
+	m_rotation_y[index] = local.rotation.y;
+	m_rotation_z[index] = local.rotation.z;
+	m_rotation_w[index] = local.rotation.w;
+	m_scale_x[index]    = local.scale.x;
+	m_scale_y[index]    = local.scale.y;
+	m_scale_z[index]    = local.scale.z;
+	m_spin_x[index]     = spin.x;
+	m_spin_y[index]     = spin.y;
+	m_spin_z[index]     = spin.z;
+	m_parents[index]    = parent;
+
+	m_bounds_x[index]      = bounds.center.x;
+	m_bounds_y[index]      = bounds.center.y;
+	m_bounds_z[index]      = bounds.center.z;
+	m_bounds_radius[index] = bounds.radius;
+
+	m_has_hierarchy = m_has_hierarchy || parent != constants::no_parent;
+	return index;
+}
+
+transform scene::local(const u32 index) const {
+	assert(index < m_size && "Object index is out of range");
+	return transform{
+		.position = { m_position_x[index], m_position_y[index], m_position_z[index] },
+		.rotation = glm::quat{ m_rotation_w[index], m_rotation_x[index], m_rotation_y[index], m_rotation_z[index] },
+		.scale    = { m_scale_x[index], m_scale_y[index], m_scale_z[index] }
+	};
+}
+
+void scene::update(const f32 delta) {
+	// Arrays are padded to the widest register, the padding objects are identities.
+	const auto count{ std::size(m_parents) };
+
+	spin<lanes>(count, delta,
+		std::data(m_spin_x), std::data(m_spin_y), std::data(m_spin_z),
+		std::data(m_rotation_x), std::data(m_rotation_y), std::data(m_rotation_z), std::data(m_rotation_w));
+
+	compose<lanes>(count,
+		std::data(m_position_x), std::data(m_position_y), std::data(m_position_z),
+		std::data(m_rotation_x), std::data(m_rotation_y), std::data(m_rotation_z), std::data(m_rotation_w),
+		std::data(m_scale_x), std::data(m_scale_y), std::data(m_scale_z),
+		std::data(m_world));
+
+	if (m_has_hierarchy) {
+		for (size_t i{}; i < m_size; ++i) {
+			if (const auto parent{ m_parents[i] }; parent != constants::no_parent) {
+				apply_parent(m_world[parent], m_world[i]);
+			}
+		}
+	}
+
+	update_spheres();
+}
+
+sphere_arrays scene::world_spheres() const noexcept {
+	return sphere_arrays{
+		.x      = std::span<const f32>{ std::data(m_sphere_x), m_size },
+		.y      = std::span<const f32>{ std::data(m_sphere_y), m_size },
+		.z      = std::span<const f32>{ std::data(m_sphere_z), m_size },
+		.radius = std::span<const f32>{ std::data(m_sphere_radius), m_size }
+	};
+}
+
+void scene::write_world(const std::span<glm::mat4> destination) const {
+	assert(std::size(destination) >= m_size && "The destination can't hold all world matrices");
+	if (m_size == 0) return;
+
+#if defined(VC_SIMD_SSE)
+	auto *target{ glm::value_ptr(destination.front()) };
+	if (reinterpret_cast<uintptr_t>(target) % alignof(__m128) == 0) {
+		const auto *source{ glm::value_ptr(m_world.front()) };
+		for (size_t i{}; i < m_size * matrix_elements; i += 4) {
+			_mm_stream_ps(target + i, _mm_loadu_ps(source + i));
+		}
+		_mm_sfence();
+		return;
+	}
+#endif
+	std::copy_n(std::begin(m_world), m_size, std::begin(destination));
+}
+
+void scene::write_world(const std::span<glm::mat4> destination, const std::span<const u32> objects) const {
+	assert(std::size(destination) >= std::size(objects) && "The destination can't hold all world matrices");
+	if (std::empty(objects)) return;
+
+#if defined(VC_SIMD_SSE)
+	auto *target{ glm::value_ptr(destination.front()) };
+	if (reinterpret_cast<uintptr_t>(target) % alignof(__m128) == 0) {
+		for (const auto object : objects) {
+			const auto *source{ glm::value_ptr(m_world[object]) };
+			for (size_t i{}; i < matrix_elements; i += 4) {
+				_mm_stream_ps(target + i, _mm_loadu_ps(source + i));
+			}
+			target += matrix_elements;
+		}
+		_mm_sfence();
+		return;
+	}
+#endif
+	for (size_t i{}; i < std::size(objects); ++i) {
+		destination[i] = m_world[objects[i]];
+	}
+}
+
+std::string_view scene::instruction_set() noexcept {
+	return lanes::name;
+}
+
+void scene::resize_arrays(const size_t size) {
+	for (auto *array : { &m_position_x, &m_position_y, &m_position_z,
+		&m_spin_x, &m_spin_y, &m_spin_z, &m_rotation_x, &m_rotation_y, &m_rotation_z }) {
+		array->resize(size, 0.0f);
+	}
+	for (auto *array : { &m_rotation_w, &m_scale_x, &m_scale_y, &m_scale_z }) {
+		array->resize(size, 1.0f);
+	}
+	for (auto *array : { &m_bounds_x, &m_bounds_y, &m_bounds_z, &m_bounds_radius,
+		&m_sphere_x, &m_sphere_y, &m_sphere_z, &m_sphere_radius }) {
+		array->resize(size, 0.0f);
+	}
+	m_parents.resize(size, constants::no_parent);
+	m_world.resize(size, glm::mat4{ 1.0f });
+}
+
+void scene::update_spheres() {
+	// The radius grows with the largest axis scale, so non-uniform scales stay conservative.
+	for (size_t i{}; i < m_size; ++i) {
+		const auto &world{ m_world[i] };
+		const auto center{ world * glm::vec4{ m_bounds_x[i], m_bounds_y[i], m_bounds_z[i], 1.0f } };
+		const auto scale_squared{ std::max({
+			glm::dot(glm::vec3{ world[0] }, glm::vec3{ world[0] }),
+			glm::dot(glm::vec3{ world[1] }, glm::vec3{ world[1] }),
+			glm::dot(glm::vec3{ world[2] }, glm::vec3{ world[2] })
+		}) };
+
+		m_sphere_x[i]      = center.x;
+		m_sphere_y[i]      = center.y;
+		m_sphere_z[i]      = center.z;
+		m_sphere_radius[i] = m_bounds_radius[i] * std::sqrt(scale_squared);
+	}
+}
+
+} // namespace vc::engine::scene
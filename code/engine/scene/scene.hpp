@@ -0,0 +1,106 @@
+#pragma once
+
+#include <span>
+#include <limits>
+#include <vector>
+#include <string_view>
+
+#include <glm/vec3.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "core/types.hpp"
+#include "engine/resources/bounds.hpp"
+
+namespace vc::engine::scene {
+
+namespace constants {
+
+constexpr u32 no_parent{ std::numeric_limits<u32>::max() };
+
+} // namespace constants
+
+/// World-space bounding spheres in structure-of-arrays form.
+struct sphere_arrays {
+	std::span<const f32> x;
+	std::span<const f32> y;
+	std::span<const f32> z;
+	std::span<const f32> radius;
+};
+
+struct transform {
+	glm::vec3 position{ 0.0f };
+	glm::quat rotation{ 1.0f, 0.0f, 0.0f, 0.0f };
+	glm::vec3 scale   { 1.0f };
+};
+
+/// Object transforms in structure-of-arrays form, so the per-frame kernels (spin, compose,
+/// hierarchy) process a full SIMD register of objects per iteration. A parent must be added
+/// before its children: a single forward pass then resolves the whole hierarchy.
+class scene {
+public:
+	scene() = default;
+	explicit scene(size_t capacity);
+
+	scene(const scene &) = delete;
+	scene &operator=(const scene &) = delete;
+
+	/// `spin` is the angular velocity: rotation axis scaled by radians per second. `bounds` is the
+	/// bounding sphere of the object's model in its local space.
+	auto add(const transform &local, const resources::bounding_sphere &bounds,
+		glm::vec3 spin = glm::vec3{ 0.0f }, u32 parent = constants::no_parent) -> u32;
+
+	[[nodiscard]] auto size() const noexcept { return m_size; }
+	[[nodiscard]] auto local(u32 index) const -> transform;
+	[[nodiscard]] auto parent(u32 index) const { return m_parents.at(index); }
+	[[nodiscard]] auto world() const noexcept -> std::span<const glm::mat4> {
+		return std::span<const glm::mat4>{ std::data(m_world), m_size };
+	}
+
+	/// World bounding spheres as of the last `update`.
+	[[nodiscard]] auto world_spheres() const noexcept -> sphere_arrays;
+
+	/// Advances the spins by `delta` seconds, recomputes the world matrices and bounding spheres.
+	void update(f32 delta);
+
+	/// Streams the world matrices into `destination`, typically mapped GPU-visible memory that
+	/// is write-combined and must not be read back.
+	void write_world(std::span<glm::mat4> destination) const;
+	/// Streams only the world matrices of the `objects`, in their order.
+	void write_world(std::span<glm::mat4> destination, std::span<const u32> objects) const;
+
+	[[nodiscard]] static auto instruction_set() noexcept -> std::string_view;
+
+private:
+	size_t                 m_size{};
+
+	std::vector<f32>       m_position_x;
+	std::vector<f32>       m_position_y;
+	std::vector<f32>       m_position_z;
+	std::vector<f32>       m_rotation_x;
+	std::vector<f32>       m_rotation_y;
+	std::vector<f32>       m_rotation_z;
+	std::vector<f32>       m_rotation_w;
+	std::vector<f32>       m_scale_x;
+	std::vector<f32>       m_scale_y;
+	std::vector<f32>       m_scale_z;
+	std::vector<f32>       m_spin_x;
+	std::vector<f32>       m_spin_y;
+	std::vector<f32>       m_spin_z;
+	std::vector<f32>       m_bounds_x;
+	std::vector<f32>       m_bounds_y;
+	std::vector<f32>       m_bounds_z;
+	std::vector<f32>       m_bounds_radius;
+	std::vector<f32>       m_sphere_x;
+	std::vector<f32>       m_sphere_y;
+	std::vector<f32>       m_sphere_z;
+	std::vector<f32>       m_sphere_radius;
+	std::vector<u32>       m_parents;
+	std::vector<glm::mat4> m_world;
+	b8                     m_has_hierarchy{ false };
+
+	void resize_arrays(size_t size);
+	void update_spheres();
+};
+
+} // namespace vc::engine::scene
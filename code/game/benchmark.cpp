@@ -0,0 +1,123 @@
+#include <span>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <numeric>
+#include <algorithm>
+
+#include <fmt/core.h>
+
+#include "core/memory-usage.hpp"
+#include "game/benchmark.hpp"
+
+namespace vc::game {
+
+namespace {
+
+/// Mean, nearest-rank percentiles and maximum of the samples, `null` without any.
+[[nodiscard]] auto describe(const std::span<const f64> samples) -> std::string {
+	if (std::empty(samples)) return "null";
+
+	std::vector<f64> sorted(std::begin(samples), std::end(samples));
+	std::ranges::sort(sorted);
+	const auto percentile{ [&sorted] (const f64 rank) {
+		const auto index{ static_cast<size_t>(rank / 100.0 * static_cast<f64>(std::size(sorted)) + 0.5) };
+		return sorted[std::clamp<size_t>(index, 1, std::size(sorted)) - 1];
+	} };
+	const auto mean{ std::accumulate(std::begin(sorted), std::end(sorted), 0.0) / static_cast<f64>(std::size(sorted)) };
+	return fmt::format(R"({{ "mean": {:.4f}, "p50": {:.4f}, "p90": {:.4f}, "p99": {:.4f}, "max": {:.4f} }})",
+		mean, percentile(50.0), percentile(90.0), percentile(99.0), sorted.back());
+}
+
+[[nodiscard]] auto escape(const std::string_view text) -> std::string {
+	std::string result;
+	for (const auto symbol : text) {
+		if (symbol == '"' || symbol == '\\') result += '\\';
+		result += symbol;
+	}
+	return result;
+}
+
+} // anonymous namespace
+
+benchmark::benchmark(const launch_options &options)
+	: m_frames       { options.benchmark_frames }
+	, m_seconds      { options.benchmark_seconds }
+	, m_warmup_frames{ options.warmup_frames }
+	, m_timestep     { options.timestep }
+	, m_output       { options.benchmark_output } {
+	if (m_frames > 0) {
+		m_cpu_times.reserve(m_frames);
+		m_gpu_times.reserve(m_frames);
+	}
+	std::printf("[game][benchmark] Timestep %.4f s, %u warm-up frames, then %u frames or %.1f s\n",
+		m_timestep, m_warmup_frames, m_frames, m_seconds);
+}
+
+void benchmark::end_frame(const u64 frame) {
+	const auto now{ clock::now() };
+	const auto previous{ std::exchange(m_previous_end, now) };
+	if (frame <= m_warmup_frames || !previous.has_value()) return;
+
+	if (!m_start.has_value()) {
+		m_start = *previous;
+	}
+	m_cpu_times.push_back(std::chrono::duration<f64, std::milli>{ now - *previous }.count());
+	m_last_measured = frame;
+	m_end = now;
+}
+
+void benchmark::add_gpu_time(const engine::graphics::gpu_time_sample &sample) {
+	// Frames submitted after the run finished are still read back on the way out
+	if (sample.frame <= m_warmup_frames || sample.frame > m_last_measured) return;
+	m_gpu_times.push_back(sample.milliseconds);
+}
+
+b8 benchmark::is_finished() const noexcept {
+	if (m_frames > 0 && std::size(m_cpu_times) >= m_frames) return true;
+	return m_seconds > 0.0 && elapsed() >= m_seconds;
+}
+
+void benchmark::write_summary(const benchmark_environment &environment) const {
+	const auto seconds{ elapsed() };
+	const auto frames{ std::size(m_cpu_times) };
+	const auto summary{ fmt::format(
+		"{{\n"
+		R"(  "device": "{}",)" "\n"
+		R"(  "mode": "{}",)" "\n"
+		R"(  "gpu_culling": {},)" "\n"
+		R"(  "objects": {},)" "\n"
+		R"(  "timestep": {:.6f},)" "\n"
+		R"(  "warmup_frames": {},)" "\n"
+		R"(  "frames": {},)" "\n"
+		R"(  "seconds": {:.4f},)" "\n"
+		R"(  "fps": {:.2f},)" "\n"
+		R"(  "cpu_frame_ms": {},)" "\n"
+		R"(  "gpu_frame_ms": {},)" "\n"
+		R"(  "peak_memory_bytes": {})" "\n"
+		"}}\n",
+		escape(environment.device), environment.mode, environment.gpu_culling, environment.objects,
+		m_timestep, m_warmup_frames, frames, seconds,
+		seconds > 0.0 ? static_cast<f64>(frames) / seconds : 0.0,
+		describe(m_cpu_times), describe(m_gpu_times), core::peak_resident_bytes()
+	) };
+
+	if (std::empty(m_output)) {
+		std::fputs(std::data(summary), stdout);
+		return;
+	}
+	auto *file{ std::fopen(std::data(m_output), "w") };
+	if (file == nullptr) {
+		throw benchmark_error{ fmt::format(R"(Cannot write the benchmark summary to "{}".)", m_output) };
+	}
+	std::fputs(std::data(summary), file);
+	std::fclose(file);
+	std::printf("[game][benchmark] %zu frames in %.2f s, summary written to %s\n", frames, seconds, std::data(m_output));
+}
+
+f64 benchmark::elapsed() const noexcept {
+	if (!m_start.has_value()) return 0.0;
+	return std::chrono::duration<f64>{ m_end - *m_start }.count();
+}
+
+} // namespace vc::game
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+
+#include "core/types.hpp"
+#include "engine/graphics/gpu-timer.hpp"
+#include "game/launch-options.hpp"
+
+namespace vc::game {
+
+/// What the summary reports next to the numbers, so runs of different setups can be told apart.
+struct benchmark_environment {
+	std::string_view device;
+	std::string_view mode;
+	u32              objects    {};
+	b8               gpu_culling{ false };
+};
+
+/// Collects the frame times of a benchmark run. The warm-up frames are skipped, then every
+/// submitted frame adds the interval since the previous one and the GPU adds its own time of
+/// the frame once its timestamps are read back.
+class benchmark {
+public:
+	explicit benchmark(const launch_options &options);
+
+	/// Called once the `frame` was submitted.
+	void end_frame(u64 frame);
+	void add_gpu_time(const engine::graphics::gpu_time_sample &sample);
+
+	[[nodiscard]] auto is_finished() const noexcept -> b8;
+	/// Writes a JSON summary to the output file, or to the standard output without one.
+	void write_summary(const benchmark_environment &environment) const;
+
+private:
+	using clock = std::chrono::steady_clock;
+
+	u32               m_frames;
+	f64               m_seconds;
+	u32               m_warmup_frames;
+	f64               m_timestep;
+	std::string       m_output;
+	u64               m_last_measured{};
+	std::optional<clock::time_point> m_previous_end;
+	std::optional<clock::time_point> m_start;
+	clock::time_point m_end{};
+	std::vector<f64>  m_cpu_times;  ///< Milliseconds
+	std::vector<f64>  m_gpu_times;
+
+	[[nodiscard]] auto elapsed() const noexcept -> f64;
+};
+
+class benchmark_error : public std::runtime_error {
+public:
+	using base_type = std::runtime_error;
+	using base_type::runtime_error;
+};
+
+} // namespace vc::game
@@ -1,6 +1,24 @@
+#include <span>
+#include <cmath>
+#include <random>
+#include <atomic>
+#include <limits>
+#include <numeric>
+#include <thread>
+#include <utility>
+#include <exception>
+#include <filesystem>
+
 #include <fmt/core.h>
 #include <glm/glm.hpp>
 #include <glm/ext/matrix_transform.hpp>
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/gtc/constants.hpp>
+
+#include "core/hash.hpp"
+#include "core/triple-buffer.hpp"
+#include "engine/resources/mesh-cache.hpp"
+#include "engine/resources/mesh-loader.hpp"
 
 #include "game/game_instance.hpp"
 #include "game/toys/serpinsky_triangle.hpp"
@@ -11,46 +29,457 @@ struct simple_push_constant_data {
 	glm::mat4 transform;
 };
 
-game_instance::game_instance() {
-	load_models();
+namespace {
+
+using engine::resources::model;
+using engine::resources::mesh_cache;
+
+constexpr std::array serpinsky_root{
+	model::vertex{ .position = {  0.0f, -0.9f, 0.0f }, .color = { 1.0f, 0.62f, 0.23f, 1.0f } },
+	model::vertex{ .position = {  0.9f,  0.9f, 0.0f }, .color = { 0.5f, 0.31f, 0.61f, 1.0f } },
+	model::vertex{ .position = { -0.9f,  0.9f, 0.0f }, .color = { 0.5f, 0.31f, 0.61f, 1.0f } }
+};
+
+[[nodiscard]] auto cache_path(const std::string_view name, const u64 source_key) -> std::string {
+	return fmt::format("{}/{}-{:016x}{}", constants::mesh_cache_dir, name, source_key,
+		engine::resources::constants::mesh_cache_extension);
+}
+
+} // anonymous namespace
+
+game_instance::game_instance(const launch_options &options) : m_options{ options } {
+	for (const auto &path : m_options.texture_paths) {
+		m_texture_handles.push_back(m_textures.request(path));
+	}
+	load_meshes();
+	construct_serpinsky();
+	populate_scene();
+	construct_render_graph();
 	construct_pipeline();
 	construct_command_buffers();
+
+	// After the initial recordings, which are never submitted
+	if (m_options.is_benchmark()) {
+		m_benchmark.emplace(m_options);
+		m_gpu_timer.emplace(m_device, engine::graphics::constants::max_frames_in_flight);
+	}
+	construct_capture();
 }
 
 int game_instance::run() {
-	constexpr float move_step{ 0.01f };
+	m_allocation_phases.begin("frames");
+	if (m_options.pipelined) {
+		run_pipelined();
+	} else {
+		run_serial();
+	}
+	m_allocation_phases.begin("shutdown");
+	m_device.wait_for_idle();
+	finish_benchmark();
+	if (m_capture.has_value()) {
+		// The device is idle, the last frames in flight are collected oldest first
+		constexpr auto slots{ static_cast<u32>(engine::graphics::constants::max_frames_in_flight) };
+		for (u32 i{ 1 }; i <= slots; ++i) {
+			m_capture->collect(static_cast<u32>((m_swap_chain.current_frame() + i) % slots));
+		}
+		m_capture->flush();
+	}
+	report_memory("shutdown");
 
+	return EXIT_SUCCESS;
+}
+
+void game_instance::run_serial() {
 	double last_time{ glfwGetTime() };
-	while (!m_window.is_closing()) {
-		const double delta{ glfwGetTime() - last_time };
-		last_time = glfwGetTime();
+	for (u64 frame{ 1 }; is_running(); ++frame) {
+		const double now{ glfwGetTime() };
+		const double delta{ frame_delta(now, last_time) };
+		last_time = now;
 
 		m_window.pull_events();
 
-		update(delta);
-		render_frame();
+		update(delta, frame);
+		render_frame(make_snapshot(frame));
 	}
-	m_device.wait_for_idle();
+}
 
-	return EXIT_SUCCESS;
+void game_instance::run_pipelined() {
+	core::triple_buffer<frame_snapshot> snapshots;
+	std::atomic<b8>    running  { true };
+	std::atomic<u64>   published{};
+	std::atomic<u64>   consumed {};
+	std::exception_ptr game_error;
+
+	// The game thread owns the simulation state. It simulates frame N+1 while the render thread
+	// records and submits frame N, but never runs further ahead than that.
+	std::thread game_thread{ [&] {
+		try {
+			double last_time{ glfwGetTime() };
+			for (u64 frame{ 1 }; running; ++frame) {
+				for (auto seen{ consumed.load() }; running && seen + 1 < frame; seen = consumed.load()) {
+					consumed.wait(seen);
+				}
+
+				const double now{ glfwGetTime() };
+				update(frame_delta(now, last_time), frame);
+				last_time = now;
+
+				snapshots.back() = make_snapshot(frame);
+				snapshots.publish();
+				published = frame;
+				published.notify_one();
+			}
+		} catch (...) {
+			game_error = std::current_exception();
+		}
+		running = false;
+		published.fetch_add(1);
+		published.notify_one();
+	} };
+
+	const auto stop_game_thread{ [&] {
+		running = false;
+		consumed = std::numeric_limits<u64>::max();
+		consumed.notify_one();
+		game_thread.join();
+	} };
+
+	try {
+		for (u64 rendered{}; is_running();) {
+			m_window.pull_events();
+
+			for (auto seen{ published.load() }; running && seen == rendered; seen = published.load()) {
+				published.wait(seen);
+			}
+			if (!running || !snapshots.acquire()) break;
+
+			const auto &snapshot{ snapshots.front() };
+			rendered = snapshot.index;
+			consumed = rendered;
+			consumed.notify_one();
+
+			render_frame(snapshot);
+		}
+	} catch (...) {
+		stop_game_thread();
+		throw;
+	}
+
+	stop_game_thread();
+	if (game_error) {
+		std::rethrow_exception(game_error);
+	}
+}
+
+b8 game_instance::is_running() const noexcept {
+	return !m_window.is_closing() && !(m_benchmark.has_value() && m_benchmark->is_finished());
+}
+
+f64 game_instance::frame_delta(const f64 now, const f64 last_time) const noexcept {
+	// Benchmarks simulate the same frames on every run, however long they take to render
+	return m_benchmark.has_value() ? m_options.timestep : now - last_time;
+}
+
+void game_instance::finish_benchmark() {
+	if (!m_benchmark.has_value()) return;
+
+	// The device is idle, so the last frames in flight have their timestamps
+	for (u32 slot{}; slot < engine::graphics::constants::max_frames_in_flight; ++slot) {
+		if (const auto sample{ m_gpu_timer->read(slot) }; sample.has_value()) {
+			m_benchmark->add_gpu_time(*sample);
+		}
+	}
+	m_benchmark->write_summary(benchmark_environment{
+		.device      = m_device.name(),
+		.mode        = m_options.pipelined ? "pipelined" : "serial",
+		.objects     = m_options.objects,
+		.gpu_culling = m_gpu_culling.has_value()
+	});
+}
+
+b8 game_instance::is_capture_supported() const {
+	return m_swap_chain.supports_capture() && engine::graphics::frame_capture::is_supported(m_swap_chain.image_format());
+}
+
+void game_instance::construct_capture() {
+	if (!m_options.is_capturing()) return;
+	if (!is_capture_supported()) {
+		std::printf("[game][game_instance] The swap chain images cannot be copied, frames are not captured\n");
+		return;
+	}
+	// Benchmarks advance by the timestep, so the video plays in real time
+	const auto fps{ static_cast<u32>(std::max(1l, std::lround(1.0 / m_options.timestep))) };
+	m_capture.emplace(m_device, m_swap_chain.extent(), m_swap_chain.image_format(),
+		engine::graphics::constants::max_frames_in_flight, m_options.capture_path, fps);
+}
+
+void game_instance::report_memory(const std::string_view reason) const {
+	std::printf("[game][game_instance] Memory usage (%.*s), peak resident set %.2f MiB\n",
+		static_cast<int>(std::size(reason)), std::data(reason),
+		static_cast<f64>(core::peak_resident_bytes()) / (1024.0 * 1024.0));
+	for (const auto &[name, allocations] : m_allocation_phases.phases()) {
+		std::printf("[game][game_instance]   %-8s %10llu heap allocations, %.2f MiB\n", std::data(name),
+			static_cast<unsigned long long>(allocations.count), static_cast<f64>(allocations.bytes) / (1024.0 * 1024.0));
+	}
+	if (m_steady_frames > 0) {
+		std::printf("[game][game_instance]   %llu heap allocations in %llu steady-state frames\n",
+			static_cast<unsigned long long>(m_steady_allocations), static_cast<unsigned long long>(m_steady_frames));
+	}
+	m_device.memory_usage().print();
+	m_instance.host_allocator().print_statistics();
+}
+
+void game_instance::report_textures() {
+	// The textures aren't sampled yet, their residency is reported once every request settled
+	if (std::empty(m_texture_handles) || m_textures.pending() > 0) return;
+
+	const auto resident{ std::ranges::count_if(m_texture_handles, [this] (const auto texture) {
+		return m_textures.get(texture) != nullptr && m_textures.sampler(texture) != VK_NULL_HANDLE;
+	}) };
+	std::printf("[game][game_instance] %zu of %zu textures are resident, sharing %zu samplers\n",
+		static_cast<size_t>(resident), std::size(m_texture_handles), m_textures.samplers().size());
+	m_texture_handles.clear();
+}
+
+void game_instance::count_frame_allocations(const u64 frame, const u64 allocations) {
+	if (frame <= constants::allocation_warmup_frames) return;
+
+#if defined(VC_DEBUG)
+	if (allocations > 0 && m_steady_allocations == 0) {
+		std::printf("[game][game_instance] Frame %llu made %llu heap allocations after the warm-up\n",
+			static_cast<unsigned long long>(frame), static_cast<unsigned long long>(allocations));
+	}
+#endif // defined(VC_DEBUG)
+	m_steady_allocations += allocations;
+	++m_steady_frames;
+}
+
+void game_instance::update(const double delta, const u64 frame) {
+	update_camera(delta);
+	if (m_serpinsky.has_value()) {
+		update_serpinsky(frame);
+	}
+	m_scene.update(static_cast<f32>(delta));
+
+	if (m_gpu_culling.has_value()) {
+		const auto slot{ static_cast<u32>(frame % constants::instance_slots) };
+		m_scene.write_world(m_gpu_culling->objects(slot));
+		return;
+	}
+	// The adaptive Sierpinski toy draws no objects, there is nothing to cull or draw
+	if (m_scene.size() == 0) return;
+
+	m_bvh.refit(m_scene.world_spheres());
+	m_culling = m_bvh.cull(engine::scene::frustum::from(m_view_projection), m_visible);
+	build_draws(frame);
+	m_scene.write_world(m_instances->as<glm::mat4>(instances_offset(frame), std::size(m_draw_order)), m_draw_order);
+}
+
+void game_instance::build_draws(const u64 frame) {
+	// Counting sort of the visible objects by mesh: every mesh is one draw record whose
+	// instances are a contiguous run of the instance buffer
+	m_mesh_instances.assign(m_batch.meshes_count(), 0);
+	for (const auto object : m_visible) {
+		++m_mesh_instances[m_object_meshes[object]];
+	}
+
+	const auto commands{ m_batch.commands(static_cast<u32>(frame % constants::instance_slots)) };
+	m_draws_count = 0;
+	u32 first_instance{};
+	for (u32 mesh{}; mesh < m_batch.meshes_count(); ++mesh) {
+		const auto instances{ std::exchange(m_mesh_instances[mesh], first_instance) };
+		if (instances == 0) continue;
+
+		commands[m_draws_count++] = engine::graphics::batch_renderer::make_command(m_batch.mesh(mesh), instances, first_instance);
+		first_instance += instances;
+	}
+
+	m_draw_order.resize(std::size(m_visible));
+	for (const auto object : m_visible) {
+		m_draw_order[m_mesh_instances[m_object_meshes[object]]++] = object;
+	}
+}
+
+void game_instance::update_camera(const double delta) {
+	if (m_serpinsky.has_value()) {
+		update_zoom(delta);
+		return;
+	}
+
+	// Hovers over a quarter of the scene, so the culling has something to do
+	m_camera_time += delta;
+	const auto angle{ static_cast<f32>(m_camera_time) * constants::camera_speed };
+	const auto radius{ 0.25f * m_scene_extent };
+	const glm::vec3 target{ radius * std::cos(angle), radius * std::sin(angle), 0.0f };
+	const auto distance{ radius / std::tan(0.5f * constants::camera_fov) };
+
+	const auto projection{ glm::perspective(constants::camera_fov, m_swap_chain.aspect_ratio(), 0.1f, 2.0f * distance) };
+	const auto view{ glm::lookAt(target + glm::vec3{ 0.0f, 0.0f, distance }, target, glm::vec3{ 0.0f, 1.0f, 0.0f }) };
+	m_view_projection = projection * view;
+}
+
+void game_instance::update_zoom(const double delta) {
+	// The view is relative to the target, the cut is written relative to it as well
+	m_camera_time += delta;
+	auto distance{ constants::zoom_start * std::exp(-constants::zoom_speed * m_camera_time) };
+	if (distance < m_zoom_floor) {
+		m_camera_time = 0.0;
+		distance      = constants::zoom_start;
+	}
+
+	const auto eye{ static_cast<f32>(distance) };
+	const auto projection{ glm::perspective(constants::camera_fov, m_swap_chain.aspect_ratio(), 0.1f * eye, 2.0f * eye) };
+	const auto view{ glm::lookAt(glm::vec3{ 0.0f, 0.0f, eye }, glm::vec3{ 0.0f }, glm::vec3{ 0.0f, 1.0f, 0.0f }) };
+	m_view_projection = projection * view;
+}
+
+void game_instance::update_serpinsky(const u64 frame) {
+	const auto extent{ m_swap_chain.extent() };
+	m_serpinsky->refine(m_view_projection, m_zoom_target,
+		glm::vec2{ static_cast<f32>(extent.width), static_cast<f32>(extent.height) });
+
+	const auto changed{ m_serpinsky->changed() };
+	auto &changes{ m_serpinsky_changes[frame % constants::instance_slots] };
+	changes.assign(std::begin(changed), std::end(changed));
+
+	// A slot last written `instance_slots` frames ago only misses the triangles changed since,
+	// which are exactly the ones the change lists hold. Any other slot is written whole.
+	auto &slot{ m_serpinsky_slots[frame % constants::instance_slots] };
+	const auto destination{ m_serpinsky_vertices->as<model::vertex>(serpinsky_offset(frame), m_serpinsky->max_vertices()) };
+	if (slot.frame + constants::instance_slots == frame) {
+		for (const auto &since : m_serpinsky_changes) {
+			m_serpinsky->write(destination, since);
+		}
+	} else {
+		m_serpinsky->write(destination);
+	}
+	slot = serpinsky_slot{
+		.frame    = frame,
+		.vertices = static_cast<u32>(m_serpinsky->vertex_count()),
+		.depth    = m_serpinsky->depth()
+	};
 }
 
-void game_instance::update(const double delta) {
-	constexpr glm::vec3 rotation_axis{ 0.0f, 1.0f, 0.0f };
-	test_model_transform = glm::rotate(test_model_transform, static_cast<float>(delta), rotation_axis);
+frame_snapshot game_instance::make_snapshot(const u64 index) const {
+	const auto &serpinsky{ m_serpinsky_slots[index % constants::instance_slots] };
+	return frame_snapshot{
+		.index              = index,
+		.view_projection    = m_view_projection,
+		.instances_offset   = instances_offset(index),
+		.instances_count    = static_cast<u32>(std::size(m_visible)),
+		.draws_count        = m_gpu_culling.has_value() ? m_gpu_culling->draws_count() : m_draws_count,
+		.culling            = m_culling,
+		.serpinsky_offset   = serpinsky_offset(index),
+		.serpinsky_vertices = serpinsky.vertices,
+		.serpinsky_depth    = serpinsky.depth
+	};
 }
 
-void game_instance::render_frame() {
+VkDeviceSize game_instance::instances_offset(const u64 frame) const noexcept {
+	if (m_gpu_culling.has_value()) {
+		return m_gpu_culling->instances_offset(static_cast<u32>(frame % constants::instance_slots));
+	}
+	return (frame % constants::instance_slots) * m_scene.size() * sizeof(engine::resources::model::instance);
+}
+
+VkDeviceSize game_instance::serpinsky_offset(const u64 frame) const noexcept {
+	if (!m_serpinsky.has_value()) return 0;
+	return sizeof(model::instance) + (frame % constants::instance_slots) * m_serpinsky->max_vertices() * sizeof(model::vertex);
+}
+
+void game_instance::render_frame(const frame_snapshot &snapshot) {
+	// Transient data goes to the swap chain's frame arena, so a steady frame shouldn't allocate
+	const auto allocations_before{ core::heap_allocations().count };
+
 	const auto image_index{ m_swap_chain.acquire_next_image() };
 	if (!image_index.has_value()) {
 		throw game_instance_error{ "Failed to acquire next image." };
 	}
+	m_frame_descriptors.begin_frame(m_swap_chain.current_frame());
+	m_textures.update();
+	report_textures();
 
-	record_command_buffer(*image_index);
+	const auto memory_key_down{ m_window.key_pressed(constants::memory_report_key) };
+	if (memory_key_down && !m_memory_key_down) {
+		report_memory(fmt::format("frame {}", snapshot.index));
+	}
+	m_memory_key_down = memory_key_down;
+
+	// The acquire waited for the slot's previous frame, so its timestamps are ready
+	if (m_gpu_timer.has_value()) {
+		if (const auto sample{ m_gpu_timer->read(static_cast<u32>(m_swap_chain.current_frame())) }; sample.has_value()) {
+			m_benchmark->add_gpu_time(*sample);
+		}
+	}
+	if (m_capture.has_value()) {
+		m_capture->collect(static_cast<u32>(m_swap_chain.current_frame()));
+	}
+
+	// The culling runs on the compute queue while the previous frame is still being drawn
+	std::optional<engine::graphics::semaphore_wait> culled;
+	if (m_gpu_culling.has_value() && m_gpu_culling->is_async()) {
+		const auto slot{ static_cast<u32>(snapshot.index % constants::instance_slots) };
+		culled = m_gpu_culling->submit(slot, engine::scene::frustum::from(snapshot.view_projection));
+	}
+
+	record_command_buffer(*image_index, snapshot);
+
+	if (snapshot.index % constants::stats_interval == 0) {
+		if (m_gpu_culling.has_value()) {
+			std::printf("[game][game_instance] Frame %llu: %zu objects culled on the GPU, %u draws\n",
+				static_cast<unsigned long long>(snapshot.index), m_scene.size(), snapshot.draws_count);
+		} else {
+			std::printf("[game][game_instance] Frame %llu: %u visible, %u culled, %u BVH nodes visited, %u draws\n",
+				static_cast<unsigned long long>(snapshot.index),
+				snapshot.culling.visible, snapshot.culling.culled, snapshot.culling.nodes_visited, snapshot.draws_count);
+		}
+		if (m_serpinsky.has_value()) {
+			std::printf("[game][game_instance] Frame %llu: Sierpinski cut of %u triangles, %u levels deep\n",
+				static_cast<unsigned long long>(snapshot.index), snapshot.serpinsky_vertices / static_cast<u32>(toys::constants::triangle_vertices), snapshot.serpinsky_depth);
+		}
+		if (m_steady_frames > 0) {
+			std::printf("[game][game_instance] %llu heap allocations in %llu steady-state frames\n",
+				static_cast<unsigned long long>(m_steady_allocations), static_cast<unsigned long long>(m_steady_frames));
+		}
+	}
 
-	if (VK_SUCCESS != m_swap_chain.submit(*image_index, &m_command_buffers[*image_index])) {
+	const auto waits{ culled.has_value() ? std::span{ &*culled, 1 } : std::span<const engine::graphics::semaphore_wait>{} };
+	if (VK_SUCCESS != m_swap_chain.submit(*image_index, &m_command_buffers[*image_index], 1, waits)) {
 		throw game_instance_error{ fmt::format("Failed to submit frame buffer #{}", *image_index) };
 	}
+	if (m_benchmark.has_value()) {
+		m_benchmark->end_frame(snapshot.index);
+	}
+	count_frame_allocations(snapshot.index, core::heap_allocations().count - allocations_before);
+}
+
+void game_instance::construct_render_graph() {
+	using engine::graphics::image_usage;
+	using engine::graphics::pass_type;
+
+	const auto extent{ m_swap_chain.extent() };
+	m_backbuffer = m_render_graph.import_image("backbuffer", m_swap_chain.image_format(), extent, image_usage::present);
+	const auto depth{ m_render_graph.create_image("depth", m_swap_chain.find_depth_format(), extent) };
+
+	m_render_graph.add_pass(constants::scene_pass, pass_type::graphics)
+		.color(m_backbuffer, constants::clear_color)
+		.depth(depth, constants::clear_depth)
+		.record([this] (VkCommandBuffer command_buffer) { record_scene(command_buffer, *m_recorded_snapshot); });
+
+	// Every frame goes through the transfer layout, only every `capture_interval`th one is copied
+	if (m_options.is_capturing() && is_capture_supported()) {
+		m_render_graph.add_pass("capture", pass_type::transfer)
+			.read(m_backbuffer, image_usage::transfer_source)
+			.side_effect()
+			.record([this] (VkCommandBuffer command_buffer) {
+				const auto index{ m_recorded_snapshot->index };
+				if (m_capture.has_value() && index % m_options.capture_interval == 0) {
+					m_capture->record(command_buffer, m_swap_chain.image(m_recorded_image),
+						static_cast<u32>(m_swap_chain.current_frame()), index);
+				}
+			});
+	}
+	m_render_graph.compile();
 }
 
 void game_instance::construct_pipeline() {
@@ -65,14 +494,17 @@ void game_instance::construct_pipeline() {
 	m_pipeline_layout.emplace(m_device, std::span<const VkDescriptorSetLayout>{}, ranges);
 
 	const auto extent{ m_swap_chain.extent() };
-	m_pipeline.emplace(m_device, constants::default_shader, engine::graphics::pipeline_config{
+	m_pipeline = m_pipelines.graphics(constants::default_shader, engine::graphics::pipeline_config{
 		.viewport = {
 			.width  = static_cast<f32>(extent.width),
 			.height = static_cast<f32>(extent.height),
 		},
-		.scissor     = { .extent = extent },
-		.layout      = static_cast<VkPipelineLayout>(*m_pipeline_layout),
-		.render_pass = m_swap_chain.render_pass()
+		.scissor      = { .extent = extent },
+		.layout       = static_cast<VkPipelineLayout>(*m_pipeline_layout),
+		.render_pass  = m_render_graph.find_pass(constants::scene_pass).render_pass(),
+		.instanced    = true,
+		.color_format = m_swap_chain.image_format(),
+		.depth_format = m_swap_chain.find_depth_format()
 	});
 }
 
@@ -92,12 +524,13 @@ void game_instance::construct_command_buffers() {
 		) };
 	}
 
+	const auto snapshot{ make_snapshot(0) };
 	for (size_t i{}; i < std::size(m_command_buffers); ++i) {
-		record_command_buffer(i);
+		record_command_buffer(i, snapshot);
 	}
 }
 
-void game_instance::record_command_buffer(size_t image_index) {
+void game_instance::record_command_buffer(size_t image_index, const frame_snapshot &snapshot) {
 	auto &command_buffer{ m_command_buffers[image_index] };
 	const VkCommandBufferBeginInfo begin_info{
 		.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO
@@ -106,49 +539,248 @@ void game_instance::record_command_buffer(size_t image_index) {
 		throw game_instance_error{ fmt::format("Failed to begin command buffer #{}.", image_index) };
 	}
 
-	const VkRenderPassBeginInfo render_pass_info{
-		.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-		.renderPass = m_swap_chain.render_pass(),
-		.framebuffer = m_swap_chain.framebuffer(image_index),
-		.renderArea = VkRect2D{
-			.offset = { 0, 0 },
-			.extent = m_swap_chain.extent()
-		},
-		.clearValueCount = static_cast<u32>(std::size(constants::clear_values)),
-		.pClearValues    = std::data(constants::clear_values)
-	};
-	vkCmdBeginRenderPass(command_buffer, &render_pass_info, VK_SUBPASS_CONTENTS_INLINE);
+	const auto frame_slot{ static_cast<u32>(m_swap_chain.current_frame()) };
+	if (m_gpu_timer.has_value()) {
+		m_gpu_timer->begin(command_buffer, frame_slot);
+	}
+
+	const auto slot{ static_cast<u32>(snapshot.index % constants::instance_slots) };
+	if (m_gpu_culling.has_value() && m_gpu_culling->is_async()) {
+		m_gpu_culling->acquire(command_buffer, slot);
+	} else if (m_gpu_culling.has_value()) {
+		m_gpu_culling->dispatch(command_buffer, slot, engine::scene::frustum::from(snapshot.view_projection));
+	}
+
+	m_recorded_snapshot = &snapshot;
+	m_recorded_image    = image_index;
+	m_render_graph.bind(m_backbuffer, m_swap_chain.image(image_index), m_swap_chain.image_view(image_index));
+	m_render_graph.execute(command_buffer, frame_slot);
+	m_recorded_snapshot = nullptr;
+
+	if (m_gpu_timer.has_value()) {
+		m_gpu_timer->end(command_buffer, frame_slot, snapshot.index);
+	}
+	if (VK_SUCCESS != vkEndCommandBuffer(command_buffer)) {
+		throw game_instance_error{ fmt::format("Failed to end command buffer #{}.", image_index) };
+	}
+}
 
+void game_instance::record_scene(VkCommandBuffer command_buffer, const frame_snapshot &snapshot) {
+	const auto slot{ static_cast<u32>(snapshot.index % constants::instance_slots) };
 	m_pipeline->bind(command_buffer);
 
-	m_model->bind(command_buffer);
+	m_batch.bind(command_buffer);
+
+	const std::array instance_buffers{ m_gpu_culling.has_value() ? m_gpu_culling->instances() : m_instances->handle() };
+	const std::array instance_offsets{ snapshot.instances_offset };
+	vkCmdBindVertexBuffers(command_buffer, engine::resources::constants::instance_binding,
+		static_cast<u32>(std::size(instance_buffers)), std::data(instance_buffers), std::data(instance_offsets));
 
 	const simple_push_constant_data constant_data{
-		.transform = test_model_transform
+		.transform = snapshot.view_projection
 	};
 	vkCmdPushConstants(command_buffer, static_cast<VkPipelineLayout>(*m_pipeline_layout),
 		VK_SHADER_STAGE_VERTEX_BIT,
 		0, sizeof(simple_push_constant_data), &constant_data);
 
-	m_model->draw(command_buffer);
+	m_batch.draw(command_buffer, slot, snapshot.draws_count);
 
-	vkCmdEndRenderPass(command_buffer);
-	if (VK_SUCCESS != vkEndCommandBuffer(command_buffer)) {
-		throw game_instance_error{ fmt::format("Failed to end command buffer #{}.", image_index) };
+	if (snapshot.serpinsky_vertices > 0) {
+		const auto buffer{ m_serpinsky_vertices->handle() };
+		const VkDeviceSize identity_offset{ 0 };
+		vkCmdBindVertexBuffers(command_buffer, 0, 1, &buffer, &snapshot.serpinsky_offset);
+		vkCmdBindVertexBuffers(command_buffer, engine::resources::constants::instance_binding, 1, &buffer, &identity_offset);
+		vkCmdDraw(command_buffer, snapshot.serpinsky_vertices, 1, 0, 0);
 	}
 }
 
-void game_instance::load_models() {
+void game_instance::load_meshes() {
 	using namespace engine;
 	using vertex = resources::model::vertex;
 
-	constexpr std::array vertices{
-		vertex{ .position = {  0.0f, -0.9f, 0.0f }, .color = { 1.0f, 0.62f, 0.23f, 1.0f } },
-		vertex{ .position = {  0.9f,  0.9f, 0.0f }, .color = { 0.5f, 0.31f, 0.61f, 1.0f } },
-		vertex{ .position = { -0.9f,  0.9f, 0.0f }, .color = { 0.5f, 0.31f, 0.61f, 1.0f } }
-	};
+	std::vector<mesh_source> sources;
+	std::optional<resources::mesh_loader> loader;
+	if (!std::empty(m_options.model_path)) {
+		namespace fs = std::filesystem;
+		const fs::path source{ m_options.model_path };
+		const auto source_key{ core::hash_combine(
+			core::fnv1a(std::as_bytes(std::span{ m_options.model_path })),
+			core::hash_combine(
+				static_cast<u64>(fs::file_size(source)),
+				static_cast<u64>(fs::last_write_time(source).time_since_epoch().count())
+			)
+		) };
+
+		const auto path{ cache_path(source.stem().string(), source_key) };
+		if (auto cache{ resources::mesh_cache::try_open(path, source_key) }; cache.has_value()) {
+			sources.push_back(mesh_source{ .cache = std::move(cache) });
+		} else {
+			loader.emplace(m_jobs, m_options.model_path);
+			sources.push_back(bake_mesh(path, source_key, loader->vertex_count(),
+				[&loader] (const std::span<vertex> vertices) { loader->load_to(vertices); }));
+		}
+	} else {
+		for (const auto depth : constants::serpinsky_depths) {
+			sources.push_back(load_serpinsky(depth));
+		}
+	}
+
+	// Every mesh is reserved before any is written, so the batch stages them in a single buffer
+	for (const auto &source : sources) {
+		const auto vertex_count{ source.cache.has_value() ? std::size(source.cache->vertices()) : source.vertex_count };
+		const auto index_count{ source.cache.has_value() ? std::size(source.cache->indices()) : source.vertex_count };
+		m_meshes.push_back(m_batch.add_mesh(static_cast<u32>(vertex_count), static_cast<u32>(index_count)));
+	}
+	if (m_batch.meshes_count() > m_batch.max_draws()) {
+		throw game_instance_error{ fmt::format("Cannot draw {} meshes, the batch is limited to {}.",
+			m_batch.meshes_count(), m_batch.max_draws()) };
+	}
+
+	for (size_t i{}; i < std::size(sources); ++i) {
+		m_batch.write_mesh(m_meshes[i],
+			[&source = sources[i]] (const std::span<vertex> vertices, const std::span<u32> indices) {
+				if (source.cache.has_value()) {
+					std::ranges::copy(source.cache->vertices(), std::begin(vertices));
+					std::ranges::copy(source.cache->indices(), std::begin(indices));
+					return;
+				}
+				source.writer(vertices);
+				std::iota(std::begin(indices), std::end(indices), 0u);
+			});
+	}
+	if (!std::empty(m_options.model_path)) {
+		std::printf("[game][game_instance] Loaded \"%s\": %u indices\n",
+			std::data(m_options.model_path), m_batch.mesh(m_meshes.front()).index_count);
+	}
+	m_batch.upload();
+}
+
+auto game_instance::load_serpinsky(const size_t depth) -> mesh_source {
+	using namespace engine;
+	using vertex = resources::model::vertex;
+
+	const auto source_key{ core::hash_combine(core::fnv1a(std::as_bytes(std::span{ serpinsky_root })), depth) };
+	const auto path{ cache_path(fmt::format("serpinsky-{}", depth), source_key) };
+	if (auto cache{ resources::mesh_cache::try_open(path, source_key) }; cache.has_value()) {
+		return mesh_source{ .cache = std::move(cache) };
+	}
+
+	auto generated{ toys::make_serpinsky(m_jobs, depth, serpinsky_root) };
+	const auto vertex_count{ std::size(generated) };
+	return bake_mesh(path, source_key, vertex_count,
+		[generated = std::move(generated)] (const std::span<vertex> destination) {
+			std::ranges::copy(generated, std::begin(destination));
+		});
+}
+
+/// Writes the mesh into a cache file, the batch then copies its payload as is. Non indexed meshes
+/// store a trivial index list there. When the cache can't be stored the batch takes the mesh from
+/// the `writer`, so a read-only working directory only costs the next startup. Only cache errors
+/// are caught: a malformed mesh would fail the same way on the fallback.
+auto game_instance::bake_mesh(const std::string_view path, const u64 source_key, const size_t vertex_count,
+	model::vertex_writer writer) -> mesh_source {
+	try {
+		return mesh_source{ .cache = mesh_cache::build(path, source_key, vertex_count, vertex_count,
+			[&writer] (const std::span<model::vertex> vertices, const std::span<u32> indices) {
+				writer(vertices);
+				std::iota(std::begin(indices), std::end(indices), 0u);
+			}) };
+	} catch (const engine::resources::mesh_cache_error &error) {
+		std::printf("[game][game_instance] Mesh cache is unavailable: %s\n", error.what());
+	} catch (const core::mapped_file_error &error) {
+		std::printf("[game][game_instance] Mesh cache is unavailable: %s\n", error.what());
+	}
+	return mesh_source{ .vertex_count = vertex_count, .writer = std::move(writer) };
+}
+
+void game_instance::populate_scene() {
+	using namespace engine;
+
+	std::mt19937 random{ constants::scene_seed };
+	std::uniform_real_distribution<f32> unit{ -1.0f, 1.0f };
+	const auto random_axis{ [&] {
+		const glm::vec3 axis{ unit(random), unit(random), unit(random) };
+		return glm::length(axis) > 0.01f ? glm::normalize(axis) : glm::vec3{ 0.0f, 0.0f, 1.0f };
+	} };
+
+	// The adaptive toy is shown alone
+	const auto objects{ m_serpinsky.has_value() ? 0u : m_options.objects };
+	const auto clusters{ (objects + constants::cluster_size - 1) / constants::cluster_size };
+	const auto side{ static_cast<u32>(std::ceil(std::sqrt(static_cast<f32>(clusters)))) };
+	const auto half_extent{ 0.5f * constants::cluster_spacing * static_cast<f32>(side) };
+	const auto mesh_bounds{ [this] (const u32 mesh) { return m_batch.mesh(mesh).bounds.sphere; } };
+	// Roots show the first mesh, children cycle through the others
+	const auto child_mesh{ [this] (const u32 member) {
+		return std::size(m_meshes) > 1 ? m_meshes[1 + member % (std::size(m_meshes) - 1)] : m_meshes.front();
+	} };
+	m_object_meshes.reserve(objects);
+
+	for (u32 object{}; object < objects; ++object) {
+		const auto cluster{ object / constants::cluster_size };
+		const auto member{ object % constants::cluster_size };
+		if (member == 0) {
+			const glm::vec3 position{
+				constants::cluster_spacing * (static_cast<f32>(cluster % side) + 0.5f) - half_extent,
+				constants::cluster_spacing * (static_cast<f32>(cluster / side) + 0.5f) - half_extent,
+				0.0f
+			};
+			m_object_meshes.push_back(m_meshes.front());
+			m_scene.add(scene::transform{ .position = position, .scale = glm::vec3{ 0.5f } },
+				mesh_bounds(m_meshes.front()), glm::vec3{ 0.0f, 0.0f, 0.5f + unit(random) * 0.25f });
+			continue;
+		}
+
+		// Children orbit the root through the hierarchy and tumble on their own
+		const auto angle{ glm::two_pi<f32>() * static_cast<f32>(member) / (constants::cluster_size - 1) };
+		const auto radius{ 1.6f + 0.8f * static_cast<f32>(member % 3) };
+		m_object_meshes.push_back(child_mesh(member));
+		m_scene.add(scene::transform{
+				.position = glm::vec3{ radius * std::cos(angle), radius * std::sin(angle), 0.0f },
+				.scale    = glm::vec3{ 0.15f }
+			}, mesh_bounds(m_object_meshes.back()),
+			random_axis() * (1.0f + unit(random)), cluster * constants::cluster_size);
+	}
+
+	m_scene_extent = 2.0f * half_extent;
+	update_camera(0.0);
+	m_scene.update(0.0f);
+
+	if (m_options.gpu_culling && m_scene.size() > 0 && graphics::gpu_culling::is_supported(m_device)) {
+		m_gpu_culling.emplace(m_device, m_descriptor_layouts, m_descriptors, m_pipelines, m_batch, m_object_meshes,
+			constants::instance_slots);
+	} else {
+		if (m_options.gpu_culling) {
+			std::printf("[game][game_instance] GPU culling needs drawIndirectFirstInstance, culling on the CPU\n");
+		}
+		m_instances.emplace(m_device,
+			std::max<VkDeviceSize>(1, constants::instance_slots * m_scene.size() * sizeof(resources::model::instance)),
+			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		if (m_scene.size() > 0) {
+			m_bvh.build(m_scene.world_spheres());
+		}
+	}
+
+	std::printf("[game][game_instance] Scene: %zu objects, %s transform kernels\n",
+		m_scene.size(), std::data(scene::scene::instruction_set()));
+}
+
+void game_instance::construct_serpinsky() {
+	if (!m_options.adaptive_serpinsky) return;
+
+	m_serpinsky.emplace(serpinsky_root, toys::adaptive_serpinsky::settings{
+		.pixel_threshold = constants::serpinsky_threshold,
+		.max_triangles   = constants::serpinsky_budget
+	});
+	m_zoom_target = m_serpinsky->zoom_target(constants::zoom_depth);
+	m_zoom_floor  = std::ldexp(static_cast<f64>(glm::length(serpinsky_root[1].position - serpinsky_root[0].position)),
+		-static_cast<i32>(constants::zoom_depth));
 
-	m_model = std::make_unique<resources::model>(m_device, toys::make_serpinsky(6, vertices));
+	m_serpinsky_vertices.emplace(m_device,
+		sizeof(model::instance) + constants::instance_slots * m_serpinsky->max_vertices() * sizeof(model::vertex),
+		VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	m_serpinsky_vertices->as<model::instance>(0, 1).front() = model::instance{ .transform = glm::mat4{ 1.0f } };
 }
 
 } // namespace vc::game
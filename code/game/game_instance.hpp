@@ -3,12 +3,30 @@
 #include <glm/mat4x4.hpp>
 
 #include "core/window.hpp"
+#include "core/memory-usage.hpp"
+#include "core/job-system.hpp"
+#include "engine/graphics/buffer.hpp"
+#include "engine/graphics/batch-renderer.hpp"
+#include "engine/graphics/gpu-culling.hpp"
+#include "engine/graphics/gpu-timer.hpp"
 #include "engine/graphics/device.hpp"
+#include "engine/graphics/frame-capture.hpp"
+#include "engine/graphics/descriptors.hpp"
 #include "engine/graphics/pipeline.hpp"
+#include "engine/graphics/pipeline-registry.hpp"
+#include "engine/graphics/render-graph.hpp"
 #include "engine/graphics/swap-chain.hpp"
+#include "engine/graphics/texture-streamer.hpp"
 #include "engine/graphics/vulkan-instance.hpp"
 
 #include "engine/resources/model.hpp"
+#include "engine/resources/mesh-cache.hpp"
+#include "engine/scene/scene.hpp"
+#include "engine/scene/culling.hpp"
+
+#include "game/benchmark.hpp"
+#include "game/launch-options.hpp"
+#include "game/toys/serpinsky_triangle.hpp"
 
 namespace vc::game {
 
@@ -16,17 +34,52 @@ namespace constants {
 
 constexpr glm::i32vec2     window_size   { 1024, 720       };
 constexpr std::string_view default_shader{ "assets/shaders/primitive/primitive" };
-constexpr std::array<VkClearValue, 2> clear_values{
-	VkClearValue{ .color = { 0.12f, 0.12f, 0.16f, 1.0f } },
-	VkClearValue{ .depthStencil = { 1.0f, 0 } }
+constexpr std::string_view mesh_cache_dir{ "cache/meshes" };
+/// Every depth is a mesh of the batch, the first one is shown by the cluster roots
+constexpr std::array<size_t, 3> serpinsky_depths{ 6, 4, 2 };
+constexpr u32              max_draws      { 64 };
+constexpr u32              cluster_size   { 64 };  ///< A spinning root object with orbiting children
+constexpr f32              cluster_spacing{ 3.0f };
+constexpr f32              camera_fov     { 0.785f };
+constexpr f32              camera_speed   { 0.1f };   ///< Radians per second of the camera orbit
+constexpr u64              stats_interval { 600 };    ///< Frames between culling reports
+constexpr i32              memory_report_key{ GLFW_KEY_F9 };
+/// Frames after which every heap allocation of a frame counts as a steady-state one
+constexpr u64              allocation_warmup_frames{ 240 };
+constexpr u32              scene_seed     { 0x5CE9E };
+/// The adaptive toy zooms exponentially into a point of the gasket, back to the start once the
+/// triangles there reach `zoom_depth`
+constexpr u32              serpinsky_budget   { 1u << 15 };  ///< Triangles of the cut
+constexpr f32              serpinsky_threshold{ 4.0f };      ///< Pixels an edge may cover without a split
+constexpr f64              zoom_start         { 2.5 };       ///< Initial camera distance
+constexpr f64              zoom_speed         { 0.4 };       ///< Logarithm of the zoom per second
+constexpr u32              zoom_depth         { 40 };
+/// The game side writes frame N+1 while up to `max_frames_in_flight` frames are still read
+constexpr u32              instance_slots {
+	static_cast<u32>(engine::graphics::constants::max_frames_in_flight) + 2
 };
+constexpr VkClearColorValue        clear_color{ .float32 = { 0.12f, 0.12f, 0.16f, 1.0f } };
+constexpr VkClearDepthStencilValue clear_depth{ 1.0f, 0 };
+constexpr std::string_view         scene_pass { "scene" };
 
 } // namespace constants
 
+/// Immutable state the render side needs to record a frame.
+struct frame_snapshot {
+	u64          index           {};
+	glm::mat4    view_projection { 1.0f };
+	VkDeviceSize instances_offset{};
+	u32          instances_count {};
+	u32          draws_count     {};
+	engine::scene::culling_stats culling{};
+	VkDeviceSize serpinsky_offset  {};
+	u32          serpinsky_vertices{};
+	u32          serpinsky_depth   {};
+};
 
 class game_instance {
 public:
-	game_instance();
+	explicit game_instance(const launch_options &options = {});
 
 	game_instance(const game_instance &) = delete;
 	game_instance &operator=(const game_instance &) = delete;
@@ -34,26 +87,110 @@ public:
 	int run();
 
 private:
+	launch_options                            m_options;
+	core::allocation_phases                   m_allocation_phases{ "startup" };
+	core::job_system                          m_jobs           {};
 	core::window                              m_window         { constants::window_size };
 	engine::graphics::vulkan_instance         m_instance       {};
-	engine::graphics::device                  m_device         { m_instance, m_window };
+	engine::graphics::device                  m_device         {
+		m_instance, m_window, m_options.device, m_options.dynamic_rendering
+	};
 	engine::graphics::swap_chain              m_swap_chain     { m_device, m_window.extent() };
+	engine::graphics::render_graph            m_render_graph   {
+		m_device, static_cast<u32>(engine::graphics::constants::max_frames_in_flight)
+	};
+	engine::graphics::render_graph::handle    m_backbuffer     {};
+	engine::graphics::descriptor_layout_cache m_descriptor_layouts{ m_device };
+	engine::graphics::descriptor_allocator    m_descriptors    { m_device };
+	engine::graphics::pipeline_registry       m_pipelines      { m_device };
+	engine::graphics::frame_descriptor_allocator m_frame_descriptors{
+		m_device, engine::graphics::constants::max_frames_in_flight
+	};
+	engine::graphics::texture_streamer        m_textures       { m_device, m_jobs };
+	std::vector<engine::graphics::texture_streamer::handle> m_texture_handles;  ///< Until they are all settled
 	std::optional<engine::graphics::pipeline_layout> m_pipeline_layout;
-	std::optional<engine::graphics::pipeline> m_pipeline;
+	std::shared_ptr<engine::graphics::pipeline> m_pipeline;
 	std::vector<VkCommandBuffer>              m_command_buffers;
-	std::unique_ptr<engine::resources::model> m_model;
-
-	glm::mat4 test_model_transform{ 1.0f };
-
-	void update(double delta);
-	void render_frame();
-
+	engine::graphics::batch_renderer          m_batch          { m_device, constants::instance_slots, constants::max_draws };
+	std::vector<u32>                          m_meshes;
+	std::vector<u32>                          m_object_meshes;
+	engine::scene::scene                      m_scene          { m_options.objects };
+	engine::scene::bvh                        m_bvh;
+	std::vector<u32>                          m_visible;
+	std::vector<u32>                          m_draw_order;      ///< Visible objects grouped by mesh
+	std::vector<u32>                          m_mesh_instances;
+	u32                                       m_draws_count    {};
+	engine::scene::culling_stats              m_culling        {};
+	std::optional<engine::graphics::buffer>   m_instances;
+	std::optional<engine::graphics::gpu_culling> m_gpu_culling;
+	glm::mat4                                 m_view_projection{ 1.0f };
+	f32                                       m_scene_extent   {};
+	f64                                       m_camera_time    {};
+	std::optional<benchmark>                  m_benchmark;
+	std::optional<engine::graphics::gpu_timer> m_gpu_timer;
+	std::optional<engine::graphics::frame_capture> m_capture;
+	std::optional<toys::adaptive_serpinsky>   m_serpinsky;
+	std::optional<engine::graphics::buffer>   m_serpinsky_vertices;  ///< An identity instance, then the cut of every slot
+	/// Frame each slot was last brought up to date at
+	struct serpinsky_slot {
+		u64 frame   {};
+		u32 vertices{};
+		u32 depth   {};
+	};
+	std::array<serpinsky_slot, constants::instance_slots> m_serpinsky_slots{};
+	/// Triangles the cut changed at every frame of the ring
+	std::array<std::vector<u32>, constants::instance_slots> m_serpinsky_changes;
+	glm::dvec2                                m_zoom_target    {};
+	f64                                       m_zoom_floor     {};  ///< Camera distance at which the zoom restarts
+	b8                                        m_memory_key_down{ false };
+	u64                                       m_steady_allocations{};  ///< Heap allocations of frames after the warm-up
+	u64                                       m_steady_frames     {};
+	const frame_snapshot                     *m_recorded_snapshot{ nullptr };  ///< While the graph records a frame
+	size_t                                    m_recorded_image    {};
+
+	/// A mesh of the batch, read from its cache or, when the cache can't be stored, from its `writer`.
+	struct mesh_source {
+		std::optional<engine::resources::mesh_cache> cache;
+		size_t                                       vertex_count{};
+		engine::resources::model::vertex_writer      writer;
+	};
+
+	void run_serial();
+	void run_pipelined();
+	[[nodiscard]] auto is_running() const noexcept -> b8;
+	[[nodiscard]] auto frame_delta(f64 now, f64 last_time) const noexcept -> f64;
+	void finish_benchmark();
+	[[nodiscard]] auto is_capture_supported() const -> b8;
+	void construct_capture();
+	void report_memory(std::string_view reason) const;
+	void report_textures();
+	void count_frame_allocations(u64 frame, u64 allocations);
+
+	void update(double delta, u64 frame);
+	void update_camera(double delta);
+	void update_zoom(double delta);
+	void update_serpinsky(u64 frame);
+	void build_draws(u64 frame);
+	void render_frame(const frame_snapshot &snapshot);
+
+	[[nodiscard]] auto make_snapshot(u64 index) const -> frame_snapshot;
+
+	void construct_render_graph();
 	void construct_pipeline();
 	void construct_command_buffers();
 
-	void record_command_buffer(size_t image_index);
+	void record_command_buffer(size_t image_index, const frame_snapshot &snapshot);
+	void record_scene(VkCommandBuffer command_buffer, const frame_snapshot &snapshot);
+
+	void load_meshes();
+	[[nodiscard]] auto load_serpinsky(size_t depth) -> mesh_source;
+	[[nodiscard]] auto bake_mesh(std::string_view path, u64 source_key, size_t vertex_count,
+		engine::resources::model::vertex_writer writer) -> mesh_source;
+	void populate_scene();
+	void construct_serpinsky();
 
-	void load_models();
+	[[nodiscard]] auto instances_offset(u64 frame) const noexcept -> VkDeviceSize;
+	[[nodiscard]] auto serpinsky_offset(u64 frame) const noexcept -> VkDeviceSize;
 };
 
 class game_instance_error : public std::runtime_error {
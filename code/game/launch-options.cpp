@@ -0,0 +1,74 @@
+#include <span>
+#include <cstdio>
+#include <charconv>
+
+#include "game/launch-options.hpp"
+
+namespace vc::game {
+
+namespace {
+
+template<class Integer>
+void parse_number(const std::string_view name, const std::string_view text, Integer &value) {
+	const auto *last{ std::data(text) + std::size(text) };
+	if (const auto [end, error]{ std::from_chars(std::data(text), last, value) }; error != std::errc{} || end != last) {
+		std::printf("[game][launch_options] Invalid value of %.*s: %.*s\n",
+			static_cast<int>(std::size(name)), std::data(name), static_cast<int>(std::size(text)), std::data(text));
+	}
+}
+
+} // anonymous namespace
+
+launch_options launch_options::parse(const int argc, const char *const *argv) {
+	launch_options options;
+	const std::span<const char *const> arguments{ argv, static_cast<size_t>(argc) };
+
+	for (size_t i{ 1 }; i < std::size(arguments); ++i) {
+		const std::string_view argument{ arguments[i] };
+		const auto separator{ argument.find('=') };
+		const auto name{ argument.substr(0, separator) };
+
+		const auto value{ [&] () -> std::string_view {
+			if (separator != std::string_view::npos) return argument.substr(separator + 1);
+			if (i + 1 < std::size(arguments)) return arguments[++i];
+			return {};
+		} };
+
+		if (name == "--model") {
+			options.model_path = value();
+		} else if (name == "--pipelined") {
+			options.pipelined = true;
+		} else if (name == "--gpu-culling") {
+			options.gpu_culling = true;
+		} else if (name == "--dynamic-rendering") {
+			options.dynamic_rendering = true;
+		} else if (name == "--adaptive-serpinsky") {
+			options.adaptive_serpinsky = true;
+		} else if (name == "--device") {
+			options.device = value();
+		} else if (name == "--texture") {
+			options.texture_paths.emplace_back(value());
+		} else if (name == "--objects") {
+			parse_number(name, value(), options.objects);
+		} else if (name == "--benchmark-frames") {
+			parse_number(name, value(), options.benchmark_frames);
+		} else if (name == "--benchmark-seconds") {
+			parse_number(name, value(), options.benchmark_seconds);
+		} else if (name == "--warmup-frames") {
+			parse_number(name, value(), options.warmup_frames);
+		} else if (name == "--timestep") {
+			parse_number(name, value(), options.timestep);
+		} else if (name == "--benchmark-output") {
+			options.benchmark_output = value();
+		} else if (name == "--capture") {
+			options.capture_path = value();
+		} else if (name == "--capture-interval") {
+			parse_number(name, value(), options.capture_interval);
+		} else {
+			std::printf("[game][launch_options] Unknown argument: %s\n", std::data(argument));
+		}
+	}
+	return options;
+}
+
+} // namespace vc::game
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <string_view>
+
+#include "core/types.hpp"
+
+namespace vc::game {
+
+struct launch_options {
+	std::string model_path;            ///< Mesh file (.obj or .glb) to show instead of the Sierpinski toy
+	b8          pipelined  { false };  ///< Simulate frame N+1 on a game thread while frame N is submitted
+	u32         objects    { 16384 };  ///< Animated copies of the model in the scene
+	b8          gpu_culling{ false };  ///< Cull and compact the draws in a compute pass instead of the BVH
+	b8          dynamic_rendering{ false };  ///< Vulkan 1.3 rendering without render passes when the device has it
+	b8          adaptive_serpinsky{ false }; ///< Zoom into one Sierpinski triangle refined for the view, no instanced scene
+	std::string device;                ///< Index or part of the name of the GPU, overrides `VC_DEVICE`
+	std::vector<std::string> texture_paths;  ///< Images streamed in the background, `--texture` may repeat
+
+	// A benchmark runs with a fixed timestep until it measured `benchmark_frames` frames or
+	// `benchmark_seconds`, whichever comes first, and writes a JSON summary at exit
+	u32         benchmark_frames  { 0 };
+	f64         benchmark_seconds { 0.0 };
+	u32         warmup_frames     { 120 };       ///< Frames excluded from the statistics
+	f64         timestep          { 1.0 / 60.0 };  ///< Simulated seconds per benchmark frame
+	std::string benchmark_output;  ///< Summary file, standard output when empty
+
+	std::string capture_path;          ///< A `.y4m` video or a directory of PNG frames, no capture when empty
+	u32         capture_interval{ 1 }; ///< Captures every n-th frame
+
+	[[nodiscard]] auto is_benchmark() const noexcept { return benchmark_frames > 0 || benchmark_seconds > 0.0; }
+	[[nodiscard]] auto is_capturing() const noexcept { return !std::empty(capture_path) && capture_interval > 0; }
+	[[nodiscard]] static auto parse(int argc, const char *const *argv) -> launch_options;
+};
+
+} // namespace vc::game
@@ -1,12 +1,24 @@
+#include <array>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <algorithm>
+
+#include <glm/geometric.hpp>
+
 #include "game/toys/serpinsky_triangle.hpp"
 
 namespace vc::game::toys {
 
 using vertex_type = engine::resources::model::vertex;
 
-std::vector<vertex_type> populate(const std::span<const vertex_type> vertices) {
-	if (std::size(vertices) < 3) return std::vector<vertex_type>{};
+namespace {
+
+constexpr u32 root{ 0 };
 
+} // anonymous namespace
+
+void populate(const std::span<const vertex_type> vertices, const std::span<vertex_type> destination) {
 	const auto &top  { vertices[0] };
 	const auto &right{ vertices[1] };
 	const auto &left { vertices[2] };
@@ -24,29 +36,319 @@ std::vector<vertex_type> populate(const std::span<const vertex_type> vertices) {
 		.color = glm::mix(left.color, top.color, 0.5f)
 	};
 
-	return std::vector<vertex_type> {
+	const std::array<vertex_type, constants::populated_vertices> populated{
 		top, top_right, left_top,
 
 		top_right, right, right_left,
 
 		left_top, right_left, left
 	};
+	std::ranges::copy(populated, std::begin(destination));
+}
+
+std::pmr::vector<vertex_type> populate(const std::span<const vertex_type> vertices, std::pmr::memory_resource *resource) {
+	if (std::size(vertices) < constants::triangle_vertices) return std::pmr::vector<vertex_type>{ resource };
+
+	std::pmr::vector<vertex_type> result(constants::populated_vertices, resource);
+	populate(vertices, result);
+	return result;
 }
 
 std::vector<vertex_type> make_serpinsky(const size_t depth, const std::span<const vertex_type> vertices) {
 	if (depth == 0) return std::vector<vertex_type>{ std::begin(vertices), std::end(vertices) };
 
-	constexpr size_t vertices_count{ 3 };
+	constexpr size_t vertices_count{ constants::triangle_vertices };
 
 	std::vector<vertex_type> result(std::size(vertices) * vertices_count);
-	auto insert_pos{ std::begin(result) };
-	for (size_t i{}; i < std::size(vertices); i += vertices_count) {
-		const auto populated{ populate(std::span<const vertex_type>{ &vertices[i], vertices_count }) };
-		std::ranges::copy(populated, insert_pos);
-		insert_pos += std::size(populated);
+	for (size_t i{}; i + vertices_count <= std::size(vertices); i += vertices_count) {
+		populate(std::span<const vertex_type>{ &vertices[i], vertices_count },
+			std::span<vertex_type>{ &result[i * vertices_count], constants::populated_vertices });
 	}
 	return make_serpinsky(depth - 1, result);
 }
 
+std::vector<vertex_type> make_serpinsky(core::job_system &jobs, const size_t depth,
+	const std::span<const vertex_type> vertices) {
+	using namespace constants;
+
+	std::vector<vertex_type> current{ std::begin(vertices), std::end(vertices) };
+	for (size_t level{}; level < depth; ++level) {
+		std::vector<vertex_type> next(std::size(current) * triangle_vertices);
+		jobs.parallel_for(0, std::size(current) / triangle_vertices, serpinsky_grain,
+			[&current, &next] (const size_t begin, const size_t end) {
+				for (size_t i{ begin }; i < end; ++i) {
+					populate(
+						std::span<const vertex_type>{ &current[i * triangle_vertices], triangle_vertices },
+						std::span<vertex_type>{ &next[i * populated_vertices], populated_vertices }
+					);
+				}
+			});
+		current = std::move(next);
+	}
+	return current;
+}
+
+adaptive_serpinsky::adaptive_serpinsky(const std::span<const vertex_type, constants::triangle_vertices> root,
+	const settings &settings) : m_settings{ settings } {
+	node first{};
+	for (size_t i{}; i < constants::triangle_vertices; ++i) {
+		first.corners[i] = glm::dvec2{ root[i].position };
+		first.colors[i]  = root[i].color;
+	}
+	m_nodes.push_back(first);
+	m_triangles.reserve(m_settings.max_triangles);
+	m_changed.reserve(m_settings.max_triangles);
+	m_queue.reserve(m_settings.max_triangles);
+}
+
+void adaptive_serpinsky::refine(const glm::mat4 &view_projection, const glm::dvec2 origin, const glm::vec2 viewport) {
+	m_changed.clear();
+	if (origin != m_origin) {
+		m_origin = origin;
+		m_changed.resize(std::size(m_triangles));
+		std::iota(std::begin(m_changed), std::end(m_changed), 0u);
+	}
+
+	shrink(view_projection, viewport);
+	grow(view_projection, viewport);
+
+	m_depth = 0;
+	for (const auto leaf : m_triangles) {
+		m_depth = std::max(m_depth, m_nodes[leaf].depth);
+	}
+}
+
+void adaptive_serpinsky::write(const std::span<vertex_type> destination) const {
+	for (u32 triangle{}; triangle < std::size(m_triangles); ++triangle) {
+		write_triangle(destination, triangle);
+	}
+}
+
+void adaptive_serpinsky::write(const std::span<vertex_type> destination, const std::span<const u32> triangles) const {
+	for (const auto triangle : triangles) {
+		if (triangle < std::size(m_triangles)) {
+			write_triangle(destination, triangle);
+		}
+	}
+}
+
+glm::dvec2 adaptive_serpinsky::zoom_target(const u32 depth) const {
+	auto current{ m_nodes[root] };
+	for (u32 level{}; level < depth; ++level) {
+		current = child(current, level % constants::serpinsky_children);
+	}
+	return (current.corners[0] + current.corners[1] + current.corners[2]) / 3.0;
+}
+
+void adaptive_serpinsky::shrink(const glm::mat4 &view_projection, const glm::vec2 viewport) {
+	m_grow.clear();
+	m_revivals.clear();
+	if (!project(m_nodes[root], view_projection, viewport)) {
+		release_children(root);
+		release_triangle(root);
+		return;
+	}
+
+	// Only releases nodes, so the references into `m_nodes` hold
+	m_stack.assign(1, root);
+	while (!std::empty(m_stack)) {
+		const auto index{ m_stack.back() };
+		m_stack.pop_back();
+
+		auto &current{ m_nodes[index] };
+		if (current.split && !refinable(current)) {
+			release_children(index);
+		}
+		if (!current.split) {
+			if (current.slot == constants::no_index || refinable(current)) {
+				m_grow.push_back(index);
+			}
+			continue;
+		}
+
+		for (u32 i{}; i < constants::serpinsky_children; ++i) {
+			auto &next{ current.children[i] };
+			if (next == constants::no_index) {
+				auto candidate{ child(current, i) };
+				if (project(candidate, view_projection, viewport)) {
+					m_revivals.push_back(revival{ .parent = index, .index = i });
+				}
+			} else if (project(m_nodes[next], view_projection, viewport)) {
+				m_stack.push_back(next);
+			} else {
+				release(std::exchange(next, constants::no_index));
+			}
+		}
+	}
+}
+
+void adaptive_serpinsky::grow(const glm::mat4 &view_projection, const glm::vec2 viewport) {
+	// Triangles of the cut plus those promised to the leaves of the queue, a leaf without one only
+	// enters the queue when it fits in the budget
+	auto reserved{ std::size(m_triangles) };
+	const auto by_extent{ [this] (const u32 lhs, const u32 rhs) { return m_nodes[lhs].extent < m_nodes[rhs].extent; } };
+	const auto push{ [&] (const u32 index) {
+		if (m_nodes[index].slot == constants::no_index) ++reserved;
+		m_queue.push_back(index);
+		std::ranges::push_heap(m_queue, by_extent);
+	} };
+	const auto has_room{ [&] (const u32 index) {
+		return m_nodes[index].slot != constants::no_index || reserved < m_settings.max_triangles;
+	} };
+
+	// What the cut already covers comes first, then the children back in the view
+	for (const auto index : m_grow) {
+		if (has_room(index)) push(index);
+	}
+	for (const auto [parent, index] : m_revivals) {
+		auto candidate{ child(m_nodes[parent], index) };
+		if (reserved >= m_settings.max_triangles || !project(candidate, view_projection, viewport)) continue;
+
+		const auto created{ allocate(candidate) };
+		m_nodes[parent].children[index] = created;
+		push(created);
+	}
+
+	// A split trades one triangle for at most three, the largest ones go first so the budget is
+	// spent where it shows
+	while (!std::empty(m_queue)) {
+		std::ranges::pop_heap(m_queue, by_extent);
+		const auto index{ m_queue.back() };
+		m_queue.pop_back();
+
+		if (!refinable(m_nodes[index]) || reserved + constants::serpinsky_children - 1 > m_settings.max_triangles) {
+			if (m_nodes[index].slot == constants::no_index) assign_triangle(index);
+			continue;
+		}
+
+		release_triangle(index);
+		--reserved;
+		m_nodes[index].split = true;
+		for (u32 i{}; i < constants::serpinsky_children; ++i) {
+			auto candidate{ child(m_nodes[index], i) };
+			if (!project(candidate, view_projection, viewport)) continue;
+
+			const auto created{ allocate(candidate) };
+			m_nodes[index].children[i] = created;
+			push(created);
+		}
+	}
+}
+
+u32 adaptive_serpinsky::allocate(const node &value) {
+	if (std::empty(m_free_nodes)) {
+		m_nodes.push_back(value);
+		return static_cast<u32>(std::size(m_nodes) - 1);
+	}
+	const auto index{ m_free_nodes.back() };
+	m_free_nodes.pop_back();
+	m_nodes[index] = value;
+	return index;
+}
+
+void adaptive_serpinsky::release(const u32 index) {
+	release_children(index);
+	release_triangle(index);
+	m_free_nodes.push_back(index);
+}
+
+void adaptive_serpinsky::release_children(const u32 index) {
+	for (auto &next : m_nodes[index].children) {
+		if (next != constants::no_index) {
+			release(std::exchange(next, constants::no_index));
+		}
+	}
+	m_nodes[index].split = false;
+}
+
+void adaptive_serpinsky::assign_triangle(const u32 index) {
+	const auto slot{ static_cast<u32>(std::size(m_triangles)) };
+	m_nodes[index].slot = slot;
+	m_triangles.push_back(index);
+	m_changed.push_back(slot);
+}
+
+void adaptive_serpinsky::release_triangle(const u32 index) {
+	const auto slot{ std::exchange(m_nodes[index].slot, constants::no_index) };
+	if (slot == constants::no_index) return;
+
+	const auto last{ m_triangles.back() };
+	m_triangles.pop_back();
+	if (last == index) return;
+
+	m_triangles[slot]  = last;
+	m_nodes[last].slot = slot;
+	m_changed.push_back(slot);
+}
+
+void adaptive_serpinsky::write_triangle(const std::span<vertex_type> destination, const u32 triangle) const {
+	const auto &leaf{ m_nodes[m_triangles[triangle]] };
+	for (size_t corner{}; corner < constants::triangle_vertices; ++corner) {
+		destination[triangle * constants::triangle_vertices + corner] = vertex_type{
+			.position = glm::vec3{ glm::vec2{ leaf.corners[corner] - m_origin }, 0.0f },
+			.color    = leaf.colors[corner]
+		};
+	}
+}
+
+b8 adaptive_serpinsky::refinable(const node &candidate) const noexcept {
+	return candidate.extent > m_settings.pixel_threshold && candidate.depth < m_settings.max_depth;
+}
+
+adaptive_serpinsky::node adaptive_serpinsky::child(const node &parent, const u32 index) {
+	// Same corners as `populate`: the top, right and left thirds
+	constexpr std::array<std::array<u32, constants::triangle_vertices>, constants::serpinsky_children> corners{ {
+		{ 0, 3, 5 },
+		{ 3, 1, 4 },
+		{ 5, 4, 2 }
+	} };
+	const std::array<glm::dvec2, 6> positions{
+		parent.corners[0], parent.corners[1], parent.corners[2],
+		0.5 * (parent.corners[0] + parent.corners[1]),
+		0.5 * (parent.corners[1] + parent.corners[2]),
+		0.5 * (parent.corners[2] + parent.corners[0])
+	};
+	const std::array<glm::vec4, 6> colors{
+		parent.colors[0], parent.colors[1], parent.colors[2],
+		glm::mix(parent.colors[0], parent.colors[1], 0.5f),
+		glm::mix(parent.colors[1], parent.colors[2], 0.5f),
+		glm::mix(parent.colors[2], parent.colors[0], 0.5f)
+	};
+
+	node result{ .depth = parent.depth + 1 };
+	for (size_t i{}; i < constants::triangle_vertices; ++i) {
+		result.corners[i] = positions[corners[index][i]];
+		result.colors[i]  = colors[corners[index][i]];
+	}
+	return result;
+}
+
+b8 adaptive_serpinsky::project(node &candidate, const glm::mat4 &view_projection, const glm::vec2 viewport) const {
+	std::array<glm::vec4, constants::triangle_vertices> clip;
+	for (size_t i{}; i < std::size(clip); ++i) {
+		clip[i] = view_projection * glm::vec4{ glm::vec2{ candidate.corners[i] - m_origin }, 0.0f, 1.0f };
+	}
+
+	// Children lie inside their parent, a triangle beyond one of the planes hides its subtree
+	const auto beyond{ [&clip] (const auto &outside) { return std::ranges::all_of(clip, outside); } };
+	if (beyond([] (const glm::vec4 &p) { return p.x >  p.w; }) || beyond([] (const glm::vec4 &p) { return p.x < -p.w; })
+		|| beyond([] (const glm::vec4 &p) { return p.y >  p.w; }) || beyond([] (const glm::vec4 &p) { return p.y < -p.w; })
+		|| beyond([] (const glm::vec4 &p) { return p.w <= 0.0f; })) {
+		return false;
+	}
+	if (std::ranges::any_of(clip, [] (const glm::vec4 &p) { return p.w <= 0.0f; })) {
+		candidate.extent = std::numeric_limits<f32>::max();
+		return true;
+	}
+
+	candidate.extent = 0.0f;
+	for (size_t i{}; i < std::size(clip); ++i) {
+		const auto &from{ clip[i] };
+		const auto &to  { clip[(i + 1) % std::size(clip)] };
+		const auto edge{ (glm::vec2{ to } / to.w - glm::vec2{ from } / from.w) * 0.5f * viewport };
+		candidate.extent = std::max(candidate.extent, glm::length(edge));
+	}
+	return true;
+}
 
 } // namespace vc::game::toys
@@ -1,15 +1,123 @@
 #pragma once
 
+#include <span>
+#include <array>
+#include <limits>
+#include <vector>
+#include <memory_resource>
+
 #include <glm/common.hpp>
+#include <glm/vec2.hpp>
+#include <glm/mat4x4.hpp>
 
+#include "core/job-system.hpp"
 #include "engine/resources/model.hpp"
 
 namespace vc::game::toys {
 
 using vertex_type = engine::resources::model::vertex;
 
-[[nodiscard]] std::vector<vertex_type> populate(const std::span<const vertex_type> vertices);
+namespace constants {
+
+constexpr size_t triangle_vertices { 3 };
+constexpr size_t populated_vertices{ 9 };
+constexpr size_t serpinsky_grain   { 1024 }; ///< Triangles per job of the parallel generation
+constexpr u32    serpinsky_children{ 3 };
+constexpr u32    no_index          { std::numeric_limits<u32>::max() };
+
+} // namespace constants
+
+void populate(const std::span<const vertex_type> vertices, const std::span<vertex_type> destination);
+[[nodiscard]] std::pmr::vector<vertex_type> populate(const std::span<const vertex_type> vertices,
+	std::pmr::memory_resource *resource = std::pmr::get_default_resource());
 [[nodiscard]] std::vector<vertex_type> make_serpinsky(size_t depth,
 	const std::span<const vertex_type> vertices);
+[[nodiscard]] std::vector<vertex_type> make_serpinsky(core::job_system &jobs, size_t depth,
+	const std::span<const vertex_type> vertices);
+
+/// Sierpinski triangle refined where the camera looks. The sub-triangles form an implicit
+/// ternary tree generated on the fly, and the cut through it is kept from one `refine` to the
+/// next: only triangles whose projected extent crossed the pixel threshold split or merge, the
+/// largest ones splitting first until the budget is spent. Triangles outside the view are dropped
+/// with their subtree, so zooming in coarsens what leaves the screen.
+///
+/// Every triangle of the cut owns a slot of the vertex stream, slots stay packed and `changed`
+/// lists those rewritten by the last `refine`, so a copy of the stream is brought up to date
+/// without writing the whole cut again.
+class adaptive_serpinsky {
+public:
+	struct settings {
+		f32 pixel_threshold{ 4.0f };     ///< Projected edge length under which a triangle is a leaf
+		u32 max_triangles  { 1u << 15 };
+		u32 max_depth      { 44 };       ///< Doubles still tell the corners apart at this depth
+	};
+
+	/// `root` is the outer triangle in the z = 0 plane, ordered like for `populate`.
+	adaptive_serpinsky(std::span<const vertex_type, constants::triangle_vertices> root, const settings &settings);
+
+	/// Updates the cut for a camera whose `view_projection` is relative to `origin`, so deep
+	/// levels keep the precision of floats. Moving the origin changes every slot.
+	void refine(const glm::mat4 &view_projection, glm::dvec2 origin, glm::vec2 viewport);
+	/// Three vertices per triangle of the cut, relative to the origin.
+	void write(std::span<vertex_type> destination) const;
+	/// Only the given slots, those past the end of the cut are skipped.
+	void write(std::span<vertex_type> destination, std::span<const u32> triangles) const;
+	/// A point of the gasket worth zooming into, the centre of the triangle reached by cycling
+	/// through the children down to `depth`.
+	[[nodiscard]] auto zoom_target(u32 depth) const -> glm::dvec2;
+
+	/// Slots rewritten by the last `refine`, possibly twice or past the end of the cut.
+	[[nodiscard]] auto changed() const noexcept -> std::span<const u32> { return m_changed; }
+	[[nodiscard]] auto triangles() const noexcept { return std::size(m_triangles); }
+	[[nodiscard]] auto vertex_count() const noexcept { return std::size(m_triangles) * constants::triangle_vertices; }
+	[[nodiscard]] auto max_vertices() const noexcept -> size_t { return m_settings.max_triangles * constants::triangle_vertices; }
+	[[nodiscard]] auto depth() const noexcept { return m_depth; }  ///< Of the deepest triangle of the cut
+
+private:
+	struct node {
+		std::array<glm::dvec2, constants::triangle_vertices> corners;
+		std::array<glm::vec4, constants::triangle_vertices>  colors;
+		/// Missing for a leaf, and for the children of a split node that are outside the view
+		std::array<u32, constants::serpinsky_children>       children{ constants::no_index, constants::no_index, constants::no_index };
+		u32 slot  { constants::no_index };  ///< Of the triangle drawing a leaf
+		u32 depth {};
+		f32 extent{};  ///< Longest projected edge in pixels
+		b8  split {};
+	};
+	struct revival {
+		u32 parent;
+		u32 index;
+	};
+
+	settings             m_settings;
+	std::vector<node>    m_nodes;       ///< The root comes first, released nodes are reused
+	std::vector<u32>     m_free_nodes;
+	std::vector<u32>     m_triangles;   ///< Leaf drawn by every slot
+	std::vector<u32>     m_changed;
+	std::vector<u32>     m_grow;        ///< Leaves to split or to give a triangle
+	std::vector<revival> m_revivals;    ///< Missing children back in the view
+	std::vector<u32>     m_queue;       ///< Max-heap on the projected extent
+	std::vector<u32>     m_stack;
+	glm::dvec2           m_origin{};
+	u32                  m_depth {};
+
+	/// Drops the subtrees that left the view and merges the split nodes under the threshold.
+	void shrink(const glm::mat4 &view_projection, glm::vec2 viewport);
+	/// Splits the leaves over the threshold, the largest first, as far as the budget goes.
+	void grow(const glm::mat4 &view_projection, glm::vec2 viewport);
+
+	[[nodiscard]] auto allocate(const node &value) -> u32;
+	void release(u32 index);
+	void release_children(u32 index);
+	void assign_triangle(u32 index);
+	/// The last slot moves into the freed one, so the slots stay packed.
+	void release_triangle(u32 index);
+	void write_triangle(std::span<vertex_type> destination, u32 triangle) const;
+
+	[[nodiscard]] auto refinable(const node &candidate) const noexcept -> b8;
+	[[nodiscard]] static auto child(const node &parent, u32 index) -> node;
+	/// Returns false when the node is outside the view, its extent is set otherwise.
+	[[nodiscard]] auto project(node &candidate, const glm::mat4 &view_projection, glm::vec2 viewport) const -> b8;
+};
 
 } // namespace vc::game::toys
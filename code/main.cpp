@@ -3,8 +3,8 @@
 
 #include "game/game_instance.hpp"
 
-int main() try {
-	return vc::game::game_instance{}.run();
+int main(int argc, char **argv) try {
+	return vc::game::game_instance{ vc::game::launch_options::parse(argc, argv) }.run();
 } catch (const std::exception &e) {
 	std::printf("[main] Fatal error: %s\n", e.what());
 	return EXIT_FAILURE;
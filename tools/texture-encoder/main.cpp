@@ -0,0 +1,77 @@
+#include <span>
+#include <cstdio>
+#include <string>
+#include <exception>
+#include <string_view>
+
+#include "engine/resources/ktx2.hpp"
+#include "engine/resources/image-decoder.hpp"
+#include "engine/resources/block-compression.hpp"
+
+namespace {
+
+using namespace vc;
+using namespace vc::engine::resources;
+
+struct encoder_options {
+	std::string  input;
+	std::string  output;
+	block_format format{ block_format::bc7 };
+	b8           srgb  { true };
+	b8           mips  { true };
+};
+
+void print_usage() {
+	std::printf("Usage: vc-texture-encoder <input> <output.ktx2> [--format bc1|bc3|bc7] [--linear] [--no-mips]\n");
+}
+
+[[nodiscard]] auto parse(const std::span<const char *const> arguments) -> encoder_options {
+	encoder_options options;
+	for (size_t i{ 1 }; i < std::size(arguments); ++i) {
+		const std::string_view argument{ arguments[i] };
+		if (argument == "--format" && i + 1 < std::size(arguments)) {
+			const std::string_view format{ arguments[++i] };
+			if (format == "bc1") {
+				options.format = block_format::bc1;
+			} else if (format == "bc3") {
+				options.format = block_format::bc3;
+			} else if (format == "bc7") {
+				options.format = block_format::bc7;
+			} else {
+				throw std::runtime_error{ "Unknown block format: " + std::string{ format } };
+			}
+		} else if (argument == "--linear") {
+			options.srgb = false;
+		} else if (argument == "--no-mips") {
+			options.mips = false;
+		} else if (std::empty(options.input)) {
+			options.input = argument;
+		} else if (std::empty(options.output)) {
+			options.output = argument;
+		} else {
+			throw std::runtime_error{ "Unexpected argument: " + std::string{ argument } };
+		}
+	}
+	return options;
+}
+
+} // anonymous namespace
+
+int main(int argc, char **argv) try {
+	const auto options{ parse(std::span<const char *const>{ argv, static_cast<size_t>(argc) }) };
+	if (std::empty(options.input) || std::empty(options.output)) {
+		print_usage();
+		return EXIT_FAILURE;
+	}
+
+	const auto source{ decode_image(options.input) };
+	const auto texture{ compress_image(source, options.format, options.srgb, options.mips) };
+	write_ktx2(options.output, texture);
+
+	std::printf("[texture_encoder] %s: %ux%u, %zu levels, %zu bytes of blocks\n", std::data(options.output),
+		texture.extent.x, texture.extent.y, std::size(texture.levels), std::size(texture.data));
+	return EXIT_SUCCESS;
+} catch (const std::exception &e) {
+	std::printf("[texture_encoder] Fatal error: %s\n", e.what());
+	return EXIT_FAILURE;
+}